@@ -0,0 +1,311 @@
+/*
+ * Geneie - A Library and Tools for DNA data
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * A small benchmark harness, shared by every benchmark in
+ * this directory.
+ *
+ * Each benchmark calls bench_run() for each input size it
+ * supports. The body is run enough times per repetition to
+ * take at least the minimum time, after one untimed
+ * warm-up repetition, and one line of JSON is printed per
+ * benchmark and size:
+ *
+ * {"benchmark": "encoding_translate", "bases": 1024, ...}
+ *
+ * with the median, minimum and maximum ns/base over the
+ * repetitions, the median GB/s and the ns/base of every
+ * repetition, so tools can do their own statistics.
+ *
+ * Options:
+ *   --large             also run the 1 GiB size
+ *   --repetitions=N     timed repetitions (default 10)
+ *   --min-time=MS       minimum time per repetition (default 20)
+ *   --filter=TEXT       only run benchmarks containing TEXT
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <sys/types.h>
+
+#define BENCH_MAX_REPETITIONS 1000
+
+// Inputs of destroyable benchmarks are kept within this,
+// so small sizes stay in cache like the others
+#define BENCH_POOL_SIZE (1024 * 1024)
+
+/*
+ * The sizes, in bases, that benchmarks are run at: one
+ * codon, 1 KiB, 1 MiB and, with --large, 1 GiB.
+ */
+static const ssize_t bench_sizes[] = {
+	3,
+	1024,
+	1024 * 1024,
+	1024 * 1024 * 1024,
+};
+
+#define BENCH_SIZE_COUNT (sizeof(bench_sizes) / sizeof(bench_sizes[0]))
+
+static struct {
+	bool large;
+	int repetitions;
+	double min_time;
+	const char *filter;
+} bench_options = {
+	.repetitions = 10,
+	.min_time = 0.02,
+};
+
+/*
+ * Runs one iteration of a benchmark. `iteration` counts up
+ * from 0 after each reset.
+ */
+typedef void bench_body(void *param, ssize_t iteration);
+
+/*
+ * Restores a benchmark's input before a repetition. Isn't
+ * timed.
+ */
+typedef void bench_reset(void *param);
+
+/*
+ * Stops the compiler from optimising away a result.
+ */
+#define bench_use(value) __asm__ volatile("" : : "r"(value) : "memory")
+
+static inline void bench_init(int argc, char **argv)
+{
+	for (int i = 1; i < argc; i++) {
+		const char *const arg = argv[i];
+		if (!strcmp(arg, "--large")) {
+			bench_options.large = true;
+		} else if (!strncmp(arg, "--repetitions=", 14)) {
+			bench_options.repetitions = atoi(arg + 14);
+		} else if (!strncmp(arg, "--min-time=", 11)) {
+			bench_options.min_time = atof(arg + 11) / 1000;
+		} else if (!strncmp(arg, "--filter=", 9)) {
+			bench_options.filter = arg + 9;
+		} else {
+			fprintf(stderr, "%s: unknown option %s\n", argv[0], arg);
+			exit(2);
+		}
+	}
+
+	if (bench_options.repetitions < 1)
+		bench_options.repetitions = 1;
+	if (bench_options.repetitions > BENCH_MAX_REPETITIONS)
+		bench_options.repetitions = BENCH_MAX_REPETITIONS;
+}
+
+static inline bool bench_size_enabled(ssize_t size)
+{
+	return bench_options.large || size < 1024 * 1024 * 1024;
+}
+
+static inline bool bench_enabled(const char *name, ssize_t size)
+{
+	if (!bench_size_enabled(size))
+		return false;
+	return !bench_options.filter || strstr(name, bench_options.filter);
+}
+
+static inline double bench_now(void)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+static inline int bench_compare(const void *a, const void *b)
+{
+	const double x = *(const double *)a, y = *(const double *)b;
+	return (x > y) - (x < y);
+}
+
+static inline double bench_repetition(
+	bench_body *body,
+	bench_reset *reset,
+	void *param,
+	ssize_t iterations
+)
+{
+	if (reset)
+		reset(param);
+
+	const double start = bench_now();
+	for (ssize_t i = 0; i < iterations; i++)
+		body(param, i);
+	return bench_now() - start;
+}
+
+/*
+ * Runs and reports one benchmark.
+ *
+ * `bases` is the size of the input a single iteration
+ * processes, in bytes. If the body destroys its input, pass a reset
+ * function and the number of iterations the input is good
+ * for; otherwise pass NULL and 0.
+ */
+static inline void bench_run(
+	const char *name,
+	ssize_t bases,
+	bench_body *body,
+	bench_reset *reset,
+	ssize_t max_iterations,
+	void *param
+)
+{
+	if (!bench_enabled(name, bases))
+		return;
+
+	// One-off costs, such as building tables, mustn't
+	// count towards the calibration
+	bench_repetition(body, reset, param, 1);
+
+	// Warms up further while finding how many iterations
+	// fill the minimum time
+	ssize_t iterations = 1;
+	double elapsed;
+	while ((elapsed = bench_repetition(body, reset, param, iterations)) < bench_options.min_time) {
+		if (max_iterations && iterations >= max_iterations)
+			break;
+
+		ssize_t next = iterations * 2;
+		if (elapsed > 0)
+			next = (ssize_t)((double)iterations * bench_options.min_time * 1.2 / elapsed) + 1;
+		if (next > iterations * 100)
+			next = iterations * 100;
+		if (max_iterations && next > max_iterations)
+			next = max_iterations;
+		iterations = next;
+	}
+
+	static double samples[BENCH_MAX_REPETITIONS], sorted[BENCH_MAX_REPETITIONS];
+	const int repetitions = bench_options.repetitions;
+	const double work = (double)bases * (double)iterations;
+	for (int i = 0; i < repetitions; i++)
+		samples[i] = bench_repetition(body, reset, param, iterations) * 1e9 / work;
+
+	memcpy(sorted, samples, sizeof(double) * (size_t)repetitions);
+	qsort(sorted, (size_t)repetitions, sizeof(double), bench_compare);
+	const double median = repetitions % 2
+		? sorted[repetitions / 2]
+		: (sorted[repetitions / 2 - 1] + sorted[repetitions / 2]) / 2;
+
+	printf("{\"benchmark\": \"%s\", \"bases\": %zd, \"iterations\": %zd, "
+		"\"repetitions\": %d, \"ns_per_base\": %.6g, "
+		"\"ns_per_base_min\": %.6g, \"ns_per_base_max\": %.6g, "
+		"\"gb_per_s\": %.6g, \"samples\": [",
+		name, bases, iterations, repetitions, median,
+		sorted[0], sorted[repetitions - 1],
+		median > 0 ? 1 / median : 0.0);
+	for (int i = 0; i < repetitions; i++)
+		printf(i ? ", %.6g" : "%.6g", samples[i]);
+	printf("]}\n");
+	fflush(stdout);
+}
+
+/*
+ * Fills a buffer with pseudo-random codes from an alphabet.
+ * The same seed always gives the same codes.
+ */
+static inline void bench_fill(char *codes, ssize_t length, const char *alphabet, uint64_t seed)
+{
+	const uint64_t count = strlen(alphabet);
+	uint64_t state = seed * 0x9e3779b97f4a7c15u + 1;
+	for (ssize_t i = 0; i < length; i++) {
+		// xorshift64*
+		state ^= state >> 12;
+		state ^= state << 25;
+		state ^= state >> 27;
+		codes[i] = alphabet[((state * 0x2545f4914f6cdd1du) >> 32) % count];
+	}
+}
+
+/*
+ * Fills a buffer with pseudo-random mRNA codons, none of
+ * which are stop codons, for encoders that stop at them.
+ */
+static inline void bench_fill_reading_frame(char *codes, ssize_t length, uint64_t seed)
+{
+	bench_fill(codes, length, "ACGU", seed);
+
+	// Every stop codon starts with U
+	for (ssize_t i = 0; i < length; i += 3) {
+		if (codes[i] == 'U')
+			codes[i] = 'C';
+	}
+}
+
+/*
+ * Holds copies of one input for a benchmark that destroys
+ * it, so each iteration of a repetition gets a fresh one.
+ */
+struct bench_pool {
+	ssize_t size;
+	ssize_t copies;
+	char *pristine;
+	char *work;
+};
+
+static inline struct bench_pool bench_pool_alloc(const char *pristine, ssize_t size)
+{
+	ssize_t copies = BENCH_POOL_SIZE / size;
+	if (copies < 1)
+		copies = 1;
+
+	struct bench_pool result = {
+		size,
+		copies,
+		malloc((size_t)size),
+		malloc((size_t)(size * copies)),
+	};
+	if (!result.pristine || !result.work) {
+		fprintf(stderr, "bench: out of memory for %zd bases\n", size);
+		exit(1);
+	}
+	memcpy(result.pristine, pristine, (size_t)size);
+	return result;
+}
+
+/*
+ * A bench_reset for a bench_pool, or for a struct starting
+ * with one.
+ */
+static inline void bench_pool_reset(void *param)
+{
+	struct bench_pool *const pool = param;
+	for (ssize_t i = 0; i < pool->copies; i++)
+		memcpy(pool->work + i * pool->size, pool->pristine, (size_t)pool->size);
+}
+
+static inline char *bench_pool_get(struct bench_pool *pool, ssize_t iteration)
+{
+	return pool->work + iteration * pool->size;
+}
+
+static inline void bench_pool_free(struct bench_pool pool)
+{
+	free(pool.pristine);
+	free(pool.work);
+}
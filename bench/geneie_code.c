@@ -0,0 +1,56 @@
+/*
+ * Geneie - A Library and Tools for DNA data
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "bench_macros.h"
+#include "geneie/code.h"
+
+static void bench_nucleic_string_valid(void *param, ssize_t iteration)
+{
+	(void)iteration;
+	bench_use(geneie_code_nucleic_string_valid(param));
+}
+
+static void bench_amino_string_valid(void *param, ssize_t iteration)
+{
+	(void)iteration;
+	bench_use(geneie_code_amino_string_valid(param));
+}
+
+int main(int argc, char **argv)
+{
+	bench_init(argc, argv);
+
+	for (size_t i = 0; i < BENCH_SIZE_COUNT; i++) {
+		const ssize_t size = bench_sizes[i];
+		if (!bench_size_enabled(size))
+			continue;
+
+		char *const nucleic = malloc((size_t)size + 1);
+		char *const amino = malloc((size_t)size + 1);
+		bench_fill(nucleic, size, "ACGTURYKMSWBDHVN", 1);
+		bench_fill(amino, size, "ACDEFGHIKLMNPQRSTVWY", 2);
+		nucleic[size] = amino[size] = '\0';
+
+		bench_run("code_nucleic_string_valid", size, bench_nucleic_string_valid, NULL, 0, nucleic);
+		bench_run("code_amino_string_valid", size, bench_amino_string_valid, NULL, 0, amino);
+
+		free(nucleic);
+		free(amino);
+	}
+}
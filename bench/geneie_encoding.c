@@ -0,0 +1,96 @@
+/*
+ * Geneie - A Library and Tools for DNA data
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "bench_macros.h"
+#include "geneie/encoding.h"
+
+typedef struct geneie_sequence_ref ref;
+
+struct input {
+	ref strand;
+	ref out;
+};
+
+static void bench_get_valid_codes(void *param, ssize_t iteration)
+{
+	(void)iteration;
+	struct input *const input = param;
+	for (ssize_t i = 0; i + 3 <= input->strand.length; i += 3) {
+		const ref codes = geneie_encoding_get_valid_codes((ref) { 3, input->strand.codes + i });
+		bench_use(codes.codes);
+	}
+}
+
+static void bench_one_codon(void *param, ssize_t iteration)
+{
+	(void)iteration;
+	struct input *const input = param;
+	for (ssize_t i = 0; i + 3 <= input->strand.length; i += 3) {
+		geneie_encoding_one_codon(
+			(ref) { 3, input->strand.codes + i },
+			(ref) { 1, input->out.codes + i / 3 }
+		);
+	}
+	bench_use(input->out.codes);
+}
+
+static void bench_translate_codon(void *param, ssize_t iteration)
+{
+	(void)iteration;
+	struct input *const input = param;
+	for (ssize_t i = 0; i + 3 <= input->strand.length; i += 3)
+		input->out.codes[i / 3] = geneie_encoding_translate_codon(input->strand.codes + i);
+	bench_use(input->out.codes);
+}
+
+static void bench_translate(void *param, ssize_t iteration)
+{
+	(void)iteration;
+	struct input *const input = param;
+	bench_use(geneie_encoding_translate(input->strand, input->out));
+}
+
+int main(int argc, char **argv)
+{
+	bench_init(argc, argv);
+
+	for (size_t i = 0; i < BENCH_SIZE_COUNT; i++) {
+		const ssize_t size = bench_sizes[i];
+		if (!bench_size_enabled(size))
+			continue;
+
+		struct input input = {
+			{ size, malloc((size_t)size) },
+			{ size / 3 + 1, malloc((size_t)size / 3 + 1) },
+		};
+		bench_fill_reading_frame(input.strand.codes, size, 1);
+
+		// These look every codon up from scratch, so
+		// they're far too slow for the big sizes
+		if (size <= 1024) {
+			bench_run("encoding_get_valid_codes", size, bench_get_valid_codes, NULL, 0, &input);
+			bench_run("encoding_one_codon", size, bench_one_codon, NULL, 0, &input);
+		}
+		bench_run("encoding_translate_codon", size, bench_translate_codon, NULL, 0, &input);
+		bench_run("encoding_translate", size, bench_translate, NULL, 0, &input);
+
+		free(input.strand.codes);
+		free(input.out.codes);
+	}
+}
@@ -0,0 +1,141 @@
+/*
+ * Geneie - A Library and Tools for DNA data
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "bench_macros.h"
+#include "geneie/fasta.h"
+#include "geneie/fastq.h"
+
+typedef struct geneie_sequence_ref ref;
+
+#define LINE_WIDTH 60
+#define FASTA_RECORD_LENGTH 10000
+#define FASTQ_READ_LENGTH 150
+#define FASTQ_BATCH_SIZE 256
+
+/*
+ * Writes `size` bytes of records, cutting the last one
+ * short if needed.
+ */
+static char *make_fasta(ssize_t size)
+{
+	char *const result = malloc((size_t)size);
+	bench_fill(result, size, "ACGT", 1);
+
+	ssize_t position = 0, record = 0;
+	while (position < size) {
+		const int header = snprintf(NULL, 0, ">record%zd\n", record);
+		if (position + header <= size)
+			sprintf(result + position, ">record%zd", record);
+		if (position + header - 1 < size)
+			result[position + header - 1] = '\n';
+		position += header;
+
+		for (ssize_t i = 0; i < FASTA_RECORD_LENGTH && position < size; i += LINE_WIDTH) {
+			position += LINE_WIDTH;
+			if (position < size)
+				result[position++] = '\n';
+		}
+		record++;
+	}
+	return result;
+}
+
+static char *make_fastq(ssize_t size)
+{
+	char *const result = malloc((size_t)size);
+
+	for (ssize_t position = 0, record = 0; position < size; record++) {
+		char text[FASTQ_READ_LENGTH * 2 + 64];
+		int length = sprintf(text, "@read%zd\n", record);
+		bench_fill(text + length, FASTQ_READ_LENGTH, "ACGT", (uint64_t)record);
+		length += FASTQ_READ_LENGTH;
+		length += sprintf(text + length, "\n+\n");
+		memset(text + length, 'I', FASTQ_READ_LENGTH);
+		length += FASTQ_READ_LENGTH;
+		text[length++] = '\n';
+
+		if (length > size - position)
+			length = (int)(size - position);
+		memcpy(result + position, text, (size_t)length);
+		position += length;
+	}
+	return result;
+}
+
+// The FASTA reader compacts sequences in-place, so needs a
+// fresh copy each time
+static void bench_fasta(void *param, ssize_t iteration)
+{
+	struct bench_pool *const pool = param;
+	struct geneie_fasta_reader reader = geneie_fasta_reader_init(
+		bench_pool_get(pool, iteration),
+		pool->size,
+		true
+	);
+	struct geneie_fasta_record record;
+	ssize_t bases = 0;
+	while (geneie_fasta_reader_next(&reader, &record))
+		bases += record.sequence.length;
+	bench_use(bases);
+}
+
+struct fastq_input {
+	ref text;
+	struct geneie_fastq_batch batch;
+};
+
+static void bench_fastq(void *param, ssize_t iteration)
+{
+	(void)iteration;
+	struct fastq_input *const input = param;
+	struct geneie_fastq_reader reader = geneie_fastq_reader_init(
+		input->text.codes,
+		input->text.length,
+		false
+	);
+	ssize_t records = 0, count;
+	while ((count = geneie_fastq_reader_read_batch(&reader, &input->batch)) > 0)
+		records += count;
+	bench_use(records);
+}
+
+int main(int argc, char **argv)
+{
+	bench_init(argc, argv);
+
+	for (size_t i = 0; i < BENCH_SIZE_COUNT; i++) {
+		const ssize_t size = bench_sizes[i];
+		if (!bench_size_enabled(size))
+			continue;
+
+		char *const fasta = make_fasta(size);
+		struct bench_pool pool = bench_pool_alloc(fasta, size);
+		bench_run("fasta_reader_next", size, bench_fasta, bench_pool_reset, pool.copies, &pool);
+		bench_pool_free(pool);
+		free(fasta);
+
+		struct fastq_input input = {
+			{ size, make_fastq(size) },
+			geneie_fastq_batch_alloc(FASTQ_BATCH_SIZE),
+		};
+		bench_run("fastq_reader_read_batch", size, bench_fastq, NULL, 0, &input);
+		free(input.text.codes);
+		geneie_fastq_batch_free(input.batch);
+	}
+}
@@ -0,0 +1,150 @@
+/*
+ * Geneie - A Library and Tools for DNA data
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench_macros.h"
+#include "geneie/fasta_index.h"
+#include "geneie/thread_pool.h"
+
+typedef struct geneie_sequence_ref ref;
+
+#define LINE_WIDTH 60
+
+// A typical short read, as fetched when checking alignments
+#define READ_LENGTH 150
+
+/*
+ * One record of `size` bases, so each benchmark covers the
+ * same bases as the others at that size.
+ */
+struct input {
+	ref text;
+	struct geneie_fasta_index index;
+	const struct geneie_fasta_index_entry *entry;
+	ref out;
+};
+
+static ref make_fasta(ssize_t size)
+{
+	static const char header[] = ">chr1\n";
+	const ssize_t lines = (size + LINE_WIDTH - 1) / LINE_WIDTH;
+	const ssize_t length = (ssize_t)sizeof(header) - 1 + size + lines;
+	char *const result = malloc((size_t)length);
+
+	memcpy(result, header, sizeof(header) - 1);
+	char *out = result + sizeof(header) - 1;
+	for (ssize_t i = 0; i < size; i += LINE_WIDTH) {
+		ssize_t line = size - i;
+		if (line > LINE_WIDTH)
+			line = LINE_WIDTH;
+		bench_fill(out, line, "ACGT", (uint64_t)i);
+		out += line;
+		*out++ = '\n';
+	}
+	return (ref) { length, result };
+}
+
+static void bench_build(void *param, ssize_t iteration)
+{
+	(void)iteration;
+	struct input *const input = param;
+	struct geneie_fasta_index index = geneie_fasta_index_build(input->text.codes, input->text.length);
+	bench_use(index.count);
+	geneie_fasta_index_free(index);
+}
+
+static void bench_build_parallel(void *param, ssize_t iteration)
+{
+	(void)iteration;
+	struct input *const input = param;
+	struct geneie_fasta_index index = geneie_fasta_index_build_parallel(
+		input->text.codes,
+		input->text.length,
+		geneie_thread_pool_default()
+	);
+	bench_use(index.count);
+	geneie_fasta_index_free(index);
+}
+
+// Fetches every read's worth of the record in turn
+static void bench_fetch(void *param, ssize_t iteration)
+{
+	(void)iteration;
+	struct input *const input = param;
+	const ssize_t length = input->entry->length;
+
+	for (ssize_t start = 0; start < length; start += READ_LENGTH) {
+		ssize_t end = start + READ_LENGTH;
+		if (end > length)
+			end = length;
+
+		struct geneie_sequence read = geneie_fasta_index_fetch(
+			input->entry,
+			input->text.codes,
+			input->text.length,
+			start,
+			end
+		);
+		bench_use(read.codes);
+		geneie_sequence_free(read);
+	}
+}
+
+static void bench_fetch_into(void *param, ssize_t iteration)
+{
+	(void)iteration;
+	struct input *const input = param;
+	bench_use(geneie_fasta_index_fetch_into(
+		input->entry,
+		input->text.codes,
+		input->text.length,
+		0,
+		input->entry->length,
+		input->out
+	).length);
+}
+
+int main(int argc, char **argv)
+{
+	bench_init(argc, argv);
+
+	for (size_t i = 0; i < BENCH_SIZE_COUNT; i++) {
+		const ssize_t size = bench_sizes[i];
+		if (!bench_size_enabled(size))
+			continue;
+
+		struct input input = {
+			.text = make_fasta(size),
+			.out = { size, malloc((size_t)size) },
+		};
+		input.index = geneie_fasta_index_build(input.text.codes, input.text.length);
+		input.entry = geneie_fasta_index_find(input.index, "chr1");
+		if (!input.entry) {
+			fprintf(stderr, "bench: couldn't index %zd bases\n", size);
+			return 1;
+		}
+
+		bench_run("fasta_index_build", size, bench_build, NULL, 0, &input);
+		bench_run("fasta_index_build_parallel", size, bench_build_parallel, NULL, 0, &input);
+		bench_run("fasta_index_fetch", size, bench_fetch, NULL, 0, &input);
+		bench_run("fasta_index_fetch_into", size, bench_fetch_into, NULL, 0, &input);
+
+		geneie_fasta_index_free(input.index);
+		free(input.text.codes);
+		free(input.out.codes);
+	}
+}
@@ -0,0 +1,120 @@
+/*
+ * Geneie - A Library and Tools for DNA data
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench_macros.h"
+#include "geneie/rope.h"
+
+typedef struct geneie_sequence_ref ref;
+typedef struct geneie_rope rope_t;
+
+// A typical short read
+#define READ_LENGTH 150
+
+// Introns of 64 every 256 bases, as for the sequence tools
+#define INTRON_SPACING 256
+#define INTRON_START 96
+#define INTRON_LENGTH 64
+
+struct input {
+	ref source;
+	rope_t rope;
+};
+
+static rope_t append_reads(ref source)
+{
+	rope_t result = geneie_rope_alloc();
+	for (ssize_t i = 0; i < source.length; i += READ_LENGTH) {
+		ssize_t length = source.length - i;
+		if (length > READ_LENGTH)
+			length = READ_LENGTH;
+		geneie_rope_append(&result, (ref) { length, source.codes + i });
+	}
+	return result;
+}
+
+static void bench_append(void *param, ssize_t iteration)
+{
+	(void)iteration;
+	struct input *const input = param;
+	rope_t rope = append_reads(input->source);
+	bench_use(rope.length);
+	geneie_rope_free(rope);
+}
+
+static void keep(rope_t *result, rope_t rope, ssize_t start, ssize_t end)
+{
+	if (end > rope.length)
+		end = rope.length;
+	if (start >= end)
+		return;
+
+	rope_t slice = geneie_rope_slice(rope, start, end - start);
+	geneie_rope_concat(result, slice);
+	geneie_rope_free(slice);
+}
+
+// Builds the spliced rope from slices of the exons, so no
+// codes are copied
+static void bench_splice(void *param, ssize_t iteration)
+{
+	(void)iteration;
+	struct input *const input = param;
+	rope_t result = geneie_rope_alloc();
+
+	for (ssize_t start = 0; start < input->rope.length; start += INTRON_SPACING) {
+		keep(&result, input->rope, start, start + INTRON_START);
+		keep(&result, input->rope, start + INTRON_START + INTRON_LENGTH, start + INTRON_SPACING);
+	}
+	bench_use(result.length);
+	geneie_rope_free(result);
+}
+
+static void bench_to_sequence(void *param, ssize_t iteration)
+{
+	(void)iteration;
+	struct input *const input = param;
+	struct geneie_sequence sequence = geneie_rope_to_sequence(input->rope);
+	bench_use(sequence.length);
+	geneie_sequence_free(sequence);
+}
+
+int main(int argc, char **argv)
+{
+	bench_init(argc, argv);
+
+	for (size_t i = 0; i < BENCH_SIZE_COUNT; i++) {
+		const ssize_t size = bench_sizes[i];
+		if (!bench_size_enabled(size))
+			continue;
+
+		struct input input = { .source = { size, malloc((size_t)size) } };
+		bench_fill(input.source.codes, size, "ACGT", 1);
+		input.rope = append_reads(input.source);
+
+		bench_run("rope_append", size, bench_append, NULL, 0, &input);
+		bench_run("rope_to_sequence", size, bench_to_sequence, NULL, 0, &input);
+
+		// Slicing and concatenating each scan the pieces from
+		// the start, so the largest size would take hours
+		if (size <= 1024 * 1024)
+			bench_run("rope_splice", size, bench_splice, NULL, 0, &input);
+
+		geneie_rope_free(input.rope);
+		free(input.source.codes);
+	}
+}
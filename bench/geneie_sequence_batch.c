@@ -0,0 +1,113 @@
+/*
+ * Geneie - A Library and Tools for DNA data
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "bench_macros.h"
+#include "geneie/sequence_batch.h"
+
+typedef struct geneie_sequence_ref ref;
+typedef struct geneie_sequence_batch batch_t;
+
+// A typical short read
+#define RECORD_LENGTH 150
+
+struct input {
+	ref source;
+	batch_t batch;
+	batch_t aminos;
+	bool *results;
+};
+
+static void bench_append(void *param, ssize_t iteration)
+{
+	(void)iteration;
+	struct input *const input = param;
+	geneie_sequence_batch_clear(&input->batch);
+	for (ssize_t i = 0; i < input->source.length; i += RECORD_LENGTH) {
+		ssize_t length = input->source.length - i;
+		if (length > RECORD_LENGTH)
+			length = RECORD_LENGTH;
+		geneie_sequence_batch_append(&input->batch, (ref) { length, input->source.codes + i });
+	}
+	bench_use(input->batch.count);
+}
+
+static void bench_validate(void *param, ssize_t iteration)
+{
+	(void)iteration;
+	struct input *const input = param;
+	bench_use(geneie_sequence_batch_validate(input->batch, input->results));
+}
+
+static void bench_dna_to_premrna(void *param, ssize_t iteration)
+{
+	(void)iteration;
+	struct input *const input = param;
+	geneie_sequence_batch_dna_to_premrna(input->batch);
+}
+
+// Reversing twice gives back the input, so this doesn't
+// need resetting
+static void bench_reverse_complement(void *param, ssize_t iteration)
+{
+	(void)iteration;
+	struct input *const input = param;
+	geneie_sequence_batch_reverse_complement(input->batch);
+}
+
+static void bench_translate(void *param, ssize_t iteration)
+{
+	(void)iteration;
+	struct input *const input = param;
+	bench_use(geneie_sequence_batch_translate(input->batch, &input->aminos));
+}
+
+int main(int argc, char **argv)
+{
+	bench_init(argc, argv);
+
+	for (size_t i = 0; i < BENCH_SIZE_COUNT; i++) {
+		const ssize_t size = bench_sizes[i];
+		if (!bench_size_enabled(size))
+			continue;
+
+		const ssize_t records = size / RECORD_LENGTH + 1;
+		struct input input = {
+			{ size, malloc((size_t)size) },
+			geneie_sequence_batch_alloc(records, size),
+			geneie_sequence_batch_alloc(records, size / 3 + 1),
+			malloc((size_t)records * sizeof(bool)),
+		};
+		bench_fill(input.source.codes, size, "ACGT", 1);
+
+		// Filled here too, as the append benchmark may be
+		// filtered out
+		bench_append(&input, 0);
+
+		bench_run("sequence_batch_append", size, bench_append, NULL, 0, &input);
+		bench_run("sequence_batch_validate", size, bench_validate, NULL, 0, &input);
+		bench_run("sequence_batch_reverse_complement", size, bench_reverse_complement, NULL, 0, &input);
+		bench_run("sequence_batch_dna_to_premrna", size, bench_dna_to_premrna, NULL, 0, &input);
+		bench_run("sequence_batch_translate", size, bench_translate, NULL, 0, &input);
+
+		free(input.source.codes);
+		geneie_sequence_batch_free(input.batch);
+		geneie_sequence_batch_free(input.aminos);
+		free(input.results);
+	}
+}
@@ -0,0 +1,98 @@
+/*
+ * Geneie - A Library and Tools for DNA data
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench_macros.h"
+#include "geneie/sequence_builder.h"
+
+typedef struct geneie_sequence_ref ref;
+typedef struct geneie_sequence_builder builder_t;
+
+// A typical short read, and a FASTA line with its newline
+#define READ_LENGTH 150
+#define LINE_LENGTH 61
+
+struct input {
+	ref dna;
+	ref text;
+};
+
+/*
+ * Builds a sequence from pieces of the source, starting
+ * from an empty builder so that growing it is measured too.
+ */
+static void build(ref source, ssize_t piece, bool clean)
+{
+	builder_t builder = geneie_sequence_builder_alloc(0);
+	for (ssize_t i = 0; i < source.length; i += piece) {
+		ssize_t length = source.length - i;
+		if (length > piece)
+			length = piece;
+
+		const ref codes = { length, source.codes + i };
+		if (clean)
+			geneie_sequence_builder_append_clean(&builder, codes);
+		else
+			geneie_sequence_builder_append(&builder, codes);
+	}
+
+	struct geneie_sequence sequence = geneie_sequence_builder_finish(builder);
+	bench_use(sequence.length);
+	geneie_sequence_free(sequence);
+}
+
+static void bench_append(void *param, ssize_t iteration)
+{
+	(void)iteration;
+	struct input *const input = param;
+	build(input->dna, READ_LENGTH, false);
+}
+
+static void bench_append_clean(void *param, ssize_t iteration)
+{
+	(void)iteration;
+	struct input *const input = param;
+	build(input->text, LINE_LENGTH, true);
+}
+
+int main(int argc, char **argv)
+{
+	bench_init(argc, argv);
+
+	for (size_t i = 0; i < BENCH_SIZE_COUNT; i++) {
+		const ssize_t size = bench_sizes[i];
+		if (!bench_size_enabled(size))
+			continue;
+
+		struct input input = {
+			{ size, malloc((size_t)size) },
+			{ size, malloc((size_t)size) },
+		};
+		bench_fill(input.dna.codes, size, "ACGT", 1);
+
+		// Lines of a FASTA record
+		bench_fill(input.text.codes, size, "ACGT", 2);
+		for (ssize_t j = LINE_LENGTH - 1; j < size; j += LINE_LENGTH)
+			input.text.codes[j] = '\n';
+
+		bench_run("sequence_builder_append", size, bench_append, NULL, 0, &input);
+		bench_run("sequence_builder_append_clean", size, bench_append_clean, NULL, 0, &input);
+
+		free(input.dna.codes);
+		free(input.text.codes);
+	}
+}
@@ -0,0 +1,69 @@
+/*
+ * Geneie - A Library and Tools for DNA data
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench_macros.h"
+#include "geneie/sequence_shared.h"
+
+typedef struct geneie_sequence_ref ref;
+typedef struct geneie_sequence_shared shared_t;
+
+/*
+ * Sharing and releasing a handle costs the same at any
+ * size, so only the operations that copy codes are
+ * measured.
+ */
+
+static void bench_from_ref(void *param, ssize_t iteration)
+{
+	(void)iteration;
+	shared_t shared = geneie_sequence_shared_from_ref(*(ref *)param);
+	bench_use(shared.owner);
+	geneie_sequence_shared_release(shared);
+}
+
+// Writing through a handle still shared with the original
+// copies the sequence
+static void bench_write_shared(void *param, ssize_t iteration)
+{
+	(void)iteration;
+	const shared_t *const original = param;
+	shared_t shared = geneie_sequence_shared_share(*original);
+	bench_use(geneie_sequence_shared_write(&shared).length);
+	geneie_sequence_shared_release(shared);
+}
+
+int main(int argc, char **argv)
+{
+	bench_init(argc, argv);
+
+	for (size_t i = 0; i < BENCH_SIZE_COUNT; i++) {
+		const ssize_t size = bench_sizes[i];
+		if (!bench_size_enabled(size))
+			continue;
+
+		ref dna = { size, malloc((size_t)size) };
+		bench_fill(dna.codes, size, "ACGT", 1);
+		bench_run("sequence_shared_from_ref", size, bench_from_ref, NULL, 0, &dna);
+
+		shared_t original = geneie_sequence_shared_from_ref(dna);
+		bench_run("sequence_shared_write_shared", size, bench_write_shared, NULL, 0, &original);
+		geneie_sequence_shared_release(original);
+
+		free(dna.codes);
+	}
+}
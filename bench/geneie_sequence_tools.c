@@ -0,0 +1,225 @@
+/*
+ * Geneie - A Library and Tools for DNA data
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "bench_macros.h"
+#include "geneie/sequence_tools.h"
+#include "geneie/splice_site.h"
+#include "geneie/thread_pool.h"
+
+typedef struct geneie_sequence_ref ref;
+typedef struct geneie_sequence_tools_interval interval_t;
+
+#define INTERVAL_SPACING 256
+
+/*
+ * The in-place functions destroy their input, so every
+ * iteration gets its own copy from the pool.
+ */
+struct input {
+	struct bench_pool pool;
+	ref strand;
+	interval_t *intervals;
+	ssize_t interval_count;
+};
+
+/*
+ * Hands out the input's intervals as regions of the copy
+ * being spliced, as many as fit in each call.
+ */
+struct batch_splicer {
+	const struct input *input;
+	char *start;
+	ssize_t next;
+};
+
+static ref get(struct input *input, ssize_t iteration)
+{
+	return (ref) { input->pool.size, bench_pool_get(&input->pool, iteration) };
+}
+
+static void bench_clean_whitespace(void *param, ssize_t iteration)
+{
+	bench_use(geneie_sequence_tools_clean_whitespace(get(param, iteration)).length);
+}
+
+static void bench_dna_to_premrna(void *param, ssize_t iteration)
+{
+	geneie_sequence_tools_dna_to_premrna(get(param, iteration));
+}
+
+static void bench_dna_to_premrna_parallel(void *param, ssize_t iteration)
+{
+	geneie_sequence_tools_dna_to_premrna_parallel(
+		get(param, iteration),
+		geneie_thread_pool_default()
+	);
+}
+
+static void bench_reverse_complement(void *param, ssize_t iteration)
+{
+	geneie_sequence_tools_reverse_complement(get(param, iteration));
+}
+
+static void bench_splice(void *param, ssize_t iteration)
+{
+	struct geneie_splice_site_params params = {
+		.motifs = GENEIE_SPLICE_SITE_GT_AG,
+		.min_length = 60,
+		.max_length = 10000,
+	};
+	bench_use(geneie_sequence_tools_splice(get(param, iteration), geneie_splice_site_splicer, &params).length);
+}
+
+static ssize_t splice_intervals_batch(
+	ref strand,
+	ref *regions,
+	ssize_t capacity,
+	void *param
+)
+{
+	struct batch_splicer *const splicer = param;
+	if (!splicer->start)
+		splicer->start = strand.codes;
+
+	ssize_t count = 0;
+	for (; count < capacity && splicer->next < splicer->input->interval_count; splicer->next++) {
+		const interval_t interval = splicer->input->intervals[splicer->next];
+		if (interval.start < interval.end)
+			regions[count++] = (ref) { interval.end - interval.start, splicer->start + interval.start };
+	}
+	return count;
+}
+
+static void bench_splice_batch(void *param, ssize_t iteration)
+{
+	struct batch_splicer splicer = { param, NULL, 0 };
+	bench_use(geneie_sequence_tools_splice_batch(
+		get(param, iteration),
+		splice_intervals_batch,
+		&splicer
+	).length);
+}
+
+static void bench_splice_intervals(void *param, ssize_t iteration)
+{
+	struct input *const input = param;
+	bench_use(geneie_sequence_tools_splice_intervals(
+		get(input, iteration),
+		input->intervals,
+		input->interval_count,
+		GENEIE_SEQUENCE_TOOLS_REMOVE_INTERVALS
+	).length);
+}
+
+static void bench_splice_intervals_into(void *param, ssize_t iteration)
+{
+	struct input *const input = param;
+	bench_use(geneie_sequence_tools_splice_intervals_into(
+		input->strand,
+		input->intervals,
+		input->interval_count,
+		GENEIE_SEQUENCE_TOOLS_KEEP_INTERVALS,
+		get(input, iteration)
+	).length);
+}
+
+static void bench_encode(void *param, ssize_t iteration)
+{
+	bench_use(geneie_sequence_tools_encode(get(param, iteration)).refs[0].length);
+}
+
+static void bench_encode_parallel(void *param, ssize_t iteration)
+{
+	bench_use(geneie_sequence_tools_encode_parallel(
+		get(param, iteration),
+		geneie_thread_pool_default()
+	).refs[0].length);
+}
+
+static void run(
+	const char *name,
+	ssize_t size,
+	const char *source,
+	bench_body *body,
+	struct input *input
+)
+{
+	input->pool = bench_pool_alloc(source, size);
+	bench_run(name, size, body, bench_pool_reset, input->pool.copies, input);
+	bench_pool_free(input->pool);
+}
+
+int main(int argc, char **argv)
+{
+	bench_init(argc, argv);
+
+	for (size_t i = 0; i < BENCH_SIZE_COUNT; i++) {
+		const ssize_t size = bench_sizes[i];
+		if (!bench_size_enabled(size))
+			continue;
+
+		struct input input = {
+			.interval_count = size / INTERVAL_SPACING + 1,
+		};
+		input.intervals = malloc((size_t)input.interval_count * sizeof(interval_t));
+
+		// Introns of 64 every 256 bases
+		for (ssize_t j = 0; j < input.interval_count; j++) {
+			ssize_t start = j * INTERVAL_SPACING + 96, end = start + 64;
+			if (start > size)
+				start = size;
+			if (end > size)
+				end = size;
+			input.intervals[j] = (interval_t) { start, end };
+		}
+
+		// Each input is freed before the next is made, to
+		// keep the largest size within memory
+
+		// About one in 60 is whitespace, as in a FASTA file
+		char *const text = malloc((size_t)size);
+		bench_fill(text, size, "ACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACGTACG\n", 3);
+		run("sequence_tools_clean_whitespace", size, text, bench_clean_whitespace, &input);
+		free(text);
+
+		char *const dna = malloc((size_t)size);
+		bench_fill(dna, size, "ACGT", 1);
+		input.strand = (ref) { size, dna };
+		run("sequence_tools_dna_to_premrna", size, dna, bench_dna_to_premrna, &input);
+		run("sequence_tools_dna_to_premrna_parallel", size, dna, bench_dna_to_premrna_parallel, &input);
+		run("sequence_tools_reverse_complement", size, dna, bench_reverse_complement, &input);
+		run("sequence_tools_splice", size, dna, bench_splice, &input);
+		run("sequence_tools_splice_batch", size, dna, bench_splice_batch, &input);
+		run("sequence_tools_splice_intervals", size, dna, bench_splice_intervals, &input);
+		run("sequence_tools_splice_intervals_into", size, dna, bench_splice_intervals_into, &input);
+		free(dna);
+
+		// These encode a codon at a time without the table,
+		// so the largest size would take hours
+		if (size <= 1024 * 1024) {
+			char *const frame = malloc((size_t)size);
+			bench_fill_reading_frame(frame, size, 2);
+			run("sequence_tools_encode", size, frame, bench_encode, &input);
+			run("sequence_tools_encode_parallel", size, frame, bench_encode_parallel, &input);
+			free(frame);
+		}
+
+		free(input.intervals);
+	}
+}
@@ -0,0 +1,150 @@
+/*
+ * Geneie - A Library and Tools for DNA data
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bench_macros.h"
+#include "geneie/sequence_view.h"
+#include "geneie/splice_site.h"
+
+typedef struct geneie_sequence_ref ref;
+typedef struct geneie_sequence_view view_t;
+typedef struct geneie_sequence_tools_interval interval_t;
+
+#define INTERVAL_SPACING 256
+
+/*
+ * Views leave the strand untouched, so unlike the sequence
+ * tools' benchmarks, these share one input throughout.
+ */
+struct input {
+	ref strand;
+	ref frame;
+	interval_t *intervals;
+	ssize_t interval_count;
+	view_t view;
+	ref out;
+};
+
+static view_t splice_intervals(struct input *input, ref strand)
+{
+	return geneie_sequence_view_splice_intervals(
+		strand,
+		input->intervals,
+		input->interval_count,
+		GENEIE_SEQUENCE_TOOLS_REMOVE_INTERVALS
+	);
+}
+
+static void bench_splice(void *param, ssize_t iteration)
+{
+	(void)iteration;
+	struct input *const input = param;
+	struct geneie_splice_site_params params = {
+		.motifs = GENEIE_SPLICE_SITE_GT_AG,
+		.min_length = 60,
+		.max_length = 10000,
+	};
+	view_t view = geneie_sequence_view_splice(input->strand, geneie_splice_site_splicer, &params);
+	bench_use(view.length);
+	geneie_sequence_view_free(view);
+}
+
+static void bench_splice_intervals(void *param, ssize_t iteration)
+{
+	(void)iteration;
+	struct input *const input = param;
+	view_t view = splice_intervals(input, input->strand);
+	bench_use(view.length);
+	geneie_sequence_view_free(view);
+}
+
+static void bench_copy_into(void *param, ssize_t iteration)
+{
+	(void)iteration;
+	struct input *const input = param;
+	bench_use(geneie_sequence_view_copy_into(input->view, input->out).length);
+}
+
+static void bench_encode(void *param, ssize_t iteration)
+{
+	(void)iteration;
+	struct input *const input = param;
+	bench_use(geneie_sequence_view_encode(input->view, input->out).length);
+}
+
+int main(int argc, char **argv)
+{
+	bench_init(argc, argv);
+
+	for (size_t i = 0; i < BENCH_SIZE_COUNT; i++) {
+		const ssize_t size = bench_sizes[i];
+		if (!bench_size_enabled(size))
+			continue;
+
+		struct input input = {
+			.strand = { size, malloc((size_t)size) },
+			.interval_count = size / INTERVAL_SPACING + 1,
+			.out = { size, malloc((size_t)size) },
+		};
+		input.intervals = malloc((size_t)input.interval_count * sizeof(interval_t));
+		bench_fill(input.strand.codes, size, "ACGT", 1);
+
+		// Introns of 64 every 256 bases
+		for (ssize_t j = 0; j < input.interval_count; j++) {
+			ssize_t start = j * INTERVAL_SPACING + 96, end = start + 64;
+			if (start > size)
+				start = size;
+			if (end > size)
+				end = size;
+			input.intervals[j] = (interval_t) { start, end };
+		}
+
+		bench_run("sequence_view_splice", size, bench_splice, NULL, 0, &input);
+		bench_run("sequence_view_splice_intervals", size, bench_splice_intervals, NULL, 0, &input);
+
+		input.view = splice_intervals(&input, input.strand);
+		bench_run("sequence_view_copy_into", size, bench_copy_into, NULL, 0, &input);
+		geneie_sequence_view_free(input.view);
+
+		// This encodes a codon at a time without the table,
+		// so the largest size would take hours
+		if (size <= 1024 * 1024) {
+			input.frame = (ref) { size, malloc((size_t)size) };
+			bench_fill(input.frame.codes, size, "ACGU", 2);
+			input.view = splice_intervals(&input, input.frame);
+
+			// The introns shift the frame, so lay stop-free
+			// codons out over the exons instead
+			char *const codons = malloc((size_t)size);
+			bench_fill_reading_frame(codons, size, 3);
+			for (ssize_t j = 0, done = 0; j < input.view.count; j++) {
+				const ref segment = input.view.segments[j];
+				memcpy(segment.codes, codons + done, (size_t)segment.length);
+				done += segment.length;
+			}
+			free(codons);
+
+			bench_run("sequence_view_encode", size, bench_encode, NULL, 0, &input);
+			geneie_sequence_view_free(input.view);
+			free(input.frame.codes);
+		}
+
+		free(input.strand.codes);
+		free(input.intervals);
+		free(input.out.codes);
+	}
+}
@@ -0,0 +1,92 @@
+/*
+ * Geneie - A Library and Tools for DNA data
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "bench_macros.h"
+#include "geneie/splice_site.h"
+
+typedef struct geneie_sequence_ref ref;
+
+/*
+ * Finds every site in the strand, so the cost of each call
+ * and of the scan are both measured.
+ */
+static void bench_find_donor(void *param, ssize_t iteration)
+{
+	(void)iteration;
+	ref strand = *(ref *)param;
+	ssize_t found = 0, index;
+	while ((index = geneie_splice_site_find_donor(strand, GENEIE_SPLICE_SITE_ALL)) >= 0) {
+		strand = geneie_sequence_ref_index(strand, index + 1);
+		found++;
+	}
+	bench_use(found);
+}
+
+static void bench_find_acceptor(void *param, ssize_t iteration)
+{
+	(void)iteration;
+	ref strand = *(ref *)param;
+	ssize_t found = 0, index;
+	while ((index = geneie_splice_site_find_acceptor(strand, GENEIE_SPLICE_SITE_ALL)) >= 0) {
+		strand = geneie_sequence_ref_index(strand, index + 1);
+		found++;
+	}
+	bench_use(found);
+}
+
+// Walks the strand as geneie_sequence_tools_splice() would,
+// without removing anything
+static void bench_splicer(void *param, ssize_t iteration)
+{
+	(void)iteration;
+	struct geneie_splice_site_params params = {
+		.motifs = GENEIE_SPLICE_SITE_GT_AG,
+		.min_length = 60,
+		.max_length = 10000,
+	};
+	ref strand = *(ref *)param, intron;
+	ssize_t found = 0;
+	while ((intron = geneie_splice_site_splicer(strand, &params)).length) {
+		strand = geneie_sequence_ref_index(strand, intron.codes + intron.length - strand.codes);
+		found++;
+	}
+	bench_use(found);
+}
+
+int main(int argc, char **argv)
+{
+	bench_init(argc, argv);
+
+	for (size_t i = 0; i < BENCH_SIZE_COUNT; i++) {
+		const ssize_t size = bench_sizes[i];
+		if (!bench_size_enabled(size))
+			continue;
+
+		// Mostly A and C, so sites are rare and the scans are
+		// long, as in real introns
+		ref strand = { size, malloc((size_t)size) };
+		bench_fill(strand.codes, size, "AAAAAAACCCCCCCGT", 1);
+
+		bench_run("splice_site_find_donor", size, bench_find_donor, NULL, 0, &strand);
+		bench_run("splice_site_find_acceptor", size, bench_find_acceptor, NULL, 0, &strand);
+		bench_run("splice_site_splicer", size, bench_splicer, NULL, 0, &strand);
+
+		free(strand.codes);
+	}
+}
@@ -0,0 +1,75 @@
+/*
+ * Geneie - A Library and Tools for DNA data
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "bench_macros.h"
+#include "geneie/synthetic.h"
+
+typedef struct geneie_sequence_ref ref;
+
+struct input {
+	struct geneie_synthetic generator;
+	ref out;
+};
+
+static void bench_fill_sequence(void *param, ssize_t iteration)
+{
+	(void)iteration;
+	struct input *const input = param;
+	geneie_synthetic_fill(&input->generator, input->out);
+	bench_use(input->out.codes);
+}
+
+static void bench_write_lines(void *param, ssize_t iteration)
+{
+	(void)iteration;
+	struct input *const input = param;
+	const ref sequence = { input->out.length, input->out.codes };
+	const ref lines = { input->out.length * 2 + 1, input->out.codes + input->out.length };
+	bench_use(geneie_synthetic_write_lines(sequence, 60, lines));
+}
+
+int main(int argc, char **argv)
+{
+	bench_init(argc, argv);
+
+	struct geneie_synthetic_params featured = GENEIE_SYNTHETIC_PARAMS_DEFAULT;
+	featured.ambiguity_rate = 0.001;
+	featured.n_run_rate = 0.00001;
+	featured.soft_mask_rate = 0.001;
+
+	for (size_t i = 0; i < BENCH_SIZE_COUNT; i++) {
+		const ssize_t size = bench_sizes[i];
+		if (!bench_size_enabled(size))
+			continue;
+
+		// Room for the lines after the sequence
+		char *const buffer = malloc((size_t)size * 3 + 1);
+		struct input input = {
+			geneie_synthetic_init(GENEIE_SYNTHETIC_PARAMS_DEFAULT, 1, 0),
+			{ size, buffer },
+		};
+		bench_run("synthetic_fill", size, bench_fill_sequence, NULL, 0, &input);
+
+		input.generator = geneie_synthetic_init(featured, 1, 0);
+		bench_run("synthetic_fill_featured", size, bench_fill_sequence, NULL, 0, &input);
+		bench_run("synthetic_write_lines", size, bench_write_lines, NULL, 0, &input);
+
+		free(buffer);
+	}
+}
@@ -0,0 +1,491 @@
+/*
+ * Geneie - A Library and Tools for DNA data
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+/*
+ * Runs benchmarks and compares them with a baseline.
+ *
+ * Usage: bench_regress --baseline=FILE [options] BENCHMARK...
+ *
+ * Each BENCHMARK program is run --runs times, and the
+ * repetitions of every run are pooled, so that differences
+ * between runs, e.g. from frequency scaling, count as
+ * noise too. The median ns/base of each benchmark and size
+ * is compared with the baseline file, written earlier with
+ * --update. The median comes with a distribution-free 95%
+ * confidence interval, from the order statistics of the
+ * samples. A result only counts as slower if it's slower
+ * than the threshold and the two intervals don't overlap,
+ * so noisy benchmarks don't fail at random.
+ *
+ * Options:
+ *   --update          write the results to the baseline
+ *                     instead of comparing
+ *   --threshold=F     the relative change that counts
+ *                     (default 0.1, or 10%)
+ *   --runs=N          runs of each program (default 3)
+ *   --repetitions=N   repetitions per run (default 7)
+ *   --min-time=MS     passed on to the benchmarks
+ *   --filter=TEXT     passed on to the benchmarks
+ *
+ * Exits with 1 if anything got slower, 2 on errors, and
+ * SKIPPED if there's no baseline to compare with yet.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <sys/types.h>
+
+#define MAX_SAMPLES 1000
+#define LINE_SIZE 65536
+#define NAME_SIZE 128
+
+// The exit status CTest's SKIP_RETURN_CODE is set to
+#define SKIPPED 77
+
+struct result {
+	char name[NAME_SIZE];
+	ssize_t bases;
+	double median;
+	double low;
+	double high;
+	int samples;
+
+	// While running, the samples so far
+	double *values;
+};
+
+struct results {
+	struct result *items;
+	ssize_t count;
+	ssize_t capacity;
+};
+
+static struct {
+	const char *baseline;
+	bool update;
+	double threshold;
+	int runs;
+	int repetitions;
+	const char *min_time;
+	const char *filter;
+} options = {
+	.threshold = 0.1,
+	.runs = 3,
+	.repetitions = 7,
+};
+
+static struct result *add(struct results *results, struct result result)
+{
+	if (results->count == results->capacity) {
+		results->capacity = results->capacity ? results->capacity * 2 : 64;
+		results->items = realloc(results->items, (size_t)results->capacity * sizeof(struct result));
+		if (!results->items) {
+			fprintf(stderr, "bench_regress: out of memory\n");
+			exit(2);
+		}
+	}
+	results->items[results->count] = result;
+	return &results->items[results->count++];
+}
+
+static struct result *find(const struct results *results, const struct result *key)
+{
+	for (ssize_t i = 0; i < results->count; i++) {
+		struct result *const item = &results->items[i];
+		if (item->bases == key->bases && !strcmp(item->name, key->name))
+			return item;
+	}
+	return NULL;
+}
+
+/*
+ * Finds the value of a key in a line of the flat JSON the
+ * benchmarks write, returning a pointer just past the
+ * colon.
+ */
+static const char *field(const char *line, const char *key)
+{
+	char quoted[NAME_SIZE];
+	snprintf(quoted, sizeof(quoted), "\"%s\":", key);
+	const char *const found = strstr(line, quoted);
+	if (!found)
+		return NULL;
+
+	const char *value = found + strlen(quoted);
+	while (*value == ' ')
+		value++;
+	return value;
+}
+
+static bool string_field(const char *line, const char *key, char *out)
+{
+	const char *value = field(line, key);
+	if (!value || *value != '"')
+		return false;
+
+	const char *const end = strchr(++value, '"');
+	if (!end || end - value >= NAME_SIZE)
+		return false;
+	memcpy(out, value, (size_t)(end - value));
+	out[end - value] = '\0';
+	return true;
+}
+
+static bool number_field(const char *line, const char *key, double *out)
+{
+	const char *const value = field(line, key);
+	if (!value)
+		return false;
+
+	char *end;
+	*out = strtod(value, &end);
+	return end != value;
+}
+
+static int compare(const void *a, const void *b)
+{
+	const double x = *(const double *)a, y = *(const double *)b;
+	return (x > y) - (x < y);
+}
+
+/*
+ * The median of the samples, and the ranks either side of
+ * it that give a 95% confidence interval, from the normal
+ * approximation to the binomial distribution.
+ */
+static void summarise(struct result *result)
+{
+	double *const samples = result->values;
+	const int count = result->samples;
+	qsort(samples, (size_t)count, sizeof(double), compare);
+	result->median = count % 2
+		? samples[count / 2]
+		: (samples[count / 2 - 1] + samples[count / 2]) / 2;
+
+	const double spread = 1.96 * sqrt(count) / 2;
+	int low = (int)floor(count / 2.0 - spread);
+	int high = (int)ceil(count / 2.0 + spread);
+	if (low < 0)
+		low = 0;
+	if (high > count - 1)
+		high = count - 1;
+
+	result->low = samples[low];
+	result->high = samples[high];
+
+	free(result->values);
+	result->values = NULL;
+}
+
+/*
+ * Parses one line of benchmark output, adding its samples
+ * to the results.
+ */
+static bool parse_sample_line(const char *line, struct results *results)
+{
+	struct result key = { 0 };
+	double bases;
+	const char *list = field(line, "samples");
+	if (!string_field(line, "benchmark", key.name)
+		|| !number_field(line, "bases", &bases)
+		|| !list || *list != '[')
+		return false;
+	key.bases = (ssize_t)bases;
+
+	struct result *result = find(results, &key);
+	if (!result) {
+		key.values = malloc(MAX_SAMPLES * sizeof(double));
+		if (!key.values)
+			return false;
+		result = add(results, key);
+	}
+
+	const int before = result->samples;
+	for (list++; result->samples < MAX_SAMPLES; ) {
+		char *end;
+		const double value = strtod(list, &end);
+		if (end == list)
+			break;
+		result->values[result->samples++] = value;
+		list = end;
+		while (*list == ',' || *list == ' ')
+			list++;
+	}
+	return result->samples > before;
+}
+
+/*
+ * Appends an argument to a shell command, quoted.
+ */
+static void append_argument(char *command, size_t size, const char *argument)
+{
+	size_t length = strlen(command);
+	if (length + 4 >= size)
+		return;
+
+	command[length++] = ' ';
+	command[length++] = '\'';
+	for (; *argument && length + 6 < size; argument++) {
+		if (*argument == '\'') {
+			memcpy(command + length, "'\\''", 4);
+			length += 4;
+		} else {
+			command[length++] = *argument;
+		}
+	}
+	command[length++] = '\'';
+	command[length] = '\0';
+}
+
+static bool run_benchmark(const char *program, struct results *results)
+{
+	char command[4096] = "", argument[256];
+	append_argument(command, sizeof(command), program);
+
+	snprintf(argument, sizeof(argument), "--repetitions=%d", options.repetitions);
+	append_argument(command, sizeof(command), argument);
+	if (options.min_time) {
+		snprintf(argument, sizeof(argument), "--min-time=%s", options.min_time);
+		append_argument(command, sizeof(command), argument);
+	}
+	if (options.filter) {
+		snprintf(argument, sizeof(argument), "--filter=%s", options.filter);
+		append_argument(command, sizeof(command), argument);
+	}
+
+	fprintf(stderr, "bench_regress: running %s\n", program);
+	FILE *const pipe = popen(command, "r");
+	if (!pipe) {
+		fprintf(stderr, "bench_regress: %s: %s\n", program, strerror(errno));
+		return false;
+	}
+
+	static char line[LINE_SIZE];
+	bool ok = true;
+	while (fgets(line, sizeof(line), pipe)) {
+		if (!parse_sample_line(line, results)) {
+			fprintf(stderr, "bench_regress: %s: can't parse: %s", program, line);
+			ok = false;
+		}
+	}
+
+	if (pclose(pipe) != 0) {
+		fprintf(stderr, "bench_regress: %s failed\n", program);
+		ok = false;
+	}
+	return ok;
+}
+
+static bool read_baseline(struct results *results)
+{
+	FILE *const file = fopen(options.baseline, "r");
+	if (!file) {
+		if (errno == ENOENT)
+			return true;
+		fprintf(stderr, "bench_regress: %s: %s\n", options.baseline, strerror(errno));
+		return false;
+	}
+
+	static char line[LINE_SIZE];
+	bool ok = true;
+	while (fgets(line, sizeof(line), file)) {
+		struct result result;
+		double bases, samples;
+		if (!string_field(line, "benchmark", result.name)
+			|| !number_field(line, "bases", &bases)
+			|| !number_field(line, "ns_per_base", &result.median)
+			|| !number_field(line, "ci_low", &result.low)
+			|| !number_field(line, "ci_high", &result.high)
+			|| !number_field(line, "samples", &samples)) {
+			fprintf(stderr, "bench_regress: %s: can't parse: %s", options.baseline, line);
+			ok = false;
+			continue;
+		}
+		result.bases = (ssize_t)bases;
+		result.samples = (int)samples;
+		add(results, result);
+	}
+
+	fclose(file);
+	return ok;
+}
+
+/*
+ * Replaces the results in the baseline, keeping any for
+ * benchmarks that weren't run, e.g. because of --filter.
+ */
+static bool write_baseline(const struct results *baseline, const struct results *current)
+{
+	FILE *const file = fopen(options.baseline, "w");
+	if (!file) {
+		fprintf(stderr, "bench_regress: %s: %s\n", options.baseline, strerror(errno));
+		return false;
+	}
+
+	for (int pass = 0; pass < 2; pass++) {
+		const struct results *const results = pass ? current : baseline;
+		for (ssize_t i = 0; i < results->count; i++) {
+			const struct result *const result = &results->items[i];
+			if (!pass && find(current, result))
+				continue;
+			fprintf(file,
+				"{\"benchmark\": \"%s\", \"bases\": %zd, \"ns_per_base\": %.6g, "
+				"\"ci_low\": %.6g, \"ci_high\": %.6g, \"samples\": %d}\n",
+				result->name, result->bases, result->median,
+				result->low, result->high, result->samples);
+		}
+	}
+
+	return fclose(file) == 0;
+}
+
+/*
+ * Prints a line per result and returns the number of
+ * regressions.
+ */
+static int compare_results(const struct results *baseline, const struct results *current)
+{
+	int slower = 0, faster = 0, same = 0, added = 0;
+
+	printf("%-40s %10s %12s %12s %9s\n", "benchmark", "bases", "baseline", "current", "change");
+	for (ssize_t i = 0; i < current->count; i++) {
+		const struct result *const result = &current->items[i];
+		const struct result *const base = find(baseline, result);
+		if (!base) {
+			printf("%-40s %10zd %12s %12.4g %9s  new\n",
+				result->name, result->bases, "-", result->median, "-");
+			added++;
+			continue;
+		}
+
+		const double change = base->median > 0
+			? result->median / base->median - 1
+			: 0;
+		const char *verdict = "";
+		if (change > options.threshold && result->low > base->high) {
+			verdict = "  SLOWER";
+			slower++;
+		} else if (change < -options.threshold && result->high < base->low) {
+			verdict = "  faster";
+			faster++;
+		} else {
+			same++;
+		}
+
+		printf("%-40s %10zd %12.4g %12.4g %+8.1f%%%s\n",
+			result->name, result->bases, base->median, result->median,
+			change * 100, verdict);
+	}
+
+	printf("\n%d slower, %d faster, %d unchanged, %d new (ns/base, threshold %.0f%%)\n",
+		slower, faster, same, added, options.threshold * 100);
+	if (slower) {
+		printf("\nSlower than the baseline in %s:\n", options.baseline);
+		for (ssize_t i = 0; i < current->count; i++) {
+			const struct result *const result = &current->items[i];
+			const struct result *const base = find(baseline, result);
+			if (!base || base->median <= 0)
+				continue;
+			if (result->median / base->median - 1 > options.threshold && result->low > base->high) {
+				printf("  %s (%zd bases): %.4g ns/base [%.4g, %.4g], was %.4g [%.4g, %.4g]\n",
+					result->name, result->bases,
+					result->median, result->low, result->high,
+					base->median, base->low, base->high);
+			}
+		}
+	}
+	return slower;
+}
+
+static void usage(void)
+{
+	fprintf(stderr,
+		"Usage: bench_regress --baseline=FILE [--update] [--threshold=F]\n"
+		"       [--runs=N] [--repetitions=N] [--min-time=MS] [--filter=TEXT]\n"
+		"       BENCHMARK...\n");
+	exit(2);
+}
+
+int main(int argc, char **argv)
+{
+	int first = 1;
+	for (; first < argc && !strncmp(argv[first], "--", 2); first++) {
+		const char *const arg = argv[first];
+		if (!strncmp(arg, "--baseline=", 11))
+			options.baseline = arg + 11;
+		else if (!strcmp(arg, "--update"))
+			options.update = true;
+		else if (!strncmp(arg, "--threshold=", 12))
+			options.threshold = atof(arg + 12);
+		else if (!strncmp(arg, "--runs=", 7))
+			options.runs = atoi(arg + 7);
+		else if (!strncmp(arg, "--repetitions=", 14))
+			options.repetitions = atoi(arg + 14);
+		else if (!strncmp(arg, "--min-time=", 11))
+			options.min_time = arg + 11;
+		else if (!strncmp(arg, "--filter=", 9))
+			options.filter = arg + 9;
+		else
+			usage();
+	}
+	if (!options.baseline
+		|| first == argc
+		|| options.runs < 1
+		|| options.repetitions < 1
+		|| options.runs * options.repetitions > MAX_SAMPLES
+		|| options.threshold < 0)
+		usage();
+
+	struct results baseline = { 0 }, current = { 0 };
+	bool ok = read_baseline(&baseline);
+
+	// Not worth minutes of benchmarking
+	if (ok && !options.update && !baseline.count) {
+		printf("bench_regress: no baseline in %s yet; run with --update to make one\n", options.baseline);
+		free(baseline.items);
+		return SKIPPED;
+	}
+
+	for (int run = 0; run < options.runs; run++) {
+		for (int i = first; i < argc; i++)
+			ok = run_benchmark(argv[i], &current) && ok;
+	}
+	if (!ok)
+		return 2;
+	for (ssize_t i = 0; i < current.count; i++)
+		summarise(&current.items[i]);
+
+	int status = 0;
+	if (options.update) {
+		if (write_baseline(&baseline, &current))
+			printf("bench_regress: wrote %zd results to %s\n", current.count, options.baseline);
+		else
+			status = 2;
+	} else if (compare_results(&baseline, &current)) {
+		status = 1;
+	}
+
+	free(baseline.items);
+	free(current.items);
+	return status;
+}
@@ -1,6 +1,5 @@
 #include <stdio.h>
 #include <errno.h>
-#include <limits.h>
 
 #include <geneie.h>
 
@@ -9,104 +8,103 @@
  * using the geneie_sequence_tools_encode function to
  * encode a large sequence in-place.
  *
- * We use a geneie_sequence to allocate memory, populate
- * it with data from a file, then create a reference to
- * it for processing.
+ * We use a geneie_async_reader to read the file in large
+ * chunks, and encode each chunk while the next ones are
+ * still being read from the disk.
  */
 
-typedef struct geneie_sequence seq_t;
+typedef struct geneie_async_reader reader_t;
 typedef struct geneie_sequence_ref ref_t;
 typedef struct geneie_sequence_tools_ref_pair pair_t;
 
+/*
+ * A multiple of 3, so that every chunk but the last holds
+ * whole codons.
+ */
+#define CHUNK_SIZE (3 * 1024 * 1024)
+
 /*
  * Moved the processing to a separate function, so even if an
- * error is returned here, we can fclose() the file safely
+ * error is returned here, we can close the reader safely
  * in main().
  */
-int process_file(FILE *file)
+int process_file(reader_t reader)
 {
+	ssize_t encoded = 0;
+	ref_t remaining = { 0 };
+	ref_t chunk;
+
 	/*
-	 * Most of this is just getting an amount of memory
-	 * to allocate for this file.
+	 * Each chunk belongs to us until we ask for the next
+	 * one, and we're free to modify it. By then, the reader
+	 * has already started reading the chunks after it.
 	 */
-	if (fseek(file, 0, SEEK_END))
-		return errno;
-
-	long length = ftell(file);
-
-	if (length < 0)
-		return errno;
-
-	rewind(file);
-
-	int error = -1;
-
-	GENEIE_SEQUENCE_WITH(sequence, length) {
-		size_t read_amount = fread(sequence.codes, 1, (size_t)length, file);
-
-		if (ferror(file)) {
-			error = ferror(file);
-			continue;
-		}
-
+	while (geneie_sequence_ref_valid(chunk = geneie_async_reader_next(reader))) {
 		/*
-		 * Most processing isn't performed against geneie_sequence
-		 * objects directly, instead it happens through a reference.
-		 *
-		 * This helps to simplify resource management - references
-		 * are never allocated and never freed; each sequence should
-		 * have been allocated, and each must be passed to
-		 * geneie_sequence_free().
+		 * Once a codon has failed to encode, the rest of the
+		 * file is printed as it is.
 		 */
-		ref_t ref = geneie_sequence_tools_ref_from_sequence(sequence);
-		// only consider read amount
-		ref = geneie_sequence_ref_trunc(ref, (ssize_t)read_amount);
+		if (geneie_sequence_ref_valid(remaining)) {
+			printf("%.*s", (int)chunk.length, chunk.codes);
+			continue;
+		}
 
 		/*
-		 * Finally, encode the data in-place.
+		 * Encode the data in-place.
 		 *
 		 * In-place encoding avoids the cost of allocating and copying
 		 * potentially huge amounts of data, at the cost of (obviously)
-		 * destroying the original data stored in the sequence.
+		 * destroying the original data stored in the chunk.
 		 *
 		 * This function returns a pair of geneie_sequence_ref objects:
 		 * the first is the a sequence containing the amino acids that
 		 * could be encoded; the second contains the remainder of the
 		 * DNA/mRNA sequence, starting from the first codon that failed.
 		 */
-		pair_t pair = geneie_sequence_tools_encode(ref);
+		pair_t pair = geneie_sequence_tools_encode(chunk);
 
-		if (pair.refs[0].length > INT_MAX)
-			printf("Encoded output too long for printf");
-		else if (pair.refs[0].length == 0)
-			printf("No DNA/mRNA encoded\n");
-		else
+		if (pair.refs[0].length > 0) {
+			if (encoded == 0)
+				printf("Encoded output: ");
 			/*
 			 * The %.*s syntax here allows us to print only the
-			 * characters in the sequence. To learn more, check
+			 * characters in the chunk. To learn more, check
 			 * the Precision section of the printf man page.
 			 */
-			printf("Encoded output: %.*s\n", (int)pair.refs[0].length, pair.refs[0].codes);
+			printf("%.*s", (int)pair.refs[0].length, pair.refs[0].codes);
+			encoded += pair.refs[0].length;
+		}
+
+		if (pair.refs[1].length > 0) {
+			remaining = pair.refs[1];
+			printf(encoded ? "\n" : "No DNA/mRNA encoded\n");
+			printf("Remaining DNA/mRNA: ");
+			printf("%.*s", (int)remaining.length, remaining.codes);
+		}
+	}
 
-		if (pair.refs[1].length > INT_MAX)
-			printf("Remaining DNA/mRNA too long for printf");
-		else if (pair.refs[1].length == 0)
-			printf("All DNA/mRNA encoded\n");
-		else
-			printf("Remaining DNA/mRNA: %.*s\n", (int)pair.refs[1].length, pair.refs[1].codes);
+	if (geneie_async_reader_failed(reader))
+		return errno;
 
-		error = 0;
+	if (geneie_sequence_ref_valid(remaining)) {
+		printf("\n");
+	} else {
+		printf(encoded ? "\n" : "No DNA/mRNA encoded\n");
+		printf("All DNA/mRNA encoded\n");
 	}
 
-	return error;
+	return 0;
 }
 
 /*
  * All this main function does is check if a filename was given
  * as an argument, try to open the file, handle errors, then pass
- * the file on to process_file.
+ * the reader on to process_file.
+ *
+ * The reader keeps four reads of CHUNK_SIZE in flight, using
+ * io_uring if the kernel allows it, and threads otherwise.
  *
- * Finally, it safely closes the file and returns the result
+ * Finally, it safely closes the reader and returns the result
  * of process_file.
  */
 int main(int argc, char **argv)
@@ -114,11 +112,16 @@ int main(int argc, char **argv)
 	if (argc < 2)
 		return 1;
 
-	FILE *file = fopen(argv[1], "r");
-	if (!file)
+	reader_t reader = geneie_async_reader_open(
+		argv[1],
+		CHUNK_SIZE,
+		4,
+		GENEIE_ASYNC_READER_AUTO
+	);
+	if (!geneie_async_reader_valid(reader))
 		return errno;
 
-	int return_value = process_file(file);
-	fclose(file);
+	int return_value = process_file(reader);
+	geneie_async_reader_close(reader);
 	return return_value;
 }
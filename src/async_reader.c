@@ -0,0 +1,692 @@
+#include "geneie/async_reader.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+
+#ifdef GENEIE_HAVE_IO_URING
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
+typedef struct geneie_async_reader reader_t;
+typedef struct geneie_async_reader_state state_t;
+typedef struct geneie_sequence_ref seq_r;
+
+#define AUTO GENEIE_ASYNC_READER_AUTO
+#define IO_URING GENEIE_ASYNC_READER_IO_URING
+#define THREADS GENEIE_ASYNC_READER_THREADS
+
+#define DEFAULT_BUFFER_SIZE (4 * 1024 * 1024)
+#define DEFAULT_DEPTH 4
+#define MAX_DEPTH 64
+
+// io_uring reads take a 32-bit length
+#define MAX_BUFFER_SIZE (1024 * 1024 * 1024)
+
+// Suits O_DIRECT and registered buffers alike
+#define BUFFER_ALIGNMENT 4096
+
+enum slot_status {
+	SLOT_IDLE,
+	SLOT_QUEUED,
+	SLOT_READING,
+	SLOT_DONE,
+};
+
+/*
+ * One buffer and the read filling it. Slots are used in
+ * turn, so slot i always holds a part of the file a whole
+ * number of rounds after slot i - 1's.
+ */
+struct slot {
+	char *buffer;
+	off_t offset;
+	ssize_t filled;
+	int error;
+	enum slot_status status;
+};
+
+#ifdef GENEIE_HAVE_IO_URING
+struct uring {
+	int fd;
+	bool fixed;
+	int in_flight;
+
+	unsigned *sq_tail, *sq_mask, *sq_array;
+	struct io_uring_sqe *sqes;
+	unsigned *cq_head, *cq_tail, *cq_mask;
+	struct io_uring_cqe *cqes;
+
+	void *sq_ring, *cq_ring;
+	size_t sq_ring_size, cq_ring_size, sqes_size;
+};
+#endif
+
+struct geneie_async_reader_state {
+	int fd;
+	bool owns_fd;
+	enum geneie_async_reader_backend backend;
+	bool failed;
+	bool finished;
+
+	ssize_t buffer_size;
+	int depth;
+	char *buffers;
+	struct slot *slots;
+
+	// Where the next read to be scheduled starts, and the
+	// size of the file if we know it
+	off_t next_offset;
+	off_t end;
+
+	// The slot with the next chunk, and whether the caller
+	// still has it from the last call
+	unsigned long current;
+	bool holding;
+
+	// THREADS
+	pthread_mutex_t lock;
+	pthread_cond_t work;
+	pthread_cond_t done;
+	bool stopping;
+	int thread_count;
+	pthread_t *threads;
+
+#ifdef GENEIE_HAVE_IO_URING
+	struct uring ring;
+#endif
+};
+
+static const reader_t invalid_reader = { 0 };
+
+static void finish_read(struct slot *slot, ssize_t filled, int error)
+{
+	slot->filled = filled;
+	slot->error = error;
+	slot->status = SLOT_DONE;
+}
+
+/*
+ * Whether a read which has got this far should carry on,
+ * after a short read.
+ */
+static bool read_incomplete(state_t *state, struct slot *slot)
+{
+	if (slot->filled >= state->buffer_size)
+		return false;
+	return state->end < 0 || slot->offset + slot->filled < state->end;
+}
+
+static void read_fully(state_t *state, struct slot *slot)
+{
+	ssize_t filled = 0;
+
+	while (filled < state->buffer_size) {
+		const ssize_t got = pread(
+			state->fd,
+			slot->buffer + filled,
+			(size_t)(state->buffer_size - filled),
+			slot->offset + filled
+		);
+		if (got < 0) {
+			if (errno == EINTR)
+				continue;
+			const int error = errno;
+			pthread_mutex_lock(&state->lock);
+			finish_read(slot, filled, error);
+			return;
+		}
+		if (got == 0)
+			break;
+		filled += got;
+	}
+
+	pthread_mutex_lock(&state->lock);
+	finish_read(slot, filled, 0);
+}
+
+static struct slot *next_queued(state_t *state)
+{
+	struct slot *result = NULL;
+	for (int i = 0; i < state->depth; i++) {
+		struct slot *const slot = &state->slots[i];
+		if (slot->status == SLOT_QUEUED && (!result || slot->offset < result->offset))
+			result = slot;
+	}
+	return result;
+}
+
+static void *worker(void *param)
+{
+	state_t *const state = param;
+
+	pthread_mutex_lock(&state->lock);
+	for (;;) {
+		struct slot *slot;
+		while (!state->stopping && !(slot = next_queued(state)))
+			pthread_cond_wait(&state->work, &state->lock);
+		if (state->stopping)
+			break;
+
+		slot->status = SLOT_READING;
+		pthread_mutex_unlock(&state->lock);
+
+		// Returns with the lock held
+		read_fully(state, slot);
+		pthread_cond_broadcast(&state->done);
+	}
+	pthread_mutex_unlock(&state->lock);
+
+	return NULL;
+}
+
+static bool threads_init(state_t *state)
+{
+	state->threads = malloc((size_t)state->depth * sizeof(pthread_t));
+	if (!state->threads)
+		return false;
+
+	for (int i = 0; i < state->depth; i++) {
+		if (pthread_create(&state->threads[i], NULL, worker, state))
+			break;
+		state->thread_count++;
+	}
+
+	state->backend = THREADS;
+	return state->thread_count > 0;
+}
+
+#ifdef GENEIE_HAVE_IO_URING
+static int uring_setup(unsigned entries, struct io_uring_params *params)
+{
+	return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int uring_enter(int fd, unsigned submit, unsigned wait, unsigned flags)
+{
+	return (int)syscall(__NR_io_uring_enter, fd, submit, wait, flags, NULL, 0);
+}
+
+static int uring_register(int fd, unsigned opcode, void *arg, unsigned count)
+{
+	return (int)syscall(__NR_io_uring_register, fd, opcode, arg, count);
+}
+
+static void *map_ring(int fd, size_t size, off_t offset)
+{
+	void *const result = mmap(
+		NULL,
+		size,
+		PROT_READ | PROT_WRITE,
+		MAP_SHARED | MAP_POPULATE,
+		fd,
+		offset
+	);
+	return result == MAP_FAILED ? NULL : result;
+}
+
+static void uring_free(struct uring *ring)
+{
+	if (ring->sqes)
+		munmap(ring->sqes, ring->sqes_size);
+	if (ring->cq_ring && ring->cq_ring != ring->sq_ring)
+		munmap(ring->cq_ring, ring->cq_ring_size);
+	if (ring->sq_ring)
+		munmap(ring->sq_ring, ring->sq_ring_size);
+	close(ring->fd);
+}
+
+/*
+ * Checks that the kernel can do plain reads on a ring.
+ * io_uring itself arrived in 5.1, but IORING_OP_READ only
+ * in 5.6, along with IORING_FEAT_RW_CUR_POS and probing;
+ * older kernels fail every read with -EINVAL.
+ */
+static bool uring_supports_read(int fd, const struct io_uring_params *params)
+{
+	if (!(params->features & IORING_FEAT_RW_CUR_POS))
+		return false;
+
+	const size_t size = sizeof(struct io_uring_probe)
+		+ (IORING_OP_READ + 1) * sizeof(struct io_uring_probe_op);
+	struct io_uring_probe *const probe = calloc(1, size);
+	if (!probe)
+		return false;
+
+	const bool result = uring_register(
+		fd,
+		IORING_REGISTER_PROBE,
+		probe,
+		IORING_OP_READ + 1
+	) == 0
+		&& probe->last_op >= IORING_OP_READ
+		&& probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED;
+
+	free(probe);
+	return result;
+}
+
+static bool uring_init(state_t *state)
+{
+	struct uring *const ring = &state->ring;
+	struct io_uring_params params = { 0 };
+
+	ring->fd = uring_setup((unsigned)state->depth, &params);
+	if (ring->fd < 0)
+		return false;
+
+	if (!uring_supports_read(ring->fd, &params)) {
+		close(ring->fd);
+		errno = ENOSYS;
+		return false;
+	}
+
+	ring->sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+	ring->cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+	ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+
+	const bool single_map = params.features & IORING_FEAT_SINGLE_MMAP;
+	if (single_map) {
+		if (ring->cq_ring_size > ring->sq_ring_size)
+			ring->sq_ring_size = ring->cq_ring_size;
+		ring->cq_ring_size = ring->sq_ring_size;
+	}
+
+	ring->sq_ring = map_ring(ring->fd, ring->sq_ring_size, IORING_OFF_SQ_RING);
+	if (ring->sq_ring)
+		ring->cq_ring = single_map
+			? ring->sq_ring
+			: map_ring(ring->fd, ring->cq_ring_size, IORING_OFF_CQ_RING);
+	if (ring->cq_ring)
+		ring->sqes = map_ring(ring->fd, ring->sqes_size, IORING_OFF_SQES);
+	if (!ring->sqes) {
+		const int error = errno;
+		uring_free(ring);
+		errno = error;
+		return false;
+	}
+
+	char *const sq = ring->sq_ring, *const cq = ring->cq_ring;
+	ring->sq_tail = (unsigned *)(sq + params.sq_off.tail);
+	ring->sq_mask = (unsigned *)(sq + params.sq_off.ring_mask);
+	ring->sq_array = (unsigned *)(sq + params.sq_off.array);
+	ring->cq_head = (unsigned *)(cq + params.cq_off.head);
+	ring->cq_tail = (unsigned *)(cq + params.cq_off.tail);
+	ring->cq_mask = (unsigned *)(cq + params.cq_off.ring_mask);
+	ring->cqes = (struct io_uring_cqe *)(cq + params.cq_off.cqes);
+
+	// Registered buffers save the kernel mapping them on
+	// every read, but count against RLIMIT_MEMLOCK; plain
+	// reads still work without them
+	struct iovec *const vectors = malloc((size_t)state->depth * sizeof(struct iovec));
+	if (vectors) {
+		for (int i = 0; i < state->depth; i++) {
+			vectors[i] = (struct iovec) {
+				state->slots[i].buffer,
+				(size_t)state->buffer_size,
+			};
+		}
+		ring->fixed = uring_register(
+			ring->fd,
+			IORING_REGISTER_BUFFERS,
+			vectors,
+			(unsigned)state->depth
+		) == 0;
+		free(vectors);
+	}
+
+	state->backend = IO_URING;
+	return true;
+}
+
+static void uring_submit(state_t *state, struct slot *slot)
+{
+	struct uring *const ring = &state->ring;
+	const int index = (int)(slot - state->slots);
+
+	// We are the only submitter, and every slot has at most
+	// one read in flight, so there is always room
+	const unsigned
+		tail = *ring->sq_tail,
+		position = tail & *ring->sq_mask;
+	struct io_uring_sqe *const sqe = &ring->sqes[position];
+
+	memset(sqe, 0, sizeof(*sqe));
+	sqe->opcode = ring->fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+	sqe->fd = state->fd;
+	sqe->off = (uint64_t)(slot->offset + slot->filled);
+	sqe->addr = (uint64_t)(uintptr_t)(slot->buffer + slot->filled);
+	sqe->len = (uint32_t)(state->buffer_size - slot->filled);
+	sqe->buf_index = (uint16_t)index;
+	sqe->user_data = (uint64_t)index;
+
+	ring->sq_array[position] = position;
+	__atomic_store_n(ring->sq_tail, tail + 1, __ATOMIC_RELEASE);
+
+	int submitted;
+	while ((submitted = uring_enter(ring->fd, 1, 0, 0)) < 0 && errno == EINTR)
+		;
+	if (submitted < 0) {
+		// Take the entry back, so it isn't submitted later
+		__atomic_store_n(ring->sq_tail, tail, __ATOMIC_RELEASE);
+		finish_read(slot, slot->filled, errno);
+		return;
+	}
+
+	slot->status = SLOT_READING;
+	ring->in_flight++;
+}
+
+static void uring_complete(state_t *state, struct slot *slot, int result)
+{
+	if (state->stopping) {
+		finish_read(slot, slot->filled, 0);
+		return;
+	}
+	if (result == -EINTR || result == -EAGAIN) {
+		uring_submit(state, slot);
+		return;
+	}
+	if (result < 0) {
+		finish_read(slot, slot->filled, -result);
+		return;
+	}
+	if (result == 0) {
+		finish_read(slot, slot->filled, 0);
+		return;
+	}
+
+	slot->filled += result;
+	if (read_incomplete(state, slot))
+		uring_submit(state, slot);
+	else
+		finish_read(slot, slot->filled, 0);
+}
+
+/*
+ * Handles every completion waiting, and returns how many
+ * there were.
+ */
+static int uring_reap(state_t *state)
+{
+	struct uring *const ring = &state->ring;
+	unsigned head = *ring->cq_head;
+	const unsigned tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+	int result = 0;
+
+	for (; head != tail; head++, result++) {
+		const struct io_uring_cqe cqe = ring->cqes[head & *ring->cq_mask];
+		__atomic_store_n(ring->cq_head, head + 1, __ATOMIC_RELEASE);
+
+		ring->in_flight--;
+		uring_complete(state, &state->slots[cqe.user_data], cqe.res);
+	}
+
+	return result;
+}
+
+/*
+ * Handles at least one completion, waiting if needed.
+ */
+static bool uring_wait(state_t *state)
+{
+	while (!uring_reap(state)) {
+		if (uring_enter(state->ring.fd, 0, 1, IORING_ENTER_GETEVENTS) < 0
+			&& errno != EINTR)
+			return false;
+	}
+	return true;
+}
+#endif
+
+static void schedule(state_t *state, struct slot *slot)
+{
+	if (state->backend == THREADS)
+		pthread_mutex_lock(&state->lock);
+
+	slot->offset = state->next_offset;
+	slot->filled = 0;
+	slot->error = 0;
+	state->next_offset += state->buffer_size;
+
+	if (state->end >= 0 && slot->offset >= state->end) {
+		// Past the end: nothing to read
+		finish_read(slot, 0, 0);
+	} else if (state->backend == THREADS) {
+		slot->status = SLOT_QUEUED;
+		pthread_cond_signal(&state->work);
+	} else {
+#ifdef GENEIE_HAVE_IO_URING
+		uring_submit(state, slot);
+#endif
+	}
+
+	if (state->backend == THREADS)
+		pthread_mutex_unlock(&state->lock);
+}
+
+static bool wait_for(state_t *state, struct slot *slot)
+{
+	if (state->backend == THREADS) {
+		pthread_mutex_lock(&state->lock);
+		while (slot->status != SLOT_DONE)
+			pthread_cond_wait(&state->done, &state->lock);
+		pthread_mutex_unlock(&state->lock);
+		return true;
+	}
+
+#ifdef GENEIE_HAVE_IO_URING
+	while (slot->status != SLOT_DONE) {
+		if (!uring_wait(state))
+			return false;
+	}
+#endif
+	return true;
+}
+
+reader_t geneie_async_reader_from_fd(
+	int fd,
+	ssize_t buffer_size,
+	int depth,
+	enum geneie_async_reader_backend backend
+)
+{
+	if (buffer_size == 0)
+		buffer_size = DEFAULT_BUFFER_SIZE;
+	if (depth == 0)
+		depth = DEFAULT_DEPTH;
+	if (buffer_size < 0 || buffer_size > MAX_BUFFER_SIZE || depth < 0 || depth > MAX_DEPTH) {
+		errno = EINVAL;
+		return invalid_reader;
+	}
+
+	// io_uring would happily read a pipe, but not in order
+	if (lseek(fd, 0, SEEK_CUR) < 0)
+		return invalid_reader;
+
+#ifndef GENEIE_HAVE_IO_URING
+	if (backend == IO_URING) {
+		errno = ENOSYS;
+		return invalid_reader;
+	}
+#endif
+
+	state_t *const state = calloc(1, sizeof(state_t));
+	if (!state)
+		return invalid_reader;
+
+	state->fd = fd;
+	state->buffer_size = buffer_size;
+	state->depth = depth;
+	state->backend = THREADS;
+	pthread_mutex_init(&state->lock, NULL);
+	pthread_cond_init(&state->work, NULL);
+	pthread_cond_init(&state->done, NULL);
+
+	const reader_t result = { state };
+
+	struct stat status;
+	state->end = fstat(fd, &status) == 0 && S_ISREG(status.st_mode)
+		? status.st_size
+		: -1;
+
+	void *buffers;
+	const int error = posix_memalign(
+		&buffers,
+		BUFFER_ALIGNMENT,
+		(size_t)depth * (size_t)buffer_size
+	);
+	if (error) {
+		errno = error;
+		goto fail;
+	}
+	state->buffers = buffers;
+
+	state->slots = calloc((size_t)depth, sizeof(struct slot));
+	if (!state->slots)
+		goto fail;
+	for (int i = 0; i < depth; i++)
+		state->slots[i].buffer = state->buffers + i * buffer_size;
+
+	bool started = false;
+#ifdef GENEIE_HAVE_IO_URING
+	if (backend != THREADS)
+		started = uring_init(state);
+#endif
+	if (!started && backend != IO_URING)
+		started = threads_init(state);
+	if (!started)
+		goto fail;
+
+	for (int i = 0; i < depth; i++)
+		schedule(state, &state->slots[i]);
+
+	return result;
+
+fail:
+	{
+		const int error = errno;
+		geneie_async_reader_close(result);
+		errno = error;
+	}
+	return invalid_reader;
+}
+
+reader_t geneie_async_reader_open(
+	const char *path,
+	ssize_t buffer_size,
+	int depth,
+	enum geneie_async_reader_backend backend
+)
+{
+	const int fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return invalid_reader;
+
+	const reader_t result = geneie_async_reader_from_fd(fd, buffer_size, depth, backend);
+	if (!geneie_async_reader_valid(result)) {
+		const int error = errno;
+		close(fd);
+		errno = error;
+		return invalid_reader;
+	}
+
+	result.state->owns_fd = true;
+	return result;
+}
+
+bool geneie_async_reader_valid(reader_t reader)
+{
+	return reader.state != NULL;
+}
+
+enum geneie_async_reader_backend geneie_async_reader_backend(reader_t reader)
+{
+	return reader.state->backend;
+}
+
+seq_r geneie_async_reader_next(reader_t reader)
+{
+	state_t *const state = reader.state;
+	if (state->failed || state->finished)
+		return (seq_r) { 0 };
+
+	if (state->holding) {
+		// Send the caller's last buffer off for a read
+		// a whole round ahead
+		schedule(state, &state->slots[state->current % (unsigned long)state->depth]);
+		state->current++;
+		state->holding = false;
+	}
+
+	struct slot *const slot = &state->slots[state->current % (unsigned long)state->depth];
+	if (!wait_for(state, slot)) {
+		state->failed = true;
+		return (seq_r) { 0 };
+	}
+
+	if (slot->error) {
+		state->failed = true;
+		errno = slot->error;
+		return (seq_r) { 0 };
+	}
+	if (slot->filled == 0) {
+		state->finished = true;
+		return (seq_r) { 0 };
+	}
+
+	// A short buffer is the end of the file
+	if (slot->filled < state->buffer_size)
+		state->finished = true;
+
+	state->holding = true;
+	return (seq_r) { slot->filled, slot->buffer };
+}
+
+bool geneie_async_reader_failed(reader_t reader)
+{
+	return reader.state->failed;
+}
+
+void geneie_async_reader_close(reader_t reader)
+{
+	state_t *const state = reader.state;
+	if (!state)
+		return;
+
+	pthread_mutex_lock(&state->lock);
+	state->stopping = true;
+	pthread_cond_broadcast(&state->work);
+	pthread_mutex_unlock(&state->lock);
+
+	for (int i = 0; i < state->thread_count; i++)
+		pthread_join(state->threads[i], NULL);
+
+#ifdef GENEIE_HAVE_IO_URING
+	if (state->backend == IO_URING) {
+		// The kernel may still be writing into the buffers
+		while (state->ring.in_flight > 0 && uring_wait(state))
+			;
+		uring_free(&state->ring);
+	}
+#endif
+
+	if (state->owns_fd)
+		close(state->fd);
+
+	pthread_mutex_destroy(&state->lock);
+	pthread_cond_destroy(&state->work);
+	pthread_cond_destroy(&state->done);
+	free(state->threads);
+	free(state->slots);
+	free(state->buffers);
+	free(state);
+}
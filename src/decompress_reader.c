@@ -0,0 +1,640 @@
+#include "geneie/decompress_reader.h"
+
+#include "geneie/async_reader.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <zlib.h>
+
+typedef struct geneie_decompress_reader reader_t;
+typedef struct geneie_decompress_reader_state state_t;
+typedef struct geneie_sequence_ref seq_r;
+
+#define PLAIN GENEIE_DECOMPRESS_PLAIN
+#define GZIP GENEIE_DECOMPRESS_GZIP
+#define BGZF GENEIE_DECOMPRESS_BGZF
+
+#define INPUT_SIZE (1024 * 1024)
+#define READ_AHEAD_DEPTH 4
+#define STREAM_CHUNK_SIZE (256 * 1024)
+
+// Both the compressed and decompressed size of a BGZF
+// block are limited to 64KiB
+#define BLOCK_SIZE (64 * 1024)
+#define BLOCK_HEADER_SIZE 18
+#define BLOCK_TRAILER_SIZE 8
+#define BLOCKS_PER_THREAD 4
+#define MIN_BATCH_BLOCKS 16
+#define MAX_BATCH_BLOCKS 256
+
+struct batch;
+
+struct block {
+	struct batch *batch;
+	ssize_t input_length;
+	ssize_t output_length;
+	uint32_t crc;
+	uint32_t size;
+	bool failed;
+};
+
+/*
+ * A run of BGZF blocks, decompressed together as a group of
+ * tasks, one per block. The reader keeps two: one being
+ * consumed, and one being decompressed by the pool in the
+ * meantime. Each task only touches its own block and its
+ * part of the buffers.
+ */
+struct batch {
+	ssize_t count;
+	bool failed;
+	struct geneie_thread_pool_group group;
+	unsigned char *input;
+	char *output;
+	struct block *blocks;
+};
+
+struct geneie_decompress_reader_state {
+	int fd;
+	bool owns_fd;
+
+	// Files which can be read at an offset are read ahead
+	// in the background; what's left of its last chunk
+	struct geneie_async_reader ahead;
+	seq_r ahead_chunk;
+	enum geneie_decompress_format format;
+	bool failed;
+	bool finished;
+
+	unsigned char *input;
+	ssize_t input_start;
+	ssize_t input_end;
+	bool input_eof;
+
+	// The unread part of the last chunk, for
+	// geneie_decompress_reader_read()
+	seq_r pending;
+
+	// GZIP
+	z_stream stream;
+	bool stream_initialized;
+	bool member_open;
+	char *output;
+
+	// BGZF
+	struct geneie_thread_pool pool;
+	ssize_t batch_capacity;
+	struct batch batches[2];
+	int current;
+	bool current_ready;
+	ssize_t delivered;
+};
+
+static const reader_t invalid_reader = { 0 };
+
+static uint16_t read_le16(const unsigned char *bytes)
+{
+	return (uint16_t)(bytes[0] | bytes[1] << 8);
+}
+
+static uint32_t read_le32(const unsigned char *bytes)
+{
+	return (uint32_t)bytes[0]
+		| (uint32_t)bytes[1] << 8
+		| (uint32_t)bytes[2] << 16
+		| (uint32_t)bytes[3] << 24;
+}
+
+static ssize_t input_available(state_t *state)
+{
+	return state->input_end - state->input_start;
+}
+
+/*
+ * Takes the next chunk read ahead, or an invalid reference
+ * at the end of the file or on an error.
+ */
+static seq_r next_ahead(state_t *state)
+{
+	if (state->ahead_chunk.length > 0) {
+		const seq_r result = state->ahead_chunk;
+		state->ahead_chunk = (seq_r) { 0 };
+		return result;
+	}
+
+	const seq_r result = geneie_async_reader_next(state->ahead);
+	if (!geneie_sequence_ref_valid(result)) {
+		state->input_eof = true;
+		if (geneie_async_reader_failed(state->ahead))
+			state->failed = true;
+	}
+	return result;
+}
+
+static ssize_t read_some(state_t *state, unsigned char *buffer, ssize_t length)
+{
+	if (!geneie_async_reader_valid(state->ahead))
+		return read(state->fd, buffer, (size_t)length);
+
+	const seq_r chunk = next_ahead(state);
+	if (!geneie_sequence_ref_valid(chunk))
+		return state->failed ? -1 : 0;
+
+	const ssize_t amount = chunk.length < length ? chunk.length : length;
+	memcpy(buffer, chunk.codes, (size_t)amount);
+	state->ahead_chunk = geneie_sequence_ref_index(chunk, amount);
+	return amount;
+}
+
+/*
+ * Moves the unread input to the front of the buffer and
+ * reads until the buffer is full or the input ends.
+ */
+static bool fill_input(state_t *state)
+{
+	const ssize_t available = input_available(state);
+	memmove(state->input, state->input + state->input_start, (size_t)available);
+	state->input_start = 0;
+	state->input_end = available;
+
+	while (!state->input_eof && state->input_end < INPUT_SIZE) {
+		const ssize_t got = read_some(
+			state,
+			state->input + state->input_end,
+			INPUT_SIZE - state->input_end
+		);
+		if (got < 0) {
+			if (errno == EINTR && !state->failed)
+				continue;
+			state->failed = true;
+			return false;
+		}
+		if (got == 0)
+			state->input_eof = true;
+		state->input_end += got;
+	}
+
+	return true;
+}
+
+/*
+ * Checks for a gzip member header with the BGZF extra
+ * field, and returns the total size of the block, or 0
+ * if this isn't a BGZF block. Returns -1 if more input
+ * is needed to tell.
+ */
+static ssize_t bgzf_block_size(const unsigned char *bytes, ssize_t available)
+{
+	if (available < BLOCK_HEADER_SIZE)
+		return -1;
+	if (bytes[0] != 0x1f || bytes[1] != 0x8b || bytes[2] != 8 || !(bytes[3] & 4))
+		return 0;
+
+	const ssize_t extra_length = read_le16(&bytes[10]);
+	if (available < 12 + extra_length)
+		return -1;
+
+	for (ssize_t i = 12; i + 4 <= 12 + extra_length;) {
+		const ssize_t field_length = read_le16(&bytes[i + 2]);
+
+		// The subfield's data must be inside the extra field
+		if (i + 4 + field_length > 12 + extra_length)
+			break;
+		if (bytes[i] == 'B' && bytes[i + 1] == 'C' && field_length == 2)
+			return (ssize_t)read_le16(&bytes[i + 4]) + 1;
+		i += 4 + field_length;
+	}
+
+	return 0;
+}
+
+static enum geneie_decompress_format detect_format(state_t *state)
+{
+	const unsigned char *const bytes = state->input + state->input_start;
+	const ssize_t available = input_available(state);
+
+	if (available < 2 || bytes[0] != 0x1f || bytes[1] != 0x8b)
+		return PLAIN;
+	if (bgzf_block_size(bytes, available) > 0)
+		return BGZF;
+	return GZIP;
+}
+
+static seq_r next_plain(state_t *state)
+{
+	// Read-ahead chunks are passed on without a copy
+	if (input_available(state) == 0 && geneie_async_reader_valid(state->ahead))
+		return state->input_eof ? (seq_r) { 0 } : next_ahead(state);
+
+	if (input_available(state) == 0 && !fill_input(state))
+		return (seq_r) { 0 };
+	if (input_available(state) == 0)
+		return (seq_r) { 0 };
+
+	const seq_r result = {
+		input_available(state),
+		(char *)state->input + state->input_start,
+	};
+	state->input_start = state->input_end;
+	return result;
+}
+
+static seq_r next_gzip(state_t *state)
+{
+	z_stream *const stream = &state->stream;
+	stream->next_out = (unsigned char *)state->output;
+	stream->avail_out = STREAM_CHUNK_SIZE;
+
+	while (stream->avail_out > 0 && !state->finished) {
+		if (input_available(state) == 0) {
+			if (!fill_input(state))
+				break;
+			if (input_available(state) == 0) {
+				// Ran out in the middle of a member
+				if (state->member_open)
+					state->failed = true;
+				state->finished = true;
+				break;
+			}
+		}
+
+		stream->next_in = state->input + state->input_start;
+		stream->avail_in = (uInt)input_available(state);
+		const int status = inflate(stream, Z_NO_FLUSH);
+		state->input_start = state->input_end - (ssize_t)stream->avail_in;
+
+		if (status == Z_STREAM_END) {
+			state->member_open = false;
+
+			// gzip files may be several members concatenated;
+			// anything else after a member is ignored, like gzip
+			// does with trailing zeroes
+			if (input_available(state) < 2 && !fill_input(state))
+				break;
+			const unsigned char *const next = state->input + state->input_start;
+			if (input_available(state) >= 2 && next[0] == 0x1f && next[1] == 0x8b) {
+				inflateReset(stream);
+				state->member_open = true;
+			} else {
+				state->finished = true;
+			}
+		} else if (status != Z_OK) {
+			state->failed = true;
+			break;
+		}
+	}
+
+	const ssize_t produced = STREAM_CHUNK_SIZE - (ssize_t)stream->avail_out;
+	if (produced == 0)
+		return (seq_r) { 0 };
+	return (seq_r) { produced, state->output };
+}
+
+static bool decompress_block(z_stream *stream, struct block *block)
+{
+	struct batch *const batch = block->batch;
+	const ssize_t index = block - batch->blocks;
+	unsigned char *const output = (unsigned char *)&batch->output[index * BLOCK_SIZE];
+
+	stream->next_in = &batch->input[index * BLOCK_SIZE];
+	stream->avail_in = (uInt)block->input_length;
+	stream->next_out = output;
+	stream->avail_out = BLOCK_SIZE;
+
+	if (inflate(stream, Z_FINISH) != Z_STREAM_END)
+		return false;
+
+	block->output_length = BLOCK_SIZE - (ssize_t)stream->avail_out;
+	return block->output_length == block->size
+		&& crc32(0, output, (uInt)block->size) == block->crc;
+}
+
+static void block_task(void *param)
+{
+	struct block *const block = param;
+
+	// A stream costs little next to inflating a whole block,
+	// and keeping one per task leaves the pool's threads
+	// free of any state belonging to the reader
+	z_stream stream = { 0 };
+	if (inflateInit2(&stream, -MAX_WBITS) != Z_OK) {
+		block->failed = true;
+		return;
+	}
+
+	block->failed = !decompress_block(&stream, block);
+	inflateEnd(&stream);
+}
+
+/*
+ * Splits the next run of blocks out of the input into a
+ * batch, then starts a task for each block.
+ */
+static void submit_batch(state_t *state, struct batch *batch)
+{
+	ssize_t count = 0;
+	bool failed = false;
+
+	while (count < state->batch_capacity) {
+		if (input_available(state) < BLOCK_SIZE && !state->input_eof && !fill_input(state)) {
+			failed = true;
+			break;
+		}
+		if (input_available(state) == 0)
+			break;
+
+		const unsigned char *const bytes = state->input + state->input_start;
+		const ssize_t size = bgzf_block_size(bytes, input_available(state));
+		if (size <= 0 || size > input_available(state)
+			|| size < BLOCK_HEADER_SIZE + BLOCK_TRAILER_SIZE) {
+			// Not BGZF, or truncated
+			failed = true;
+			break;
+		}
+
+		const ssize_t data_offset = 12 + read_le16(&bytes[10]);
+		const unsigned char *const trailer = bytes + size - BLOCK_TRAILER_SIZE;
+		struct block *const block = &batch->blocks[count];
+		block->input_length = size - data_offset - BLOCK_TRAILER_SIZE;
+		block->output_length = 0;
+		block->crc = read_le32(trailer);
+		block->size = read_le32(trailer + 4);
+		block->failed = false;
+		if (block->input_length < 0 || block->size > BLOCK_SIZE) {
+			failed = true;
+			break;
+		}
+
+		memcpy(
+			&batch->input[count * BLOCK_SIZE],
+			bytes + data_offset,
+			(size_t)block->input_length
+		);
+		state->input_start += size;
+		count++;
+	}
+
+	batch->count = count;
+	batch->failed = failed;
+	for (ssize_t i = 0; i < count; i++)
+		geneie_thread_pool_group_run(&batch->group, block_task, &batch->blocks[i]);
+}
+
+/*
+ * Waits for a batch to finish; the waiting thread runs
+ * queued tasks, so it decompresses alongside the pool
+ * rather than sitting idle.
+ */
+static void wait_batch(struct batch *batch)
+{
+	geneie_thread_pool_group_wait(&batch->group);
+	for (ssize_t i = 0; i < batch->count; i++)
+		batch->failed = batch->failed || batch->blocks[i].failed;
+}
+
+static seq_r next_bgzf(state_t *state)
+{
+	for (;;) {
+		struct batch *const batch = &state->batches[state->current];
+		if (!state->current_ready) {
+			wait_batch(batch);
+			state->current_ready = true;
+			state->delivered = 0;
+			if (batch->failed) {
+				state->failed = true;
+				return (seq_r) { 0 };
+			}
+		}
+
+		while (state->delivered < batch->count) {
+			const ssize_t index = state->delivered++;
+			const struct block block = batch->blocks[index];
+			if (block.output_length > 0)
+				return (seq_r) {
+					block.output_length,
+					&batch->output[index * BLOCK_SIZE],
+				};
+		}
+
+		if (batch->count == 0)
+			return (seq_r) { 0 };
+
+		// Everything in this batch has been handed out, so
+		// it can be refilled while the other is consumed
+		submit_batch(state, batch);
+		state->current ^= 1;
+		state->current_ready = false;
+	}
+}
+
+static bool start_bgzf(state_t *state, struct geneie_thread_pool pool)
+{
+	if (!geneie_thread_pool_valid(pool))
+		return false;
+	state->pool = pool;
+
+	// Enough blocks for every worker, and the reading
+	// thread, to have a few each
+	ssize_t capacity = (ssize_t)(geneie_thread_pool_size(pool) + 1) * BLOCKS_PER_THREAD;
+	if (capacity < MIN_BATCH_BLOCKS)
+		capacity = MIN_BATCH_BLOCKS;
+	if (capacity > MAX_BATCH_BLOCKS)
+		capacity = MAX_BATCH_BLOCKS;
+	state->batch_capacity = capacity;
+
+	for (int i = 0; i < 2; i++)
+		geneie_thread_pool_group_init(&state->batches[i].group, pool);
+
+	for (int i = 0; i < 2; i++) {
+		struct batch *const batch = &state->batches[i];
+		batch->input = malloc((size_t)capacity * BLOCK_SIZE);
+		batch->output = malloc((size_t)capacity * BLOCK_SIZE);
+		batch->blocks = malloc((size_t)capacity * sizeof(struct block));
+		if (!batch->input || !batch->output || !batch->blocks)
+			return false;
+		for (ssize_t j = 0; j < capacity; j++)
+			batch->blocks[j].batch = batch;
+	}
+
+	submit_batch(state, &state->batches[0]);
+	submit_batch(state, &state->batches[1]);
+	return true;
+}
+
+reader_t geneie_decompress_reader_from_fd(int fd, struct geneie_thread_pool pool)
+{
+	state_t *const state = calloc(1, sizeof(state_t));
+	if (!state)
+		return invalid_reader;
+
+	state->fd = fd;
+
+	// Pipes can't be read at an offset, so are read as the
+	// data arrives
+	if (lseek(fd, 0, SEEK_CUR) == 0)
+		state->ahead = geneie_async_reader_from_fd(
+			fd,
+			INPUT_SIZE,
+			READ_AHEAD_DEPTH,
+			GENEIE_ASYNC_READER_AUTO
+		);
+
+	const reader_t result = { state };
+
+	state->input = malloc(INPUT_SIZE);
+	if (!state->input || !fill_input(state))
+		goto fail;
+
+	state->format = detect_format(state);
+	switch (state->format) {
+	case PLAIN:
+		break;
+	case GZIP:
+		state->output = malloc(STREAM_CHUNK_SIZE);
+		if (!state->output)
+			goto fail;
+		if (inflateInit2(&state->stream, MAX_WBITS + 16) != Z_OK)
+			goto fail;
+		state->stream_initialized = true;
+		state->member_open = true;
+		break;
+	case BGZF:
+		if (!start_bgzf(state, pool))
+			goto fail;
+		break;
+	}
+
+	return result;
+
+fail:
+	{
+		const int error = errno;
+		geneie_decompress_reader_close(result);
+		errno = error;
+	}
+	return invalid_reader;
+}
+
+reader_t geneie_decompress_reader_open(
+	const char *path,
+	struct geneie_thread_pool pool
+)
+{
+	const int fd = open(path, O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return invalid_reader;
+
+	const reader_t result = geneie_decompress_reader_from_fd(fd, pool);
+	if (!geneie_decompress_reader_valid(result)) {
+		const int error = errno;
+		close(fd);
+		errno = error;
+		return invalid_reader;
+	}
+
+	result.state->owns_fd = true;
+	return result;
+}
+
+bool geneie_decompress_reader_valid(reader_t reader)
+{
+	return reader.state != NULL;
+}
+
+enum geneie_decompress_format geneie_decompress_reader_format(reader_t reader)
+{
+	return reader.state->format;
+}
+
+static seq_r next_chunk(state_t *state)
+{
+	if (state->failed)
+		return (seq_r) { 0 };
+
+	switch (state->format) {
+	case PLAIN:
+		return next_plain(state);
+	case GZIP:
+		return next_gzip(state);
+	case BGZF:
+		return next_bgzf(state);
+	}
+
+	return (seq_r) { 0 };
+}
+
+seq_r geneie_decompress_reader_next(reader_t reader)
+{
+	state_t *const state = reader.state;
+	if (state->pending.length > 0) {
+		const seq_r result = state->pending;
+		state->pending = (seq_r) { 0 };
+		return result;
+	}
+	return next_chunk(state);
+}
+
+ssize_t geneie_decompress_reader_read(reader_t reader, char *buffer, ssize_t length)
+{
+	state_t *const state = reader.state;
+	ssize_t copied = 0;
+
+	while (copied < length) {
+		if (state->pending.length == 0) {
+			state->pending = next_chunk(state);
+			if (!geneie_sequence_ref_valid(state->pending)) {
+				state->pending = (seq_r) { 0 };
+				break;
+			}
+		}
+
+		const ssize_t wanted = length - copied;
+		const ssize_t amount = state->pending.length < wanted
+			? state->pending.length
+			: wanted;
+		memcpy(buffer + copied, state->pending.codes, (size_t)amount);
+		copied += amount;
+		state->pending = geneie_sequence_ref_index(state->pending, amount);
+	}
+
+	if (copied == 0 && state->failed)
+		return -1;
+	return copied;
+}
+
+bool geneie_decompress_reader_failed(reader_t reader)
+{
+	return reader.state->failed;
+}
+
+void geneie_decompress_reader_close(reader_t reader)
+{
+	state_t *const state = reader.state;
+	if (!state)
+		return;
+
+	// Tasks may still be decompressing into the batches
+	if (geneie_thread_pool_valid(state->pool))
+		for (int i = 0; i < 2; i++)
+			geneie_thread_pool_group_wait(&state->batches[i].group);
+
+	if (state->stream_initialized)
+		inflateEnd(&state->stream);
+	for (int i = 0; i < 2; i++) {
+		free(state->batches[i].input);
+		free(state->batches[i].output);
+		free(state->batches[i].blocks);
+	}
+	if (geneie_async_reader_valid(state->ahead))
+		geneie_async_reader_close(state->ahead);
+	if (state->owns_fd)
+		close(state->fd);
+
+	free(state->output);
+	free(state->input);
+	free(state);
+}
@@ -1,7 +1,12 @@
 #include "geneie/encoding.h"
 #include "geneie/code.h"
 
+#include "encoding_internal.h"
+#include "stats_internal.h"
+
 #include <stdbool.h>
+#include <ctype.h>
+#include <pthread.h>
 
 typedef struct geneie_sequence_ref ref;
 
@@ -165,13 +170,8 @@ static bool matches(ref search, ref input)
 	return true;
 }
 
-bool geneie_encoding_one_codon(ref codon, ref amino_out)
+static bool lookup_codon(ref codon, ref amino_out)
 {
-	if (codon.length < 3)
-		return false;
-	if (amino_out.length < 1)
-		return false;
-
 	// I hate this
 	// Just call this linear search: the library
 	// I wish I was smarter than this
@@ -196,3 +196,127 @@ bool geneie_encoding_one_codon(ref codon, ref amino_out)
 
 	return false;
 }
+
+bool geneie_encoding_one_codon_uncounted(ref codon, ref amino_out)
+{
+	if (codon.length < 3)
+		return false;
+	if (amino_out.length < 1)
+		return false;
+
+	return lookup_codon(codon, amino_out);
+}
+
+bool geneie_encoding_one_codon(ref codon, ref amino_out)
+{
+	if (codon.length < 3)
+		return false;
+	if (amino_out.length < 1)
+		return false;
+
+	if (!lookup_codon(codon, amino_out)) {
+		GENEIE_STATS_ADD(AMBIGUOUS_CODONS, 1);
+		return false;
+	}
+
+	GENEIE_STATS_ADD(CODONS_TRANSLATED, 1);
+	if (amino_out.codes[0] == GENEIE_CODE_STOP)
+		GENEIE_STATS_ADD(STOP_CODONS, 1);
+	return true;
+}
+
+// Every code geneie_code_nucleic_char_valid() accepts; index
+// 0 is for anything else
+static const char table_codes[] = "ACGTURYKMSWBDHVNX-";
+
+#define CODE_BITS 5
+#define TABLE_SIZE (1 << (3 * CODE_BITS))
+
+static unsigned char code_index[256];
+static geneie_code codon_table[TABLE_SIZE];
+static pthread_once_t codon_table_once = PTHREAD_ONCE_INIT;
+
+static unsigned table_position(const geneie_code *codon)
+{
+	return (unsigned)code_index[(unsigned char)codon[0]] << (2 * CODE_BITS)
+		| (unsigned)code_index[(unsigned char)codon[1]] << CODE_BITS
+		| (unsigned)code_index[(unsigned char)codon[2]];
+}
+
+static void build_codon_table(void)
+{
+	const int count = (int)sizeof(table_codes) - 1;
+
+	for (int i = 0; i < count; i++) {
+		const unsigned char code = (unsigned char)table_codes[i];
+		code_index[code] = (unsigned char)(i + 1);
+		code_index[tolower(code)] = (unsigned char)(i + 1);
+	}
+
+	for (int i = 0; i < TABLE_SIZE; i++)
+		codon_table[i] = GENEIE_CODE_MASKED;
+
+	for (int i = 0; i < count * count * count; i++) {
+		geneie_code codon[3] = {
+			table_codes[i / (count * count)],
+			table_codes[i / count % count],
+			table_codes[i % count],
+		};
+		geneie_code amino;
+
+		// Not counted: these aren't the caller's codons
+		if (lookup_codon((ref){ 3, codon }, (ref){ 1, &amino }))
+			codon_table[table_position(codon)] = amino;
+	}
+}
+
+/*
+ * Counts a run of table lookups; kept out of the lookup loop
+ * itself so that the loop is the same with or without stats.
+ */
+static void count_translated(const geneie_code *aminos, ssize_t count)
+{
+#ifdef GENEIE_STATS
+	ssize_t
+		ambiguous = 0,
+		stops = 0;
+	for (ssize_t i = 0; i < count; i++) {
+		ambiguous += aminos[i] == GENEIE_CODE_MASKED;
+		stops += aminos[i] == GENEIE_CODE_STOP;
+	}
+
+	GENEIE_STATS_ADD(BYTES_PROCESSED, count * 3);
+	GENEIE_STATS_ADD(CODONS_TRANSLATED, count - ambiguous);
+	if (ambiguous)
+		GENEIE_STATS_ADD(AMBIGUOUS_CODONS, ambiguous);
+	if (stops)
+		GENEIE_STATS_ADD(STOP_CODONS, stops);
+#else
+	(void)aminos;
+	(void)count;
+#endif
+}
+
+geneie_code geneie_encoding_translate_codon(const geneie_code *codon)
+{
+	pthread_once(&codon_table_once, build_codon_table);
+	const geneie_code result = codon_table[table_position(codon)];
+	count_translated(&result, 1);
+	return result;
+}
+
+ssize_t geneie_encoding_translate(ref strand, ref amino_out)
+{
+	pthread_once(&codon_table_once, build_codon_table);
+
+	ssize_t count = strand.length / 3;
+	if (count > amino_out.length)
+		count = amino_out.length;
+
+	const geneie_code *read = strand.codes;
+	for (ssize_t i = 0; i < count; i++, read += 3)
+		amino_out.codes[i] = codon_table[table_position(read)];
+
+	count_translated(amino_out.codes, count);
+	return count;
+}
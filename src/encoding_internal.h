@@ -0,0 +1,18 @@
+#ifndef GENEIE_ENCODING_INTERNAL_H
+#define GENEIE_ENCODING_INTERNAL_H
+
+#include <stdbool.h>
+
+#include "geneie/encoding.h"
+
+/*
+ * geneie_encoding_one_codon(), without adding to the
+ * geneie_stats counters, for callers which only know what
+ * to count once they've combined several results.
+ */
+bool geneie_encoding_one_codon_uncounted(
+	struct geneie_sequence_ref codon,
+	struct geneie_sequence_ref amino_out
+);
+
+#endif // GENEIE_ENCODING_INTERNAL_H
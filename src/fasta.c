@@ -0,0 +1,88 @@
+#include "geneie/fasta.h"
+
+#include "geneie/sequence_tools.h"
+
+#include <string.h>
+
+typedef struct geneie_fasta_reader reader_t;
+typedef struct geneie_fasta_record record_t;
+typedef struct geneie_sequence_ref seq_r;
+
+/*
+ * Finds the next '>' at the start of a line, at or after
+ * the given position. The first byte of the buffer counts
+ * as the start of a line.
+ */
+static char *find_header(char *begin, char *position, char *end)
+{
+	while (position < end) {
+		char *const found = memchr(position, '>', (size_t)(end - position));
+		if (!found)
+			return NULL;
+		if (found == begin || found[-1] == '\n')
+			return found;
+		position = found + 1;
+	}
+	return NULL;
+}
+
+reader_t geneie_fasta_reader_init(char *buffer, ssize_t length, bool final)
+{
+	return (reader_t) {
+		buffer,
+		buffer + length,
+		final,
+	};
+}
+
+bool geneie_fasta_reader_next(reader_t *reader, record_t *record)
+{
+	char *const header = find_header(reader->position, reader->position, reader->end);
+	if (!header) {
+		// Nothing but junk before the end
+		if (reader->final)
+			reader->position = reader->end;
+		return false;
+	}
+	reader->position = header;
+
+	char *header_end = memchr(header, '\n', (size_t)(reader->end - header));
+	if (!header_end && !reader->final)
+		return false;
+
+	char *const sequence_start = header_end ? header_end + 1 : reader->end;
+	if (!header_end)
+		header_end = reader->end;
+
+	char *next = find_header(header, sequence_start, reader->end);
+	if (!next) {
+		if (!reader->final)
+			return false;
+		next = reader->end;
+	}
+
+	if (header_end > header + 1 && header_end[-1] == '\r')
+		header_end--;
+
+	const seq_r lines = {
+		next - sequence_start,
+		sequence_start,
+	};
+
+	*record = (record_t) {
+		.header = header + 1,
+		.header_length = header_end - (header + 1),
+		.sequence = geneie_sequence_tools_clean_whitespace(lines),
+	};
+
+	reader->position = next;
+	return true;
+}
+
+seq_r geneie_fasta_reader_remaining(reader_t reader)
+{
+	return (seq_r) {
+		reader.end - reader.position,
+		reader.position,
+	};
+}
@@ -0,0 +1,667 @@
+#include "geneie/fasta_index.h"
+
+#include "geneie/sequence_tools.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+typedef struct geneie_fasta_index index_t;
+typedef struct geneie_fasta_index_entry entry_t;
+typedef struct geneie_sequence_ref seq_r;
+
+// Records longer than this are measured by several
+// threads at once
+#define PIECE_SIZE (4 * 1024 * 1024)
+
+static const index_t invalid_index = { 0 };
+
+static bool reserve(index_t *index, ssize_t extra)
+{
+	if (index->count + extra <= index->capacity)
+		return true;
+
+	ssize_t capacity = index->capacity ? index->capacity : 16;
+	while (capacity < index->count + extra)
+		capacity *= 2;
+
+	entry_t *const entries = realloc(
+		index->entries,
+		(size_t)capacity * sizeof(entry_t)
+	);
+	if (!entries)
+		return false;
+
+	index->entries = entries;
+	index->capacity = capacity;
+	return true;
+}
+
+static bool is_name_end(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+static char *copy_name(const char *name, const char *end)
+{
+	const char *name_end = name;
+	while (name_end < end && !is_name_end(*name_end))
+		name_end++;
+
+	const size_t length = (size_t)(name_end - name);
+	char *const result = malloc(length + 1);
+	if (!result)
+		return NULL;
+
+	memcpy(result, name, length);
+	result[length] = '\0';
+	return result;
+}
+
+static const char *line_end(const char *position, const char *end)
+{
+	const char *const found = memchr(position, '\n', (size_t)(end - position));
+	return found ? found : end;
+}
+
+static const char *next_line(const char *position, const char *end)
+{
+	const char *const found = line_end(position, end);
+	return found < end ? found + 1 : end;
+}
+
+/*
+ * Running totals for the sequence lines of a record, so
+ * a record can be measured in several pieces.
+ */
+struct line_stats {
+	ssize_t length;
+	ssize_t line_bases;
+	ssize_t line_width;
+	bool short_line;
+};
+
+/*
+ * Measures sequence lines, adding them to the stats. Every
+ * line but the last must have the same length; blank
+ * lines are only allowed at the end of the record. `final`
+ * says whether `end` is the end of the record, where the
+ * last line may be missing its line ending.
+ */
+static bool measure_lines(
+	struct line_stats *stats,
+	const char *position,
+	const char *end,
+	bool final
+)
+{
+	while (position < end) {
+		const char *const newline = line_end(position, end);
+		const char *const next = next_line(position, end);
+
+		ssize_t bases = newline - position;
+		if (bases > 0 && position[bases - 1] == '\r')
+			bases--;
+		const ssize_t width = next - position;
+
+		if (bases == 0) {
+			stats->short_line = true;
+		} else if (stats->short_line) {
+			// Codes after a short or blank line
+			return false;
+		} else if (stats->line_bases == 0) {
+			stats->line_bases = bases;
+			stats->line_width = width;
+		} else if (bases != stats->line_bases) {
+			if (bases > stats->line_bases)
+				return false;
+			stats->short_line = true;
+		} else if (width != stats->line_width && !(final && next == end)) {
+			return false;
+		}
+
+		stats->length += bases;
+		position = next;
+	}
+
+	return true;
+}
+
+static bool measure_record(const char *position, const char *end, entry_t *entry)
+{
+	struct line_stats stats = { 0 };
+	if (!measure_lines(&stats, position, end, true))
+		return false;
+
+	entry->length = stats.length;
+	entry->line_bases = stats.line_bases;
+	entry->line_width = stats.line_width;
+	return true;
+}
+
+static int compare_entries(const void *a, const void *b)
+{
+	const entry_t
+		*const *first = a,
+		*const *second = b;
+	return strcmp((*first)->name, (*second)->name);
+}
+
+static int compare_name(const void *key, const void *element)
+{
+	const entry_t *const *entry = element;
+	return strcmp(key, (*entry)->name);
+}
+
+static bool sort_names(index_t *index)
+{
+	index->by_name = malloc((size_t)(index->count ? index->count : 1) * sizeof(entry_t *));
+	if (!index->by_name)
+		return false;
+
+	for (ssize_t i = 0; i < index->count; i++)
+		index->by_name[i] = &index->entries[i];
+	qsort(index->by_name, (size_t)index->count, sizeof(entry_t *), compare_entries);
+
+	// Like samtools faidx, refuse names that find couldn't
+	// tell apart
+	for (ssize_t i = 1; i < index->count; i++)
+		if (!compare_entries(&index->by_name[i - 1], &index->by_name[i]))
+			return false;
+	return true;
+}
+
+index_t geneie_fasta_index_build(const char *data, ssize_t length)
+{
+	index_t result = { 0 };
+	const char *position = data;
+	const char *const end = data + length;
+
+	// Skip anything before the first header
+	while (position < end && *position != '>')
+		position = next_line(position, end);
+
+	while (position < end) {
+		const char *const header_end = line_end(position, end);
+		const char *const sequence = next_line(position, end);
+
+		const char *next = sequence;
+		while (next < end && *next != '>')
+			next = next_line(next, end);
+
+		if (!reserve(&result, 1))
+			goto fail;
+
+		entry_t *const entry = &result.entries[result.count];
+		entry->offset = (off_t)(sequence - data);
+		if (!measure_record(sequence, next, entry))
+			goto fail;
+		if (!(entry->name = copy_name(position + 1, header_end)))
+			goto fail;
+		result.count++;
+
+		position = next;
+	}
+
+	if (!sort_names(&result))
+		goto fail;
+	return result;
+
+fail:
+	geneie_fasta_index_free(result);
+	return invalid_index;
+}
+
+struct header_scan {
+	const char *data;
+	ssize_t start;
+	ssize_t end;
+	ssize_t count;
+	ssize_t capacity;
+	ssize_t *offsets;
+	bool failed;
+};
+
+/*
+ * Finds the headers starting inside one byte range. The
+ * byte before the range is checked too, so a header
+ * starting right on the boundary isn't missed.
+ */
+static void scan_headers(struct header_scan *scan)
+{
+	const char *position = scan->data + scan->start;
+	const char *const end = scan->data + scan->end;
+
+	while (position < end) {
+		const char *const found = memchr(position, '>', (size_t)(end - position));
+		if (!found)
+			break;
+
+		if (found == scan->data || found[-1] == '\n') {
+			if (scan->count == scan->capacity) {
+				const ssize_t capacity = scan->capacity ? scan->capacity * 2 : 64;
+				ssize_t *const offsets = realloc(
+					scan->offsets,
+					(size_t)capacity * sizeof(ssize_t)
+				);
+				if (!offsets) {
+					scan->failed = true;
+					break;
+				}
+				scan->offsets = offsets;
+				scan->capacity = capacity;
+			}
+			scan->offsets[scan->count++] = found - scan->data;
+		}
+
+		position = found + 1;
+	}
+}
+
+static void scan_ranges(ssize_t begin, ssize_t end, void *param)
+{
+	struct header_scan *const scans = param;
+	for (ssize_t i = begin; i < end; i++)
+		scan_headers(&scans[i]);
+}
+
+/*
+ * A run of whole lines from one record. Records longer
+ * than PIECE_SIZE are split into several, on multiples
+ * of the width of their first line, so that one huge
+ * chromosome doesn't leave the other threads idle.
+ */
+struct piece {
+	ssize_t record;
+	const char *header;
+	const char *header_end;
+	const char *start;
+	const char *end;
+	bool first;
+	bool final;
+	bool valid;
+	char *name;
+	struct line_stats stats;
+};
+
+struct piece_work {
+	struct piece *pieces;
+	ssize_t count;
+};
+
+static void measure_pieces(ssize_t begin, ssize_t end, void *param)
+{
+	struct piece_work *const work = param;
+
+	for (ssize_t i = begin; i < end; i++) {
+		struct piece *const piece = &work->pieces[i];
+		piece->valid = measure_lines(&piece->stats, piece->start, piece->end, piece->final);
+		if (piece->valid && piece->first)
+			piece->valid = (piece->name = copy_name(piece->header + 1, piece->header_end));
+	}
+}
+
+/*
+ * Adds the pieces for one record, returning the number
+ * added. `pieces` must have room for count_pieces() more.
+ */
+static ssize_t split_record(
+	struct piece *pieces,
+	ssize_t record,
+	const char *header,
+	const char *end
+)
+{
+	const char *const header_end = line_end(header, end);
+	const char *const sequence = next_line(header, end);
+
+	const struct piece base = {
+		.record = record,
+		.header = header,
+		.header_end = header_end,
+		.start = sequence,
+		.end = end,
+		.first = true,
+		.final = true,
+	};
+
+	// Use the first line to find where the others start
+	const char *const first_end = line_end(sequence, end);
+	ssize_t bases = first_end - sequence;
+	if (bases > 0 && sequence[bases - 1] == '\r')
+		bases--;
+	const ssize_t width = next_line(sequence, end) - sequence;
+
+	if (end - sequence <= PIECE_SIZE || bases == 0) {
+		pieces[0] = base;
+		return 1;
+	}
+
+	const ssize_t step = (PIECE_SIZE / width + 1) * width;
+	ssize_t count = 0;
+	for (const char *start = sequence; start < end; start += step) {
+		struct piece piece = base;
+		piece.start = start;
+		piece.end = end - start > step ? start + step : end;
+		piece.first = count == 0;
+		piece.final = piece.end == end;
+		piece.stats = (struct line_stats) { 0, bases, width, false };
+		pieces[count++] = piece;
+	}
+	return count;
+}
+
+static ssize_t count_pieces(const char *header, const char *end)
+{
+	const ssize_t size = end - next_line(header, end);
+	return size / PIECE_SIZE + 2;
+}
+
+/*
+ * Combines the pieces of one record into its entry. A
+ * short line in one piece means every later piece must
+ * be blank.
+ */
+static bool merge_pieces(const struct piece *pieces, ssize_t count, entry_t *entry)
+{
+	*entry = (entry_t) {
+		.name = pieces[0].name,
+		.line_bases = pieces[0].stats.line_bases,
+		.line_width = pieces[0].stats.line_width,
+	};
+
+	bool short_line = false;
+	for (ssize_t i = 0; i < count; i++) {
+		const struct piece *const piece = &pieces[i];
+		if (!piece->valid || (short_line && piece->stats.length > 0))
+			return false;
+		short_line = short_line || piece->stats.short_line;
+		entry->length += piece->stats.length;
+	}
+	return true;
+}
+
+index_t geneie_fasta_index_build_parallel(
+	const char *data,
+	ssize_t length,
+	struct geneie_thread_pool pool
+)
+{
+	if (length < PIECE_SIZE)
+		return geneie_fasta_index_build(data, length);
+
+	// One range for each worker, and one for the waiting
+	// thread, which joins in
+	const int threads = geneie_thread_pool_size(pool) + 1;
+
+	index_t result = { 0 };
+	ssize_t *headers = NULL;
+	struct piece_work work = { 0 };
+	bool failed = false;
+
+	// First find every header, with each thread taking an
+	// equal share of the bytes
+	struct header_scan *const scans = calloc((size_t)threads, sizeof(struct header_scan));
+	if (!scans)
+		return invalid_index;
+	for (int i = 0; i < threads; i++) {
+		scans[i].data = data;
+		scans[i].start = length * i / threads;
+		scans[i].end = length * (i + 1) / threads;
+	}
+	geneie_thread_pool_parallel_for(pool, 0, threads, 1, scan_ranges, scans);
+
+	ssize_t total = 0;
+	for (int i = 0; i < threads; i++) {
+		failed = failed || scans[i].failed;
+		total += scans[i].count;
+	}
+	if (failed || !(headers = malloc((size_t)(total ? total : 1) * sizeof(ssize_t))))
+		goto fail;
+	for (int i = 0, record = 0; i < threads; i++) {
+		// Ranges without a header never allocated their offsets
+		if (!scans[i].count)
+			continue;
+		memcpy(&headers[record], scans[i].offsets, (size_t)scans[i].count * sizeof(ssize_t));
+		record += scans[i].count;
+	}
+
+	// Then measure every record, splitting large ones up
+	ssize_t piece_capacity = 0;
+	for (ssize_t i = 0; i < total; i++) {
+		const ssize_t end = i + 1 < total ? headers[i + 1] : length;
+		piece_capacity += count_pieces(data + headers[i], data + end);
+	}
+	if (!(work.pieces = calloc((size_t)(piece_capacity ? piece_capacity : 1), sizeof(struct piece))))
+		goto fail;
+	for (ssize_t i = 0; i < total; i++) {
+		const ssize_t end = i + 1 < total ? headers[i + 1] : length;
+		work.count += split_record(&work.pieces[work.count], i, data + headers[i], data + end);
+	}
+	geneie_thread_pool_parallel_for(pool, 0, work.count, 1, measure_pieces, &work);
+
+	if (!reserve(&result, total ? total : 1))
+		goto fail;
+	for (ssize_t i = 0, first = 0; first < work.count; i++) {
+		ssize_t last = first + 1;
+		while (last < work.count && work.pieces[last].record == i)
+			last++;
+
+		if (!merge_pieces(&work.pieces[first], last - first, &result.entries[i]))
+			goto fail;
+		result.entries[i].offset = (off_t)(work.pieces[first].start - data);
+		work.pieces[first].name = NULL;
+		result.count++;
+		first = last;
+	}
+
+	if (!sort_names(&result))
+		goto fail;
+
+	free(work.pieces);
+	free(headers);
+	for (int i = 0; i < threads; i++)
+		free(scans[i].offsets);
+	free(scans);
+	return result;
+
+fail:
+	for (ssize_t i = 0; i < work.count; i++)
+		free(work.pieces[i].name);
+	free(work.pieces);
+	free(headers);
+	for (int i = 0; i < threads; i++)
+		free(scans[i].offsets);
+	free(scans);
+	geneie_fasta_index_free(result);
+	return invalid_index;
+}
+
+static bool parse_field(char **position, long long *out)
+{
+	char *field_end;
+	errno = 0;
+	*out = strtoll(*position, &field_end, 10);
+	if (errno || field_end == *position || *out < 0)
+		return false;
+	*position = field_end;
+	return true;
+}
+
+static bool parse_line(char *line, entry_t *entry)
+{
+	char *const tab = strchr(line, '\t');
+	if (!tab || tab == line)
+		return false;
+	*tab = '\0';
+
+	long long fields[4];
+	char *position = tab + 1;
+	for (int i = 0; i < 4; i++) {
+		if (i > 0 && *position++ != '\t')
+			return false;
+		if (!parse_field(&position, &fields[i]))
+			return false;
+	}
+
+	// Newer samtools adds a quality offset for FASTQ
+	if (*position != '\0' && *position != '\t'
+		&& *position != '\n' && *position != '\r')
+		return false;
+
+	if (fields[0] > 0 && (fields[2] == 0 || fields[3] < fields[2]))
+		return false;
+
+	if (!(entry->name = strdup(line)))
+		return false;
+	entry->length = (ssize_t)fields[0];
+	entry->offset = (off_t)fields[1];
+	entry->line_bases = (ssize_t)fields[2];
+	entry->line_width = (ssize_t)fields[3];
+	return true;
+}
+
+index_t geneie_fasta_index_read(FILE *file)
+{
+	index_t result = { 0 };
+	char *line = NULL;
+	size_t line_capacity = 0;
+
+	while (getline(&line, &line_capacity, file) != -1) {
+		if (line[0] == '\n' || line[0] == '\0')
+			continue;
+		if (!reserve(&result, 1))
+			goto fail;
+		if (!parse_line(line, &result.entries[result.count]))
+			goto fail;
+		result.count++;
+	}
+
+	if (ferror(file) || !sort_names(&result))
+		goto fail;
+	free(line);
+	return result;
+
+fail:
+	free(line);
+	geneie_fasta_index_free(result);
+	return invalid_index;
+}
+
+bool geneie_fasta_index_write(index_t index, FILE *file)
+{
+	for (ssize_t i = 0; i < index.count; i++) {
+		const entry_t entry = index.entries[i];
+		const int written = fprintf(
+			file,
+			"%s\t%zd\t%lld\t%zd\t%zd\n",
+			entry.name,
+			entry.length,
+			(long long)entry.offset,
+			entry.line_bases,
+			entry.line_width
+		);
+		if (written < 0)
+			return false;
+	}
+	return !ferror(file);
+}
+
+bool geneie_fasta_index_valid(index_t index)
+{
+	return index.by_name != NULL;
+}
+
+void geneie_fasta_index_free(index_t index)
+{
+	for (ssize_t i = 0; i < index.count; i++)
+		free(index.entries[i].name);
+	free(index.entries);
+	free(index.by_name);
+}
+
+const entry_t *geneie_fasta_index_find(index_t index, const char *name)
+{
+	entry_t *const *const found = bsearch(
+		name,
+		index.by_name,
+		(size_t)index.count,
+		sizeof(entry_t *),
+		compare_name
+	);
+	return found ? *found : NULL;
+}
+
+seq_r geneie_fasta_index_fetch_into(
+	const entry_t *entry,
+	const char *data,
+	ssize_t length,
+	ssize_t start,
+	ssize_t end,
+	seq_r destination
+)
+{
+	if (start < 0 || end < start || end > entry->length)
+		return (seq_r) { 0 };
+	if (end - start > destination.length)
+		return (seq_r) { 0 };
+	if (start == end)
+		return geneie_sequence_ref_trunc(destination, 0);
+
+	// Make sure the last code is inside the file before
+	// reading any of them
+	const ssize_t last = end - 1;
+	const off_t last_offset = entry->offset
+		+ (off_t)(last / entry->line_bases) * entry->line_width
+		+ last % entry->line_bases;
+	if (last_offset >= length)
+		return (seq_r) { 0 };
+
+	geneie_code *out = destination.codes;
+	for (ssize_t position = start; position < end;) {
+		const ssize_t
+			column = position % entry->line_bases,
+			available = entry->line_bases - column,
+			amount = end - position < available ? end - position : available;
+		const off_t offset = entry->offset
+			+ (off_t)(position / entry->line_bases) * entry->line_width
+			+ column;
+
+		memcpy(out, &data[offset], (size_t)amount);
+		out += amount;
+		position += amount;
+	}
+
+	return geneie_sequence_ref_trunc(destination, end - start);
+}
+
+struct geneie_sequence geneie_fasta_index_fetch(
+	const entry_t *entry,
+	const char *data,
+	ssize_t length,
+	ssize_t start,
+	ssize_t end
+)
+{
+	if (start < 0 || end < start || end > entry->length)
+		return (struct geneie_sequence) { 0 };
+
+	struct geneie_sequence result = geneie_sequence_alloc(end - start);
+	if (!geneie_sequence_valid(result))
+		return result;
+
+	const seq_r fetched = geneie_fasta_index_fetch_into(
+		entry,
+		data,
+		length,
+		start,
+		end,
+		geneie_sequence_tools_ref_from_sequence(result)
+	);
+	if (!geneie_sequence_ref_valid(fetched)) {
+		geneie_sequence_free(result);
+		return (struct geneie_sequence) { 0 };
+	}
+
+	return result;
+}
@@ -0,0 +1,154 @@
+#include "geneie/fastq.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct geneie_fastq_reader reader_t;
+typedef struct geneie_fastq_record record_t;
+typedef struct geneie_fastq_batch batch_t;
+typedef struct geneie_sequence_ref seq_r;
+
+enum parse_result {
+	PARSE_COMPLETE,
+	PARSE_INCOMPLETE,
+	PARSE_MALFORMED,
+};
+
+batch_t geneie_fastq_batch_alloc(ssize_t capacity)
+{
+	if (capacity <= 0)
+		return (batch_t) { 0 };
+
+	record_t *const records = malloc((size_t)capacity * sizeof(record_t));
+	if (!records)
+		return (batch_t) { 0 };
+
+	return (batch_t) {
+		0,
+		capacity,
+		records,
+	};
+}
+
+bool geneie_fastq_batch_valid(batch_t batch)
+{
+	return batch.records != NULL;
+}
+
+void geneie_fastq_batch_free(batch_t batch)
+{
+	free(batch.records);
+}
+
+reader_t geneie_fastq_reader_init(char *buffer, ssize_t length, bool final)
+{
+	return (reader_t) {
+		buffer,
+		buffer + length,
+		final,
+	};
+}
+
+/*
+ * Takes the line starting at *position, without its line
+ * ending, and moves *position to the start of the next.
+ * A line running into the end of the buffer only counts
+ * if the buffer is final.
+ */
+static bool take_line(char **position, char *end, bool final, seq_r *line)
+{
+	char *const start = *position;
+	if (start >= end)
+		return false;
+
+	char *newline = memchr(start, '\n', (size_t)(end - start));
+	if (newline) {
+		*position = newline + 1;
+	} else if (final) {
+		newline = end;
+		*position = end;
+	} else {
+		return false;
+	}
+
+	if (newline > start && newline[-1] == '\r')
+		newline--;
+
+	*line = (seq_r) { newline - start, start };
+	return true;
+}
+
+static enum parse_result parse_record(reader_t *reader, record_t *record)
+{
+	char *position = reader->position;
+	seq_r name, sequence, separator, quality;
+
+	if (*position != '@')
+		return PARSE_MALFORMED;
+
+	if (!take_line(&position, reader->end, reader->final, &name)
+		|| !take_line(&position, reader->end, reader->final, &sequence)
+		|| !take_line(&position, reader->end, reader->final, &separator)
+		|| !take_line(&position, reader->end, reader->final, &quality))
+		return reader->final ? PARSE_MALFORMED : PARSE_INCOMPLETE;
+
+	if (separator.length == 0 || *separator.codes != '+')
+		return PARSE_MALFORMED;
+	if (quality.length != sequence.length)
+		return PARSE_MALFORMED;
+
+	*record = (record_t) {
+		.name = name.codes + 1,
+		.name_length = name.length - 1,
+		.sequence = sequence,
+		.quality = quality,
+	};
+	reader->position = position;
+	return PARSE_COMPLETE;
+}
+
+static void skip_blank_lines(reader_t *reader)
+{
+	while (reader->position < reader->end) {
+		if (*reader->position == '\n') {
+			reader->position++;
+		} else if (*reader->position == '\r'
+			&& reader->end - reader->position > 1
+			&& reader->position[1] == '\n') {
+			reader->position += 2;
+		} else {
+			break;
+		}
+	}
+}
+
+ssize_t geneie_fastq_reader_read_batch(reader_t *reader, batch_t *batch)
+{
+	batch->count = 0;
+
+	while (batch->count < batch->capacity) {
+		skip_blank_lines(reader);
+		if (reader->position >= reader->end)
+			break;
+
+		switch (parse_record(reader, &batch->records[batch->count])) {
+		case PARSE_COMPLETE:
+			batch->count++;
+			break;
+		case PARSE_INCOMPLETE:
+			return batch->count;
+		case PARSE_MALFORMED:
+			return -1;
+		}
+	}
+
+	return batch->count;
+}
+
+seq_r geneie_fastq_reader_remaining(reader_t reader)
+{
+	return (seq_r) {
+		reader.end - reader.position,
+		reader.position,
+	};
+}
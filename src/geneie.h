@@ -22,7 +22,25 @@
 #include "geneie/code.h"
 #include "geneie/sequence.h"
 #include "geneie/sequence_ref.h"
+#include "geneie/sequence_shared.h"
+#include "geneie/sequence_builder.h"
 #include "geneie/encoding.h"
 #include "geneie/sequence_tools.h"
+#include "geneie/sequence_batch.h"
+#include "geneie/synthetic.h"
+#include "geneie/sequence_view.h"
+#include "geneie/splice_site.h"
+#include "geneie/mapped_file.h"
+#include "geneie/fasta.h"
+#include "geneie/fasta_index.h"
+#include "geneie/fastq.h"
+#include "geneie/decompress_reader.h"
+#include "geneie/async_reader.h"
+#include "geneie/thread_pool.h"
+#include "geneie/ring.h"
+#include "geneie/pipeline.h"
+#include "geneie/reorder.h"
+#include "geneie/rope.h"
+#include "geneie/stats.h"
 
 #endif // GENEIE_H
@@ -0,0 +1,214 @@
+/*
+ * Geneie - A Library and Tools for gene processing
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GENEIE_ASYNC_READER_H
+#define GENEIE_ASYNC_READER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <sys/types.h>
+#include <stdbool.h>
+
+#include "sequence_ref.h"
+
+/**
+ * \file
+ */
+
+/**
+ * \brief The ways geneie_async_reader can read ahead.
+ */
+enum geneie_async_reader_backend {
+	/**
+	 * \brief Use io_uring if the library was built with it
+	 * 	and the kernel allows it, otherwise threads.
+	 *
+	 * io_uring needs Linux 5.6 or later, for plain reads;
+	 * earlier kernels use threads.
+	 */
+	GENEIE_ASYNC_READER_AUTO,
+
+	/**
+	 * \brief Submit reads through io_uring, into buffers
+	 * 	registered with the kernel where possible.
+	 */
+	GENEIE_ASYNC_READER_IO_URING,
+
+	/**
+	 * \brief Run blocking pread() calls on worker threads.
+	 */
+	GENEIE_ASYNC_READER_THREADS,
+};
+
+/**
+ * \brief Internal state of a geneie_async_reader.
+ */
+struct geneie_async_reader_state;
+
+/**
+ * \brief Reads a file in large chunks, keeping several
+ * 	reads in flight ahead of the caller.
+ *
+ * The reader owns a fixed set of buffers. Each one is
+ * filled from the next part of the file while the caller
+ * works on the chunk returned before it, so computation
+ * and I/O overlap and a fast disk is kept busy. When a
+ * chunk is finished with, its buffer is sent off for a
+ * read further ahead.
+ *
+ * Chunks are writable and belong to the caller until the
+ * next call, so in-place kernels such as
+ * geneie_sequence_tools_dna_to_premrna() can run on them
+ * directly, without a copy.
+ *
+ * The file must support reading at an offset, as regular
+ * files and block devices do. For pipes and compressed
+ * input, use geneie_decompress_reader.
+ *
+ * A reader must only be used by one thread at a time. You
+ * must pass these to geneie_async_reader_close() when
+ * finished with them.
+ */
+struct geneie_async_reader {
+	/**
+	 * \brief The reader's state.
+	 */
+	struct geneie_async_reader_state *state;
+};
+
+/**
+ * \public \memberof geneie_async_reader
+ * \brief Opens a file for reading.
+ *
+ * \param path The path to the file.
+ * \param buffer_size The size of each buffer, or 0 for a
+ * 	default of 4MiB.
+ * \param depth The number of buffers, which is how many
+ * 	reads can be in flight at once, or 0 for a default
+ * 	of 4.
+ * \param backend How to read ahead.
+ *
+ * \returns A new reader, or a reader failing
+ * 	geneie_async_reader_valid() if the file couldn't be
+ * 	opened or can't be read at an offset, the requested
+ * 	backend is unavailable, or allocation failed. errno is set to indicate the error.
+ */
+struct geneie_async_reader geneie_async_reader_open(
+	const char *path,
+	ssize_t buffer_size,
+	int depth,
+	enum geneie_async_reader_backend backend
+);
+
+/**
+ * \public \memberof geneie_async_reader
+ * \brief Creates a reader over an open file descriptor,
+ * 	starting at offset 0.
+ *
+ * The file descriptor is not closed by
+ * geneie_async_reader_close().
+ *
+ * \param fd The file descriptor to read from.
+ * \param buffer_size The size of each buffer, or 0 for a
+ * 	default of 4MiB.
+ * \param depth The number of buffers, or 0 for a default
+ * 	of 4.
+ * \param backend How to read ahead.
+ *
+ * \returns A new reader, or a reader failing
+ * 	geneie_async_reader_valid() if the file can't be read
+ * 	at an offset, the requested backend is unavailable or
+ * 	allocation failed. errno is set to indicate the error.
+ */
+struct geneie_async_reader geneie_async_reader_from_fd(
+	int fd,
+	ssize_t buffer_size,
+	int depth,
+	enum geneie_async_reader_backend backend
+);
+
+/**
+ * \public \memberof geneie_async_reader
+ * \brief Returns whether this is a valid reader.
+ *
+ * \param reader The reader to test.
+ *
+ * \returns True if the reader is safe to use, false otherwise.
+ */
+bool geneie_async_reader_valid(struct geneie_async_reader reader);
+
+/**
+ * \public \memberof geneie_async_reader
+ * \brief Returns the backend the reader ended up with.
+ *
+ * \param reader The reader.
+ *
+ * \returns GENEIE_ASYNC_READER_IO_URING or
+ * 	GENEIE_ASYNC_READER_THREADS.
+ */
+enum geneie_async_reader_backend geneie_async_reader_backend(
+	struct geneie_async_reader reader
+);
+
+/**
+ * \public \memberof geneie_async_reader
+ * \brief Returns the next chunk of the file.
+ *
+ * Every chunk but the last is a full buffer. The chunk is
+ * owned by the reader and stays valid until the next call
+ * to geneie_async_reader_next() or
+ * geneie_async_reader_close(); until then, the caller may
+ * modify it freely.
+ *
+ * \param reader The reader.
+ *
+ * \returns The next chunk, or a reference failing
+ * 	geneie_sequence_ref_valid() at the end of the file or
+ * 	on an error; use geneie_async_reader_failed() to tell
+ * 	them apart. The bytes are not necessarily valid codes.
+ */
+struct geneie_sequence_ref geneie_async_reader_next(
+	struct geneie_async_reader reader
+);
+
+/**
+ * \public \memberof geneie_async_reader
+ * \brief Returns whether a read failed.
+ *
+ * \param reader The reader.
+ *
+ * \returns True if an error occurred, false otherwise.
+ */
+bool geneie_async_reader_failed(struct geneie_async_reader reader);
+
+/**
+ * \public \memberof geneie_async_reader
+ * \brief Waits for any reads in flight, stops the reader's
+ * 	threads and frees it.
+ *
+ * \param reader The reader to close.
+ */
+void geneie_async_reader_close(struct geneie_async_reader reader);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // GENEIE_ASYNC_READER_H
@@ -0,0 +1,225 @@
+/*
+ * Geneie - A Library and Tools for gene processing
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GENEIE_DECOMPRESS_READER_H
+#define GENEIE_DECOMPRESS_READER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <sys/types.h>
+#include <stdbool.h>
+
+#include "sequence_ref.h"
+#include "thread_pool.h"
+
+/**
+ * \file
+ */
+
+/**
+ * \brief The compression formats recognised by
+ * 	geneie_decompress_reader.
+ */
+enum geneie_decompress_format {
+	/**
+	 * \brief Uncompressed input, passed through as-is.
+	 */
+	GENEIE_DECOMPRESS_PLAIN,
+
+	/**
+	 * \brief gzip input, including concatenated members,
+	 * 	decompressed as a single stream.
+	 */
+	GENEIE_DECOMPRESS_GZIP,
+
+	/**
+	 * \brief Blocked gzip, as written by bgzip and samtools,
+	 * 	whose independent blocks are decompressed in parallel.
+	 */
+	GENEIE_DECOMPRESS_BGZF,
+};
+
+/**
+ * \brief Internal state of a geneie_decompress_reader.
+ */
+struct geneie_decompress_reader_state;
+
+/**
+ * \brief Reads a file, decompressing it if needed, and
+ * 	delivers the contents in order as a series of chunks.
+ *
+ * The format is detected from the start of the input. BGZF
+ * files are made of small gzip members that can each be
+ * decompressed on their own: the reader decompresses
+ * batches of them as tasks on a geneie_thread_pool, while
+ * the previous batch is being consumed. Plain gzip has to be
+ * decompressed serially and is streamed; anything else is
+ * read as-is.
+ *
+ * Files which can be read at an offset are read ahead
+ * with a geneie_async_reader, so the disk keeps reading
+ * while the caller works on the last chunk, and plain
+ * input is passed on in the reader's buffers without a
+ * copy. Pipes are read as the data arrives.
+ *
+ * The chunks can be handed straight to
+ * geneie_fasta_reader or geneie_fastq_reader with `final`
+ * set to false, or copied into a buffer of the caller's
+ * choosing with geneie_decompress_reader_read(), which
+ * works like fread().
+ *
+ * A reader must only be used by one thread at a time. You
+ * must pass these to geneie_decompress_reader_close() when
+ * finished with them.
+ */
+struct geneie_decompress_reader {
+	/**
+	 * \brief The reader's state.
+	 */
+	struct geneie_decompress_reader_state *state;
+};
+
+/**
+ * \public \memberof geneie_decompress_reader
+ * \brief Opens a file for reading.
+ *
+ * \param path The path to the file.
+ * \param pool The pool to decompress BGZF input on,
+ * 	usually geneie_thread_pool_default(). It must outlive
+ * 	the reader.
+ *
+ * \returns A new reader, or a reader failing
+ * 	geneie_decompress_reader_valid() if the file couldn't
+ * 	be opened or read, or allocation failed. errno is set
+ * 	to indicate the error.
+ */
+struct geneie_decompress_reader geneie_decompress_reader_open(
+	const char *path,
+	struct geneie_thread_pool pool
+);
+
+/**
+ * \public \memberof geneie_decompress_reader
+ * \brief Creates a reader over an open file descriptor, such
+ * 	as a pipe or standard input.
+ *
+ * The file descriptor is not closed by
+ * geneie_decompress_reader_close(). It is only read ahead
+ * if it is at the start of the file; otherwise, reading
+ * starts from its current offset.
+ *
+ * \param fd The file descriptor to read from.
+ * \param pool The pool to decompress BGZF input on,
+ * 	usually geneie_thread_pool_default(). It must outlive
+ * 	the reader.
+ *
+ * \returns A new reader, or a reader failing
+ * 	geneie_decompress_reader_valid() if reading failed or
+ * 	allocation failed.
+ */
+struct geneie_decompress_reader geneie_decompress_reader_from_fd(
+	int fd,
+	struct geneie_thread_pool pool
+);
+
+/**
+ * \public \memberof geneie_decompress_reader
+ * \brief Returns whether this is a valid reader.
+ *
+ * \param reader The reader to test.
+ *
+ * \returns True if the reader is safe to use, false otherwise.
+ */
+bool geneie_decompress_reader_valid(struct geneie_decompress_reader reader);
+
+/**
+ * \public \memberof geneie_decompress_reader
+ * \brief Returns the format detected for the input.
+ *
+ * \param reader The reader.
+ *
+ * \returns The input format.
+ */
+enum geneie_decompress_format geneie_decompress_reader_format(
+	struct geneie_decompress_reader reader
+);
+
+/**
+ * \public \memberof geneie_decompress_reader
+ * \brief Returns the next chunk of decompressed data.
+ *
+ * The chunk is owned by the reader and stays valid until
+ * the next call to geneie_decompress_reader_next(),
+ * geneie_decompress_reader_read() or
+ * geneie_decompress_reader_close().
+ *
+ * \param reader The reader.
+ *
+ * \returns The next chunk, or a reference failing
+ * 	geneie_sequence_ref_valid() at the end of the input or
+ * 	on an error; use geneie_decompress_reader_failed() to
+ * 	tell them apart. The bytes are not necessarily valid
+ * 	codes.
+ */
+struct geneie_sequence_ref geneie_decompress_reader_next(
+	struct geneie_decompress_reader reader
+);
+
+/**
+ * \public \memberof geneie_decompress_reader
+ * \brief Copies decompressed data into a buffer.
+ *
+ * \param reader The reader.
+ * \param buffer The buffer to fill.
+ * \param length The size of the buffer.
+ *
+ * \returns The number of bytes copied, which is only less
+ * 	than `length` at the end of the input, or -1 on an error.
+ */
+ssize_t geneie_decompress_reader_read(
+	struct geneie_decompress_reader reader,
+	char *buffer,
+	ssize_t length
+);
+
+/**
+ * \public \memberof geneie_decompress_reader
+ * \brief Returns whether reading failed, because of an I/O
+ * 	error or corrupt compressed data.
+ *
+ * \param reader The reader.
+ *
+ * \returns True if an error occurred, false otherwise.
+ */
+bool geneie_decompress_reader_failed(struct geneie_decompress_reader reader);
+
+/**
+ * \public \memberof geneie_decompress_reader
+ * \brief Stops any worker threads and frees the reader.
+ *
+ * \param reader The reader to close.
+ */
+void geneie_decompress_reader_close(struct geneie_decompress_reader reader);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // GENEIE_DECOMPRESS_READER_H
@@ -86,6 +86,44 @@ bool geneie_encoding_one_codon(
 	struct geneie_sequence_ref amino_out
 );
 
+/**
+ * \brief Encodes a single codon using a lookup table.
+ *
+ * The result is the same as geneie_encoding_one_codon(),
+ * but takes constant time: the table is built from
+ * geneie_encoding_one_codon() the first time this or
+ * geneie_encoding_translate() is called. Lower case codes
+ * are treated like their upper case equivalents.
+ *
+ * \param codon A pointer to the three codes of the codon.
+ *
+ * \returns The amino acid code, GENEIE_CODE_STOP for a stop
+ * 	codon, or GENEIE_CODE_MASKED if
+ * 	geneie_encoding_one_codon() would fail.
+ */
+geneie_code geneie_encoding_translate_codon(const geneie_code *codon);
+
+/**
+ * \brief Encodes every whole codon of a strand, without
+ * 	stopping at stop codons or failures.
+ *
+ * Each codon is encoded as geneie_encoding_translate_codon()
+ * would. The output may be the start of the strand itself,
+ * to encode in-place.
+ *
+ * \param strand The strand to encode. Any codes after the
+ * 	last whole codon are ignored.
+ * \param amino_out Where to write the amino acid codes.
+ *
+ * \returns The number of codes written: the number of
+ * 	whole codons, or the length of amino_out if that is
+ * 	smaller.
+ */
+ssize_t geneie_encoding_translate(
+	struct geneie_sequence_ref strand,
+	struct geneie_sequence_ref amino_out
+);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
@@ -0,0 +1,173 @@
+/*
+ * Geneie - A Library and Tools for gene processing
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GENEIE_FASTA_H
+#define GENEIE_FASTA_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <sys/types.h>
+#include <stdbool.h>
+
+#include "sequence_ref.h"
+
+/**
+ * \file
+ */
+
+/**
+ * \brief A single FASTA record.
+ *
+ * Both the header and the sequence point into the buffer
+ * being read, so nothing is copied.
+ */
+struct geneie_fasta_record {
+	/**
+	 * \brief The header line, without the leading '>' or
+	 * 	the line ending. This is not null-terminated.
+	 */
+	char *header;
+
+	/**
+	 * \brief The length of the header.
+	 */
+	ssize_t header_length;
+
+	/**
+	 * \brief The sequence, with the line breaks and any other
+	 * 	whitespace removed.
+	 *
+	 * The codes are not checked for validity.
+	 */
+	struct geneie_sequence_ref sequence;
+};
+
+/**
+ * \brief Reads FASTA records from a buffer, such as a file
+ * 	mapped with geneie_mapped_file_open().
+ *
+ * The reader works in-place: each sequence's lines are
+ * compacted together inside the buffer with
+ * geneie_sequence_tools_clean_whitespace(), so the buffer
+ * must be writable.
+ *
+ * The buffer can also be one chunk of a larger file. In
+ * that case, initialize the reader with `final` set to
+ * false: only records which are known to be complete are
+ * returned, and geneie_fasta_reader_remaining() gives the
+ * unread part, to be moved to the front of the next chunk.
+ * If that's the whole buffer, a record didn't fit, and the
+ * buffer has to grow before reading more:
+ *
+ * \code
+ * for (;;) {
+ * 	if (kept == size) {
+ * 		size *= 2;
+ * 		buffer = realloc(buffer, (size_t)size);
+ * 	}
+ * 	ssize_t got = (ssize_t)fread(buffer + kept, 1, size - kept, file);
+ * 	bool final = got < size - kept || feof(file);
+ * 	struct geneie_fasta_reader reader
+ * 		= geneie_fasta_reader_init(buffer, kept + got, final);
+ * 	struct geneie_fasta_record record;
+ * 	while (geneie_fasta_reader_next(&reader, &record))
+ * 		process(record);
+ * 	if (final)
+ * 		break;
+ * 	struct geneie_sequence_ref rest = geneie_fasta_reader_remaining(reader);
+ * 	memmove(buffer, rest.codes, (size_t)rest.length);
+ * 	kept = rest.length;
+ * }
+ * \endcode
+ */
+struct geneie_fasta_reader {
+	/**
+	 * \brief The next unread byte.
+	 */
+	char *position;
+
+	/**
+	 * \brief One past the end of the buffer.
+	 */
+	char *end;
+
+	/**
+	 * \brief Whether the buffer ends at the end of the input.
+	 */
+	bool final;
+};
+
+/**
+ * \public \memberof geneie_fasta_reader
+ * \brief Creates a reader over a buffer.
+ *
+ * \param buffer The buffer to read from.
+ * \param length The length of the buffer.
+ * \param final True if the buffer holds the rest of the
+ * 	input, false if more may follow.
+ *
+ * \returns The new reader.
+ */
+struct geneie_fasta_reader geneie_fasta_reader_init(
+	char *buffer,
+	ssize_t length,
+	bool final
+);
+
+/**
+ * \public \memberof geneie_fasta_reader
+ * \brief Reads the next record.
+ *
+ * Anything before the first header is skipped.
+ *
+ * \param reader The reader to read from.
+ * \param record Set to the record read, on success.
+ *
+ * \returns True if a record was read, false if there are
+ * 	no more complete records in the buffer.
+ */
+bool geneie_fasta_reader_next(
+	struct geneie_fasta_reader *reader,
+	struct geneie_fasta_record *record
+);
+
+/**
+ * \public \memberof geneie_fasta_reader
+ * \brief Returns the part of the buffer that hasn't been
+ * 	read yet.
+ *
+ * This is untouched by the reader. After
+ * geneie_fasta_reader_next() returns false on a non-final
+ * buffer, it holds the start of an incomplete record.
+ *
+ * \param reader The reader.
+ *
+ * \returns A reference to the unread bytes. These are not
+ * 	necessarily valid codes.
+ */
+struct geneie_sequence_ref geneie_fasta_reader_remaining(
+	struct geneie_fasta_reader reader
+);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // GENEIE_FASTA_H
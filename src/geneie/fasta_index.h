@@ -0,0 +1,266 @@
+/*
+ * Geneie - A Library and Tools for gene processing
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GENEIE_FASTA_INDEX_H
+#define GENEIE_FASTA_INDEX_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <sys/types.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "sequence.h"
+#include "sequence_ref.h"
+#include "thread_pool.h"
+
+/**
+ * \file
+ */
+
+/**
+ * \brief The index entry for one FASTA record, matching
+ * 	a line of a samtools .fai file.
+ */
+struct geneie_fasta_index_entry {
+	/**
+	 * \brief The record name: the header, up to the first
+	 * 	whitespace character. Null-terminated.
+	 */
+	char *name;
+
+	/**
+	 * \brief The number of codes in the sequence.
+	 */
+	ssize_t length;
+
+	/**
+	 * \brief The byte offset of the first code in the file.
+	 */
+	off_t offset;
+
+	/**
+	 * \brief The number of codes on each full line.
+	 */
+	ssize_t line_bases;
+
+	/**
+	 * \brief The number of bytes in each full line,
+	 * 	including the line ending.
+	 */
+	ssize_t line_width;
+};
+
+/**
+ * \brief An index of the records in a FASTA file,
+ * 	compatible with samtools .fai files.
+ *
+ * The index allows any region of any record to be fetched
+ * from the FASTA file directly, by turning coordinates into
+ * byte offsets, without parsing the rest of the file. This
+ * requires that every line of a record, except its last,
+ * has the same length.
+ *
+ * You must pass these to geneie_fasta_index_free() when
+ * finished with them.
+ */
+struct geneie_fasta_index {
+	/**
+	 * \brief The number of records.
+	 */
+	ssize_t count;
+
+	/**
+	 * \brief The number of entries allocated.
+	 */
+	ssize_t capacity;
+
+	/**
+	 * \brief The entries, in file order.
+	 */
+	struct geneie_fasta_index_entry *entries;
+
+	/**
+	 * \brief The entries, sorted by name, for
+	 * 	geneie_fasta_index_find(). For internal use.
+	 */
+	struct geneie_fasta_index_entry **by_name;
+};
+
+/**
+ * \public \memberof geneie_fasta_index
+ * \brief Builds an index by scanning the contents of a
+ * 	FASTA file.
+ *
+ * \param data The contents of the file, e.g. from
+ * 	geneie_mapped_file_open(). This is not modified.
+ * \param length The length of the contents.
+ *
+ * \returns A new index, or an index failing
+ * 	geneie_fasta_index_valid() if a record has uneven line
+ * 	lengths, two records have the same name, or allocation
+ * 	failed.
+ */
+struct geneie_fasta_index geneie_fasta_index_build(
+	const char *data,
+	ssize_t length
+);
+
+/**
+ * \public \memberof geneie_fasta_index
+ * \brief Builds an index like geneie_fasta_index_build(),
+ * 	using a thread pool.
+ *
+ * The file is split into equal byte ranges, one per
+ * thread, which are searched for headers at the same time. The records are
+ * then measured in parallel, with long records split into
+ * runs of lines so that a single large chromosome is
+ * shared between threads too. The result is the same as
+ * geneie_fasta_index_build().
+ *
+ * \param data The contents of the file, e.g. from
+ * 	geneie_mapped_file_open(). This is not modified.
+ * \param length The length of the contents.
+ * \param pool The pool to run on, usually
+ * 	geneie_thread_pool_default().
+ *
+ * \returns A new index, or an index failing
+ * 	geneie_fasta_index_valid() if a record has uneven line
+ * 	lengths, two records have the same name, or allocation
+ * 	failed.
+ */
+struct geneie_fasta_index geneie_fasta_index_build_parallel(
+	const char *data,
+	ssize_t length,
+	struct geneie_thread_pool pool
+);
+
+/**
+ * \public \memberof geneie_fasta_index
+ * \brief Reads an index from a .fai file.
+ *
+ * \param file The file to read.
+ *
+ * \returns A new index, or an index failing
+ * 	geneie_fasta_index_valid() if the file was malformed,
+ * 	named a sequence twice, or allocation failed.
+ */
+struct geneie_fasta_index geneie_fasta_index_read(FILE *file);
+
+/**
+ * \public \memberof geneie_fasta_index
+ * \brief Writes an index in the .fai format.
+ *
+ * \param index The index to write.
+ * \param file The file to write to.
+ *
+ * \returns True on success, false on a write error.
+ */
+bool geneie_fasta_index_write(struct geneie_fasta_index index, FILE *file);
+
+/**
+ * \public \memberof geneie_fasta_index
+ * \brief Returns whether this is a valid index.
+ *
+ * \param index The index to test.
+ *
+ * \returns True if the index is safe to use, false otherwise.
+ */
+bool geneie_fasta_index_valid(struct geneie_fasta_index index);
+
+/**
+ * \public \memberof geneie_fasta_index
+ * \brief Frees an index.
+ *
+ * \param index The index to free.
+ */
+void geneie_fasta_index_free(struct geneie_fasta_index index);
+
+/**
+ * \public \memberof geneie_fasta_index
+ * \brief Looks up a record by name.
+ *
+ * \param index The index to search.
+ * \param name The name of the record.
+ *
+ * \returns The entry for the record, or NULL if there is
+ * 	no record with that name.
+ */
+const struct geneie_fasta_index_entry *geneie_fasta_index_find(
+	struct geneie_fasta_index index,
+	const char *name
+);
+
+/**
+ * \public \memberof geneie_fasta_index_entry
+ * \brief Copies a region of a record into a buffer, leaving
+ * 	out the line endings.
+ *
+ * Only the lines covering the region are touched, so this
+ * takes the same time regardless of the size of the file.
+ *
+ * \param entry The record to fetch from.
+ * \param data The contents of the FASTA file.
+ * \param length The length of the contents.
+ * \param start The index of the first code to fetch.
+ * \param end One past the index of the last code to fetch.
+ * \param destination Where to write the codes.
+ *
+ * \returns A reference to the written part of the destination,
+ * 	or a reference failing geneie_sequence_ref_valid() if
+ * 	the region is out of bounds or the destination too short.
+ */
+struct geneie_sequence_ref geneie_fasta_index_fetch_into(
+	const struct geneie_fasta_index_entry *entry,
+	const char *data,
+	ssize_t length,
+	ssize_t start,
+	ssize_t end,
+	struct geneie_sequence_ref destination
+);
+
+/**
+ * \public \memberof geneie_fasta_index_entry
+ * \brief Copies a region of a record into a new sequence,
+ * 	leaving out the line endings.
+ *
+ * \param entry The record to fetch from.
+ * \param data The contents of the FASTA file.
+ * \param length The length of the contents.
+ * \param start The index of the first code to fetch.
+ * \param end One past the index of the last code to fetch.
+ *
+ * \returns A new sequence, or a sequence failing
+ * 	geneie_sequence_valid() if the region is out of bounds
+ * 	or allocation failed.
+ */
+struct geneie_sequence geneie_fasta_index_fetch(
+	const struct geneie_fasta_index_entry *entry,
+	const char *data,
+	ssize_t length,
+	ssize_t start,
+	ssize_t end
+);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // GENEIE_FASTA_INDEX_H
@@ -0,0 +1,212 @@
+/*
+ * Geneie - A Library and Tools for gene processing
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GENEIE_FASTQ_H
+#define GENEIE_FASTQ_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <sys/types.h>
+#include <stdbool.h>
+
+#include "sequence_ref.h"
+
+/**
+ * \file
+ */
+
+/**
+ * \brief A single FASTQ record.
+ *
+ * Every member points into the buffer being read, so
+ * nothing is copied.
+ */
+struct geneie_fastq_record {
+	/**
+	 * \brief The name line, without the leading '@' or
+	 * 	the line ending. This is not null-terminated.
+	 */
+	char *name;
+
+	/**
+	 * \brief The length of the name.
+	 */
+	ssize_t name_length;
+
+	/**
+	 * \brief The sequence.
+	 *
+	 * The codes are not checked for validity.
+	 */
+	struct geneie_sequence_ref sequence;
+
+	/**
+	 * \brief The quality string, one character per code
+	 * 	of the sequence.
+	 *
+	 * These are Phred scores in ASCII, not codes.
+	 */
+	struct geneie_sequence_ref quality;
+};
+
+/**
+ * \brief A reusable array of FASTQ records.
+ *
+ * Allocate a batch once and pass it to
+ * geneie_fastq_reader_read_batch() repeatedly: reading
+ * only overwrites the records, so parsing never allocates.
+ *
+ * You must pass these to geneie_fastq_batch_free() when
+ * finished with them.
+ */
+struct geneie_fastq_batch {
+	/**
+	 * \brief The number of records read into the batch.
+	 */
+	ssize_t count;
+
+	/**
+	 * \brief The maximum number of records in the batch.
+	 */
+	ssize_t capacity;
+
+	/**
+	 * \brief The records.
+	 */
+	struct geneie_fastq_record *records;
+};
+
+/**
+ * \brief Reads FASTQ records from a buffer, such as a file
+ * 	mapped with geneie_mapped_file_open().
+ *
+ * Records must use the common four-line layout: a name
+ * line, one sequence line, a '+' line and one quality line.
+ * The buffer is not modified.
+ *
+ * As with geneie_fasta_reader, the buffer can be one chunk
+ * of a larger file: initialize the reader with `final` set
+ * to false, and move geneie_fastq_reader_remaining() to the
+ * front of the next chunk when a batch comes back short.
+ */
+struct geneie_fastq_reader {
+	/**
+	 * \brief The next unread byte.
+	 */
+	char *position;
+
+	/**
+	 * \brief One past the end of the buffer.
+	 */
+	char *end;
+
+	/**
+	 * \brief Whether the buffer ends at the end of the input.
+	 */
+	bool final;
+};
+
+/**
+ * \public \memberof geneie_fastq_batch
+ * \brief Creates an empty batch.
+ *
+ * \param capacity The maximum number of records per batch.
+ *
+ * \returns A new batch, or a batch failing
+ * 	geneie_fastq_batch_valid() if the capacity is not
+ * 	positive or allocation failed.
+ */
+struct geneie_fastq_batch geneie_fastq_batch_alloc(ssize_t capacity);
+
+/**
+ * \public \memberof geneie_fastq_batch
+ * \brief Returns whether this is a valid batch.
+ *
+ * \param batch The batch to test.
+ *
+ * \returns True if the batch is safe to use, false otherwise.
+ */
+bool geneie_fastq_batch_valid(struct geneie_fastq_batch batch);
+
+/**
+ * \public \memberof geneie_fastq_batch
+ * \brief Frees a batch.
+ *
+ * \param batch The batch to free.
+ */
+void geneie_fastq_batch_free(struct geneie_fastq_batch batch);
+
+/**
+ * \public \memberof geneie_fastq_reader
+ * \brief Creates a reader over a buffer.
+ *
+ * \param buffer The buffer to read from.
+ * \param length The length of the buffer.
+ * \param final True if the buffer holds the rest of the
+ * 	input, false if more may follow.
+ *
+ * \returns The new reader.
+ */
+struct geneie_fastq_reader geneie_fastq_reader_init(
+	char *buffer,
+	ssize_t length,
+	bool final
+);
+
+/**
+ * \public \memberof geneie_fastq_reader
+ * \brief Fills a batch with the next records.
+ *
+ * Blank lines between records are skipped.
+ *
+ * \param reader The reader to read from.
+ * \param batch The batch to fill. Its previous records are
+ * 	overwritten.
+ *
+ * \returns The number of records read, which is less than
+ * 	the batch capacity when there are no more complete
+ * 	records in the buffer, or -1 if a malformed record was
+ * 	found. On error, the batch holds the records before the
+ * 	malformed one, and the reader is left pointing at it.
+ */
+ssize_t geneie_fastq_reader_read_batch(
+	struct geneie_fastq_reader *reader,
+	struct geneie_fastq_batch *batch
+);
+
+/**
+ * \public \memberof geneie_fastq_reader
+ * \brief Returns the part of the buffer that hasn't been
+ * 	read yet.
+ *
+ * \param reader The reader.
+ *
+ * \returns A reference to the unread bytes. These are not
+ * 	necessarily valid codes.
+ */
+struct geneie_sequence_ref geneie_fastq_reader_remaining(
+	struct geneie_fastq_reader reader
+);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // GENEIE_FASTQ_H
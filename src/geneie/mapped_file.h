@@ -0,0 +1,94 @@
+/*
+ * Geneie - A Library and Tools for gene processing
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GENEIE_MAPPED_FILE_H
+#define GENEIE_MAPPED_FILE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <sys/types.h>
+#include <stdbool.h>
+
+/**
+ * \file
+ */
+
+/**
+ * \brief A whole file, mapped into memory.
+ *
+ * Mapping a file avoids reading it into a separately
+ * allocated buffer: the parsers in geneie can work on
+ * the mapped bytes directly.
+ *
+ * You must pass these to geneie_mapped_file_close() when
+ * finished with them.
+ */
+struct geneie_mapped_file {
+	/**
+	 * \brief The length of the file, in bytes.
+	 */
+	ssize_t length;
+
+	/**
+	 * \brief The contents of the file.
+	 */
+	char *data;
+};
+
+/**
+ * \public \memberof geneie_mapped_file
+ * \brief Maps a file into memory.
+ *
+ * If `writable` is true, the mapping is private: it can be
+ * modified in-place, e.g. by geneie_fasta_reader_next(),
+ * without the changes reaching the file. Only the pages
+ * that are modified take up extra memory.
+ *
+ * \param path The path of the file to map.
+ * \param writable Whether the mapping should be writable.
+ *
+ * \returns The mapped file, or an object failing
+ * 	geneie_mapped_file_valid() on error, with errno set.
+ */
+struct geneie_mapped_file geneie_mapped_file_open(const char *path, bool writable);
+
+/**
+ * \public \memberof geneie_mapped_file
+ * \brief Returns whether this is a valid mapped file.
+ *
+ * \param file The mapped file to test.
+ *
+ * \returns True if the mapping is safe to use, false otherwise.
+ */
+bool geneie_mapped_file_valid(struct geneie_mapped_file file);
+
+/**
+ * \public \memberof geneie_mapped_file
+ * \brief Unmaps a file.
+ *
+ * \param file The mapped file to close.
+ */
+void geneie_mapped_file_close(struct geneie_mapped_file file);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // GENEIE_MAPPED_FILE_H
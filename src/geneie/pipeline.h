@@ -0,0 +1,318 @@
+/*
+ * Geneie - A Library and Tools for gene processing
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GENEIE_PIPELINE_H
+#define GENEIE_PIPELINE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <sys/types.h>
+#include <stdbool.h>
+
+#include "code.h"
+#include "sequence_ref.h"
+#include "thread_pool.h"
+
+/**
+ * \file
+ */
+
+/**
+ * \brief Internal state of a geneie_pipeline.
+ */
+struct geneie_pipeline_state;
+
+/**
+ * \brief A chain of stages which data streams through in
+ * 	fixed-size chunks.
+ *
+ * A source fills chunks, each stage works on one chunk at
+ * a time, and a sink consumes them. Neighbouring stages are
+ * connected by lock-free rings: single-producer,
+ * single-consumer where both sides have one thread, and
+ * multi-producer, multi-consumer otherwise. Stages run as
+ * tasks on a geneie_thread_pool, started as chunks reach
+ * them, so while one stage works on a chunk, the stage
+ * before it is already working on the next, and the
+ * pipeline shares the processors with any other work on
+ * the same pool.
+ *
+ * The pipeline owns a fixed number of chunks, which go back
+ * to the source once the sink has finished with them, so
+ * memory use stays at the number of chunks times their size
+ * however long the input is. When a stage falls behind, the
+ * chunks collect in front of it and the source waits for
+ * them, rather than running ahead.
+ *
+ * \code
+ * struct geneie_pipeline pipeline = geneie_pipeline_create(
+ * 	16,
+ * 	1 << 20,
+ * 	geneie_thread_pool_default()
+ * );
+ * geneie_pipeline_add_stage(pipeline, geneie_pipeline_stage_clean_whitespace, NULL, 1);
+ * geneie_pipeline_add_stage(pipeline, geneie_pipeline_stage_dna_to_premrna, NULL, 2);
+ * geneie_pipeline_add_stage(pipeline, my_stage, &my_state, 4);
+ * bool ok = geneie_pipeline_run(pipeline, read_input, input, write_output, output);
+ * geneie_pipeline_destroy(pipeline);
+ * \endcode
+ *
+ * You must pass these to geneie_pipeline_destroy() when
+ * finished with them.
+ */
+struct geneie_pipeline {
+	/**
+	 * \brief The pipeline's state.
+	 */
+	struct geneie_pipeline_state *state;
+};
+
+/**
+ * \brief One chunk of data travelling through a pipeline.
+ */
+struct geneie_pipeline_chunk {
+	/**
+	 * \brief The chunk's position in the order the source
+	 * 	produced them, starting from 0.
+	 *
+	 * Stages with more than one thread can finish chunks
+	 * out of order; this is how to put them back.
+	 */
+	ssize_t index;
+
+	/**
+	 * \brief The number of codes the chunk's buffer holds.
+	 */
+	ssize_t capacity;
+
+	/**
+	 * \brief The chunk's buffer.
+	 */
+	geneie_code *codes;
+
+	/**
+	 * \brief The chunk's current contents.
+	 *
+	 * Stages may change this to any reference within the
+	 * buffer, e.g. to a shorter one after removing codes.
+	 */
+	struct geneie_sequence_ref data;
+};
+
+/**
+ * \brief A function filling chunks at the start of a
+ * 	pipeline.
+ *
+ * This is only ever called from one thread at a time.
+ *
+ * \param buffer The buffer to fill.
+ * \param capacity The number of codes the buffer holds.
+ * \param param The parameter given to geneie_pipeline_run().
+ *
+ * \returns The number of codes written, 0 at the end of the
+ * 	input, or -1 to stop the pipeline with an error.
+ */
+typedef ssize_t geneie_pipeline_source(
+	geneie_code *buffer,
+	ssize_t capacity,
+	void *param
+);
+
+/**
+ * \brief A function run on each chunk by a stage or sink.
+ *
+ * A stage with more than one thread may call this from
+ * several threads at once, on different chunks. A stage
+ * with one thread is only called from one at a time,
+ * though not always the same one.
+ *
+ * \param chunk The chunk to work on.
+ * \param param The parameter given with the function.
+ *
+ * \returns True to pass the chunk on, false to stop the
+ * 	pipeline with an error.
+ */
+typedef bool geneie_pipeline_stage(
+	struct geneie_pipeline_chunk *chunk,
+	void *param
+);
+
+/**
+ * \public \memberof geneie_pipeline
+ * \brief Creates a pipeline with no stages.
+ *
+ * \param chunks The number of chunks the pipeline owns,
+ * 	which limits how many can be in flight at once.
+ * \param chunk_size The number of codes in each chunk.
+ * \param pool The pool to run the stages on, usually
+ * 	geneie_thread_pool_default(). It must outlive the
+ * 	pipeline.
+ *
+ * \returns A new pipeline, or a pipeline failing
+ * 	geneie_pipeline_valid() if either number is not positive
+ * 	or allocation failed.
+ */
+struct geneie_pipeline geneie_pipeline_create(
+	ssize_t chunks,
+	ssize_t chunk_size,
+	struct geneie_thread_pool pool
+);
+
+/**
+ * \public \memberof geneie_pipeline
+ * \brief Returns whether this is a valid pipeline.
+ *
+ * \param pipeline The pipeline to test.
+ *
+ * \returns True if the pipeline is safe to use, false
+ * 	otherwise.
+ */
+bool geneie_pipeline_valid(struct geneie_pipeline pipeline);
+
+/**
+ * \public \memberof geneie_pipeline
+ * \brief Frees a pipeline and its chunks.
+ *
+ * \param pipeline The pipeline to free.
+ */
+void geneie_pipeline_destroy(struct geneie_pipeline pipeline);
+
+/**
+ * \public \memberof geneie_pipeline
+ * \brief Adds a stage to the end of the pipeline.
+ *
+ * \param pipeline The pipeline.
+ * \param stage The function to run on each chunk.
+ * \param param A parameter to pass to the function.
+ * \param threads The most threads to run the stage on at
+ * 	once, which the size of the pool also limits. With more
+ * 	than one, chunks can leave the stage in a different
+ * 	order to the one they arrived in.
+ *
+ * \returns True on success, false if threads is not
+ * 	positive or allocation failed.
+ */
+bool geneie_pipeline_add_stage(
+	struct geneie_pipeline pipeline,
+	geneie_pipeline_stage *stage,
+	void *param,
+	int threads
+);
+
+/**
+ * \public \memberof geneie_pipeline
+ * \brief Streams all of a source's data through the
+ * 	pipeline's stages into a sink.
+ *
+ * The source runs on a thread of its own, started by this
+ * function, since it mostly waits for input; the stages run
+ * on the pipeline's pool, and the sink runs on the calling
+ * thread. The source and sink sleep while they have
+ * nothing to do. Chunks reach the sink in the order they
+ * finish, which is only the order of their index if every
+ * stage has one thread; see geneie_pipeline_run_ordered().
+ * Once any function fails, the others stop at their next
+ * chunk.
+ *
+ * A pipeline may be run any number of times, but not from
+ * more than one thread at once.
+ *
+ * \param pipeline The pipeline.
+ * \param source The function to fill chunks.
+ * \param source_param A parameter to pass to the source.
+ * \param sink The function to finish with chunks. The chunk
+ * 	is reused when it returns.
+ * \param sink_param A parameter to pass to the sink.
+ *
+ * \returns True if every chunk went through the pipeline,
+ * 	false if any function failed or the source's thread
+ * 	could not be started.
+ */
+bool geneie_pipeline_run(
+	struct geneie_pipeline pipeline,
+	geneie_pipeline_source *source,
+	void *source_param,
+	geneie_pipeline_stage *sink,
+	void *sink_param
+);
+
+/**
+ * \public \memberof geneie_pipeline
+ * \brief Like geneie_pipeline_run(), but gives chunks to the
+ * 	sink in the order of their index.
+ *
+ * Chunks finishing early wait, still holding their buffers,
+ * until the ones before them reach the sink. Since the
+ * source can only fill chunks the sink has finished with,
+ * this never needs more than the pipeline's chunks, but a
+ * single slow chunk can stall the source until it arrives.
+ *
+ * \param pipeline The pipeline.
+ * \param source The function to fill chunks.
+ * \param source_param A parameter to pass to the source.
+ * \param sink The function to finish with chunks, in order.
+ * 	The chunk is reused when it returns.
+ * \param sink_param A parameter to pass to the sink.
+ *
+ * \returns True if every chunk went through the pipeline,
+ * 	false if any function failed or the source's thread
+ * 	could not be started.
+ */
+bool geneie_pipeline_run_ordered(
+	struct geneie_pipeline pipeline,
+	geneie_pipeline_source *source,
+	void *source_param,
+	geneie_pipeline_stage *sink,
+	void *sink_param
+);
+
+/**
+ * \brief A stage performing
+ * 	geneie_sequence_tools_clean_whitespace() on each chunk.
+ *
+ * \param chunk The chunk to clean.
+ * \param param Unused.
+ *
+ * \returns True.
+ */
+bool geneie_pipeline_stage_clean_whitespace(
+	struct geneie_pipeline_chunk *chunk,
+	void *param
+);
+
+/**
+ * \brief A stage performing
+ * 	geneie_sequence_tools_dna_to_premrna() on each chunk.
+ *
+ * \param chunk The chunk to transcribe.
+ * \param param Unused.
+ *
+ * \returns True.
+ */
+bool geneie_pipeline_stage_dna_to_premrna(
+	struct geneie_pipeline_chunk *chunk,
+	void *param
+);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // GENEIE_PIPELINE_H
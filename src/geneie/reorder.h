@@ -0,0 +1,246 @@
+/*
+ * Geneie - A Library and Tools for gene processing
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GENEIE_REORDER_H
+#define GENEIE_REORDER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <sys/types.h>
+#include <stdbool.h>
+
+#include "code.h"
+#include "sequence_ref.h"
+
+/**
+ * \file
+ */
+
+/**
+ * \brief Internal state of a geneie_reorder.
+ */
+struct geneie_reorder_state;
+
+/**
+ * \brief Puts results from many workers back into order
+ * 	for a single writer.
+ *
+ * Each result has a sequence number, counting up from 0
+ * with no gaps. A worker takes the buffer for its sequence
+ * number with geneie_reorder_acquire(), fills it, and hands
+ * it back with geneie_reorder_submit(). Results are given
+ * to the writer in sequence order as soon as the ones
+ * before them have been written, and their buffers are
+ * then reused.
+ *
+ * Only a window of sequence numbers, starting from the
+ * oldest unwritten one, have buffers at a time. A worker
+ * acquiring a sequence number past the window waits until
+ * the results before it have been written, so however far
+ * one result falls behind the others, memory stays at the
+ * window's size.
+ *
+ * \code
+ * // In each worker
+ * struct geneie_reorder_buffer *buffer = geneie_reorder_acquire(reorder, record);
+ * if (!buffer || !geneie_reorder_buffer_reserve(buffer, needed))
+ * 	geneie_reorder_abort(reorder);
+ * buffer->length = translate(record, buffer->codes);
+ * geneie_reorder_submit(reorder, buffer);
+ * \endcode
+ *
+ * You must pass these to geneie_reorder_destroy() when
+ * finished with them.
+ */
+struct geneie_reorder {
+	/**
+	 * \brief The reorder buffer's state.
+	 */
+	struct geneie_reorder_state *state;
+};
+
+/**
+ * \brief A buffer for one result.
+ */
+struct geneie_reorder_buffer {
+	/**
+	 * \brief The sequence number the buffer was acquired
+	 * 	for.
+	 */
+	ssize_t sequence;
+
+	/**
+	 * \brief The number of codes in the result.
+	 */
+	ssize_t length;
+
+	/**
+	 * \brief The number of codes the buffer holds.
+	 */
+	ssize_t capacity;
+
+	/**
+	 * \brief The buffer's codes.
+	 */
+	geneie_code *codes;
+};
+
+/**
+ * \brief A function writing results, in order.
+ *
+ * This is only ever called from one thread at a time,
+ * which is whichever worker submitted the result that
+ * allowed it to be written.
+ *
+ * \param result The result.
+ * \param sequence The result's sequence number.
+ * \param param The parameter given to
+ * 	geneie_reorder_create().
+ *
+ * \returns True on success, false to stop with an error.
+ */
+typedef bool geneie_reorder_writer(
+	struct geneie_sequence_ref result,
+	ssize_t sequence,
+	void *param
+);
+
+/**
+ * \public \memberof geneie_reorder
+ * \brief Creates a reorder buffer expecting sequence
+ * 	number 0 first.
+ *
+ * \param window The number of sequence numbers which can
+ * 	have buffers at once.
+ * \param buffer_size The starting capacity of each buffer.
+ * \param writer The function to write results.
+ * \param param A parameter to pass to the writer.
+ *
+ * \returns A new reorder buffer, or one failing
+ * 	geneie_reorder_valid() if the window is not positive,
+ * 	the buffer size is negative, or allocation failed.
+ */
+struct geneie_reorder geneie_reorder_create(
+	ssize_t window,
+	ssize_t buffer_size,
+	geneie_reorder_writer *writer,
+	void *param
+);
+
+/**
+ * \public \memberof geneie_reorder
+ * \brief Returns whether this is a valid reorder buffer.
+ *
+ * \param reorder The reorder buffer to test.
+ *
+ * \returns True if the reorder buffer is safe to use, false
+ * 	otherwise.
+ */
+bool geneie_reorder_valid(struct geneie_reorder reorder);
+
+/**
+ * \public \memberof geneie_reorder
+ * \brief Frees a reorder buffer and all its buffers.
+ *
+ * \param reorder The reorder buffer to free.
+ */
+void geneie_reorder_destroy(struct geneie_reorder reorder);
+
+/**
+ * \public \memberof geneie_reorder
+ * \brief Takes the buffer for a sequence number, waiting
+ * 	until it is inside the window.
+ *
+ * Each sequence number must be acquired exactly once. The
+ * buffer keeps whatever capacity it grew to for earlier
+ * results, and has a length of 0.
+ *
+ * \param reorder The reorder buffer.
+ * \param sequence The sequence number of the result.
+ *
+ * \returns The buffer, or NULL if the sequence number was
+ * 	already written or the reorder buffer has failed.
+ */
+struct geneie_reorder_buffer *geneie_reorder_acquire(
+	struct geneie_reorder reorder,
+	ssize_t sequence
+);
+
+/**
+ * \public \memberof geneie_reorder
+ * \brief Makes sure a buffer can hold a number of codes,
+ * 	growing it if needed.
+ *
+ * \param buffer The buffer.
+ * \param capacity The number of codes needed.
+ *
+ * \returns True on success, false if allocation failed.
+ */
+bool geneie_reorder_buffer_reserve(
+	struct geneie_reorder_buffer *buffer,
+	ssize_t capacity
+);
+
+/**
+ * \public \memberof geneie_reorder
+ * \brief Hands back a filled buffer, writing it and any
+ * 	results waiting on it if it is next in sequence.
+ *
+ * \param reorder The reorder buffer.
+ * \param buffer The buffer from geneie_reorder_acquire(),
+ * 	with its length set to the result's.
+ *
+ * \returns True on success, false if the reorder buffer has
+ * 	failed.
+ */
+bool geneie_reorder_submit(
+	struct geneie_reorder reorder,
+	struct geneie_reorder_buffer *buffer
+);
+
+/**
+ * \public \memberof geneie_reorder
+ * \brief Stops the reorder buffer with an error, e.g. when a
+ * 	worker cannot produce its result.
+ *
+ * Workers waiting in geneie_reorder_acquire() return NULL,
+ * and nothing more is written.
+ *
+ * \param reorder The reorder buffer.
+ */
+void geneie_reorder_abort(struct geneie_reorder reorder);
+
+/**
+ * \public \memberof geneie_reorder
+ * \brief Returns how many results have been written.
+ *
+ * \param reorder The reorder buffer.
+ *
+ * \returns The number of results written, which is also the
+ * 	next sequence number to be written, or -1 if the
+ * 	writer failed or geneie_reorder_abort() was called.
+ */
+ssize_t geneie_reorder_written(struct geneie_reorder reorder);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // GENEIE_REORDER_H
@@ -0,0 +1,196 @@
+/*
+ * Geneie - A Library and Tools for gene processing
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GENEIE_RING_H
+#define GENEIE_RING_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <sys/types.h>
+#include <stdbool.h>
+
+/**
+ * \file
+ */
+
+/**
+ * \brief Internal state of a geneie_ring_spsc.
+ */
+struct geneie_ring_spsc_state;
+
+/**
+ * \brief Internal state of a geneie_ring_mpmc.
+ */
+struct geneie_ring_mpmc_state;
+
+/**
+ * \brief A bounded, lock-free queue of pointers for exactly
+ * 	one producing thread and one consuming thread.
+ *
+ * Pushing and popping never block or allocate: they fail
+ * when the ring is full or empty, and the caller decides
+ * whether to wait. This is what gives a chain of rings its
+ * back-pressure.
+ *
+ * You must pass these to geneie_ring_spsc_free() when
+ * finished with them.
+ */
+struct geneie_ring_spsc {
+	/**
+	 * \brief The ring's state.
+	 */
+	struct geneie_ring_spsc_state *state;
+};
+
+/**
+ * \brief A bounded, lock-free queue of pointers for any
+ * 	number of producing and consuming threads.
+ *
+ * This is Dmitry Vyukov's bounded MPMC queue: each slot
+ * carries a sequence number saying whether it is ready to
+ * be written or read, so producers and consumers only
+ * contend on their own position counter.
+ *
+ * You must pass these to geneie_ring_mpmc_free() when
+ * finished with them.
+ */
+struct geneie_ring_mpmc {
+	/**
+	 * \brief The ring's state.
+	 */
+	struct geneie_ring_mpmc_state *state;
+};
+
+/**
+ * \public \memberof geneie_ring_spsc
+ * \brief Creates an empty ring.
+ *
+ * \param capacity The minimum number of items the ring can
+ * 	hold. This is rounded up to a power of two.
+ *
+ * \returns A new ring, or a ring failing
+ * 	geneie_ring_spsc_valid() if the capacity is not positive
+ * 	or allocation failed.
+ */
+struct geneie_ring_spsc geneie_ring_spsc_alloc(ssize_t capacity);
+
+/**
+ * \public \memberof geneie_ring_spsc
+ * \brief Returns whether this is a valid ring.
+ *
+ * \param ring The ring to test.
+ *
+ * \returns True if the ring is safe to use, false otherwise.
+ */
+bool geneie_ring_spsc_valid(struct geneie_ring_spsc ring);
+
+/**
+ * \public \memberof geneie_ring_spsc
+ * \brief Frees a ring. Any items still in it are not
+ * 	touched.
+ *
+ * \param ring The ring to free.
+ */
+void geneie_ring_spsc_free(struct geneie_ring_spsc ring);
+
+/**
+ * \public \memberof geneie_ring_spsc
+ * \brief Adds an item to the back of the ring. Must only be
+ * 	called by the producing thread.
+ *
+ * \param ring The ring.
+ * \param item The item to add.
+ *
+ * \returns True on success, false if the ring is full.
+ */
+bool geneie_ring_spsc_push(struct geneie_ring_spsc ring, void *item);
+
+/**
+ * \public \memberof geneie_ring_spsc
+ * \brief Takes the item from the front of the ring. Must
+ * 	only be called by the consuming thread.
+ *
+ * \param ring The ring.
+ * \param item Set to the item taken, on success.
+ *
+ * \returns True on success, false if the ring is empty.
+ */
+bool geneie_ring_spsc_pop(struct geneie_ring_spsc ring, void **item);
+
+/**
+ * \public \memberof geneie_ring_mpmc
+ * \brief Creates an empty ring.
+ *
+ * \param capacity The minimum number of items the ring can
+ * 	hold. This is rounded up to a power of two, of at
+ * 	least 2.
+ *
+ * \returns A new ring, or a ring failing
+ * 	geneie_ring_mpmc_valid() if the capacity is not positive
+ * 	or allocation failed.
+ */
+struct geneie_ring_mpmc geneie_ring_mpmc_alloc(ssize_t capacity);
+
+/**
+ * \public \memberof geneie_ring_mpmc
+ * \brief Returns whether this is a valid ring.
+ *
+ * \param ring The ring to test.
+ *
+ * \returns True if the ring is safe to use, false otherwise.
+ */
+bool geneie_ring_mpmc_valid(struct geneie_ring_mpmc ring);
+
+/**
+ * \public \memberof geneie_ring_mpmc
+ * \brief Frees a ring. Any items still in it are not
+ * 	touched.
+ *
+ * \param ring The ring to free.
+ */
+void geneie_ring_mpmc_free(struct geneie_ring_mpmc ring);
+
+/**
+ * \public \memberof geneie_ring_mpmc
+ * \brief Adds an item to the back of the ring.
+ *
+ * \param ring The ring.
+ * \param item The item to add.
+ *
+ * \returns True on success, false if the ring is full.
+ */
+bool geneie_ring_mpmc_push(struct geneie_ring_mpmc ring, void *item);
+
+/**
+ * \public \memberof geneie_ring_mpmc
+ * \brief Takes the item from the front of the ring.
+ *
+ * \param ring The ring.
+ * \param item Set to the item taken, on success.
+ *
+ * \returns True on success, false if the ring is empty.
+ */
+bool geneie_ring_mpmc_pop(struct geneie_ring_mpmc ring, void **item);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // GENEIE_RING_H
@@ -0,0 +1,304 @@
+/*
+ * Geneie - A Library and Tools for gene processing
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GENEIE_ROPE_H
+#define GENEIE_ROPE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <sys/types.h>
+#include <stdbool.h>
+
+#include "sequence.h"
+#include "sequence_ref.h"
+
+/**
+ * \file
+ */
+
+/**
+ * \brief The number of codes stored in each block of
+ * 	a geneie_rope.
+ */
+#define GENEIE_ROPE_BLOCK_SIZE (1024 * 1024)
+
+/**
+ * \brief A fixed-size, reference-counted block of codes.
+ *
+ * Blocks are shared between ropes created from each other
+ * and are freed when the last rope referencing them is freed.
+ */
+struct geneie_rope_block;
+
+/**
+ * \brief A contiguous span of codes inside a block.
+ */
+struct geneie_rope_piece {
+	/**
+	 * \brief The block the span lives in.
+	 */
+	struct geneie_rope_block *block;
+
+	/**
+	 * \brief The span itself.
+	 */
+	struct geneie_sequence_ref ref;
+};
+
+/**
+ * \brief Represents a sequence of codes stored as a list
+ * 	of spans over fixed-size blocks.
+ *
+ * Unlike geneie_sequence, a rope never needs a single
+ * allocation large enough for the whole sequence, and
+ * concatenating, slicing, inserting and erasing only
+ * touch the list of pieces, rather than moving codes
+ * around. This makes editing multi-gigabyte sequences
+ * cheap.
+ *
+ * Ropes produced by geneie_rope_slice() and geneie_rope_concat()
+ * share blocks with the ropes they came from. Like a
+ * geneie_sequence_ref, modifying the codes of a shared
+ * span modifies them for every rope sharing it.
+ *
+ * The contiguous spans can be passed to the ref-based
+ * tools with a geneie_rope_iter.
+ *
+ * You must pass these to geneie_rope_free() when finished
+ * with them.
+ */
+struct geneie_rope {
+	/**
+	 * \brief The total number of codes in the rope.
+	 */
+	ssize_t length;
+
+	/**
+	 * \brief The number of pieces in the rope.
+	 */
+	ssize_t count;
+
+	/**
+	 * \brief The number of pieces allocated.
+	 */
+	ssize_t capacity;
+
+	/**
+	 * \brief The pieces, in order.
+	 */
+	struct geneie_rope_piece *pieces;
+};
+
+/**
+ * \brief Iterates over the contiguous spans of a rope.
+ *
+ * \sa geneie_rope_iter_next
+ */
+struct geneie_rope_iter {
+	/**
+	 * \brief The rope being iterated over.
+	 */
+	struct geneie_rope rope;
+
+	/**
+	 * \brief The index of the next piece to return.
+	 */
+	ssize_t next;
+};
+
+/**
+ * \public \memberof geneie_rope
+ * \brief Creates a new, empty rope.
+ *
+ * \returns A new rope, or a rope failing geneie_rope_valid()
+ * 	if allocation failed.
+ */
+struct geneie_rope geneie_rope_alloc(void);
+
+/**
+ * \public \memberof geneie_rope
+ * \brief Creates a new rope containing a copy of the given
+ * 	reference.
+ *
+ * \param ref The codes to copy.
+ *
+ * \returns A new rope, or a rope failing geneie_rope_valid()
+ * 	if the reference was invalid or allocation failed.
+ */
+struct geneie_rope geneie_rope_from_ref(struct geneie_sequence_ref ref);
+
+/**
+ * \public \memberof geneie_rope
+ * \brief Returns whether this is a valid rope.
+ *
+ * \param rope The rope to test.
+ *
+ * \returns True if the rope is safe to use, false otherwise.
+ */
+bool geneie_rope_valid(struct geneie_rope rope);
+
+/**
+ * \public \memberof geneie_rope
+ * \brief Frees a rope, along with any blocks no longer
+ * 	referenced by other ropes.
+ *
+ * \param rope The rope to free.
+ */
+void geneie_rope_free(struct geneie_rope rope);
+
+/**
+ * \public \memberof geneie_rope
+ * \brief Copies the given codes onto the end of the rope.
+ *
+ * Codes are written into the free space at the end of the
+ * last block if this rope is the only one using it, and
+ * into new blocks otherwise.
+ *
+ * \param rope The rope to append to.
+ * \param ref The codes to append.
+ *
+ * \returns True on success, false if allocation failed. On
+ * 	failure, the rope is left unchanged.
+ */
+bool geneie_rope_append(struct geneie_rope *rope, struct geneie_sequence_ref ref);
+
+/**
+ * \public \memberof geneie_rope
+ * \brief Appends the contents of another rope, without copying
+ * 	any codes.
+ *
+ * The blocks of `other` become shared with `rope`. `other`
+ * must still be freed separately, and must not be `rope`
+ * itself; use geneie_rope_slice() to make a second rope
+ * first.
+ *
+ * \param rope The rope to append to.
+ * \param other The rope to append.
+ *
+ * \returns True on success, false if allocation failed. On
+ * 	failure, the rope is left unchanged.
+ */
+bool geneie_rope_concat(struct geneie_rope *rope, struct geneie_rope other);
+
+/**
+ * \public \memberof geneie_rope
+ * \brief Creates a new rope referencing part of another,
+ * 	without copying any codes.
+ *
+ * \param rope The rope to slice.
+ * \param start The index of the first code in the slice.
+ * \param length The number of codes in the slice.
+ *
+ * \returns A new rope, or a rope failing geneie_rope_valid()
+ * 	if the range is out of bounds or allocation failed.
+ */
+struct geneie_rope geneie_rope_slice(
+	struct geneie_rope rope,
+	ssize_t start,
+	ssize_t length
+);
+
+/**
+ * \public \memberof geneie_rope
+ * \brief Removes a range of codes from the rope.
+ *
+ * This only edits the list of pieces: no codes are moved.
+ *
+ * \param rope The rope to edit.
+ * \param start The index of the first code to remove.
+ * \param length The number of codes to remove.
+ *
+ * \returns True on success, false if the range is out of
+ * 	bounds or allocation failed. On failure, the rope is
+ * 	left unchanged.
+ */
+bool geneie_rope_erase(struct geneie_rope *rope, ssize_t start, ssize_t length);
+
+/**
+ * \public \memberof geneie_rope
+ * \brief Inserts the contents of another rope at the given
+ * 	index, without copying any codes.
+ *
+ * As with geneie_rope_concat(), `other` must not be `rope`
+ * itself.
+ *
+ * \param rope The rope to edit.
+ * \param at The index to insert at.
+ * \param other The rope to insert.
+ *
+ * \returns True on success, false if the index is out of
+ * 	bounds or allocation failed. On failure, the rope is
+ * 	left unchanged.
+ */
+bool geneie_rope_insert(
+	struct geneie_rope *rope,
+	ssize_t at,
+	struct geneie_rope other
+);
+
+/**
+ * \public \memberof geneie_rope
+ * \brief Copies the rope into a single new geneie_sequence.
+ *
+ * \param rope The rope to copy.
+ *
+ * \returns A new sequence, or a sequence failing
+ * 	geneie_sequence_valid() if allocation failed.
+ */
+struct geneie_sequence geneie_rope_to_sequence(struct geneie_rope rope);
+
+/**
+ * \public \memberof geneie_rope_iter
+ * \brief Creates an iterator over the spans of a rope.
+ *
+ * The rope must not be edited while iterating.
+ *
+ * \param rope The rope to iterate over.
+ *
+ * \returns The new iterator.
+ */
+struct geneie_rope_iter geneie_rope_iter_init(struct geneie_rope rope);
+
+/**
+ * \public \memberof geneie_rope_iter
+ * \brief Returns the next contiguous span of the rope.
+ *
+ * Each span can be passed directly to the ref-based
+ * tools, e.g.:
+ *
+ * \code
+ * struct geneie_rope_iter iter = geneie_rope_iter_init(rope);
+ * struct geneie_sequence_ref span;
+ * while (geneie_sequence_ref_valid(span = geneie_rope_iter_next(&iter)))
+ * 	geneie_sequence_tools_dna_to_premrna(span);
+ * \endcode
+ *
+ * \param iter The iterator to advance.
+ *
+ * \returns The next span, or a reference failing
+ * 	geneie_sequence_ref_valid() when there are no more.
+ */
+struct geneie_sequence_ref geneie_rope_iter_next(struct geneie_rope_iter *iter);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // GENEIE_ROPE_H
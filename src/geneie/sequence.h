@@ -25,6 +25,7 @@ extern "C" {
 
 #include <sys/types.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 #include "code.h"
 
@@ -41,7 +42,9 @@ extern "C" {
  * will always allocate on the heap.
  *
  * You must pass these to geneie_sequence_free() when
- * finished with them.
+ * finished with them. Sequences made by hand must use
+ * designated initializers, so that the members they leave
+ * out are zeroed.
  *
  * \sa GENEIE_SEQUENCE_WITH
  */
@@ -62,6 +65,49 @@ struct geneie_sequence {
 	 * processing.
 	 */
 	geneie_code *codes;
+
+	/**
+	 * \brief The size of the anonymous mapping backing
+	 * 	`codes`, or zero if `codes` came from malloc().
+	 *
+	 * Only geneie_sequence_alloc_huge() sets this. It is
+	 * used by geneie_sequence_free() to decide how to
+	 * release the memory, and should not be modified.
+	 */
+	size_t mapping_length;
+};
+
+/**
+ * \brief Counters describing huge page allocations made by
+ * 	geneie_sequence_alloc_huge().
+ *
+ * The counters are totals since the process started; they
+ * are not decremented when sequences are freed.
+ *
+ * \sa geneie_sequence_huge_stats
+ */
+struct geneie_sequence_huge_stats {
+	/**
+	 * \brief The total number of bytes mapped by
+	 * 	geneie_sequence_alloc_huge().
+	 */
+	size_t mapped_bytes;
+
+	/**
+	 * \brief The total number of mapped bytes that the
+	 * 	kernel accepted a MADV_HUGEPAGE hint for.
+	 */
+	size_t advised_bytes;
+
+	/**
+	 * \brief The number of calls to geneie_sequence_alloc_huge()
+	 * 	whose mapping failed, so fell back to
+	 * 	geneie_sequence_alloc().
+	 *
+	 * Calls too small to be worth a huge page go to
+	 * geneie_sequence_alloc() too, but aren't counted.
+	 */
+	size_t fallbacks;
 };
 
 /**
@@ -93,6 +139,56 @@ bool geneie_sequence_valid(struct geneie_sequence sequence);
  */
 struct geneie_sequence geneie_sequence_alloc(ssize_t length);
 
+/**
+ * \public \memberof geneie_sequence
+ * \brief Allocates uninitialized memory for a large
+ * 	geneie_sequence, backed by transparent huge pages
+ * 	where possible.
+ *
+ * The memory is a 2 MiB-aligned anonymous mapping, advised
+ * with MADV_HUGEPAGE, which greatly reduces TLB misses when
+ * scanning chromosome-sized sequences.
+ *
+ * Sequences smaller than a single huge page, and systems
+ * where the mapping cannot be created, fall back to
+ * geneie_sequence_alloc(). Either way, the result is
+ * passed to geneie_sequence_free() as normal.
+ *
+ * Whether the kernel actually backs the memory with huge
+ * pages is up to the kernel; use geneie_sequence_huge_backed()
+ * to find out.
+ *
+ * \param length The amount of codes to allocate memory for.
+ *
+ * \returns A new sequence, or a sequence failing
+ * 	geneie_sequence_valid() if allocation failed.
+ */
+struct geneie_sequence geneie_sequence_alloc_huge(ssize_t length);
+
+/**
+ * \public \memberof geneie_sequence
+ * \brief Returns the number of bytes of the given sequence
+ * 	that are currently backed by huge pages.
+ *
+ * This reads /proc/self/smaps, so it is intended for
+ * diagnostics rather than hot paths.
+ *
+ * \param sequence The sequence to inspect.
+ *
+ * \returns The number of bytes backed by huge pages, 0 for
+ * 	sequences not allocated with geneie_sequence_alloc_huge(),
+ * 	or -1 if the information isn't available.
+ */
+ssize_t geneie_sequence_huge_backed(struct geneie_sequence sequence);
+
+/**
+ * \brief Returns a snapshot of the process-wide huge page
+ * 	allocation counters.
+ *
+ * \returns The current counters.
+ */
+struct geneie_sequence_huge_stats geneie_sequence_huge_stats(void);
+
 /**
  * \public \memberof geneie_sequence
  * \brief Constructs a new geneie_sequence from the given string.
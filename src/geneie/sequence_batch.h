@@ -0,0 +1,235 @@
+/*
+ * Geneie - A Library and Tools for gene processing
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GENEIE_SEQUENCE_BATCH_H
+#define GENEIE_SEQUENCE_BATCH_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <sys/types.h>
+#include <stdbool.h>
+
+#include "code.h"
+#include "sequence_ref.h"
+
+/**
+ * \file
+ */
+
+/**
+ * \brief Many sequences stored end to end in one buffer.
+ *
+ * Sequence i is the codes from offsets[i] up to
+ * offsets[i + 1]. Keeping short sequences, such as reads,
+ * together like this costs two allocations for the whole
+ * batch, rather than one for each sequence, and lets the
+ * batch functions work through all of them in one pass
+ * over memory.
+ *
+ * Sequences are only ever added at the end. A batch can be
+ * emptied with geneie_sequence_batch_clear() and refilled
+ * without allocating again.
+ *
+ * You must pass these to geneie_sequence_batch_free() when
+ * finished with them.
+ */
+struct geneie_sequence_batch {
+	/**
+	 * \brief The number of sequences.
+	 */
+	ssize_t count;
+
+	/**
+	 * \brief The number of sequences there is room for.
+	 */
+	ssize_t capacity;
+
+	/**
+	 * \brief Where each sequence starts in `codes`,
+	 * 	followed by the total length, so there are
+	 * 	count + 1 offsets.
+	 */
+	ssize_t *offsets;
+
+	/**
+	 * \brief The number of codes there is room for.
+	 */
+	ssize_t codes_capacity;
+
+	/**
+	 * \brief Every sequence's codes.
+	 */
+	geneie_code *codes;
+};
+
+/**
+ * \public \memberof geneie_sequence_batch
+ * \brief Allocates an empty batch.
+ *
+ * Both capacities are only a starting point: the batch
+ * grows as sequences are appended.
+ *
+ * \param sequences The number of sequences to make room
+ * 	for.
+ * \param codes The total number of codes to make room for.
+ *
+ * \returns A new batch, or a batch failing
+ * 	geneie_sequence_batch_valid() if either capacity is
+ * 	negative or allocation failed.
+ */
+struct geneie_sequence_batch geneie_sequence_batch_alloc(
+	ssize_t sequences,
+	ssize_t codes
+);
+
+/**
+ * \public \memberof geneie_sequence_batch
+ * \brief Returns whether this is a valid batch.
+ *
+ * \param batch The batch to test.
+ *
+ * \returns True if the batch is safe to use, false otherwise.
+ */
+bool geneie_sequence_batch_valid(struct geneie_sequence_batch batch);
+
+/**
+ * \public \memberof geneie_sequence_batch
+ * \brief Frees a batch.
+ *
+ * \param batch The batch to free.
+ */
+void geneie_sequence_batch_free(struct geneie_sequence_batch batch);
+
+/**
+ * \public \memberof geneie_sequence_batch
+ * \brief Removes every sequence, keeping the memory for
+ * 	reuse.
+ *
+ * \param batch The batch to empty.
+ */
+void geneie_sequence_batch_clear(struct geneie_sequence_batch *batch);
+
+/**
+ * \public \memberof geneie_sequence_batch
+ * \brief Copies a sequence onto the end of the batch.
+ *
+ * \param batch The batch.
+ * \param sequence The sequence to copy, which may be empty.
+ *
+ * \returns True on success, false if the sequence is
+ * 	invalid or allocation failed, in which case the batch
+ * 	is unchanged.
+ */
+bool geneie_sequence_batch_append(
+	struct geneie_sequence_batch *batch,
+	struct geneie_sequence_ref sequence
+);
+
+/**
+ * \public \memberof geneie_sequence_batch
+ * \brief Returns the total number of codes in the batch.
+ *
+ * \param batch The batch.
+ *
+ * \returns The total length of every sequence.
+ */
+ssize_t geneie_sequence_batch_length(struct geneie_sequence_batch batch);
+
+/**
+ * \public \memberof geneie_sequence_batch
+ * \brief Returns a reference to one sequence in the batch.
+ *
+ * The reference is invalidated by appending to the batch,
+ * which may move the codes.
+ *
+ * \param batch The batch.
+ * \param index The index of the sequence.
+ *
+ * \returns A reference to the sequence, or a reference
+ * 	failing geneie_sequence_ref_valid() if the index is out
+ * 	of bounds.
+ */
+struct geneie_sequence_ref geneie_sequence_batch_get(
+	struct geneie_sequence_batch batch,
+	ssize_t index
+);
+
+/**
+ * \public \memberof geneie_sequence_batch
+ * \brief Checks which sequences contain only valid nucleic
+ * 	acid codes, as geneie_code_nucleic_char_valid() defines
+ * 	them.
+ *
+ * \param batch The batch.
+ * \param results If not NULL, set to whether each sequence
+ * 	is valid. Must have room for batch.count values.
+ *
+ * \returns The number of valid sequences.
+ */
+ssize_t geneie_sequence_batch_validate(
+	struct geneie_sequence_batch batch,
+	bool *results
+);
+
+/**
+ * \public \memberof geneie_sequence_batch
+ * \brief Performs geneie_sequence_tools_dna_to_premrna() on
+ * 	every sequence.
+ *
+ * \param batch The batch to modify.
+ */
+void geneie_sequence_batch_dna_to_premrna(struct geneie_sequence_batch batch);
+
+/**
+ * \public \memberof geneie_sequence_batch
+ * \brief Performs geneie_sequence_tools_reverse_complement()
+ * 	on every sequence.
+ *
+ * \param batch The batch to modify.
+ */
+void geneie_sequence_batch_reverse_complement(struct geneie_sequence_batch batch);
+
+/**
+ * \public \memberof geneie_sequence_batch
+ * \brief Encodes every whole codon of every sequence into
+ * 	another batch.
+ *
+ * Each sequence is encoded with geneie_encoding_translate(),
+ * so encoding carries on past stop codons, which are
+ * written as GENEIE_CODE_STOP, and codons which can't be
+ * encoded are written as GENEIE_CODE_MASKED.
+ *
+ * \param batch The batch to encode.
+ * \param amino_out The batch to replace with the amino
+ * 	acid sequences, in the same order. Must not be
+ * 	`batch` itself.
+ *
+ * \returns True on success, false if allocation failed.
+ */
+bool geneie_sequence_batch_translate(
+	struct geneie_sequence_batch batch,
+	struct geneie_sequence_batch *amino_out
+);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // GENEIE_SEQUENCE_BATCH_H
@@ -0,0 +1,186 @@
+/*
+ * Geneie - A Library and Tools for gene processing
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GENEIE_SEQUENCE_BUILDER_H
+#define GENEIE_SEQUENCE_BUILDER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <sys/types.h>
+#include <stdbool.h>
+
+#include "sequence.h"
+#include "sequence_ref.h"
+
+/**
+ * \file
+ */
+
+/**
+ * \brief Builds a geneie_sequence from many smaller pieces.
+ *
+ * The builder's buffer grows geometrically, so appending
+ * costs amortized O(1) per code, regardless of how many
+ * pieces the sequence is built from. This is useful when
+ * the final length isn't known up front, such as when
+ * reading a multi-line FASTA record.
+ *
+ * When finished, geneie_sequence_builder_finish() hands
+ * the buffer back as a normal geneie_sequence. Otherwise,
+ * pass the builder to geneie_sequence_builder_free().
+ */
+struct geneie_sequence_builder {
+	/**
+	 * \brief The number of codes appended so far.
+	 */
+	ssize_t length;
+
+	/**
+	 * \brief The number of codes that fit in the buffer
+	 * 	before it has to grow.
+	 */
+	ssize_t capacity;
+
+	/**
+	 * \brief The buffer being built.
+	 */
+	geneie_code *codes;
+};
+
+/**
+ * \public \memberof geneie_sequence_builder
+ * \brief Creates a new, empty builder.
+ *
+ * \param capacity The number of codes to allocate space for
+ * 	initially. This is only a hint; the buffer grows as
+ * 	needed.
+ *
+ * \returns A new builder, or a builder failing
+ * 	geneie_sequence_builder_valid() if allocation failed.
+ */
+struct geneie_sequence_builder geneie_sequence_builder_alloc(ssize_t capacity);
+
+/**
+ * \public \memberof geneie_sequence_builder
+ * \brief Returns whether this is a valid builder.
+ *
+ * \param builder The builder to test.
+ *
+ * \returns True if the builder is safe to use, false otherwise.
+ */
+bool geneie_sequence_builder_valid(struct geneie_sequence_builder builder);
+
+/**
+ * \public \memberof geneie_sequence_builder
+ * \brief Makes sure at least `extra` more codes can be appended
+ * 	without growing the buffer.
+ *
+ * \param builder The builder to reserve space in.
+ * \param extra The number of codes to make room for.
+ *
+ * \returns True on success, false if allocation failed. On
+ * 	failure, the builder is left unchanged.
+ */
+bool geneie_sequence_builder_reserve(
+	struct geneie_sequence_builder *builder,
+	ssize_t extra
+);
+
+/**
+ * \public \memberof geneie_sequence_builder
+ * \brief Copies the given codes onto the end of the builder.
+ *
+ * \param builder The builder to append to.
+ * \param reference The codes to append.
+ *
+ * \returns True on success, false if the reference was
+ * 	invalid or allocation failed. On failure, the builder
+ * 	is left unchanged.
+ */
+bool geneie_sequence_builder_append(
+	struct geneie_sequence_builder *builder,
+	struct geneie_sequence_ref reference
+);
+
+/**
+ * \public \memberof geneie_sequence_builder
+ * \brief Copies the given codes onto the end of the builder,
+ * 	leaving out any whitespace.
+ *
+ * This is equivalent to appending, then running
+ * geneie_sequence_tools_clean_whitespace() on the appended
+ * codes.
+ *
+ * \param builder The builder to append to.
+ * \param reference The codes to append.
+ *
+ * \returns True on success, false if the reference was
+ * 	invalid or allocation failed. On failure, the builder
+ * 	is left unchanged.
+ */
+bool geneie_sequence_builder_append_clean(
+	struct geneie_sequence_builder *builder,
+	struct geneie_sequence_ref reference
+);
+
+/**
+ * \public \memberof geneie_sequence_builder
+ * \brief Returns a reference to the codes appended so far.
+ *
+ * The reference is invalidated by the next append.
+ *
+ * \param builder The builder to reference.
+ *
+ * \returns A reference to the builder's contents.
+ */
+struct geneie_sequence_ref geneie_sequence_builder_ref(
+	struct geneie_sequence_builder builder
+);
+
+/**
+ * \public \memberof geneie_sequence_builder
+ * \brief Shrinks the builder's buffer to fit and returns
+ * 	it as a geneie_sequence.
+ *
+ * The builder must not be used or freed afterwards. The
+ * resulting sequence must be passed to geneie_sequence_free().
+ *
+ * \param builder The builder to finish.
+ *
+ * \returns The built sequence, or a sequence failing
+ * 	geneie_sequence_valid() if the builder was invalid.
+ */
+struct geneie_sequence geneie_sequence_builder_finish(
+	struct geneie_sequence_builder builder
+);
+
+/**
+ * \public \memberof geneie_sequence_builder
+ * \brief Frees a builder without producing a sequence.
+ *
+ * \param builder The builder to free.
+ */
+void geneie_sequence_builder_free(struct geneie_sequence_builder builder);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // GENEIE_SEQUENCE_BUILDER_H
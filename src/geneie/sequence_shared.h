@@ -0,0 +1,222 @@
+/*
+ * Geneie - A Library and Tools for gene processing
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GENEIE_SEQUENCE_SHARED_H
+#define GENEIE_SEQUENCE_SHARED_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+
+#include "sequence.h"
+#include "sequence_ref.h"
+
+/**
+ * \file
+ */
+
+/**
+ * \brief The reference-counted owner of a shared sequence.
+ */
+struct geneie_sequence_shared_owner;
+
+/**
+ * \brief A reference-counted handle to a geneie_sequence,
+ * 	with copy-on-write.
+ *
+ * Sharing a handle with geneie_sequence_shared_share() only
+ * increments an atomic count, so any number of readers can
+ * use the same sequence for free, including from different
+ * threads.
+ *
+ * Before running a destructive, in-place tool, get a
+ * writable reference with geneie_sequence_shared_write().
+ * This copies the sequence only if another handle still
+ * shares it. Tools which shrink the sequence, such as
+ * splicing or removing whitespace, return the new length,
+ * which must be stored with geneie_sequence_shared_commit().
+ *
+ * Every handle must be passed to geneie_sequence_shared_release()
+ * when finished with it.
+ */
+struct geneie_sequence_shared {
+	/**
+	 * \brief The owner of the underlying sequence.
+	 */
+	struct geneie_sequence_shared_owner *owner;
+};
+
+/**
+ * \public \memberof geneie_sequence_shared
+ * \brief Creates a shared handle which takes ownership of
+ * 	the given sequence.
+ *
+ * On success, the sequence must no longer be passed to
+ * geneie_sequence_free(): it is freed when the last handle
+ * is released. On failure, the caller still owns it.
+ *
+ * \param sequence The sequence to take ownership of.
+ *
+ * \returns A new handle, or a handle failing
+ * 	geneie_sequence_shared_valid() on error.
+ */
+struct geneie_sequence_shared geneie_sequence_shared_from_sequence(
+	struct geneie_sequence sequence
+);
+
+/**
+ * \public \memberof geneie_sequence_shared
+ * \brief Creates a shared handle holding a copy of the
+ * 	given reference.
+ *
+ * \param reference The codes to copy.
+ *
+ * \returns A new handle, or a handle failing
+ * 	geneie_sequence_shared_valid() on error.
+ */
+struct geneie_sequence_shared geneie_sequence_shared_from_ref(
+	struct geneie_sequence_ref reference
+);
+
+/**
+ * \public \memberof geneie_sequence_shared
+ * \brief Returns whether this is a valid handle.
+ *
+ * \param shared The handle to test.
+ *
+ * \returns True if the handle is safe to use, false otherwise.
+ */
+bool geneie_sequence_shared_valid(struct geneie_sequence_shared shared);
+
+/**
+ * \public \memberof geneie_sequence_shared
+ * \brief Creates another handle to the same sequence.
+ *
+ * No codes are copied.
+ *
+ * \param shared The handle to share.
+ *
+ * \returns A new handle, which must be released separately,
+ * 	or a handle failing geneie_sequence_shared_valid() if
+ * 	the given one was invalid.
+ */
+struct geneie_sequence_shared geneie_sequence_shared_share(
+	struct geneie_sequence_shared shared
+);
+
+/**
+ * \public \memberof geneie_sequence_shared
+ * \brief Returns whether this is the only handle to its
+ * 	sequence.
+ *
+ * \param shared The handle to test.
+ *
+ * \returns True if no other handle shares the sequence.
+ */
+bool geneie_sequence_shared_unique(struct geneie_sequence_shared shared);
+
+/**
+ * \public \memberof geneie_sequence_shared
+ * \brief Returns a read-only reference to the shared sequence.
+ *
+ * The codes must not be modified through this reference,
+ * since other handles may be reading them. Use
+ * geneie_sequence_shared_write() for that.
+ *
+ * \param shared The handle to reference.
+ *
+ * \returns A reference to the sequence.
+ */
+struct geneie_sequence_ref geneie_sequence_shared_read(
+	struct geneie_sequence_shared shared
+);
+
+/**
+ * \public \memberof geneie_sequence_shared
+ * \brief Returns a writable reference to the shared sequence,
+ * 	copying it first if any other handle shares it.
+ *
+ * If a copy is made, `*shared` is updated to a new handle
+ * owning the copy, and the old sequence is released. Other
+ * handles keep seeing the original codes.
+ *
+ * \code
+ * struct geneie_sequence_ref ref = geneie_sequence_shared_write(&shared);
+ * if (geneie_sequence_ref_valid(ref))
+ * 	geneie_sequence_tools_dna_to_premrna(ref);
+ * \endcode
+ *
+ * \param shared A pointer to the handle to write through.
+ *
+ * \returns A writable reference, or a reference failing
+ * 	geneie_sequence_ref_valid() if the copy could not be
+ * 	allocated. On failure, `*shared` is left unchanged.
+ */
+struct geneie_sequence_ref geneie_sequence_shared_write(
+	struct geneie_sequence_shared *shared
+);
+
+/**
+ * \public \memberof geneie_sequence_shared
+ * \brief Stores the result of a tool which shrank the
+ * 	sequence through geneie_sequence_shared_write().
+ *
+ * Without this, geneie_sequence_shared_read() would still
+ * return the old length, including whatever was left
+ * behind after the shortened codes.
+ *
+ * \code
+ * struct geneie_sequence_ref ref = geneie_sequence_shared_write(&shared);
+ * if (geneie_sequence_ref_valid(ref))
+ * 	geneie_sequence_shared_commit(
+ * 		shared,
+ * 		geneie_sequence_tools_clean_whitespace(ref)
+ * 	);
+ * \endcode
+ *
+ * \param shared The handle written through, which must
+ * 	still be the only one to its sequence.
+ * \param result The reference returned by the tool. It
+ * 	must start at the sequence's codes and be no longer
+ * 	than the sequence.
+ *
+ * \returns True if the new length was stored, false if
+ * 	the handle is invalid or shared, or the result isn't
+ * 	a shortened reference to its sequence.
+ */
+bool geneie_sequence_shared_commit(
+	struct geneie_sequence_shared shared,
+	struct geneie_sequence_ref result
+);
+
+/**
+ * \public \memberof geneie_sequence_shared
+ * \brief Releases a handle, freeing the sequence if it was
+ * 	the last one.
+ *
+ * \param shared The handle to release.
+ */
+void geneie_sequence_shared_release(struct geneie_sequence_shared shared);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // GENEIE_SEQUENCE_SHARED_H
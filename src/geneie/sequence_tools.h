@@ -25,6 +25,7 @@ extern "C" {
 
 #include "sequence.h"
 #include "sequence_ref.h"
+#include "thread_pool.h"
 
 /**
  * \file
@@ -85,6 +86,36 @@ geneie_sequence_tools_clean_whitespace(struct geneie_sequence_ref reference);
  */
 void geneie_sequence_tools_dna_to_premrna(struct geneie_sequence_ref reference);
 
+/**
+ * \brief Reverses a nucleic acid sequence in-place and
+ * 	replaces each code with its complement.
+ *
+ * Ambiguous codes are complemented too, e.g. R (A or G)
+ * becomes Y (C or T), and case is kept. Both T and U are
+ * complemented to A, and A to T; use
+ * geneie_sequence_tools_dna_to_premrna() afterwards for
+ * RNA. Any other codes, such as N, gaps and whitespace,
+ * are only moved.
+ *
+ * \param reference The sequence to reverse complement.
+ */
+void geneie_sequence_tools_reverse_complement(
+	struct geneie_sequence_ref reference
+);
+
+/**
+ * \brief Performs geneie_sequence_tools_dna_to_premrna() on
+ * 	chunks of the sequence in parallel.
+ *
+ * \param reference The sequence reference to modify.
+ * \param pool The pool to run on, usually
+ * 	geneie_thread_pool_default().
+ */
+void geneie_sequence_tools_dna_to_premrna_parallel(
+	struct geneie_sequence_ref reference,
+	struct geneie_thread_pool pool
+);
+
 /**
  * \brief The function signature for a splicer.
  *
@@ -109,9 +140,10 @@ typedef struct geneie_sequence_ref
  * with the remainder of the original sequence, and
  * so on, until there is nothing left to splice.
  *
- * Then, the original sequence is modified in-place
- * to remove the parts of the sequence that are to
- * be spliced.
+ * Each part is removed from the original sequence,
+ * in-place, as soon as the splicer returns it. This
+ * happens in a single pass over the sequence and never
+ * allocates memory.
  *
  * A new sequence, containing the final length, is
  * returned. The original reference is invalid and should
@@ -133,6 +165,153 @@ struct geneie_sequence_ref geneie_sequence_tools_splice(
 	void *param
 );
 
+/**
+ * \brief The function signature for a batch splicer.
+ *
+ * A batch splicer is like a geneie_sequence_tools_splicer,
+ * except that it reports many parts to splice at once. It
+ * takes a pre-mRNA sequence and fills `regions` with up to
+ * `capacity` parts of it that should be spliced, returning
+ * how many it wrote, or zero if there is nothing left to
+ * splice.
+ *
+ * The regions must be in order, must not overlap, and must
+ * each have a non-zero length.
+ */
+typedef ssize_t geneie_sequence_tools_batch_splicer(
+	struct geneie_sequence_ref strand,
+	struct geneie_sequence_ref *regions,
+	ssize_t capacity,
+	void *param
+);
+
+/**
+ * \brief Splices a pre-mRNA sequence into a mature
+ * 	mRNA sequence, using a batch splicer.
+ *
+ * This behaves like geneie_sequence_tools_splice(), but
+ * asks the splicer for many regions per call. The regions
+ * are removed as they are received, without allocating,
+ * so the cost of calling the splicer is spread over the
+ * whole batch.
+ *
+ * The splicer is called first with the full sequence, then
+ * with the remainder of the original sequence after the last
+ * region it returned, and so on, until it returns zero.
+ *
+ * As with geneie_sequence_tools_splice(), the original
+ * reference is invalid after this call.
+ *
+ * \param strand The strand of pre-mRNA to splice.
+ * \param splicer_func A function which fills an array with
+ * 	the sections of the strand to splice.
+ * \param param An optional parameter, passed to splicer_func
+ * 	on each call.
+ *
+ * \returns A new reference, containing the correct
+ * 	length, after splicing.
+ */
+struct geneie_sequence_ref geneie_sequence_tools_splice_batch(
+	struct geneie_sequence_ref strand,
+	geneie_sequence_tools_batch_splicer *splicer_func,
+	void *param
+);
+
+/**
+ * \brief A half-open range of indexes, [start, end), into
+ * 	a sequence.
+ */
+struct geneie_sequence_tools_interval {
+	/**
+	 * \brief The index of the first code in the interval.
+	 */
+	ssize_t start;
+
+	/**
+	 * \brief One past the index of the last code in the
+	 * 	interval.
+	 */
+	ssize_t end;
+};
+
+/**
+ * \brief Whether a list of intervals describes the parts of
+ * 	a sequence to keep, or the parts to remove.
+ */
+enum geneie_sequence_tools_interval_mode {
+	/**
+	 * \brief Keep only the codes inside the intervals, e.g.
+	 * 	exons.
+	 */
+	GENEIE_SEQUENCE_TOOLS_KEEP_INTERVALS,
+
+	/**
+	 * \brief Remove the codes inside the intervals, e.g.
+	 * 	introns.
+	 */
+	GENEIE_SEQUENCE_TOOLS_REMOVE_INTERVALS,
+};
+
+/**
+ * \brief Splices a sequence in-place, using a sorted list of
+ * 	intervals rather than a splicer.
+ *
+ * This is useful when the coordinates to splice are already
+ * known, such as exon coordinates from an annotation file.
+ *
+ * The intervals must be sorted, must not overlap and must lie
+ * within the strand. They are checked before anything is
+ * modified, so on error the strand is left untouched.
+ *
+ * As with geneie_sequence_tools_splice(), the original
+ * reference is invalid after a successful call.
+ *
+ * \param strand The strand to splice.
+ * \param intervals The intervals, relative to the start of
+ * 	the strand.
+ * \param count The number of intervals.
+ * \param mode Whether to keep or remove the intervals.
+ *
+ * \returns A new reference, containing the correct length
+ * 	after splicing, or a reference failing
+ * 	geneie_sequence_ref_valid() if the intervals were invalid.
+ */
+struct geneie_sequence_ref geneie_sequence_tools_splice_intervals(
+	struct geneie_sequence_ref strand,
+	const struct geneie_sequence_tools_interval *intervals,
+	ssize_t count,
+	enum geneie_sequence_tools_interval_mode mode
+);
+
+/**
+ * \brief Splices a sequence into a separate destination buffer,
+ * 	using a sorted list of intervals.
+ *
+ * This is the non-destructive version of
+ * geneie_sequence_tools_splice_intervals(): the strand is
+ * left untouched, and the kept parts are gathered into the
+ * destination with one block copy each.
+ *
+ * \param strand The strand to splice.
+ * \param intervals The intervals, relative to the start of
+ * 	the strand.
+ * \param count The number of intervals.
+ * \param mode Whether to keep or remove the intervals.
+ * \param destination Where to write the spliced sequence. It
+ * 	must not overlap the strand.
+ *
+ * \returns A reference to the written part of the destination,
+ * 	or a reference failing geneie_sequence_ref_valid() if
+ * 	the intervals were invalid or the destination too short.
+ */
+struct geneie_sequence_ref geneie_sequence_tools_splice_intervals_into(
+	struct geneie_sequence_ref strand,
+	const struct geneie_sequence_tools_interval *intervals,
+	ssize_t count,
+	enum geneie_sequence_tools_interval_mode mode,
+	struct geneie_sequence_ref destination
+);
+
 /**
  * \brief Provides a pair of references.
  */
@@ -161,6 +340,34 @@ struct geneie_sequence_tools_ref_pair geneie_sequence_tools_encode(
 	struct geneie_sequence_ref strand
 );
 
+/**
+ * \brief Encodes mRNA sequences into amino acid sequences
+ * 	in-place, using several threads.
+ *
+ * The strand is split into chunks of whole codons which
+ * are encoded at the same time, then the results are moved
+ * together. The result is the same as
+ * geneie_sequence_tools_encode(), including stopping at the
+ * first stop codon or failure and leaving the remaining
+ * strand untouched.
+ *
+ * Unlike geneie_sequence_tools_encode(), whitespace is not
+ * skipped, since it would move the codon boundaries; use
+ * geneie_sequence_tools_clean_whitespace() first.
+ *
+ * \param strand The mRNA strand to encode, with no whitespace.
+ * \param pool The pool to run on, usually
+ * 	geneie_thread_pool_default().
+ *
+ * \returns A pair of new references, the first containing
+ * 	the encoded amino acid sequence and the second
+ * 	containing the remaining strand.
+ */
+struct geneie_sequence_tools_ref_pair geneie_sequence_tools_encode_parallel(
+	struct geneie_sequence_ref strand,
+	struct geneie_thread_pool pool
+);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
@@ -0,0 +1,199 @@
+/*
+ * Geneie - A Library and Tools for gene processing
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GENEIE_SEQUENCE_VIEW_H
+#define GENEIE_SEQUENCE_VIEW_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <sys/types.h>
+#include <stdbool.h>
+
+#include "sequence.h"
+#include "sequence_ref.h"
+#include "sequence_tools.h"
+
+/**
+ * \file
+ */
+
+/**
+ * \brief A non-destructive, spliced view over a sequence.
+ *
+ * A view is a list of segments, each a geneie_sequence_ref
+ * into the original, unmodified sequence. Read in order, the
+ * segments make up the spliced sequence, without any codes
+ * being moved or copied.
+ *
+ * This allows building several isoforms from one pre-mRNA:
+ * each isoform costs a handful of segments, rather than a
+ * full copy of the transcript. The view can then be encoded
+ * or copied out directly.
+ *
+ * The original sequence must outlive the view, and must not
+ * be modified while the view is in use.
+ *
+ * You must pass these to geneie_sequence_view_free() when
+ * finished with them.
+ */
+struct geneie_sequence_view {
+	/**
+	 * \brief The total number of codes in the view.
+	 */
+	ssize_t length;
+
+	/**
+	 * \brief The number of segments in the view.
+	 */
+	ssize_t count;
+
+	/**
+	 * \brief The number of segments allocated.
+	 */
+	ssize_t capacity;
+
+	/**
+	 * \brief The segments, in order.
+	 */
+	struct geneie_sequence_ref *segments;
+};
+
+/**
+ * \public \memberof geneie_sequence_view
+ * \brief Creates a spliced view of a strand, leaving the
+ * 	strand untouched.
+ *
+ * The splicer is called in the same way as by
+ * geneie_sequence_tools_splice(), but the parts it returns
+ * are skipped over rather than removed.
+ *
+ * \param strand The strand of pre-mRNA to splice.
+ * \param splicer_func A function which analyses the strand
+ * 	for a section to splice.
+ * \param param An optional parameter, passed to splicer_func
+ * 	on each call.
+ *
+ * \returns A new view, or a view failing
+ * 	geneie_sequence_view_valid() on error.
+ */
+struct geneie_sequence_view geneie_sequence_view_splice(
+	struct geneie_sequence_ref strand,
+	geneie_sequence_tools_splicer *splicer_func,
+	void *param
+);
+
+/**
+ * \public \memberof geneie_sequence_view
+ * \brief Creates a spliced view of a strand from a sorted
+ * 	list of intervals, leaving the strand untouched.
+ *
+ * The intervals follow the same rules as for
+ * geneie_sequence_tools_splice_intervals().
+ *
+ * \param strand The strand to splice.
+ * \param intervals The intervals, relative to the start of
+ * 	the strand.
+ * \param count The number of intervals.
+ * \param mode Whether to keep or remove the intervals.
+ *
+ * \returns A new view, or a view failing
+ * 	geneie_sequence_view_valid() if the intervals were
+ * 	invalid or allocation failed.
+ */
+struct geneie_sequence_view geneie_sequence_view_splice_intervals(
+	struct geneie_sequence_ref strand,
+	const struct geneie_sequence_tools_interval *intervals,
+	ssize_t count,
+	enum geneie_sequence_tools_interval_mode mode
+);
+
+/**
+ * \public \memberof geneie_sequence_view
+ * \brief Returns whether this is a valid view.
+ *
+ * \param view The view to test.
+ *
+ * \returns True if the view is safe to use, false otherwise.
+ */
+bool geneie_sequence_view_valid(struct geneie_sequence_view view);
+
+/**
+ * \public \memberof geneie_sequence_view
+ * \brief Frees a view. The sequence it refers to is not
+ * 	affected.
+ *
+ * \param view The view to free.
+ */
+void geneie_sequence_view_free(struct geneie_sequence_view view);
+
+/**
+ * \public \memberof geneie_sequence_view
+ * \brief Copies the codes of a view, in order, into the
+ * 	destination.
+ *
+ * \param view The view to copy.
+ * \param destination Where to write the codes.
+ *
+ * \returns A reference to the written part of the destination,
+ * 	or a reference failing geneie_sequence_ref_valid() if
+ * 	the destination is too short.
+ */
+struct geneie_sequence_ref geneie_sequence_view_copy_into(
+	struct geneie_sequence_view view,
+	struct geneie_sequence_ref destination
+);
+
+/**
+ * \public \memberof geneie_sequence_view
+ * \brief Copies the codes of a view into a new geneie_sequence.
+ *
+ * \param view The view to copy.
+ *
+ * \returns A new sequence, or a sequence failing
+ * 	geneie_sequence_valid() if allocation failed.
+ */
+struct geneie_sequence geneie_sequence_view_to_sequence(
+	struct geneie_sequence_view view
+);
+
+/**
+ * \public \memberof geneie_sequence_view
+ * \brief Encodes the mRNA codes of a view into amino acid codes.
+ *
+ * Codons may span segments. Encoding stops under the same
+ * conditions as geneie_sequence_tools_encode(), or when
+ * amino_out is full.
+ *
+ * \param view The view to encode.
+ * \param amino_out Where to write the amino acid codes.
+ *
+ * \returns A reference to the encoded amino acids in
+ * 	amino_out.
+ */
+struct geneie_sequence_ref geneie_sequence_view_encode(
+	struct geneie_sequence_view view,
+	struct geneie_sequence_ref amino_out
+);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // GENEIE_SEQUENCE_VIEW_H
@@ -0,0 +1,149 @@
+/*
+ * Geneie - A Library and Tools for gene processing
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GENEIE_SPLICE_SITE_H
+#define GENEIE_SPLICE_SITE_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <sys/types.h>
+
+#include "sequence_ref.h"
+
+/**
+ * \file
+ */
+
+/**
+ * \brief The canonical intron, starting with GT (or GU)
+ * 	and ending with AG.
+ */
+#define GENEIE_SPLICE_SITE_GT_AG (1u << 0)
+
+/**
+ * \brief The non-canonical intron starting with GC and
+ * 	ending with AG.
+ */
+#define GENEIE_SPLICE_SITE_GC_AG (1u << 1)
+
+/**
+ * \brief The minor-spliceosome intron starting with AT
+ * 	(or AU) and ending with AC.
+ */
+#define GENEIE_SPLICE_SITE_AT_AC (1u << 2)
+
+/**
+ * \brief All of the supported intron motifs.
+ */
+#define GENEIE_SPLICE_SITE_ALL \
+	(GENEIE_SPLICE_SITE_GT_AG | GENEIE_SPLICE_SITE_GC_AG | GENEIE_SPLICE_SITE_AT_AC)
+
+/**
+ * \brief The parameter to pass to geneie_splice_site_splicer().
+ */
+struct geneie_splice_site_params {
+	/**
+	 * \brief Which intron motifs to look for, as a
+	 * 	combination of the GENEIE_SPLICE_SITE_ flags.
+	 */
+	unsigned motifs;
+
+	/**
+	 * \brief The minimum length of an intron, including
+	 * 	both dinucleotides.
+	 */
+	ssize_t min_length;
+
+	/**
+	 * \brief The maximum length of an intron, including
+	 * 	both dinucleotides, or zero for no maximum.
+	 */
+	ssize_t max_length;
+};
+
+/**
+ * \brief Finds the first donor (5') splice site in a strand.
+ *
+ * The search is case-insensitive, and T and U are treated
+ * the same. On x86, 16 positions are compared at a time.
+ *
+ * \param strand The strand to search.
+ * \param motifs The intron motifs to find donor sites for.
+ *
+ * \returns The index of the first code of the donor
+ * 	dinucleotide, or -1 if there is none.
+ */
+ssize_t geneie_splice_site_find_donor(
+	struct geneie_sequence_ref strand,
+	unsigned motifs
+);
+
+/**
+ * \brief Finds the first acceptor (3') splice site in a strand.
+ *
+ * The search is case-insensitive, and T and U are treated
+ * the same. On x86, 16 positions are compared at a time.
+ *
+ * \param strand The strand to search.
+ * \param motifs The intron motifs to find acceptor sites for.
+ *
+ * \returns The index of the first code of the acceptor
+ * 	dinucleotide, or -1 if there is none.
+ */
+ssize_t geneie_splice_site_find_acceptor(
+	struct geneie_sequence_ref strand,
+	unsigned motifs
+);
+
+/**
+ * \brief A geneie_sequence_tools_splicer which splices out
+ * 	candidate introns.
+ *
+ * A candidate intron starts at a donor site and ends at
+ * the first matching acceptor site that gives an intron
+ * of at least the minimum length. If there's no such
+ * acceptor within the maximum length, the donor is
+ * skipped.
+ *
+ * \code
+ * struct geneie_splice_site_params params = {
+ * 	.motifs = GENEIE_SPLICE_SITE_GT_AG,
+ * 	.min_length = 60,
+ * 	.max_length = 10000,
+ * };
+ * ref = geneie_sequence_tools_splice(ref, geneie_splice_site_splicer, &params);
+ * \endcode
+ *
+ * \param strand The strand to search.
+ * \param params A pointer to a struct geneie_splice_site_params.
+ *
+ * \returns The first candidate intron, or a reference of
+ * 	zero length if there are none.
+ */
+struct geneie_sequence_ref geneie_splice_site_splicer(
+	struct geneie_sequence_ref strand,
+	void *params
+);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // GENEIE_SPLICE_SITE_H
@@ -0,0 +1,144 @@
+/*
+ * Geneie - A Library and Tools for gene processing
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GENEIE_STATS_H
+#define GENEIE_STATS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+/**
+ * \file
+ *
+ * Counters kept by the library's hot paths, for finding out
+ * what a program is spending its time on.
+ *
+ * Counting is only compiled in when the library is built
+ * with the GENEIE_STATS CMake option; otherwise the counting
+ * code is left out entirely and every counter reads 0. Each
+ * thread keeps its own counters, so counting never contends
+ * between threads, and they are only added up when a
+ * snapshot is asked for.
+ */
+
+/**
+ * \brief Totals for every counter, taken by
+ * 	geneie_stats_snapshot().
+ */
+struct geneie_stats {
+	/**
+	 * \brief Codes passed through the encoding functions
+	 * 	and the in-place sequence tools.
+	 */
+	uint64_t bytes_processed;
+
+	/**
+	 * \brief Codons translated into an amino acid,
+	 * 	including stop codons.
+	 */
+	uint64_t codons_translated;
+
+	/**
+	 * \brief Codons which couldn't be translated, because
+	 * 	they were too ambiguous or weren't nucleic codes.
+	 */
+	uint64_t ambiguous_codons;
+
+	/**
+	 * \brief Stop codons translated.
+	 */
+	uint64_t stop_codons;
+
+	/**
+	 * \brief Regions removed or kept by the splicing
+	 * 	functions.
+	 */
+	uint64_t splice_regions;
+
+	/**
+	 * \brief Bytes moved by memmove() when splicing and
+	 * 	editing ropes.
+	 */
+	uint64_t memmove_bytes;
+
+	/**
+	 * \brief Calls to malloc() and realloc() made by the
+	 * 	sequence containers.
+	 */
+	uint64_t allocations;
+
+	/**
+	 * \brief Bytes asked for by those allocations.
+	 */
+	uint64_t allocation_bytes;
+};
+
+/**
+ * \brief Checks whether counting was compiled in.
+ *
+ * \returns True if the library was built with GENEIE_STATS,
+ * 	false otherwise.
+ */
+bool geneie_stats_enabled(void);
+
+/**
+ * \public \memberof geneie_stats
+ * \brief Adds up every thread's counters.
+ *
+ * Threads which have exited still count. Counters being
+ * updated while the snapshot is taken may or may not be
+ * included, but each counter is never torn.
+ *
+ * \returns The totals since the library was loaded, or
+ * 	since the last geneie_stats_reset().
+ */
+struct geneie_stats geneie_stats_snapshot(void);
+
+/**
+ * \brief Starts every counter again from 0.
+ *
+ * The counters themselves are left alone; later snapshots
+ * just leave out whatever had been counted by now.
+ */
+void geneie_stats_reset(void);
+
+/**
+ * \public \memberof geneie_stats
+ * \brief Writes a snapshot out, one counter per line.
+ *
+ * Each line is the counter's name, prefixed with "geneie_",
+ * a space and its value, which monitoring systems reading
+ * the Prometheus text format can scrape directly.
+ *
+ * \param stats The snapshot to write.
+ * \param file The file to write to.
+ *
+ * \returns True on success, false if writing failed.
+ */
+bool geneie_stats_write(struct geneie_stats stats, FILE *file);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // GENEIE_STATS_H
@@ -0,0 +1,416 @@
+/*
+ * Geneie - A Library and Tools for gene processing
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GENEIE_SYNTHETIC_H
+#define GENEIE_SYNTHETIC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <sys/types.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "sequence_ref.h"
+#include "sequence_tools.h"
+
+/**
+ * \file
+ */
+
+/**
+ * \brief A xoshiro256** pseudo-random number generator.
+ *
+ * This is not suitable for anything needing security, but
+ * is fast and gives the same numbers on every platform for
+ * the same seed.
+ */
+struct geneie_synthetic_rng {
+	/**
+	 * \brief The generator's state.
+	 */
+	uint64_t state[4];
+};
+
+/**
+ * \public \memberof geneie_synthetic_rng
+ * \brief Seeds a generator.
+ *
+ * Generators with the same seed but different streams
+ * give unrelated numbers, so a large output can be split
+ * into pieces, each generated from its own stream, and
+ * still be reproducible however the pieces are scheduled.
+ *
+ * \param seed The seed.
+ * \param stream The stream number.
+ *
+ * \returns A new generator.
+ */
+struct geneie_synthetic_rng geneie_synthetic_rng_init(
+	uint64_t seed,
+	uint64_t stream
+);
+
+/**
+ * \public \memberof geneie_synthetic_rng
+ * \brief Returns the next 64 random bits.
+ *
+ * \param rng The generator.
+ *
+ * \returns 64 random bits.
+ */
+uint64_t geneie_synthetic_rng_next(struct geneie_synthetic_rng *rng);
+
+/**
+ * \public \memberof geneie_synthetic_rng
+ * \brief Returns a random number from 0 up to, but not
+ * 	including, a bound.
+ *
+ * \param rng The generator.
+ * \param bound The bound, which must be positive.
+ *
+ * \returns A random number in [0, bound).
+ */
+uint64_t geneie_synthetic_rng_below(
+	struct geneie_synthetic_rng *rng,
+	uint64_t bound
+);
+
+/**
+ * \public \memberof geneie_synthetic_rng
+ * \brief Returns a random number in [0, 1).
+ *
+ * \param rng The generator.
+ *
+ * \returns A random number in [0, 1).
+ */
+double geneie_synthetic_rng_uniform(struct geneie_synthetic_rng *rng);
+
+/**
+ * \brief The properties of generated sequences.
+ *
+ * Rates are per base, and lengths are means: the actual
+ * distances between features and their lengths are
+ * geometrically distributed.
+ */
+struct geneie_synthetic_params {
+	/**
+	 * \brief The fraction of plain bases which are G or C,
+	 * 	from 0 to 1.
+	 */
+	double gc_content;
+
+	/**
+	 * \brief The fraction of bases replaced by an IUPAC
+	 * 	ambiguity code other than N.
+	 */
+	double ambiguity_rate;
+
+	/**
+	 * \brief The number of runs of N started per base.
+	 */
+	double n_run_rate;
+
+	/**
+	 * \brief The mean length of a run of N.
+	 */
+	ssize_t n_run_length;
+
+	/**
+	 * \brief The number of soft-masked (lower case) regions
+	 * 	started per base.
+	 */
+	double soft_mask_rate;
+
+	/**
+	 * \brief The mean length of a soft-masked region.
+	 */
+	ssize_t soft_mask_length;
+};
+
+/**
+ * \brief Parameters giving plain, upper case DNA with a
+ * 	GC content of 41%, about that of the human genome.
+ */
+#define GENEIE_SYNTHETIC_PARAMS_DEFAULT \
+	((struct geneie_synthetic_params) { \
+		.gc_content = 0.41, \
+		.n_run_length = 1000, \
+		.soft_mask_length = 300, \
+	})
+
+/**
+ * \brief Generates DNA sequences with controlled
+ * 	properties.
+ *
+ * The same parameters, seed and stream always give the
+ * same sequences, on every platform, so large test inputs
+ * can be made on demand instead of stored.
+ *
+ * Bases are generated several at a time from a lookup
+ * table, with ambiguity codes, runs of N and soft-masking
+ * added afterwards at geometrically-distributed distances,
+ * so sequence is generated at gigabytes per second per
+ * thread.
+ *
+ * Generators need no cleaning up, but a generator must
+ * only be used by one thread at a time: use a generator per
+ * stream to generate in parallel.
+ */
+struct geneie_synthetic {
+	/**
+	 * \brief The random number generator for bases, genes
+	 * 	and reads.
+	 */
+	struct geneie_synthetic_rng rng;
+
+	/**
+	 * \brief The random number generators for placing
+	 * 	ambiguity codes, runs of N and soft-masking.
+	 *
+	 * Each feature has its own, so that how many numbers one
+	 * feature has drawn never depends on where the others
+	 * fell within a call.
+	 */
+	struct geneie_synthetic_rng ambiguity_rng, n_run_rng, soft_mask_rng;
+
+	/**
+	 * \brief Random bits left over from the last call,
+	 * 	and how many bytes of them there are.
+	 */
+	uint64_t bits;
+	int bytes_left;
+
+	/**
+	 * \brief The parameters.
+	 */
+	struct geneie_synthetic_params params;
+
+	/**
+	 * \brief Maps a random byte to a base, in the
+	 * 	proportions given by the GC content.
+	 */
+	char bases[256];
+
+	/**
+	 * \brief The distances to the next ambiguity code, run
+	 * 	of N and soft-masked region.
+	 */
+	ssize_t next_ambiguity, next_n_run, next_soft_mask;
+
+	/**
+	 * \brief The remaining lengths of the current run of N
+	 * 	and soft-masked region, which can continue from one
+	 * 	call to the next.
+	 */
+	ssize_t n_run_left, soft_mask_left;
+};
+
+/**
+ * \public \memberof geneie_synthetic
+ * \brief Creates a generator.
+ *
+ * \param params The properties of the sequences to
+ * 	generate.
+ * \param seed The random seed.
+ * \param stream The stream number, as for
+ * 	geneie_synthetic_rng_init().
+ *
+ * \returns A new generator, or a generator failing
+ * 	geneie_synthetic_valid() if a rate is outside [0, 1]
+ * 	or a length isn't positive.
+ */
+struct geneie_synthetic geneie_synthetic_init(
+	struct geneie_synthetic_params params,
+	uint64_t seed,
+	uint64_t stream
+);
+
+/**
+ * \public \memberof geneie_synthetic
+ * \brief Checks whether a generator is valid.
+ *
+ * \param generator The generator to check.
+ *
+ * \returns True if the generator is valid, false
+ * 	otherwise.
+ */
+bool geneie_synthetic_valid(struct geneie_synthetic generator);
+
+/**
+ * \public \memberof geneie_synthetic
+ * \brief Fills a buffer with generated DNA.
+ *
+ * Successive calls continue the same sequence, which
+ * doesn't depend on how it's split between calls: runs of
+ * N and soft-masked regions carry on from one call into
+ * the next.
+ *
+ * \param generator The generator.
+ * \param out The buffer to fill.
+ */
+void geneie_synthetic_fill(
+	struct geneie_synthetic *generator,
+	struct geneie_sequence_ref out
+);
+
+/**
+ * \brief The shape of generated genes.
+ */
+struct geneie_synthetic_gene_params {
+	/**
+	 * \brief The number of exons, at least 1.
+	 */
+	ssize_t exons;
+
+	/**
+	 * \brief The mean length of an exon. Exon lengths
+	 * 	are uniformly distributed between half and one
+	 * 	and a half times this.
+	 */
+	ssize_t exon_length;
+
+	/**
+	 * \brief The mean length of an intron, distributed
+	 * 	like the exon lengths. Introns are never shorter
+	 * 	than 4, to fit their splice sites.
+	 */
+	ssize_t intron_length;
+};
+
+/**
+ * \public \memberof geneie_synthetic
+ * \brief Generates a gene: a coding sequence broken up by
+ * 	introns.
+ *
+ * The coding sequence starts with ATG, ends with a stop
+ * codon and has no other stop codons, so splicing out the
+ * introns and translating it gives a single protein. Each
+ * intron starts with GT and ends with AG, and is filled in
+ * with the generator's parameters, so it can contain
+ * ambiguity codes, runs of N and soft-masking. The coding
+ * sequence is always plain upper case DNA.
+ *
+ * \param generator The generator.
+ * \param params The shape of the gene.
+ * \param out Where to write the gene.
+ * \param introns Where to write the position of each
+ * 	intron, which must have room for params.exons - 1.
+ * 	These can be passed to
+ * 	geneie_sequence_tools_splice_intervals() to remove
+ * 	the introns. May be NULL.
+ *
+ * \returns The length of the gene, or -1 if the parameters
+ * 	are invalid or the gene doesn't fit in out. Genes
+ * 	that don't fit still use up random numbers.
+ */
+ssize_t geneie_synthetic_gene(
+	struct geneie_synthetic *generator,
+	struct geneie_synthetic_gene_params params,
+	struct geneie_sequence_ref out,
+	struct geneie_sequence_tools_interval *introns
+);
+
+/**
+ * \brief The distribution of generated reads.
+ */
+struct geneie_synthetic_read_params {
+	/**
+	 * \brief The mean read length.
+	 */
+	ssize_t length;
+
+	/**
+	 * \brief The standard deviation of the read length,
+	 * 	which is normally distributed, or 0 for reads all
+	 * 	of the same length.
+	 */
+	ssize_t length_deviation;
+
+	/**
+	 * \brief The shortest read to generate, at least 1.
+	 */
+	ssize_t min_length;
+
+	/**
+	 * \brief The longest read to generate, or 0 for no
+	 * 	maximum.
+	 */
+	ssize_t max_length;
+
+	/**
+	 * \brief The fraction of bases substituted with a
+	 * 	different base, as sequencing errors.
+	 */
+	double error_rate;
+
+	/**
+	 * \brief The fraction of reads taken from the reverse
+	 * 	strand.
+	 */
+	double reverse_rate;
+};
+
+/**
+ * \public \memberof geneie_synthetic
+ * \brief Generates a read from a random position of a
+ * 	source sequence.
+ *
+ * Reads are never longer than the source or the output.
+ *
+ * \param generator The generator. Only its random number
+ * 	generator is used.
+ * \param params The distribution of reads.
+ * \param source The sequence to read from.
+ * \param out Where to write the read.
+ *
+ * \returns The length of the read, or -1 if the parameters
+ * 	are invalid or the source or out are empty.
+ */
+ssize_t geneie_synthetic_read(
+	struct geneie_synthetic *generator,
+	struct geneie_synthetic_read_params params,
+	struct geneie_sequence_ref source,
+	struct geneie_sequence_ref out
+);
+
+/**
+ * \brief Copies a sequence, adding a line ending every
+ * 	`width` codes, as in a FASTA file.
+ *
+ * \param sequence The sequence to copy.
+ * \param width The line width, or 0 to write the whole
+ * 	sequence as one line.
+ * \param out Where to write the lines. This needs room for
+ * 	the sequence plus a line ending per line.
+ *
+ * \returns The number of characters written, or -1 if out
+ * 	is too small.
+ */
+ssize_t geneie_synthetic_write_lines(
+	struct geneie_sequence_ref sequence,
+	ssize_t width,
+	struct geneie_sequence_ref out
+);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // GENEIE_SYNTHETIC_H
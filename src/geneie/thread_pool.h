@@ -0,0 +1,292 @@
+/*
+ * Geneie - A Library and Tools for gene processing
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GENEIE_THREAD_POOL_H
+#define GENEIE_THREAD_POOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <sys/types.h>
+#include <stdbool.h>
+
+#include "sequence_ref.h"
+
+/**
+ * \file
+ */
+
+/**
+ * \brief Internal state of a geneie_thread_pool.
+ */
+struct geneie_thread_pool_state;
+
+/**
+ * \brief A set of worker threads which run tasks.
+ *
+ * Each worker keeps its own queue of tasks. Tasks created
+ * by a worker go on its own queue, and a worker with
+ * nothing to do steals the oldest task from another's.
+ * Tasks are grouped with a geneie_thread_pool_group, and a
+ * thread waiting for a group runs tasks itself rather
+ * than blocking, so tasks may start and wait for groups
+ * of their own.
+ *
+ * Most programs should share geneie_thread_pool_default()
+ * between all their parallel work, so that the number of
+ * running threads stays at the number of processors.
+ *
+ * Pools made with geneie_thread_pool_create() must be passed
+ * to geneie_thread_pool_destroy() when finished with.
+ *
+ * An invalid pool, such as a default pool which couldn't be
+ * started, may still be used: its tasks run one after
+ * another on the calling thread.
+ */
+struct geneie_thread_pool {
+	/**
+	 * \brief The pool's state.
+	 */
+	struct geneie_thread_pool_state *state;
+};
+
+/**
+ * \brief A function run as a task.
+ *
+ * \param param The parameter given when the task was
+ * 	started.
+ */
+typedef void geneie_thread_pool_task(void *param);
+
+/**
+ * \brief A set of tasks which can be waited for together.
+ *
+ * \code
+ * struct geneie_thread_pool_group group;
+ * geneie_thread_pool_group_init(&group, geneie_thread_pool_default());
+ * geneie_thread_pool_group_run(&group, first_task, &first);
+ * geneie_thread_pool_group_run(&group, second_task, &second);
+ * geneie_thread_pool_group_wait(&group);
+ * \endcode
+ */
+struct geneie_thread_pool_group {
+	/**
+	 * \brief The pool the tasks run on.
+	 */
+	struct geneie_thread_pool pool;
+
+	/**
+	 * \brief The number of tasks still to finish. Only
+	 * 	touched atomically, by the group functions.
+	 */
+	long pending;
+};
+
+/**
+ * \brief A function run over part of a range by
+ * 	geneie_thread_pool_parallel_for().
+ *
+ * \param begin The first index of the part.
+ * \param end One past the last index of the part.
+ * \param param The parameter given to
+ * 	geneie_thread_pool_parallel_for().
+ */
+typedef void geneie_thread_pool_range_function(
+	ssize_t begin,
+	ssize_t end,
+	void *param
+);
+
+/**
+ * \brief A function run over one chunk of a reference by
+ * 	geneie_thread_pool_map().
+ *
+ * \param chunk The chunk, followed by up to `overlap` codes
+ * 	from the start of the next chunk.
+ * \param offset The index of the chunk in the whole
+ * 	reference.
+ * \param param The parameter given to
+ * 	geneie_thread_pool_map().
+ */
+typedef void geneie_thread_pool_chunk_function(
+	struct geneie_sequence_ref chunk,
+	ssize_t offset,
+	void *param
+);
+
+/**
+ * \public \memberof geneie_thread_pool
+ * \brief Starts a new pool.
+ *
+ * \param threads The number of worker threads, or 0 to use
+ * 	one per online processor.
+ *
+ * \returns A new pool, or a pool failing
+ * 	geneie_thread_pool_valid() if allocation failed or no
+ * 	threads could be started.
+ */
+struct geneie_thread_pool geneie_thread_pool_create(int threads);
+
+/**
+ * \public \memberof geneie_thread_pool
+ * \brief Returns the pool shared by the whole program.
+ *
+ * It is started on first use, with one worker fewer than
+ * the number of online processors (but at least one),
+ * since the thread waiting for work joins in. It is
+ * never destroyed.
+ *
+ * \returns The default pool, or a pool failing
+ * 	geneie_thread_pool_valid() if it couldn't be started.
+ */
+struct geneie_thread_pool geneie_thread_pool_default(void);
+
+/**
+ * \public \memberof geneie_thread_pool
+ * \brief Returns whether this is a valid pool.
+ *
+ * \param pool The pool to test.
+ *
+ * \returns True if the pool is safe to use, false otherwise.
+ */
+bool geneie_thread_pool_valid(struct geneie_thread_pool pool);
+
+/**
+ * \public \memberof geneie_thread_pool
+ * \brief Returns the number of worker threads in a pool.
+ *
+ * \param pool The pool.
+ *
+ * \returns The number of workers, or 0 for an invalid pool.
+ */
+int geneie_thread_pool_size(struct geneie_thread_pool pool);
+
+/**
+ * \public \memberof geneie_thread_pool
+ * \brief Stops the workers and frees a pool.
+ *
+ * Every group using the pool must have been waited for.
+ * Must not be called on geneie_thread_pool_default().
+ *
+ * \param pool The pool to destroy.
+ */
+void geneie_thread_pool_destroy(struct geneie_thread_pool pool);
+
+/**
+ * \public \memberof geneie_thread_pool_group
+ * \brief Initializes an empty group.
+ *
+ * \param group The group to initialize.
+ * \param pool The pool to run the group's tasks on.
+ */
+void geneie_thread_pool_group_init(
+	struct geneie_thread_pool_group *group,
+	struct geneie_thread_pool pool
+);
+
+/**
+ * \public \memberof geneie_thread_pool_group
+ * \brief Starts a task in a group.
+ *
+ * If the task can't be queued because allocation failed,
+ * or the group's pool is invalid, it is run immediately on
+ * the calling thread instead.
+ *
+ * \param group The group to add the task to.
+ * \param task The function to run.
+ * \param param The parameter to pass to the function.
+ */
+void geneie_thread_pool_group_run(
+	struct geneie_thread_pool_group *group,
+	geneie_thread_pool_task *task,
+	void *param
+);
+
+/**
+ * \public \memberof geneie_thread_pool_group
+ * \brief Waits for every task in a group to finish, running
+ * 	queued tasks in the meantime.
+ *
+ * \param group The group to wait for.
+ */
+void geneie_thread_pool_group_wait(struct geneie_thread_pool_group *group);
+
+/**
+ * \public \memberof geneie_thread_pool
+ * \brief Runs a function over a range of indices in
+ * 	parallel, and waits for it to finish.
+ *
+ * The range is split in halves recursively, until the
+ * parts are no longer than `grain`. Idle workers steal the
+ * largest halves first, which spreads the range out
+ * evenly even when some parts take longer than others.
+ * On an invalid pool, the function is run once over the
+ * whole range on the calling thread.
+ *
+ * \param pool The pool to run on.
+ * \param begin The first index.
+ * \param end One past the last index.
+ * \param grain The largest part to run without splitting,
+ * 	or 0 to pick one from the size of the pool.
+ * \param function The function to run on each part.
+ * \param param The parameter to pass to the function.
+ */
+void geneie_thread_pool_parallel_for(
+	struct geneie_thread_pool pool,
+	ssize_t begin,
+	ssize_t end,
+	ssize_t grain,
+	geneie_thread_pool_range_function *function,
+	void *param
+);
+
+/**
+ * \public \memberof geneie_thread_pool
+ * \brief Runs a function over fixed-size chunks of a
+ * 	reference in parallel, and waits for it to finish.
+ *
+ * Each chunk is passed along with the first `overlap`
+ * codes of the next one, for work that has to look
+ * past the end of its chunk, such as motifs spanning
+ * the boundary. Only the chunk itself should be
+ * modified; the overlap belongs to the next chunk.
+ *
+ * \param pool The pool to run on.
+ * \param ref The reference to split up.
+ * \param chunk_size The number of codes in each chunk, except
+ * 	the last. Use a multiple of 3 to keep codons whole.
+ * \param overlap The number of codes of the next chunk to
+ * 	include.
+ * \param function The function to run on each chunk.
+ * \param param The parameter to pass to the function.
+ */
+void geneie_thread_pool_map(
+	struct geneie_thread_pool pool,
+	struct geneie_sequence_ref ref,
+	ssize_t chunk_size,
+	ssize_t overlap,
+	geneie_thread_pool_chunk_function *function,
+	void *param
+);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // GENEIE_THREAD_POOL_H
@@ -0,0 +1,66 @@
+#include "geneie/mapped_file.h"
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+
+typedef struct geneie_mapped_file mapped_file;
+
+// mmap() can't map zero bytes, so empty files share this
+static char empty_file[1];
+
+mapped_file geneie_mapped_file_open(const char *path, bool writable)
+{
+	const int fd = open(path, O_RDONLY);
+	if (fd < 0)
+		return (mapped_file) { 0 };
+
+	struct stat info;
+	if (fstat(fd, &info)) {
+		const int error = errno;
+		close(fd);
+		errno = error;
+		return (mapped_file) { 0 };
+	}
+
+	if (info.st_size == 0) {
+		close(fd);
+		return (mapped_file) { 0, empty_file };
+	}
+
+	void *const data = mmap(
+		NULL,
+		(size_t)info.st_size,
+		writable ? PROT_READ | PROT_WRITE : PROT_READ,
+		writable ? MAP_PRIVATE : MAP_SHARED,
+		fd,
+		0
+	);
+	const int error = errno;
+
+	// The mapping keeps its own reference to the file
+	close(fd);
+
+	if (data == MAP_FAILED) {
+		errno = error;
+		return (mapped_file) { 0 };
+	}
+
+	return (mapped_file) {
+		(ssize_t)info.st_size,
+		data,
+	};
+}
+
+bool geneie_mapped_file_valid(mapped_file file)
+{
+	return file.data != NULL;
+}
+
+void geneie_mapped_file_close(mapped_file file)
+{
+	if (file.length > 0)
+		munmap(file.data, (size_t)file.length);
+}
@@ -0,0 +1,587 @@
+#include "geneie/pipeline.h"
+
+#include "geneie/ring.h"
+#include "geneie/sequence_tools.h"
+
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <sched.h>
+#include <pthread.h>
+
+typedef struct geneie_pipeline pipeline_t;
+typedef struct geneie_pipeline_state state_t;
+typedef struct geneie_pipeline_chunk chunk_t;
+
+// Waits before a waiting thread starts yielding, then sleeping
+#define SPIN_LIMIT 64
+#define YIELD_LIMIT 128
+
+struct stage {
+	geneie_pipeline_stage *function;
+	void *param;
+	int threads;
+};
+
+struct geneie_pipeline_state {
+	ssize_t chunk_count;
+	chunk_t *chunks;
+	geneie_code *buffer;
+	struct geneie_thread_pool pool;
+
+	ssize_t stage_count, stage_capacity;
+	struct stage *stages;
+};
+
+/*
+ * The connection into a stage, or into the sink. Which ring
+ * it uses depends on the threads on each side. It has room
+ * for every chunk, so pushing never has to wait.
+ */
+struct link {
+	bool multiple;
+	union {
+		struct geneie_ring_spsc spsc;
+		struct geneie_ring_mpmc mpmc;
+	};
+};
+
+/*
+ * The tasks running a stage. A push into the stage's link
+ * starts another one if fewer than the stage's threads are
+ * running, and each runs until the link is empty. Both
+ * happen under the lock, so a chunk is never left behind
+ * with no task to take it.
+ */
+struct stage_tasks {
+	struct run *run;
+	ssize_t index;
+	pthread_mutex_t lock;
+	int active;
+	bool input_done;
+};
+
+struct run {
+	state_t *state;
+	struct link *links;
+	struct stage_tasks *tasks;
+	struct geneie_thread_pool_group group;
+	struct geneie_ring_spsc free_chunks;
+	atomic_bool failed;
+
+	// The last stage has pushed its last chunk
+	atomic_bool finished;
+
+	// The source and sink sleep here once they have waited
+	// a while, until a chunk is pushed or the run ends
+	pthread_mutex_t lock;
+	pthread_cond_t wake;
+	atomic_long epoch;
+	atomic_int sleepers;
+
+	geneie_pipeline_source *source;
+	void *source_param;
+};
+
+pipeline_t geneie_pipeline_create(
+	ssize_t chunks,
+	ssize_t chunk_size,
+	struct geneie_thread_pool pool
+)
+{
+	if (chunks <= 0 || chunk_size <= 0)
+		return (pipeline_t) { 0 };
+
+	state_t *const state = calloc(1, sizeof(state_t));
+	if (!state)
+		return (pipeline_t) { 0 };
+
+	state->chunk_count = chunks;
+	state->pool = pool;
+	state->chunks = malloc((size_t)chunks * sizeof(chunk_t));
+	state->buffer = malloc((size_t)chunks * (size_t)chunk_size);
+	if (!state->chunks || !state->buffer) {
+		free(state->chunks);
+		free(state->buffer);
+		free(state);
+		return (pipeline_t) { 0 };
+	}
+
+	for (ssize_t i = 0; i < chunks; i++) {
+		geneie_code *const codes = state->buffer + i * chunk_size;
+		state->chunks[i] = (chunk_t) {
+			.capacity = chunk_size,
+			.codes = codes,
+			.data = { 0, codes },
+		};
+	}
+
+	return (pipeline_t) { state };
+}
+
+bool geneie_pipeline_valid(pipeline_t pipeline)
+{
+	return pipeline.state != NULL;
+}
+
+void geneie_pipeline_destroy(pipeline_t pipeline)
+{
+	state_t *const state = pipeline.state;
+	if (!state)
+		return;
+
+	free(state->stages);
+	free(state->chunks);
+	free(state->buffer);
+	free(state);
+}
+
+bool geneie_pipeline_add_stage(
+	pipeline_t pipeline,
+	geneie_pipeline_stage *function,
+	void *param,
+	int threads
+)
+{
+	state_t *const state = pipeline.state;
+	if (threads <= 0)
+		return false;
+
+	if (state->stage_count == state->stage_capacity) {
+		const ssize_t capacity = state->stage_capacity
+			? state->stage_capacity * 2
+			: 4;
+		struct stage *const stages = realloc(
+			state->stages,
+			(size_t)capacity * sizeof(struct stage)
+		);
+		if (!stages)
+			return false;
+		state->stages = stages;
+		state->stage_capacity = capacity;
+	}
+
+	state->stages[state->stage_count++] = (struct stage) {
+		function,
+		param,
+		threads,
+	};
+	return true;
+}
+
+static void notify(struct run *run)
+{
+	atomic_fetch_add(&run->epoch, 1);
+	if (atomic_load(&run->sleepers) > 0) {
+		pthread_mutex_lock(&run->lock);
+		pthread_cond_broadcast(&run->wake);
+		pthread_mutex_unlock(&run->lock);
+	}
+}
+
+/*
+ * Spins, then yields, then sleeps until notify() is called
+ * after the epoch was read. Reading the epoch before
+ * looking for a chunk means a push in between is never
+ * slept through.
+ */
+static void backoff(struct run *run, long epoch, unsigned *waits)
+{
+	const unsigned count = (*waits)++;
+	if (count < SPIN_LIMIT) {
+#if defined(__x86_64__) || defined(__i386__)
+		__builtin_ia32_pause();
+#endif
+		return;
+	}
+	if (count < YIELD_LIMIT) {
+		sched_yield();
+		return;
+	}
+
+	pthread_mutex_lock(&run->lock);
+	atomic_fetch_add(&run->sleepers, 1);
+	while (atomic_load(&run->epoch) == epoch)
+		pthread_cond_wait(&run->wake, &run->lock);
+	atomic_fetch_sub(&run->sleepers, 1);
+	pthread_mutex_unlock(&run->lock);
+}
+
+static bool failed(struct run *run)
+{
+	return atomic_load_explicit(&run->failed, memory_order_relaxed);
+}
+
+static void fail(struct run *run)
+{
+	atomic_store_explicit(&run->failed, true, memory_order_relaxed);
+	notify(run);
+}
+
+static bool link_init(struct link *link, int producers, int consumers, ssize_t capacity)
+{
+	link->multiple = producers > 1 || consumers > 1;
+
+	if (link->multiple) {
+		link->mpmc = geneie_ring_mpmc_alloc(capacity);
+		return geneie_ring_mpmc_valid(link->mpmc);
+	}
+	link->spsc = geneie_ring_spsc_alloc(capacity);
+	return geneie_ring_spsc_valid(link->spsc);
+}
+
+static void link_free(struct link *link)
+{
+	if (link->multiple)
+		geneie_ring_mpmc_free(link->mpmc);
+	else
+		geneie_ring_spsc_free(link->spsc);
+}
+
+static bool link_try_push(struct link *link, chunk_t *chunk)
+{
+	return link->multiple
+		? geneie_ring_mpmc_push(link->mpmc, chunk)
+		: geneie_ring_spsc_push(link->spsc, chunk);
+}
+
+static bool link_try_pop(struct link *link, chunk_t **chunk)
+{
+	void *item;
+	const bool result = link->multiple
+		? geneie_ring_mpmc_pop(link->mpmc, &item)
+		: geneie_ring_spsc_pop(link->spsc, &item);
+	if (result)
+		*chunk = item;
+	return result;
+}
+
+static void run_stage(void *param);
+
+/*
+ * Marks the end of a link's input. Once the stage reading
+ * it has no tasks left, its own output ends too.
+ */
+static void finish_link(struct run *run, ssize_t index)
+{
+	if (index == run->state->stage_count) {
+		atomic_store_explicit(&run->finished, true, memory_order_release);
+		notify(run);
+		return;
+	}
+
+	struct stage_tasks *const tasks = &run->tasks[index];
+	pthread_mutex_lock(&tasks->lock);
+	tasks->input_done = true;
+	const bool finished = tasks->active == 0;
+	pthread_mutex_unlock(&tasks->lock);
+
+	if (finished)
+		finish_link(run, index + 1);
+}
+
+/*
+ * Passes a chunk into a link, starting a task for the
+ * stage reading it if it has threads to spare, or waking
+ * the sink.
+ */
+static void link_push(struct run *run, ssize_t index, chunk_t *chunk)
+{
+	// Never full: it has room for every chunk
+	if (!link_try_push(&run->links[index], chunk)) {
+		fail(run);
+		return;
+	}
+
+	if (index == run->state->stage_count) {
+		notify(run);
+		return;
+	}
+
+	struct stage_tasks *const tasks = &run->tasks[index];
+	pthread_mutex_lock(&tasks->lock);
+	const bool start = tasks->active < run->state->stages[index].threads;
+	if (start)
+		tasks->active++;
+	pthread_mutex_unlock(&tasks->lock);
+
+	if (start)
+		geneie_thread_pool_group_run(&run->group, run_stage, tasks);
+}
+
+/*
+ * Takes the next chunk for a stage's task, or ends the task
+ * if there is none. Ending it under the lock means a chunk
+ * pushed meanwhile is either found here or starts a new
+ * task.
+ */
+static bool next_chunk(struct stage_tasks *tasks, chunk_t **chunk)
+{
+	struct run *const run = tasks->run;
+	struct link *const input = &run->links[tasks->index];
+	if (!failed(run) && link_try_pop(input, chunk))
+		return true;
+
+	pthread_mutex_lock(&tasks->lock);
+	const bool result = !failed(run) && link_try_pop(input, chunk);
+	bool finished = false;
+	if (!result) {
+		tasks->active--;
+		finished = tasks->input_done && tasks->active == 0;
+	}
+	pthread_mutex_unlock(&tasks->lock);
+
+	if (finished)
+		finish_link(run, tasks->index + 1);
+	return result;
+}
+
+static void run_stage(void *param)
+{
+	struct stage_tasks *const tasks = param;
+	struct run *const run = tasks->run;
+	const struct stage stage = run->state->stages[tasks->index];
+
+	chunk_t *chunk;
+	while (next_chunk(tasks, &chunk)) {
+		if (stage.function(chunk, stage.param))
+			link_push(run, tasks->index + 1, chunk);
+		else
+			fail(run);
+	}
+}
+
+/*
+ * The source has a thread of its own, rather than a task
+ * on the pool, since it spends most of its time waiting
+ * for input or for the sink to free a chunk. As a task it
+ * would hold a worker that the stages it is waiting for
+ * might need.
+ */
+static void *source_main(void *param)
+{
+	struct run *const run = param;
+	ssize_t index = 0;
+
+	while (!failed(run)) {
+		void *item;
+		unsigned waits = 0;
+		for (;;) {
+			const long epoch = atomic_load(&run->epoch);
+			if (geneie_ring_spsc_pop(run->free_chunks, &item))
+				break;
+			if (failed(run))
+				goto done;
+			backoff(run, epoch, &waits);
+		}
+
+		chunk_t *const chunk = item;
+		const ssize_t length = run->source(chunk->codes, chunk->capacity, run->source_param);
+		if (length < 0 || length > chunk->capacity) {
+			fail(run);
+			break;
+		}
+		if (length == 0)
+			break;
+
+		chunk->index = index++;
+		chunk->data = (struct geneie_sequence_ref) { length, chunk->codes };
+		link_push(run, 0, chunk);
+	}
+
+done:
+	finish_link(run, 0);
+	return NULL;
+}
+
+/*
+ * Waits for a chunk from the last stage. Returns false once
+ * the last stage has finished and its link is empty, or if
+ * the pipeline failed.
+ */
+static bool sink_pop(struct run *run, chunk_t **chunk)
+{
+	struct link *const input = &run->links[run->state->stage_count];
+	for (unsigned waits = 0;;) {
+		const long epoch = atomic_load(&run->epoch);
+		if (link_try_pop(input, chunk))
+			return true;
+		if (failed(run))
+			return false;
+		if (atomic_load_explicit(&run->finished, memory_order_acquire))
+			// Every push happened before it finished
+			return link_try_pop(input, chunk);
+		backoff(run, epoch, &waits);
+	}
+}
+
+static void free_chunk(struct run *run, chunk_t *chunk)
+{
+	// Never full: it has room for every chunk
+	geneie_ring_spsc_push(run->free_chunks, chunk);
+	notify(run);
+}
+
+/*
+ * Gives finished chunks to the sink and back to the source,
+ * until the last stage finishes.
+ */
+static void sink_chunks(struct run *run, geneie_pipeline_stage *sink, void *param)
+{
+	chunk_t *chunk;
+	while (sink_pop(run, &chunk)) {
+		if (!sink(chunk, param)) {
+			fail(run);
+			break;
+		}
+		free_chunk(run, chunk);
+	}
+}
+
+/*
+ * Chunks only go back to the source once they reach the
+ * sink, and the source numbers them in order, so every
+ * chunk in the pipeline is within chunk_count of the next
+ * one the sink wants. That makes an array of chunk_count
+ * slots a big enough window to put them back in order.
+ */
+static void sink_chunks_ordered(
+	struct run *run,
+	chunk_t **pending,
+	geneie_pipeline_stage *sink,
+	void *param
+)
+{
+	const ssize_t count = run->state->chunk_count;
+	ssize_t next = 0;
+
+	chunk_t *chunk;
+	while (sink_pop(run, &chunk)) {
+		pending[chunk->index % count] = chunk;
+
+		while ((chunk = pending[next % count])) {
+			pending[next % count] = NULL;
+			next++;
+			if (!sink(chunk, param)) {
+				fail(run);
+				return;
+			}
+			free_chunk(run, chunk);
+		}
+	}
+}
+
+static bool run_pipeline(
+	pipeline_t pipeline,
+	geneie_pipeline_source *source,
+	void *source_param,
+	geneie_pipeline_stage *sink,
+	void *sink_param,
+	bool ordered
+)
+{
+	state_t *const state = pipeline.state;
+	const ssize_t stages = state->stage_count;
+
+	struct run run = {
+		.state = state,
+		.links = calloc((size_t)stages + 1, sizeof(struct link)),
+		.tasks = calloc((size_t)stages + 1, sizeof(struct stage_tasks)),
+		.free_chunks = geneie_ring_spsc_alloc(state->chunk_count),
+		.source = source,
+		.source_param = source_param,
+	};
+	atomic_init(&run.failed, false);
+	atomic_init(&run.finished, false);
+	atomic_init(&run.epoch, 0);
+	atomic_init(&run.sleepers, 0);
+	pthread_mutex_init(&run.lock, NULL);
+	pthread_cond_init(&run.wake, NULL);
+	geneie_thread_pool_group_init(&run.group, state->pool);
+	chunk_t **const pending = ordered
+		? calloc((size_t)state->chunk_count, sizeof(chunk_t *))
+		: NULL;
+
+	ssize_t links = 0;
+	bool result = false;
+	if (!run.links || !run.tasks || (ordered && !pending)
+		|| !geneie_ring_spsc_valid(run.free_chunks))
+		goto cleanup;
+
+	for (; links <= stages; links++) {
+		const int
+			producers = links ? state->stages[links - 1].threads : 1,
+			consumers = links < stages ? state->stages[links].threads : 1;
+		if (!link_init(&run.links[links], producers, consumers, state->chunk_count)) {
+			// link_init() leaves nothing to free on failure
+			goto cleanup;
+		}
+		run.tasks[links].run = &run;
+		run.tasks[links].index = links;
+		pthread_mutex_init(&run.tasks[links].lock, NULL);
+	}
+
+	for (ssize_t i = 0; i < state->chunk_count; i++)
+		geneie_ring_spsc_push(run.free_chunks, &state->chunks[i]);
+
+	pthread_t source_thread;
+	if (pthread_create(&source_thread, NULL, source_main, &run))
+		goto cleanup;
+
+	if (ordered)
+		sink_chunks_ordered(&run, pending, sink, sink_param);
+	else
+		sink_chunks(&run, sink, sink_param);
+
+	// Only the source and the stages' own tasks start tasks
+	pthread_join(source_thread, NULL);
+	geneie_thread_pool_group_wait(&run.group);
+	result = !failed(&run);
+cleanup:
+	for (ssize_t i = 0; i < links; i++) {
+		link_free(&run.links[i]);
+		pthread_mutex_destroy(&run.tasks[i].lock);
+	}
+	pthread_cond_destroy(&run.wake);
+	pthread_mutex_destroy(&run.lock);
+	geneie_ring_spsc_free(run.free_chunks);
+	free(run.links);
+	free(run.tasks);
+	free(pending);
+	return result;
+}
+
+bool geneie_pipeline_run(
+	pipeline_t pipeline,
+	geneie_pipeline_source *source,
+	void *source_param,
+	geneie_pipeline_stage *sink,
+	void *sink_param
+)
+{
+	return run_pipeline(pipeline, source, source_param, sink, sink_param, false);
+}
+
+bool geneie_pipeline_run_ordered(
+	pipeline_t pipeline,
+	geneie_pipeline_source *source,
+	void *source_param,
+	geneie_pipeline_stage *sink,
+	void *sink_param
+)
+{
+	return run_pipeline(pipeline, source, source_param, sink, sink_param, true);
+}
+
+bool geneie_pipeline_stage_clean_whitespace(chunk_t *chunk, void *param)
+{
+	(void)param;
+	chunk->data = geneie_sequence_tools_clean_whitespace(chunk->data);
+	return true;
+}
+
+bool geneie_pipeline_stage_dna_to_premrna(chunk_t *chunk, void *param)
+{
+	(void)param;
+	geneie_sequence_tools_dna_to_premrna(chunk->data);
+	return true;
+}
@@ -0,0 +1,202 @@
+#include "geneie/reorder.h"
+
+#include <stdlib.h>
+#include <pthread.h>
+
+typedef struct geneie_reorder reorder_t;
+typedef struct geneie_reorder_state state_t;
+typedef struct geneie_reorder_buffer buffer_t;
+typedef struct geneie_sequence_ref seq_r;
+
+struct slot {
+	buffer_t buffer;
+	bool ready;
+};
+
+struct geneie_reorder_state {
+	pthread_mutex_t lock;
+
+	// Signalled whenever next moves or we fail
+	pthread_cond_t advanced;
+
+	ssize_t window;
+	struct slot *slots;
+
+	// The oldest unwritten sequence number
+	ssize_t next;
+
+	// Whether a thread is in the writer loop
+	bool writing;
+	bool failed;
+
+	geneie_reorder_writer *writer;
+	void *param;
+};
+
+static void free_slots(struct slot *slots, ssize_t count)
+{
+	for (ssize_t i = 0; i < count; i++)
+		free(slots[i].buffer.codes);
+	free(slots);
+}
+
+reorder_t geneie_reorder_create(
+	ssize_t window,
+	ssize_t buffer_size,
+	geneie_reorder_writer *writer,
+	void *param
+)
+{
+	if (window <= 0 || buffer_size < 0)
+		return (reorder_t) { 0 };
+
+	state_t *const state = calloc(1, sizeof(state_t));
+	if (!state)
+		return (reorder_t) { 0 };
+
+	state->slots = calloc((size_t)window, sizeof(struct slot));
+	if (!state->slots) {
+		free(state);
+		return (reorder_t) { 0 };
+	}
+
+	for (ssize_t i = 0; i < window; i++) {
+		buffer_t *const buffer = &state->slots[i].buffer;
+		if (!geneie_reorder_buffer_reserve(buffer, buffer_size)) {
+			free_slots(state->slots, window);
+			free(state);
+			return (reorder_t) { 0 };
+		}
+	}
+
+	pthread_mutex_init(&state->lock, NULL);
+	pthread_cond_init(&state->advanced, NULL);
+	state->window = window;
+	state->writer = writer;
+	state->param = param;
+	return (reorder_t) { state };
+}
+
+bool geneie_reorder_valid(reorder_t reorder)
+{
+	return reorder.state != NULL;
+}
+
+void geneie_reorder_destroy(reorder_t reorder)
+{
+	state_t *const state = reorder.state;
+	if (!state)
+		return;
+
+	pthread_mutex_destroy(&state->lock);
+	pthread_cond_destroy(&state->advanced);
+	free_slots(state->slots, state->window);
+	free(state);
+}
+
+buffer_t *geneie_reorder_acquire(reorder_t reorder, ssize_t sequence)
+{
+	state_t *const state = reorder.state;
+	buffer_t *result = NULL;
+
+	pthread_mutex_lock(&state->lock);
+	while (!state->failed && sequence >= state->next + state->window)
+		pthread_cond_wait(&state->advanced, &state->lock);
+
+	if (!state->failed && sequence >= state->next) {
+		result = &state->slots[sequence % state->window].buffer;
+		result->sequence = sequence;
+		result->length = 0;
+	}
+	pthread_mutex_unlock(&state->lock);
+
+	return result;
+}
+
+bool geneie_reorder_buffer_reserve(buffer_t *buffer, ssize_t capacity)
+{
+	if (capacity <= buffer->capacity && buffer->codes)
+		return true;
+
+	// Doubling, so a buffer settles after a few results
+	ssize_t new_capacity = buffer->capacity ? buffer->capacity : 1;
+	while (new_capacity < capacity)
+		new_capacity *= 2;
+
+	geneie_code *const codes = realloc(buffer->codes, (size_t)new_capacity);
+	if (!codes)
+		return false;
+
+	buffer->codes = codes;
+	buffer->capacity = new_capacity;
+	return true;
+}
+
+bool geneie_reorder_submit(reorder_t reorder, buffer_t *buffer)
+{
+	state_t *const state = reorder.state;
+
+	pthread_mutex_lock(&state->lock);
+	if (state->failed) {
+		pthread_mutex_unlock(&state->lock);
+		return false;
+	}
+
+	struct slot *const submitted = &state->slots[buffer->sequence % state->window];
+	submitted->ready = true;
+
+	// Someone else will write it when its turn comes
+	if (state->writing || buffer->sequence != state->next) {
+		pthread_mutex_unlock(&state->lock);
+		return true;
+	}
+
+	state->writing = true;
+	for (;;) {
+		struct slot *const slot = &state->slots[state->next % state->window];
+		if (state->failed || !slot->ready)
+			break;
+
+		// Results submitted while we write are picked up by
+		// this loop, so only one thread ever writes
+		pthread_mutex_unlock(&state->lock);
+		const bool written = state->writer(
+			(seq_r) { slot->buffer.length, slot->buffer.codes },
+			slot->buffer.sequence,
+			state->param
+		);
+		pthread_mutex_lock(&state->lock);
+
+		slot->ready = false;
+		if (written)
+			state->next++;
+		else
+			state->failed = true;
+		pthread_cond_broadcast(&state->advanced);
+	}
+	state->writing = false;
+
+	const bool result = !state->failed;
+	pthread_mutex_unlock(&state->lock);
+	return result;
+}
+
+void geneie_reorder_abort(reorder_t reorder)
+{
+	state_t *const state = reorder.state;
+
+	pthread_mutex_lock(&state->lock);
+	state->failed = true;
+	pthread_cond_broadcast(&state->advanced);
+	pthread_mutex_unlock(&state->lock);
+}
+
+ssize_t geneie_reorder_written(reorder_t reorder)
+{
+	state_t *const state = reorder.state;
+
+	pthread_mutex_lock(&state->lock);
+	const ssize_t result = state->failed ? -1 : state->next;
+	pthread_mutex_unlock(&state->lock);
+	return result;
+}
@@ -0,0 +1,223 @@
+#include "geneie/ring.h"
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+
+typedef struct geneie_ring_spsc spsc_t;
+typedef struct geneie_ring_mpmc mpmc_t;
+
+struct geneie_ring_spsc_state {
+	// The consumer's position, and its copy of the producer's
+	alignas(64) atomic_size_t head;
+	size_t cached_tail;
+
+	// The producer's position, and its copy of the consumer's
+	alignas(64) atomic_size_t tail;
+	size_t cached_head;
+
+	alignas(64) size_t mask;
+	void **slots;
+};
+
+struct cell {
+	atomic_size_t sequence;
+	void *item;
+};
+
+struct geneie_ring_mpmc_state {
+	alignas(64) atomic_size_t enqueue;
+	alignas(64) atomic_size_t dequeue;
+	alignas(64) size_t mask;
+	struct cell *cells;
+};
+
+static size_t round_up(ssize_t capacity, size_t minimum)
+{
+	size_t result = minimum;
+	while (result < (size_t)capacity)
+		result *= 2;
+	return result;
+}
+
+spsc_t geneie_ring_spsc_alloc(ssize_t capacity)
+{
+	if (capacity <= 0)
+		return (spsc_t) { 0 };
+
+	struct geneie_ring_spsc_state *const state = aligned_alloc(
+		alignof(struct geneie_ring_spsc_state),
+		sizeof(struct geneie_ring_spsc_state)
+	);
+	if (!state)
+		return (spsc_t) { 0 };
+
+	const size_t size = round_up(capacity, 1);
+	state->slots = malloc(size * sizeof(void *));
+	if (!state->slots) {
+		free(state);
+		return (spsc_t) { 0 };
+	}
+
+	atomic_init(&state->head, 0);
+	atomic_init(&state->tail, 0);
+	state->cached_head = 0;
+	state->cached_tail = 0;
+	state->mask = size - 1;
+	return (spsc_t) { state };
+}
+
+bool geneie_ring_spsc_valid(spsc_t ring)
+{
+	return ring.state != NULL;
+}
+
+void geneie_ring_spsc_free(spsc_t ring)
+{
+	if (!ring.state)
+		return;
+	free(ring.state->slots);
+	free(ring.state);
+}
+
+bool geneie_ring_spsc_push(spsc_t ring, void *item)
+{
+	struct geneie_ring_spsc_state *const state = ring.state;
+	const size_t tail = atomic_load_explicit(&state->tail, memory_order_relaxed);
+
+	// Only look at the consumer's position when our copy
+	// says we're full, to keep its cache line still
+	if (tail - state->cached_head > state->mask) {
+		state->cached_head = atomic_load_explicit(&state->head, memory_order_acquire);
+		if (tail - state->cached_head > state->mask)
+			return false;
+	}
+
+	state->slots[tail & state->mask] = item;
+	atomic_store_explicit(&state->tail, tail + 1, memory_order_release);
+	return true;
+}
+
+bool geneie_ring_spsc_pop(spsc_t ring, void **item)
+{
+	struct geneie_ring_spsc_state *const state = ring.state;
+	const size_t head = atomic_load_explicit(&state->head, memory_order_relaxed);
+
+	if (head == state->cached_tail) {
+		state->cached_tail = atomic_load_explicit(&state->tail, memory_order_acquire);
+		if (head == state->cached_tail)
+			return false;
+	}
+
+	*item = state->slots[head & state->mask];
+	atomic_store_explicit(&state->head, head + 1, memory_order_release);
+	return true;
+}
+
+mpmc_t geneie_ring_mpmc_alloc(ssize_t capacity)
+{
+	if (capacity <= 0)
+		return (mpmc_t) { 0 };
+
+	struct geneie_ring_mpmc_state *const state = aligned_alloc(
+		alignof(struct geneie_ring_mpmc_state),
+		sizeof(struct geneie_ring_mpmc_state)
+	);
+	if (!state)
+		return (mpmc_t) { 0 };
+
+	const size_t size = round_up(capacity, 2);
+	state->cells = malloc(size * sizeof(struct cell));
+	if (!state->cells) {
+		free(state);
+		return (mpmc_t) { 0 };
+	}
+
+	for (size_t i = 0; i < size; i++)
+		atomic_init(&state->cells[i].sequence, i);
+	atomic_init(&state->enqueue, 0);
+	atomic_init(&state->dequeue, 0);
+	state->mask = size - 1;
+	return (mpmc_t) { state };
+}
+
+bool geneie_ring_mpmc_valid(mpmc_t ring)
+{
+	return ring.state != NULL;
+}
+
+void geneie_ring_mpmc_free(mpmc_t ring)
+{
+	if (!ring.state)
+		return;
+	free(ring.state->cells);
+	free(ring.state);
+}
+
+bool geneie_ring_mpmc_push(mpmc_t ring, void *item)
+{
+	struct geneie_ring_mpmc_state *const state = ring.state;
+	size_t position = atomic_load_explicit(&state->enqueue, memory_order_relaxed);
+	struct cell *cell;
+
+	for (;;) {
+		cell = &state->cells[position & state->mask];
+		const size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+		const intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+
+		if (difference == 0) {
+			// The cell is free for this lap: claim it
+			if (atomic_compare_exchange_weak_explicit(
+				&state->enqueue,
+				&position,
+				position + 1,
+				memory_order_relaxed,
+				memory_order_relaxed
+			))
+				break;
+		} else if (difference < 0) {
+			// Still holding last lap's item: full
+			return false;
+		} else {
+			position = atomic_load_explicit(&state->enqueue, memory_order_relaxed);
+		}
+	}
+
+	cell->item = item;
+	atomic_store_explicit(&cell->sequence, position + 1, memory_order_release);
+	return true;
+}
+
+bool geneie_ring_mpmc_pop(mpmc_t ring, void **item)
+{
+	struct geneie_ring_mpmc_state *const state = ring.state;
+	size_t position = atomic_load_explicit(&state->dequeue, memory_order_relaxed);
+	struct cell *cell;
+
+	for (;;) {
+		cell = &state->cells[position & state->mask];
+		const size_t sequence = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+		const intptr_t difference = (intptr_t)sequence - (intptr_t)(position + 1);
+
+		if (difference == 0) {
+			if (atomic_compare_exchange_weak_explicit(
+				&state->dequeue,
+				&position,
+				position + 1,
+				memory_order_relaxed,
+				memory_order_relaxed
+			))
+				break;
+		} else if (difference < 0) {
+			// Not written yet: empty
+			return false;
+		} else {
+			position = atomic_load_explicit(&state->dequeue, memory_order_relaxed);
+		}
+	}
+
+	*item = cell->item;
+	atomic_store_explicit(&cell->sequence, position + state->mask + 1, memory_order_release);
+	return true;
+}
@@ -0,0 +1,342 @@
+#include "geneie/rope.h"
+
+#include "stats_internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+
+typedef struct geneie_rope rope_t;
+typedef struct geneie_rope_piece piece_t;
+typedef struct geneie_rope_block block_t;
+typedef struct geneie_sequence_ref seq_r;
+
+#define BLOCK_SIZE GENEIE_ROPE_BLOCK_SIZE
+
+struct geneie_rope_block {
+	atomic_long references;
+
+	// Only meaningful while references == 1, for
+	// appending into the free space at the end
+	ssize_t used;
+	geneie_code codes[];
+};
+
+static const rope_t invalid_rope = { 0 };
+
+static block_t *block_alloc(void)
+{
+	block_t *const result = malloc(sizeof(block_t) + BLOCK_SIZE);
+	if (!result)
+		return NULL;
+
+	GENEIE_STATS_ALLOCATION(sizeof(block_t) + BLOCK_SIZE);
+
+	atomic_init(&result->references, 1);
+	result->used = 0;
+	return result;
+}
+
+static void block_retain(block_t *block)
+{
+	atomic_fetch_add_explicit(&block->references, 1, memory_order_relaxed);
+}
+
+static void block_release(block_t *block)
+{
+	if (atomic_fetch_sub_explicit(&block->references, 1, memory_order_acq_rel) == 1)
+		free(block);
+}
+
+static bool block_exclusive(block_t *block)
+{
+	return atomic_load_explicit(&block->references, memory_order_acquire) == 1;
+}
+
+static bool reserve(rope_t *rope, ssize_t extra)
+{
+	if (rope->count + extra <= rope->capacity)
+		return true;
+
+	ssize_t capacity = rope->capacity ? rope->capacity : 8;
+	while (capacity < rope->count + extra)
+		capacity *= 2;
+
+	piece_t *const pieces = realloc(
+		rope->pieces,
+		(size_t)capacity * sizeof(piece_t)
+	);
+	if (!pieces)
+		return false;
+
+	GENEIE_STATS_ALLOCATION((size_t)capacity * sizeof(piece_t));
+
+	rope->pieces = pieces;
+	rope->capacity = capacity;
+	return true;
+}
+
+/*
+ * Makes sure a piece starts at the given position,
+ * splitting the piece containing it if necessary,
+ * and returns the index of that piece. The caller
+ * must have reserved space for one more piece.
+ */
+static ssize_t split_at(rope_t *rope, ssize_t position)
+{
+	ssize_t i = 0;
+	for (; i < rope->count; i++) {
+		const seq_r current = rope->pieces[i].ref;
+		if (position == 0)
+			return i;
+		if (position < current.length)
+			break;
+		position -= current.length;
+	}
+
+	if (i == rope->count)
+		return i;
+
+	piece_t *const piece = &rope->pieces[i];
+	const piece_t second = {
+		piece->block,
+		geneie_sequence_ref_index(piece->ref, position),
+	};
+	piece->ref = geneie_sequence_ref_trunc(piece->ref, position);
+	block_retain(piece->block);
+
+	memmove(
+		&rope->pieces[i + 2],
+		&rope->pieces[i + 1],
+		(size_t)(rope->count - i - 1) * sizeof(piece_t)
+	);
+	GENEIE_STATS_ADD(MEMMOVE_BYTES, (size_t)(rope->count - i - 1) * sizeof(piece_t));
+	rope->pieces[i + 1] = second;
+	rope->count++;
+	return i + 1;
+}
+
+rope_t geneie_rope_alloc(void)
+{
+	rope_t result = { 0 };
+	if (!reserve(&result, 1))
+		return invalid_rope;
+	return result;
+}
+
+bool geneie_rope_valid(rope_t rope)
+{
+	return rope.pieces != NULL;
+}
+
+void geneie_rope_free(rope_t rope)
+{
+	for (ssize_t i = 0; i < rope.count; i++)
+		block_release(rope.pieces[i].block);
+	free(rope.pieces);
+}
+
+rope_t geneie_rope_from_ref(seq_r ref)
+{
+	if (!geneie_sequence_ref_valid(ref))
+		return invalid_rope;
+
+	rope_t result = geneie_rope_alloc();
+	if (!geneie_rope_valid(result))
+		return invalid_rope;
+
+	if (!geneie_rope_append(&result, ref)) {
+		geneie_rope_free(result);
+		return invalid_rope;
+	}
+
+	return result;
+}
+
+bool geneie_rope_append(rope_t *rope, seq_r ref)
+{
+	if (!geneie_sequence_ref_valid(ref))
+		return false;
+	if (ref.length == 0)
+		return true;
+
+	const ssize_t
+		original_count = rope->count,
+		original_length = rope->length;
+
+	piece_t *last = rope->count ? &rope->pieces[rope->count - 1] : NULL;
+	const ssize_t original_last_length = last ? last->ref.length : 0;
+
+	// Fill the free space of the last block first, if we
+	// are the only ones who can see it
+	if (last && block_exclusive(last->block)) {
+		block_t *const block = last->block;
+		const bool at_end = last->ref.codes + last->ref.length
+			== block->codes + block->used;
+		const ssize_t space = BLOCK_SIZE - block->used;
+		if (at_end && space > 0) {
+			const ssize_t amount = ref.length < space ? ref.length : space;
+			memcpy(&block->codes[block->used], ref.codes, (size_t)amount);
+			block->used += amount;
+			last->ref.length += amount;
+			rope->length += amount;
+			ref = geneie_sequence_ref_index(ref, amount);
+		}
+	}
+
+	while (ref.length > 0) {
+		block_t *block = NULL;
+		if (!reserve(rope, 1) || !(block = block_alloc()))
+			goto fail;
+
+		const ssize_t amount = ref.length < BLOCK_SIZE ? ref.length : BLOCK_SIZE;
+		memcpy(block->codes, ref.codes, (size_t)amount);
+		block->used = amount;
+
+		rope->pieces[rope->count++] = (piece_t) {
+			block,
+			{ amount, block->codes },
+		};
+		rope->length += amount;
+		ref = geneie_sequence_ref_index(ref, amount);
+	}
+
+	return true;
+
+fail:
+	for (ssize_t i = original_count; i < rope->count; i++)
+		block_release(rope->pieces[i].block);
+	rope->count = original_count;
+	rope->length = original_length;
+	if (original_count) {
+		// reserve() may have moved the pieces
+		last = &rope->pieces[original_count - 1];
+		last->block->used -= last->ref.length - original_last_length;
+		last->ref.length = original_last_length;
+	}
+	return false;
+}
+
+bool geneie_rope_insert(rope_t *rope, ssize_t at, rope_t other)
+{
+	if (at < 0 || at > rope->length)
+		return false;
+	if (!reserve(rope, other.count + 1))
+		return false;
+
+	const ssize_t i = split_at(rope, at);
+
+	memmove(
+		&rope->pieces[i + other.count],
+		&rope->pieces[i],
+		(size_t)(rope->count - i) * sizeof(piece_t)
+	);
+	GENEIE_STATS_ADD(MEMMOVE_BYTES, (size_t)(rope->count - i) * sizeof(piece_t));
+
+	for (ssize_t j = 0; j < other.count; j++) {
+		block_retain(other.pieces[j].block);
+		rope->pieces[i + j] = other.pieces[j];
+	}
+
+	rope->count += other.count;
+	rope->length += other.length;
+	return true;
+}
+
+bool geneie_rope_concat(rope_t *rope, rope_t other)
+{
+	return geneie_rope_insert(rope, rope->length, other);
+}
+
+bool geneie_rope_erase(rope_t *rope, ssize_t start, ssize_t length)
+{
+	if (start < 0 || length < 0 || start > rope->length - length)
+		return false;
+	if (!reserve(rope, 2))
+		return false;
+
+	const ssize_t
+		first = split_at(rope, start),
+		last = split_at(rope, start + length);
+
+	for (ssize_t i = first; i < last; i++)
+		block_release(rope->pieces[i].block);
+
+	memmove(
+		&rope->pieces[first],
+		&rope->pieces[last],
+		(size_t)(rope->count - last) * sizeof(piece_t)
+	);
+	GENEIE_STATS_ADD(MEMMOVE_BYTES, (size_t)(rope->count - last) * sizeof(piece_t));
+
+	rope->count -= last - first;
+	rope->length -= length;
+	return true;
+}
+
+rope_t geneie_rope_slice(rope_t rope, ssize_t start, ssize_t length)
+{
+	if (start < 0 || length < 0 || start > rope.length - length)
+		return invalid_rope;
+
+	rope_t result = geneie_rope_alloc();
+	if (!geneie_rope_valid(result))
+		return invalid_rope;
+
+	for (ssize_t i = 0; i < rope.count && length > 0; i++) {
+		seq_r ref = rope.pieces[i].ref;
+		if (start >= ref.length) {
+			start -= ref.length;
+			continue;
+		}
+
+		ref = geneie_sequence_ref_index(ref, start);
+		start = 0;
+		if (ref.length > length)
+			ref = geneie_sequence_ref_trunc(ref, length);
+
+		if (!reserve(&result, 1)) {
+			geneie_rope_free(result);
+			return invalid_rope;
+		}
+
+		block_retain(rope.pieces[i].block);
+		result.pieces[result.count++] = (piece_t) {
+			rope.pieces[i].block,
+			ref,
+		};
+		result.length += ref.length;
+		length -= ref.length;
+	}
+
+	return result;
+}
+
+struct geneie_sequence geneie_rope_to_sequence(rope_t rope)
+{
+	struct geneie_sequence result = geneie_sequence_alloc(rope.length);
+	if (!geneie_sequence_valid(result))
+		return result;
+
+	geneie_code *out = result.codes;
+	for (ssize_t i = 0; i < rope.count; i++) {
+		const seq_r ref = rope.pieces[i].ref;
+		memcpy(out, ref.codes, (size_t)ref.length);
+		out += ref.length;
+	}
+
+	return result;
+}
+
+struct geneie_rope_iter geneie_rope_iter_init(rope_t rope)
+{
+	return (struct geneie_rope_iter) { rope, 0 };
+}
+
+seq_r geneie_rope_iter_next(struct geneie_rope_iter *iter)
+{
+	if (iter->next >= iter->rope.count)
+		return (seq_r) { 0 };
+
+	return iter->rope.pieces[iter->next++].ref;
+}
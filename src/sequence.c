@@ -1,8 +1,21 @@
 #include "geneie/sequence.h"
 
+#include "stats_internal.h"
+
 #include <stdlib.h>
 #include <string.h>
 #include <limits.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+
+#define HUGE_PAGE_SIZE ((size_t)2 * 1024 * 1024)
+
+static atomic_size_t huge_mapped_bytes;
+static atomic_size_t huge_advised_bytes;
+static atomic_size_t huge_fallbacks;
 
 bool geneie_sequence_valid(struct geneie_sequence sequence)
 {
@@ -15,21 +28,123 @@ struct geneie_sequence geneie_sequence_alloc(ssize_t length)
 		return (struct geneie_sequence) { 0 };
 
 	const struct geneie_sequence result = {
-		length,
-		malloc((size_t)length + 1)
+		.length = length,
+		.codes = malloc((size_t)length + 1),
 	};
+	if (!result.codes)
+		return (struct geneie_sequence) { 0 };
+
+	GENEIE_STATS_ALLOCATION((size_t)length + 1);
 	result.codes[length] = '\0';
 	return result;
 }
 
+static size_t round_to_huge_page(size_t size)
+{
+	return (size + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+}
+
+static struct geneie_sequence huge_fallback(ssize_t length)
+{
+	atomic_fetch_add_explicit(&huge_fallbacks, 1, memory_order_relaxed);
+	return geneie_sequence_alloc(length);
+}
+
+struct geneie_sequence geneie_sequence_alloc_huge(ssize_t length)
+{
+	if (length < 0)
+		return (struct geneie_sequence) { 0 };
+
+	// Not worth a whole huge page
+	if ((size_t)length + 1 < HUGE_PAGE_SIZE)
+		return geneie_sequence_alloc(length);
+
+	const size_t size = round_to_huge_page((size_t)length + 1);
+
+	// Over-allocate by one huge page so we can trim the
+	// mapping down to an aligned start
+	char *const raw = mmap(
+		NULL,
+		size + HUGE_PAGE_SIZE,
+		PROT_READ | PROT_WRITE,
+		MAP_PRIVATE | MAP_ANONYMOUS,
+		-1,
+		0
+	);
+	if (raw == MAP_FAILED)
+		return huge_fallback(length);
+
+	char *const aligned = (char *)round_to_huge_page((uintptr_t)raw);
+	const size_t head = (size_t)(aligned - raw);
+	const size_t tail = HUGE_PAGE_SIZE - head;
+	if (head)
+		munmap(raw, head);
+	if (tail)
+		munmap(aligned + size, tail);
+
+	atomic_fetch_add_explicit(&huge_mapped_bytes, size, memory_order_relaxed);
+	GENEIE_STATS_ALLOCATION(size);
+
+#ifdef MADV_HUGEPAGE
+	if (!madvise(aligned, size, MADV_HUGEPAGE))
+		atomic_fetch_add_explicit(&huge_advised_bytes, size, memory_order_relaxed);
+#endif
+
+	// Anonymous mappings are zeroed, so the null
+	// terminator is already there
+	return (struct geneie_sequence) {
+		.length = length,
+		.codes = aligned,
+		.mapping_length = size,
+	};
+}
+
+ssize_t geneie_sequence_huge_backed(struct geneie_sequence sequence)
+{
+	if (!sequence.mapping_length)
+		return 0;
+
+	FILE *smaps = fopen("/proc/self/smaps", "r");
+	if (!smaps)
+		return -1;
+
+	const uintptr_t
+		begin = (uintptr_t)sequence.codes,
+		end = begin + sequence.mapping_length;
+
+	char line[256];
+	bool in_range = false;
+	ssize_t result = 0;
+	while (fgets(line, sizeof(line), smaps)) {
+		uintptr_t vma_begin, vma_end;
+		size_t kilobytes;
+		if (sscanf(line, "%" SCNxPTR "-%" SCNxPTR, &vma_begin, &vma_end) == 2)
+			in_range = vma_begin < end && vma_end > begin;
+		else if (in_range && sscanf(line, "AnonHugePages: %zu kB", &kilobytes) == 1)
+			result += (ssize_t)kilobytes * 1024;
+	}
+
+	fclose(smaps);
+	return result;
+}
+
+struct geneie_sequence_huge_stats geneie_sequence_huge_stats(void)
+{
+	return (struct geneie_sequence_huge_stats) {
+		.mapped_bytes = atomic_load_explicit(&huge_mapped_bytes, memory_order_relaxed),
+		.advised_bytes = atomic_load_explicit(&huge_advised_bytes, memory_order_relaxed),
+		.fallbacks = atomic_load_explicit(&huge_fallbacks, memory_order_relaxed),
+	};
+}
+
 struct geneie_sequence geneie_sequence_from_string(const char *string)
 {
 	const bool valid = geneie_code_nucleic_string_valid(string)
 		|| geneie_code_amino_string_valid(string);
 	if (!valid)
 		return (struct geneie_sequence) {
-			0,
-			NULL,
+			.length = 0,
+			.codes = NULL,
 		};
 
 	const size_t strlen_result = strlen(string);
@@ -61,6 +176,9 @@ struct geneie_sequence geneie_sequence_copy(struct geneie_sequence other)
 
 void geneie_sequence_free(struct geneie_sequence sequence)
 {
-	free(sequence.codes);
+	if (sequence.mapping_length)
+		munmap(sequence.codes, sequence.mapping_length);
+	else
+		free(sequence.codes);
 }
 
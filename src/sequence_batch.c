@@ -0,0 +1,190 @@
+#include "geneie/sequence_batch.h"
+
+#include "geneie/code.h"
+#include "geneie/encoding.h"
+#include "geneie/sequence_tools.h"
+
+#include "stats_internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct geneie_sequence_batch batch_t;
+typedef struct geneie_sequence_ref seq_r;
+
+static const batch_t invalid_batch = { 0 };
+
+batch_t geneie_sequence_batch_alloc(ssize_t sequences, ssize_t codes)
+{
+	if (sequences < 0 || codes < 0)
+		return invalid_batch;
+
+	// Never zero, so every batch has somewhere for
+	// empty sequences to point
+	if (codes == 0)
+		codes = 1;
+
+	batch_t result = {
+		.capacity = sequences,
+		.offsets = malloc(((size_t)sequences + 1) * sizeof(ssize_t)),
+		.codes_capacity = codes,
+		.codes = malloc((size_t)codes),
+	};
+	if (!result.offsets || !result.codes) {
+		geneie_sequence_batch_free(result);
+		return invalid_batch;
+	}
+
+	GENEIE_STATS_ALLOCATION(((size_t)sequences + 1) * sizeof(ssize_t));
+	GENEIE_STATS_ALLOCATION((size_t)codes);
+
+	result.offsets[0] = 0;
+	return result;
+}
+
+bool geneie_sequence_batch_valid(batch_t batch)
+{
+	return batch.offsets != NULL;
+}
+
+void geneie_sequence_batch_free(batch_t batch)
+{
+	free(batch.offsets);
+	free(batch.codes);
+}
+
+void geneie_sequence_batch_clear(batch_t *batch)
+{
+	batch->count = 0;
+}
+
+ssize_t geneie_sequence_batch_length(batch_t batch)
+{
+	return batch.offsets[batch.count];
+}
+
+static bool reserve(batch_t *batch, ssize_t sequences, ssize_t codes)
+{
+	if (batch->count + sequences > batch->capacity) {
+		ssize_t capacity = batch->capacity ? batch->capacity : 16;
+		while (capacity < batch->count + sequences)
+			capacity *= 2;
+
+		ssize_t *const offsets = realloc(
+			batch->offsets,
+			((size_t)capacity + 1) * sizeof(ssize_t)
+		);
+		if (!offsets)
+			return false;
+
+		GENEIE_STATS_ALLOCATION(((size_t)capacity + 1) * sizeof(ssize_t));
+		batch->offsets = offsets;
+		batch->capacity = capacity;
+	}
+
+	const ssize_t length = geneie_sequence_batch_length(*batch);
+	if (length + codes > batch->codes_capacity) {
+		ssize_t capacity = batch->codes_capacity;
+		while (capacity < length + codes)
+			capacity *= 2;
+
+		geneie_code *const new_codes = realloc(batch->codes, (size_t)capacity);
+		if (!new_codes)
+			return false;
+
+		GENEIE_STATS_ALLOCATION((size_t)capacity);
+		batch->codes = new_codes;
+		batch->codes_capacity = capacity;
+	}
+
+	return true;
+}
+
+bool geneie_sequence_batch_append(batch_t *batch, seq_r sequence)
+{
+	if (!geneie_sequence_ref_valid(sequence))
+		return false;
+	if (!reserve(batch, 1, sequence.length))
+		return false;
+
+	const ssize_t start = geneie_sequence_batch_length(*batch);
+	memcpy(batch->codes + start, sequence.codes, (size_t)sequence.length);
+	batch->offsets[++batch->count] = start + sequence.length;
+	return true;
+}
+
+seq_r geneie_sequence_batch_get(batch_t batch, ssize_t index)
+{
+	if (index < 0 || index >= batch.count)
+		return (seq_r) { 0 };
+
+	return (seq_r) {
+		batch.offsets[index + 1] - batch.offsets[index],
+		batch.codes + batch.offsets[index],
+	};
+}
+
+ssize_t geneie_sequence_batch_validate(batch_t batch, bool *results)
+{
+	bool valid_code[256];
+	for (int i = 0; i < 256; i++)
+		valid_code[i] = geneie_code_nucleic_char_valid((char)i);
+
+	ssize_t result = 0;
+	for (ssize_t i = 0; i < batch.count; i++) {
+		const unsigned char
+			*current = (const unsigned char *)batch.codes + batch.offsets[i],
+			*const end = (const unsigned char *)batch.codes + batch.offsets[i + 1];
+
+		// No early exit: valid sequences, the common case,
+		// have to be read to the end anyway
+		bool valid = true;
+		for (; current < end; current++)
+			valid &= valid_code[*current];
+
+		if (results)
+			results[i] = valid;
+		result += valid;
+	}
+
+	return result;
+}
+
+void geneie_sequence_batch_dna_to_premrna(batch_t batch)
+{
+	// Sequences are end to end, so this is one pass
+	geneie_sequence_tools_dna_to_premrna((seq_r) {
+		geneie_sequence_batch_length(batch),
+		batch.codes,
+	});
+}
+
+void geneie_sequence_batch_reverse_complement(batch_t batch)
+{
+	for (ssize_t i = 0; i < batch.count; i++)
+		geneie_sequence_tools_reverse_complement(geneie_sequence_batch_get(batch, i));
+}
+
+bool geneie_sequence_batch_translate(batch_t batch, batch_t *amino_out)
+{
+	geneie_sequence_batch_clear(amino_out);
+
+	// Never more than a third of the total
+	if (!reserve(amino_out, batch.count, geneie_sequence_batch_length(batch) / 3))
+		return false;
+
+	ssize_t written = 0;
+	for (ssize_t i = 0; i < batch.count; i++) {
+		written += geneie_encoding_translate(
+			geneie_sequence_batch_get(batch, i),
+			(seq_r) {
+				amino_out->codes_capacity - written,
+				amino_out->codes + written,
+			}
+		);
+		amino_out->offsets[i + 1] = written;
+	}
+
+	amino_out->count = batch.count;
+	return true;
+}
@@ -0,0 +1,129 @@
+#include "geneie/sequence_builder.h"
+
+#include "geneie/sequence_tools.h"
+
+#include "stats_internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+
+typedef struct geneie_sequence_builder builder_t;
+typedef struct geneie_sequence_ref seq_r;
+
+// Small enough not to matter, big enough to skip the
+// first few doublings
+#define MINIMUM_CAPACITY 64
+
+static const builder_t invalid_builder = { 0 };
+
+builder_t geneie_sequence_builder_alloc(ssize_t capacity)
+{
+	if (capacity < MINIMUM_CAPACITY)
+		capacity = MINIMUM_CAPACITY;
+
+	// One extra for the null terminator added by finish()
+	geneie_code *const codes = malloc((size_t)capacity + 1);
+	if (!codes)
+		return invalid_builder;
+
+	GENEIE_STATS_ALLOCATION((size_t)capacity + 1);
+
+	return (builder_t) {
+		.length = 0,
+		.capacity = capacity,
+		.codes = codes,
+	};
+}
+
+bool geneie_sequence_builder_valid(builder_t builder)
+{
+	return builder.codes != NULL;
+}
+
+bool geneie_sequence_builder_reserve(builder_t *builder, ssize_t extra)
+{
+	if (extra < 0 || builder->length > SSIZE_MAX / 2 - extra)
+		return false;
+
+	const ssize_t required = builder->length + extra;
+	if (required <= builder->capacity)
+		return true;
+
+	ssize_t capacity = builder->capacity;
+	while (capacity < required)
+		capacity *= 2;
+
+	geneie_code *const codes = realloc(builder->codes, (size_t)capacity + 1);
+	if (!codes)
+		return false;
+
+	GENEIE_STATS_ALLOCATION((size_t)capacity + 1);
+
+	builder->codes = codes;
+	builder->capacity = capacity;
+	return true;
+}
+
+bool geneie_sequence_builder_append(builder_t *builder, seq_r reference)
+{
+	if (!geneie_sequence_ref_valid(reference))
+		return false;
+	if (!geneie_sequence_builder_reserve(builder, reference.length))
+		return false;
+
+	memcpy(
+		&builder->codes[builder->length],
+		reference.codes,
+		(size_t)reference.length
+	);
+	builder->length += reference.length;
+	return true;
+}
+
+bool geneie_sequence_builder_append_clean(builder_t *builder, seq_r reference)
+{
+	const ssize_t start = builder->length;
+	if (!geneie_sequence_builder_append(builder, reference))
+		return false;
+
+	const seq_r appended = {
+		builder->length - start,
+		&builder->codes[start],
+	};
+	builder->length = start
+		+ geneie_sequence_tools_clean_whitespace(appended).length;
+	return true;
+}
+
+seq_r geneie_sequence_builder_ref(builder_t builder)
+{
+	return (seq_r) {
+		builder.length,
+		builder.codes,
+	};
+}
+
+struct geneie_sequence geneie_sequence_builder_finish(builder_t builder)
+{
+	if (!geneie_sequence_builder_valid(builder))
+		return (struct geneie_sequence) { 0 };
+
+	// If shrinking fails, the larger buffer is still fine
+	geneie_code *codes = realloc(builder.codes, (size_t)builder.length + 1);
+	if (codes)
+		GENEIE_STATS_ALLOCATION((size_t)builder.length + 1);
+	else
+		codes = builder.codes;
+
+	codes[builder.length] = '\0';
+	return (struct geneie_sequence) {
+		.length = builder.length,
+		.codes = codes,
+	};
+}
+
+void geneie_sequence_builder_free(builder_t builder)
+{
+	free(builder.codes);
+}
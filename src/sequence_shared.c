@@ -0,0 +1,123 @@
+#include "geneie/sequence_shared.h"
+
+#include "geneie/sequence_tools.h"
+
+#include "stats_internal.h"
+
+#include <stdlib.h>
+#include <stdatomic.h>
+
+typedef struct geneie_sequence_shared shared_t;
+typedef struct geneie_sequence_ref seq_r;
+
+struct geneie_sequence_shared_owner {
+	atomic_long references;
+	struct geneie_sequence sequence;
+};
+
+static const shared_t invalid_shared = { 0 };
+
+shared_t geneie_sequence_shared_from_sequence(struct geneie_sequence sequence)
+{
+	if (!geneie_sequence_valid(sequence))
+		return invalid_shared;
+
+	struct geneie_sequence_shared_owner *const owner = malloc(sizeof(*owner));
+	if (!owner)
+		return invalid_shared;
+
+	GENEIE_STATS_ALLOCATION(sizeof(*owner));
+
+	atomic_init(&owner->references, 1);
+	owner->sequence = sequence;
+	return (shared_t) { owner };
+}
+
+shared_t geneie_sequence_shared_from_ref(seq_r reference)
+{
+	struct geneie_sequence sequence
+		= geneie_sequence_tools_sequence_from_ref(reference);
+	if (!geneie_sequence_valid(sequence))
+		return invalid_shared;
+
+	const shared_t result = geneie_sequence_shared_from_sequence(sequence);
+	if (!geneie_sequence_shared_valid(result))
+		geneie_sequence_free(sequence);
+	return result;
+}
+
+bool geneie_sequence_shared_valid(shared_t shared)
+{
+	return shared.owner != NULL;
+}
+
+shared_t geneie_sequence_shared_share(shared_t shared)
+{
+	if (!geneie_sequence_shared_valid(shared))
+		return invalid_shared;
+
+	atomic_fetch_add_explicit(&shared.owner->references, 1, memory_order_relaxed);
+	return shared;
+}
+
+bool geneie_sequence_shared_unique(shared_t shared)
+{
+	return atomic_load_explicit(
+		&shared.owner->references,
+		memory_order_acquire
+	) == 1;
+}
+
+seq_r geneie_sequence_shared_read(shared_t shared)
+{
+	return geneie_sequence_tools_ref_from_sequence(shared.owner->sequence);
+}
+
+seq_r geneie_sequence_shared_write(shared_t *shared)
+{
+	if (!geneie_sequence_shared_unique(*shared)) {
+		const shared_t copy = geneie_sequence_shared_from_ref(
+			geneie_sequence_shared_read(*shared)
+		);
+		if (!geneie_sequence_shared_valid(copy))
+			return (seq_r) { 0 };
+
+		geneie_sequence_shared_release(*shared);
+		*shared = copy;
+	}
+
+	return geneie_sequence_shared_read(*shared);
+}
+
+bool geneie_sequence_shared_commit(shared_t shared, seq_r result)
+{
+	if (!geneie_sequence_shared_valid(shared)
+		|| !geneie_sequence_shared_unique(shared))
+		return false;
+
+	// Tools only ever shrink the sequence in place
+	struct geneie_sequence *const sequence = &shared.owner->sequence;
+	if (result.codes != sequence->codes
+		|| result.length < 0
+		|| result.length > sequence->length)
+		return false;
+
+	sequence->length = result.length;
+	return true;
+}
+
+void geneie_sequence_shared_release(shared_t shared)
+{
+	if (!geneie_sequence_shared_valid(shared))
+		return;
+
+	if (atomic_fetch_sub_explicit(
+		&shared.owner->references,
+		1,
+		memory_order_acq_rel
+	) != 1)
+		return;
+
+	geneie_sequence_free(shared.owner->sequence);
+	free(shared.owner);
+}
@@ -1,12 +1,16 @@
 #include "geneie/sequence_tools.h"
 
+#include <stdlib.h>
 #include <string.h>
 #include <ctype.h>
+#include <stdint.h>
+#include <stdatomic.h>
 
 #include "geneie/code.h"
 #include "geneie/encoding.h"
 
-#include <libadt/vector.h>
+#include "encoding_internal.h"
+#include "stats_internal.h"
 
 typedef struct geneie_sequence seq;
 typedef struct geneie_sequence_ref seq_r;
@@ -17,45 +21,196 @@ typedef struct geneie_sequence_tools_ref_pair seq_r_pair;
 #define one_codon geneie_encoding_one_codon
 #define valid geneie_sequence_ref_valid
 
-typedef struct libadt_vector vector;
+static const seq invalid_sequence = { 0 };
 
-#define vector_identity libadt_vector_identity
-#define vector_index libadt_vector_index
-#define vector_append libadt_vector_append
-#define vector_vacuum libadt_vector_vacuum
+// Number of regions asked from a batch splicer per call
+#define SPLICE_BATCH 256
 
-static const seq invalid_sequence = { 0 };
+// Codes per chunk for the parallel tools; a whole number
+// of codons
+#define PARALLEL_CHUNK_SIZE (3 * 16 * 1024)
+
+/*
+ * Whitespace, as isspace() sees it in the "C" locale:
+ * space, and \t through \r.
+ */
+static bool is_whitespace(geneie_code code)
+{
+	return code == ' ' || (unsigned char)(code - '\t') <= '\r' - '\t';
+}
+
+/*
+ * The whitespace-cleaning kernels below all compact in-place:
+ * codes are copied down from the read cursor to the write
+ * cursor, skipping whitespace. Blocks are always loaded before
+ * anything is stored over them, and a store never reaches past
+ * the end of the block just loaded, so nothing is overwritten
+ * before it has been read.
+ */
+static geneie_code *clean_whitespace_scalar(
+	geneie_code *write,
+	const geneie_code *read,
+	const geneie_code *end
+)
+{
+	// Branchless: always copy, only advance for non-whitespace
+	for (; read < end; read++) {
+		*write = *read;
+		write += !is_whitespace(*read);
+	}
+	return write;
+}
+
+#if defined(__SSE2__) && defined(__GNUC__)
+#include <immintrin.h>
 
-static seq_r splice_whitespace(seq_r ref, void *_)
-{
-	// The param is unused
-	(void)_;
-	for (; valid(ref); ref = index(ref, 1)) {
-		if (!isspace(ref.codes[0]))
-			continue;
-
-		ssize_t whitespace_length = 0;
-		seq_r result = ref;
-		for (; valid(ref); ref = index(ref, 1)) {
-			if (isspace(ref.codes[0]))
-				whitespace_length++;
-			else
-				break;
+#define HAS_WHITESPACE_KERNELS
+
+static int whitespace_mask_sse2(__m128i block)
+{
+	// \t through \r, via an unsigned range check:
+	// min(x, 4) == x only when x <= 4
+	const __m128i
+		shifted = _mm_sub_epi8(block, _mm_set1_epi8('\t')),
+		in_range = _mm_cmpeq_epi8(
+			_mm_min_epu8(shifted, _mm_set1_epi8('\r' - '\t')),
+			shifted
+		),
+		spaces = _mm_cmpeq_epi8(block, _mm_set1_epi8(' '));
+	return _mm_movemask_epi8(_mm_or_si128(in_range, spaces));
+}
+
+static geneie_code *clean_whitespace_sse2(
+	geneie_code *write,
+	const geneie_code *read,
+	const geneie_code *end
+)
+{
+	for (; end - read >= 16; read += 16) {
+		const __m128i block = _mm_loadu_si128((const __m128i *)read);
+		const int mask = whitespace_mask_sse2(block);
+
+		if (!mask) {
+			if (write != read)
+				_mm_storeu_si128((__m128i *)write, block);
+			write += 16;
+		} else if (mask != 0xFFFF) {
+			write = clean_whitespace_scalar(write, read, read + 16);
 		}
+	}
 
-		return trunc(result, whitespace_length);
+	return clean_whitespace_scalar(write, read, end);
+}
+
+/*
+ * pext gathers the bytes selected by a mask into the low end
+ * of a word, which compacts 8 codes at a time without a loop.
+ */
+__attribute__((target("bmi,bmi2,popcnt")))
+static geneie_code *compress_half_bmi2(
+	geneie_code *write,
+	uint64_t half,
+	unsigned whitespace
+)
+{
+	const unsigned keep = ~whitespace & 0xFF;
+	const uint64_t
+		byte_mask = _pdep_u64(keep, 0x0101010101010101) * 0xFF,
+		codes = _pext_u64(half, byte_mask);
+
+	memcpy(write, &codes, sizeof(codes));
+	return write + _mm_popcnt_u32(keep);
+}
+
+__attribute__((target("bmi,bmi2,popcnt")))
+static geneie_code *clean_whitespace_bmi2(
+	geneie_code *write,
+	const geneie_code *read,
+	const geneie_code *end
+)
+{
+	for (; end - read >= 16; read += 16) {
+		const __m128i block = _mm_loadu_si128((const __m128i *)read);
+		const unsigned mask = (unsigned)whitespace_mask_sse2(block);
+
+		if (!mask) {
+			if (write != read)
+				_mm_storeu_si128((__m128i *)write, block);
+			write += 16;
+		} else if (mask != 0xFFFF) {
+			// Each half stores 8 bytes, so the second store
+			// can't pass the end of this block
+			uint64_t halves[2];
+			memcpy(halves, read, sizeof(halves));
+			write = compress_half_bmi2(write, halves[0], mask & 0xFF);
+			write = compress_half_bmi2(write, halves[1], mask >> 8);
+		}
+	}
+
+	return clean_whitespace_scalar(write, read, end);
+}
+
+__attribute__((target("avx512f,avx512bw,avx512vbmi2")))
+static geneie_code *clean_whitespace_avx512(
+	geneie_code *write,
+	const geneie_code *read,
+	const geneie_code *end
+)
+{
+	const __m512i
+		tab = _mm512_set1_epi8('\t'),
+		range = _mm512_set1_epi8('\r' - '\t'),
+		space = _mm512_set1_epi8(' ');
+
+	for (; end - read >= 64; read += 64) {
+		const __m512i block = _mm512_loadu_si512(read);
+		const __mmask64 whitespace =
+			_mm512_cmple_epu8_mask(_mm512_sub_epi8(block, tab), range)
+			| _mm512_cmpeq_epi8_mask(block, space);
+
+		// Only writes the kept codes, so never past the block
+		_mm512_mask_compressstoreu_epi8(write, ~whitespace, block);
+		write += 64 - __builtin_popcountll(whitespace);
 	}
 
-	return (seq_r) { 0 };
+	return clean_whitespace_scalar(write, read, end);
+}
+
+typedef geneie_code *whitespace_kernel(
+	geneie_code *write,
+	const geneie_code *read,
+	const geneie_code *end
+);
+
+static whitespace_kernel *select_whitespace_kernel(void)
+{
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512vbmi2")
+		&& __builtin_cpu_supports("avx512bw"))
+		return clean_whitespace_avx512;
+	if (__builtin_cpu_supports("bmi2") && __builtin_cpu_supports("popcnt"))
+		return clean_whitespace_bmi2;
+	return clean_whitespace_sse2;
 }
+#endif
 
 seq_r geneie_sequence_tools_clean_whitespace(seq_r reference)
 {
-	return geneie_sequence_tools_splice(
-		reference,
-		splice_whitespace,
-		NULL
-	);
+	if (reference.length <= 0)
+		return reference;
+
+	GENEIE_STATS_ADD(BYTES_PROCESSED, reference.length);
+
+	geneie_code *const start = reference.codes;
+	const geneie_code *const end = start + reference.length;
+
+#ifdef HAS_WHITESPACE_KERNELS
+	geneie_code *const write = select_whitespace_kernel()(start, start, end);
+#else
+	geneie_code *const write = clean_whitespace_scalar(start, start, end);
+#endif
+
+	return trunc(reference, write - start);
 }
 
 seq_r geneie_sequence_tools_ref_from_sequence(seq sequence)
@@ -82,6 +237,9 @@ seq geneie_sequence_tools_sequence_from_ref(seq_r reference)
 
 void geneie_sequence_tools_dna_to_premrna(seq_r reference)
 {
+	if (reference.length > 0)
+		GENEIE_STATS_ADD(BYTES_PROCESSED, reference.length);
+
 	const geneie_code *const end = &reference.codes[reference.length];
 	for (
 		geneie_code *current = reference.codes;
@@ -93,105 +251,281 @@ void geneie_sequence_tools_dna_to_premrna(seq_r reference)
 	}
 }
 
-static vector collect_splices(
-	vector splices,
-	seq_r strand,
-	geneie_sequence_tools_splicer *splicer_func,
-	void *state
-)
+// Codes left out complement to themselves
+static const geneie_code complements[256] = {
+	['A'] = 'T', ['C'] = 'G', ['G'] = 'C', ['T'] = 'A', ['U'] = 'A',
+	['R'] = 'Y', ['Y'] = 'R', ['K'] = 'M', ['M'] = 'K',
+	['B'] = 'V', ['V'] = 'B', ['D'] = 'H', ['H'] = 'D',
+	['a'] = 't', ['c'] = 'g', ['g'] = 'c', ['t'] = 'a', ['u'] = 'a',
+	['r'] = 'y', ['y'] = 'r', ['k'] = 'm', ['m'] = 'k',
+	['b'] = 'v', ['v'] = 'b', ['d'] = 'h', ['h'] = 'd',
+};
+
+static geneie_code complement(geneie_code code)
 {
-	seq_r remaining = strand;
-	seq_r to_splice = { 0 };
-	while ((to_splice = splicer_func(remaining, state)).length) {
-		vector attempt = vector_append(splices, &to_splice);
-		if (vector_identity(attempt, splices)) {
-			// Better error handling somehow?
-			// Currently we just proceed with the
-			// vector that worked
-			break;
-		} else {
-			splices = attempt;
-		}
+	const geneie_code result = complements[(unsigned char)code];
+	return result ? result : code;
+}
 
-		const ssize_t start = to_splice.codes - remaining.codes;
-		remaining = index(
-			remaining,
-			start + to_splice.length
-		);
+void geneie_sequence_tools_reverse_complement(seq_r reference)
+{
+	if (reference.length <= 0)
+		return;
+
+	GENEIE_STATS_ADD(BYTES_PROCESSED, reference.length);
+
+	geneie_code
+		*start = reference.codes,
+		*end = reference.codes + reference.length - 1;
+
+	for (; start < end; start++, end--) {
+		const geneie_code swap = complement(*start);
+		*start = complement(*end);
+		*end = swap;
 	}
-	return splices;
+	if (start == end)
+		*start = complement(*start);
 }
 
-static void perform_move(seq_r from, seq_r to)
+static void premrna_chunk(seq_r chunk, ssize_t offset, void *param)
 {
-	memmove(to.codes, from.codes, (size_t)from.length);
+	(void)offset;
+	(void)param;
+	geneie_sequence_tools_dna_to_premrna(chunk);
 }
 
-static seq_r perform_moves(seq_r strand, vector splices)
+void geneie_sequence_tools_dna_to_premrna_parallel(
+	seq_r reference,
+	struct geneie_thread_pool pool
+)
 {
-	seq_r current_destination = *(seq_r*)vector_index(splices, 0);
-	ssize_t spliced = 0;
+	geneie_thread_pool_map(
+		pool,
+		reference,
+		PARALLEL_CHUNK_SIZE,
+		0,
+		premrna_chunk,
+		NULL
+	);
+}
 
-	for (size_t i = 0; i < splices.length - 1; i++) {
-		const seq_r *splice = vector_index(splices, i);
-		const seq_r *next = vector_index(splices, i + 1);
+/*
+ * Removes regions from a strand in a single pass: everything
+ * between the read cursor and the next region is moved down
+ * to the write cursor, and the read cursor skips the region.
+ * The write cursor never passes the read cursor, so the part
+ * of the strand still to be read is never disturbed.
+ */
+typedef struct {
+	geneie_code *write;
+	geneie_code *read;
+	const geneie_code *end;
+} compactor;
 
-		seq_r from_seq_ref = index(*splice, splice->length);
-		ssize_t length = next->codes - from_seq_ref.codes;
-		from_seq_ref = trunc(from_seq_ref, length);
+static compactor compactor_init(seq_r strand)
+{
+	return (compactor) {
+		strand.codes,
+		strand.codes,
+		strand.codes + strand.length,
+	};
+}
 
-		// In principle, we should, but in practice,
-		// we only pass this to perform_move which we
-		// know won't actually _use_ the length
-		// current_destination = trunc(current_destination, length);
+static seq_r compactor_remaining(compactor c)
+{
+	return (seq_r) {
+		c.end - c.read,
+		c.read,
+	};
+}
 
-		perform_move(from_seq_ref, current_destination);
+static bool compactor_remove(compactor *c, seq_r region)
+{
+	// Refuse regions that aren't in what's left of the strand
+	if (region.length <= 0
+		|| region.codes < c->read
+		|| region.length > c->end - region.codes)
+		return false;
+
+	const ssize_t keep = region.codes - c->read;
+	if (c->write != c->read) {
+		memmove(c->write, c->read, (size_t)keep);
+		GENEIE_STATS_ADD(MEMMOVE_BYTES, keep);
+	}
 
-		current_destination = index(
-			current_destination,
-			length
-		);
+	GENEIE_STATS_ADD(SPLICE_REGIONS, 1);
+	c->write += keep;
+	c->read = region.codes + region.length;
+	return true;
+}
 
-		spliced += splice->length;
+static seq_r compactor_finish(compactor c, seq_r strand)
+{
+	const ssize_t keep = c.end - c.read;
+	if (c.write != c.read) {
+		memmove(c.write, c.read, (size_t)keep);
+		GENEIE_STATS_ADD(MEMMOVE_BYTES, keep);
 	}
 
-	/*
-	 * last move is just whatever's left at the end of the
-	 * sequence
-	 */
-	const seq_r *splice = vector_index(splices, splices.length - 1);
-	seq_r from_seq_ref = index(*splice, splice->length);
-	ssize_t length = strand.length - (from_seq_ref.codes - strand.codes);
-	from_seq_ref = trunc(from_seq_ref, length);
+	return trunc(strand, c.write + keep - strand.codes);
+}
 
-	perform_move(from_seq_ref, current_destination);
-	// current_destination = trunc(current_destination, length);
+seq_r geneie_sequence_tools_splice(
+	seq_r strand,
+	geneie_sequence_tools_splicer *splicer_func,
+	void *state
+)
+{
+	if (strand.length <= 0)
+		return strand;
 
-	spliced += splice->length;
+	compactor c = compactor_init(strand);
+	seq_r to_splice = { 0 };
 
-	return trunc(strand, strand.length - spliced);
+	while ((to_splice = splicer_func(compactor_remaining(c), state)).length)
+		if (!compactor_remove(&c, to_splice))
+			break;
+
+	return compactor_finish(c, strand);
 }
 
-seq_r geneie_sequence_tools_splice(
+seq_r geneie_sequence_tools_splice_batch(
 	seq_r strand,
-	geneie_sequence_tools_splicer *splicer_func,
+	geneie_sequence_tools_batch_splicer *splicer_func,
 	void *state
 )
 {
 	if (strand.length <= 0)
 		return strand;
 
-	// 16 picked arbitrarily
-	// how should we handle vector errors in append()?
-	LIBADT_VECTOR_WITH(splices, sizeof(seq_r), 16) {
-		splices = collect_splices(splices, strand, splicer_func, state);
-		if (splices.length == 0)
-			continue;
-		splices = vector_vacuum(splices);
-		strand = perform_moves(strand, splices);
+	compactor c = compactor_init(strand);
+	seq_r regions[SPLICE_BATCH];
+	ssize_t count = 0;
+
+	while ((count = splicer_func(
+		compactor_remaining(c),
+		regions,
+		SPLICE_BATCH,
+		state
+	)) > 0) {
+		for (ssize_t i = 0; i < count; i++)
+			if (!compactor_remove(&c, regions[i]))
+				return compactor_finish(c, strand);
+	}
+
+	return compactor_finish(c, strand);
+}
+
+
+typedef struct geneie_sequence_tools_interval interval;
+
+/*
+ * Checks the intervals and returns how long the strand
+ * will be after splicing, or -1 if they're invalid.
+ */
+static ssize_t spliced_length(
+	seq_r strand,
+	const interval *intervals,
+	ssize_t count,
+	enum geneie_sequence_tools_interval_mode mode
+)
+{
+	if (!valid(strand) || count < 0)
+		return -1;
+
+	ssize_t
+		previous_end = 0,
+		inside = 0;
+	for (ssize_t i = 0; i < count; i++) {
+		const interval current = intervals[i];
+		if (current.start < previous_end
+			|| current.end < current.start
+			|| current.end > strand.length)
+			return -1;
+
+		inside += current.end - current.start;
+		previous_end = current.end;
+	}
+
+	return mode == GENEIE_SEQUENCE_TOOLS_KEEP_INTERVALS ?
+		inside :
+		strand.length - inside;
+}
+
+/*
+ * Copies each kept part of the strand to out, one after
+ * another. out may be the start of the strand itself,
+ * since nothing is ever written past what's been read.
+ */
+static void gather_intervals(
+	seq_r strand,
+	const interval *intervals,
+	ssize_t count,
+	enum geneie_sequence_tools_interval_mode mode,
+	geneie_code *out
+)
+{
+	ssize_t previous_end = 0;
+	for (ssize_t i = 0; i < count; i++) {
+		const interval current = intervals[i];
+		const ssize_t
+			start = mode == GENEIE_SEQUENCE_TOOLS_KEEP_INTERVALS ?
+				current.start :
+				previous_end,
+			end = mode == GENEIE_SEQUENCE_TOOLS_KEEP_INTERVALS ?
+				current.end :
+				current.start;
+
+		if (out != &strand.codes[start]) {
+			memmove(out, &strand.codes[start], (size_t)(end - start));
+			GENEIE_STATS_ADD(MEMMOVE_BYTES, end - start);
+		}
+		out += end - start;
+		previous_end = current.end;
+	}
+
+	if (mode == GENEIE_SEQUENCE_TOOLS_REMOVE_INTERVALS
+		&& out != &strand.codes[previous_end]) {
+		memmove(
+			out,
+			&strand.codes[previous_end],
+			(size_t)(strand.length - previous_end)
+		);
+		GENEIE_STATS_ADD(MEMMOVE_BYTES, strand.length - previous_end);
 	}
 
-	return strand;
+	GENEIE_STATS_ADD(SPLICE_REGIONS, count);
+}
+
+seq_r geneie_sequence_tools_splice_intervals(
+	seq_r strand,
+	const interval *intervals,
+	ssize_t count,
+	enum geneie_sequence_tools_interval_mode mode
+)
+{
+	const ssize_t length = spliced_length(strand, intervals, count, mode);
+	if (length < 0)
+		return (seq_r) { 0 };
+
+	gather_intervals(strand, intervals, count, mode, strand.codes);
+	return trunc(strand, length);
+}
+
+seq_r geneie_sequence_tools_splice_intervals_into(
+	seq_r strand,
+	const interval *intervals,
+	ssize_t count,
+	enum geneie_sequence_tools_interval_mode mode,
+	seq_r destination
+)
+{
+	const ssize_t length = spliced_length(strand, intervals, count, mode);
+	if (length < 0 || !valid(destination) || destination.length < length)
+		return (seq_r) { 0 };
+
+	gather_intervals(strand, intervals, count, mode, destination.codes);
+	return trunc(destination, length);
 }
 
 
@@ -203,7 +537,7 @@ typedef struct {
 static read_result read_one_codon(seq_r strand)
 {
 	read_result result = { 0 };
-	for (ssize_t i = 0; valid(strand) && i < 3;) {
+	for (ssize_t i = 0; strand.length > 0 && i < 3;) {
 		result.codon[i] = *strand.codes;
 		result.bytes_read++;
 		if (!isspace(*strand.codes)) {
@@ -242,8 +576,137 @@ seq_r_pair geneie_sequence_tools_encode(seq_r strand)
 		}
 	}
 
+	GENEIE_STATS_ADD(BYTES_PROCESSED, in);
 	return (seq_r_pair) {
 		{ trunc(strand, out), index(strand, in) },
 	};
 }
 
+struct encoded_chunk {
+	ssize_t encoded;
+	ssize_t consumed;
+	bool stopped;
+};
+
+struct parallel_encode {
+	// One amino acid per codon, PARALLEL_CHUNK_SIZE / 3
+	// for each chunk
+	geneie_code *aminos;
+	struct encoded_chunk *chunks;
+
+	// The first chunk known to stop; later chunks
+	// needn't bother
+	atomic_long first_stop;
+};
+
+static void encode_chunk(seq_r chunk, ssize_t offset, void *param)
+{
+	struct parallel_encode *const encode = param;
+	const ssize_t index = offset / PARALLEL_CHUNK_SIZE;
+	struct encoded_chunk *const result = &encode->chunks[index];
+	geneie_code *const aminos = &encode->aminos[index * (PARALLEL_CHUNK_SIZE / 3)];
+
+	*result = (struct encoded_chunk) { 0 };
+	if (atomic_load_explicit(&encode->first_stop, memory_order_relaxed) < index)
+		return;
+
+	// The codes are left alone, so that a chunk after the
+	// first stop doesn't damage the remaining strand
+	for (ssize_t in = 0; in < chunk.length; in += 3) {
+		const seq_r codon = { chunk.length - in < 3 ? chunk.length - in : 3, chunk.codes + in };
+		const seq_r amino_out = { 1, &aminos[result->encoded] };
+		// Chunks past the first stop are thrown away, so
+		// counting waits until they've been combined
+		if (!geneie_encoding_one_codon_uncounted(codon, amino_out)) {
+			result->stopped = true;
+			break;
+		}
+
+		result->encoded++;
+		result->consumed = in + 3;
+		if (*amino_out.codes == GENEIE_CODE_STOP) {
+			result->stopped = true;
+			break;
+		}
+	}
+
+	if (result->stopped) {
+		long first = atomic_load_explicit(&encode->first_stop, memory_order_relaxed);
+		while (index < first && !atomic_compare_exchange_weak_explicit(
+			&encode->first_stop,
+			&first,
+			index,
+			memory_order_relaxed,
+			memory_order_relaxed
+		))
+			;
+	}
+}
+
+seq_r_pair geneie_sequence_tools_encode_parallel(
+	seq_r strand,
+	struct geneie_thread_pool pool
+)
+{
+	const ssize_t chunks = (strand.length + PARALLEL_CHUNK_SIZE - 1) / PARALLEL_CHUNK_SIZE;
+	if (chunks <= 1)
+		return geneie_sequence_tools_encode(strand);
+
+	struct parallel_encode encode = {
+		.aminos = malloc((size_t)chunks * (PARALLEL_CHUNK_SIZE / 3)),
+		.chunks = malloc((size_t)chunks * sizeof(struct encoded_chunk)),
+	};
+	if (!encode.aminos || !encode.chunks) {
+		free(encode.aminos);
+		free(encode.chunks);
+		return geneie_sequence_tools_encode(strand);
+	}
+
+	GENEIE_STATS_ALLOCATION((size_t)chunks * (PARALLEL_CHUNK_SIZE / 3));
+	GENEIE_STATS_ALLOCATION((size_t)chunks * sizeof(struct encoded_chunk));
+	atomic_init(&encode.first_stop, chunks);
+
+	geneie_thread_pool_map(
+		pool,
+		strand,
+		PARALLEL_CHUNK_SIZE,
+		0,
+		encode_chunk,
+		&encode
+	);
+
+	// Every chunk has been read, so the output can go
+	// over the strand now
+	ssize_t
+		in = 0,
+		out = 0;
+	for (ssize_t i = 0; i < chunks; i++) {
+		const struct encoded_chunk chunk = encode.chunks[i];
+		memcpy(
+			&strand.codes[out],
+			&encode.aminos[i * (PARALLEL_CHUNK_SIZE / 3)],
+			(size_t)chunk.encoded
+		);
+		out += chunk.encoded;
+		in = i * PARALLEL_CHUNK_SIZE + chunk.consumed;
+		if (chunk.stopped)
+			break;
+	}
+
+	free(encode.aminos);
+	free(encode.chunks);
+
+	// Counted as geneie_sequence_tools_encode() would: the
+	// codons kept, then either a stop codon or the codon
+	// that couldn't be translated
+	const bool stopped = out > 0 && strand.codes[out - 1] == GENEIE_CODE_STOP;
+	GENEIE_STATS_ADD(BYTES_PROCESSED, in);
+	GENEIE_STATS_ADD(CODONS_TRANSLATED, out);
+	if (stopped)
+		GENEIE_STATS_ADD(STOP_CODONS, 1);
+	else
+		GENEIE_STATS_ADD(AMBIGUOUS_CODONS, 1);
+	return (seq_r_pair) {
+		{ trunc(strand, out), index(strand, in) },
+	};
+}
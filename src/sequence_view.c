@@ -0,0 +1,228 @@
+#include "geneie/sequence_view.h"
+
+#include "geneie/encoding.h"
+
+#include "stats_internal.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+typedef struct geneie_sequence_view view_t;
+typedef struct geneie_sequence_ref seq_r;
+typedef struct geneie_sequence_tools_interval interval;
+
+#define index geneie_sequence_ref_index
+#define trunc geneie_sequence_ref_trunc
+
+static const view_t invalid_view = { 0 };
+
+static view_t view_alloc(void)
+{
+	const ssize_t capacity = 8;
+	seq_r *const segments = malloc((size_t)capacity * sizeof(seq_r));
+	if (!segments)
+		return invalid_view;
+
+	GENEIE_STATS_ALLOCATION((size_t)capacity * sizeof(seq_r));
+
+	return (view_t) {
+		.capacity = capacity,
+		.segments = segments,
+	};
+}
+
+static bool view_add(view_t *view, seq_r segment)
+{
+	if (segment.length == 0)
+		return true;
+
+	// Extend the previous segment if this one carries on
+	// directly from it
+	if (view->count) {
+		seq_r *const last = &view->segments[view->count - 1];
+		if (last->codes + last->length == segment.codes) {
+			last->length += segment.length;
+			view->length += segment.length;
+			return true;
+		}
+	}
+
+	if (view->count == view->capacity) {
+		const ssize_t capacity = view->capacity * 2;
+		seq_r *const segments = realloc(
+			view->segments,
+			(size_t)capacity * sizeof(seq_r)
+		);
+		if (!segments)
+			return false;
+
+		GENEIE_STATS_ALLOCATION((size_t)capacity * sizeof(seq_r));
+
+		view->segments = segments;
+		view->capacity = capacity;
+	}
+
+	view->segments[view->count++] = segment;
+	view->length += segment.length;
+	return true;
+}
+
+view_t geneie_sequence_view_splice(
+	seq_r strand,
+	geneie_sequence_tools_splicer *splicer_func,
+	void *state
+)
+{
+	if (!geneie_sequence_ref_valid(strand))
+		return invalid_view;
+
+	view_t result = view_alloc();
+	if (!geneie_sequence_view_valid(result))
+		return invalid_view;
+
+	seq_r remaining = strand;
+	seq_r to_splice = { 0 };
+	while (remaining.length > 0
+		&& (to_splice = splicer_func(remaining, state)).length > 0) {
+		const ssize_t start = to_splice.codes - remaining.codes;
+		if (start < 0 || to_splice.length > remaining.length - start)
+			break;
+
+		if (!view_add(&result, trunc(remaining, start)))
+			goto fail;
+		remaining = index(remaining, start + to_splice.length);
+	}
+
+	if (!view_add(&result, remaining))
+		goto fail;
+	return result;
+
+fail:
+	geneie_sequence_view_free(result);
+	return invalid_view;
+}
+
+view_t geneie_sequence_view_splice_intervals(
+	seq_r strand,
+	const interval *intervals,
+	ssize_t count,
+	enum geneie_sequence_tools_interval_mode mode
+)
+{
+	if (!geneie_sequence_ref_valid(strand) || count < 0)
+		return invalid_view;
+
+	view_t result = view_alloc();
+	if (!geneie_sequence_view_valid(result))
+		return invalid_view;
+
+	ssize_t previous_end = 0;
+	for (ssize_t i = 0; i < count; i++) {
+		const interval current = intervals[i];
+		if (current.start < previous_end
+			|| current.end < current.start
+			|| current.end > strand.length)
+			goto fail;
+
+		const seq_r segment = mode == GENEIE_SEQUENCE_TOOLS_KEEP_INTERVALS ?
+			trunc(index(strand, current.start), current.end - current.start) :
+			trunc(index(strand, previous_end), current.start - previous_end);
+		if (!view_add(&result, segment))
+			goto fail;
+
+		previous_end = current.end;
+	}
+
+	if (mode == GENEIE_SEQUENCE_TOOLS_REMOVE_INTERVALS
+		&& !view_add(&result, index(strand, previous_end)))
+		goto fail;
+
+	return result;
+
+fail:
+	geneie_sequence_view_free(result);
+	return invalid_view;
+}
+
+bool geneie_sequence_view_valid(view_t view)
+{
+	return view.segments != NULL;
+}
+
+void geneie_sequence_view_free(view_t view)
+{
+	free(view.segments);
+}
+
+seq_r geneie_sequence_view_copy_into(view_t view, seq_r destination)
+{
+	if (!geneie_sequence_ref_valid(destination) || destination.length < view.length)
+		return (seq_r) { 0 };
+
+	geneie_code *out = destination.codes;
+	for (ssize_t i = 0; i < view.count; i++) {
+		memcpy(out, view.segments[i].codes, (size_t)view.segments[i].length);
+		out += view.segments[i].length;
+	}
+
+	return trunc(destination, view.length);
+}
+
+struct geneie_sequence geneie_sequence_view_to_sequence(view_t view)
+{
+	struct geneie_sequence result = geneie_sequence_alloc(view.length);
+	if (geneie_sequence_valid(result))
+		geneie_sequence_view_copy_into(
+			view,
+			geneie_sequence_tools_ref_from_sequence(result)
+		);
+	return result;
+}
+
+/*
+ * Reads the next three non-whitespace codes from the view,
+ * moving on to the next segment as needed.
+ */
+typedef struct {
+	ssize_t segment;
+	seq_r current;
+} view_cursor;
+
+static bool read_one_codon(const view_t *view, view_cursor *cursor, geneie_code codon[3])
+{
+	for (int i = 0; i < 3;) {
+		while (cursor->current.length == 0) {
+			if (++cursor->segment >= view->count)
+				return false;
+			cursor->current = view->segments[cursor->segment];
+		}
+
+		const geneie_code code = *cursor->current.codes;
+		cursor->current = index(cursor->current, 1);
+		if (!isspace(code))
+			codon[i++] = code;
+	}
+	return true;
+}
+
+seq_r geneie_sequence_view_encode(view_t view, seq_r amino_out)
+{
+	view_cursor cursor = {
+		0,
+		view.count ? view.segments[0] : (seq_r) { 0 },
+	};
+
+	ssize_t out = 0;
+	geneie_code codon[3];
+	while (out < amino_out.length && read_one_codon(&view, &cursor, codon)) {
+		const seq_r codon_ref = { 3, codon };
+		if (!geneie_encoding_one_codon(codon_ref, index(amino_out, out)))
+			break;
+
+		if (amino_out.codes[out++] == GENEIE_CODE_STOP)
+			break;
+	}
+
+	return trunc(amino_out, out);
+}
@@ -0,0 +1,209 @@
+#include "geneie/splice_site.h"
+
+#include <stdbool.h>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+typedef struct geneie_sequence_ref seq_r;
+typedef struct geneie_splice_site_params params_t;
+
+#define index geneie_sequence_ref_index
+#define trunc geneie_sequence_ref_trunc
+
+/*
+ * A dinucleotide to search for, in lower case. The
+ * second code may be either of two alternatives, so
+ * that T and U can both match.
+ */
+typedef struct {
+	char first;
+	char second[2];
+} pair;
+
+#define MAX_PAIRS 3
+
+typedef struct {
+	int count;
+	pair pairs[MAX_PAIRS];
+} pair_set;
+
+static pair_set donor_pairs(unsigned motifs)
+{
+	pair_set result = { 0 };
+	if (motifs & GENEIE_SPLICE_SITE_GT_AG)
+		result.pairs[result.count++] = (pair) { 'g', { 't', 'u' } };
+	if (motifs & GENEIE_SPLICE_SITE_GC_AG)
+		result.pairs[result.count++] = (pair) { 'g', { 'c', 'c' } };
+	if (motifs & GENEIE_SPLICE_SITE_AT_AC)
+		result.pairs[result.count++] = (pair) { 'a', { 't', 'u' } };
+	return result;
+}
+
+static pair_set acceptor_pairs(unsigned motifs)
+{
+	pair_set result = { 0 };
+	if (motifs & (GENEIE_SPLICE_SITE_GT_AG | GENEIE_SPLICE_SITE_GC_AG))
+		result.pairs[result.count++] = (pair) { 'a', { 'g', 'g' } };
+	if (motifs & GENEIE_SPLICE_SITE_AT_AC)
+		result.pairs[result.count++] = (pair) { 'a', { 'c', 'c' } };
+	return result;
+}
+
+static char lower(char code)
+{
+	// Only letters matter here, and this is much
+	// cheaper than tolower()
+	return (char)(code | 0x20);
+}
+
+static bool pair_matches(const pair_set *set, const geneie_code *codes)
+{
+	const char
+		first = lower(codes[0]),
+		second = lower(codes[1]);
+	for (int i = 0; i < set->count; i++) {
+		const pair *p = &set->pairs[i];
+		if (first == p->first
+			&& (second == p->second[0] || second == p->second[1]))
+			return true;
+	}
+	return false;
+}
+
+static ssize_t find_pair(seq_r strand, const pair_set *set)
+{
+	if (set->count == 0)
+		return -1;
+
+	ssize_t i = 0;
+
+#ifdef __SSE2__
+	const __m128i case_bit = _mm_set1_epi8(0x20);
+	__m128i
+		firsts[MAX_PAIRS],
+		seconds_a[MAX_PAIRS],
+		seconds_b[MAX_PAIRS];
+	for (int p = 0; p < set->count; p++) {
+		firsts[p] = _mm_set1_epi8(set->pairs[p].first);
+		seconds_a[p] = _mm_set1_epi8(set->pairs[p].second[0]);
+		seconds_b[p] = _mm_set1_epi8(set->pairs[p].second[1]);
+	}
+
+	// Each block checks the pairs starting at 16 positions,
+	// which needs 17 codes
+	for (; i + 17 <= strand.length; i += 16) {
+		const __m128i
+			current = _mm_or_si128(
+				_mm_loadu_si128((const __m128i *)&strand.codes[i]),
+				case_bit
+			),
+			next = _mm_or_si128(
+				_mm_loadu_si128((const __m128i *)&strand.codes[i + 1]),
+				case_bit
+			);
+
+		__m128i matches = _mm_setzero_si128();
+		for (int p = 0; p < set->count; p++) {
+			const __m128i
+				first = _mm_cmpeq_epi8(current, firsts[p]),
+				second = _mm_or_si128(
+					_mm_cmpeq_epi8(next, seconds_a[p]),
+					_mm_cmpeq_epi8(next, seconds_b[p])
+				);
+			matches = _mm_or_si128(matches, _mm_and_si128(first, second));
+		}
+
+		const int mask = _mm_movemask_epi8(matches);
+		if (mask)
+			return i + __builtin_ctz((unsigned)mask);
+	}
+#endif
+
+	for (; i + 2 <= strand.length; i++)
+		if (pair_matches(set, &strand.codes[i]))
+			return i;
+
+	return -1;
+}
+
+ssize_t geneie_splice_site_find_donor(seq_r strand, unsigned motifs)
+{
+	const pair_set set = donor_pairs(motifs);
+	return find_pair(strand, &set);
+}
+
+ssize_t geneie_splice_site_find_acceptor(seq_r strand, unsigned motifs)
+{
+	const pair_set set = acceptor_pairs(motifs);
+	return find_pair(strand, &set);
+}
+
+/*
+ * A donor site only belongs to one motif, except GT and
+ * GC which share an acceptor anyway, so work out which
+ * acceptors can close the intron it starts.
+ */
+static unsigned donor_motif(const geneie_code *codes, unsigned motifs)
+{
+	const pair_set set = donor_pairs(motifs & GENEIE_SPLICE_SITE_AT_AC);
+	return pair_matches(&set, codes) ?
+		GENEIE_SPLICE_SITE_AT_AC :
+		GENEIE_SPLICE_SITE_GT_AG;
+}
+
+seq_r geneie_splice_site_splicer(seq_r strand, void *param)
+{
+	const params_t *const params = param;
+
+	// Both dinucleotides must fit
+	const ssize_t min_length = params->min_length < 4 ? 4 : params->min_length;
+
+	// Once a motif's acceptor isn't found anywhere up to the
+	// end of the strand, as always happens without a maximum,
+	// its later donors are skipped rather than searching the
+	// same codes again
+	unsigned motifs = params->motifs;
+
+	ssize_t position = 0;
+	for (;;) {
+		const ssize_t found = geneie_splice_site_find_donor(
+			index(strand, position),
+			motifs
+		);
+		if (found < 0)
+			return (seq_r) { 0 };
+
+		const ssize_t donor = position + found;
+		const ssize_t acceptor_start = donor + min_length - 2;
+		if (acceptor_start + 2 > strand.length)
+			return (seq_r) { 0 };
+
+		seq_r window = index(strand, acceptor_start);
+		if (params->max_length > 0) {
+			const ssize_t window_length = params->max_length - min_length + 2;
+			if (window_length < window.length)
+				window = trunc(window, window_length);
+		}
+
+		const unsigned motif = donor_motif(&strand.codes[donor], motifs);
+		const ssize_t acceptor = geneie_splice_site_find_acceptor(window, motif);
+		if (acceptor >= 0)
+			return trunc(
+				index(strand, donor),
+				acceptor_start + acceptor + 2 - donor
+			);
+
+		// GT and GC share the AG acceptor
+		if (acceptor_start + window.length == strand.length) {
+			motifs &= motif == GENEIE_SPLICE_SITE_AT_AC
+				? ~GENEIE_SPLICE_SITE_AT_AC
+				: ~(GENEIE_SPLICE_SITE_GT_AG | GENEIE_SPLICE_SITE_GC_AG);
+			if (!motifs)
+				return (seq_r) { 0 };
+		}
+
+		position = donor + 1;
+	}
+}
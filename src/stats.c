@@ -0,0 +1,174 @@
+#include "geneie/stats.h"
+
+#include "stats_internal.h"
+
+#include <inttypes.h>
+
+#ifdef GENEIE_STATS
+#include <pthread.h>
+#include <stdlib.h>
+
+_Thread_local struct geneie_stats_block *geneie_stats_local
+	__attribute__((tls_model("initial-exec")));
+
+static pthread_mutex_t blocks_lock = PTHREAD_MUTEX_INITIALIZER;
+
+// Every live thread's block, and what exited threads and
+// geneie_stats_reset() have left behind
+static struct geneie_stats_block *blocks;
+static uint64_t
+	retired[GENEIE_STATS_COUNTERS],
+	baseline[GENEIE_STATS_COUNTERS];
+
+static pthread_key_t exit_key;
+static pthread_once_t exit_key_once = PTHREAD_ONCE_INIT;
+static bool have_exit_key;
+
+/*
+ * Folds an exiting thread's counts into the retired totals,
+ * so that its block can be freed.
+ */
+static void retire_block(void *param)
+{
+	struct geneie_stats_block *const block = param;
+
+	pthread_mutex_lock(&blocks_lock);
+	for (
+		struct geneie_stats_block **current = &blocks;
+		*current;
+		current = &(*current)->next
+	) {
+		if (*current == block) {
+			*current = block->next;
+			break;
+		}
+	}
+	for (int i = 0; i < GENEIE_STATS_COUNTERS; i++)
+		retired[i] += atomic_load_explicit(
+			&block->counters[i],
+			memory_order_relaxed
+		);
+	pthread_mutex_unlock(&blocks_lock);
+
+	geneie_stats_local = NULL;
+	free(block);
+}
+
+static void create_exit_key(void)
+{
+	have_exit_key = pthread_key_create(&exit_key, retire_block) == 0;
+}
+
+struct geneie_stats_block *geneie_stats_register(void)
+{
+	pthread_once(&exit_key_once, create_exit_key);
+	if (!have_exit_key)
+		return NULL;
+
+	struct geneie_stats_block *const block = calloc(1, sizeof(*block));
+	if (!block)
+		return NULL;
+
+	if (pthread_setspecific(exit_key, block)) {
+		free(block);
+		return NULL;
+	}
+
+	pthread_mutex_lock(&blocks_lock);
+	block->next = blocks;
+	blocks = block;
+	pthread_mutex_unlock(&blocks_lock);
+
+	geneie_stats_local = block;
+	return block;
+}
+
+// Callers hold blocks_lock
+static void sum_counters(uint64_t *totals)
+{
+	for (int i = 0; i < GENEIE_STATS_COUNTERS; i++)
+		totals[i] = retired[i];
+
+	for (
+		const struct geneie_stats_block *block = blocks;
+		block;
+		block = block->next
+	) {
+		for (int i = 0; i < GENEIE_STATS_COUNTERS; i++)
+			totals[i] += atomic_load_explicit(
+				&block->counters[i],
+				memory_order_relaxed
+			);
+	}
+}
+#endif
+
+bool geneie_stats_enabled(void)
+{
+#ifdef GENEIE_STATS
+	return true;
+#else
+	return false;
+#endif
+}
+
+struct geneie_stats geneie_stats_snapshot(void)
+{
+	uint64_t totals[GENEIE_STATS_COUNTERS] = { 0 };
+
+#ifdef GENEIE_STATS
+	pthread_mutex_lock(&blocks_lock);
+	sum_counters(totals);
+	for (int i = 0; i < GENEIE_STATS_COUNTERS; i++)
+		totals[i] -= baseline[i];
+	pthread_mutex_unlock(&blocks_lock);
+#endif
+
+	return (struct geneie_stats) {
+		.bytes_processed = totals[GENEIE_STATS_BYTES_PROCESSED],
+		.codons_translated = totals[GENEIE_STATS_CODONS_TRANSLATED],
+		.ambiguous_codons = totals[GENEIE_STATS_AMBIGUOUS_CODONS],
+		.stop_codons = totals[GENEIE_STATS_STOP_CODONS],
+		.splice_regions = totals[GENEIE_STATS_SPLICE_REGIONS],
+		.memmove_bytes = totals[GENEIE_STATS_MEMMOVE_BYTES],
+		.allocations = totals[GENEIE_STATS_ALLOCATIONS],
+		.allocation_bytes = totals[GENEIE_STATS_ALLOCATION_BYTES],
+	};
+}
+
+void geneie_stats_reset(void)
+{
+#ifdef GENEIE_STATS
+	pthread_mutex_lock(&blocks_lock);
+	sum_counters(baseline);
+	pthread_mutex_unlock(&blocks_lock);
+#endif
+}
+
+bool geneie_stats_write(struct geneie_stats stats, FILE *file)
+{
+	const struct {
+		const char *name;
+		uint64_t value;
+	} counters[] = {
+		{ "bytes_processed", stats.bytes_processed },
+		{ "codons_translated", stats.codons_translated },
+		{ "ambiguous_codons", stats.ambiguous_codons },
+		{ "stop_codons", stats.stop_codons },
+		{ "splice_regions", stats.splice_regions },
+		{ "memmove_bytes", stats.memmove_bytes },
+		{ "allocations", stats.allocations },
+		{ "allocation_bytes", stats.allocation_bytes },
+	};
+
+	for (size_t i = 0; i < sizeof(counters) / sizeof(counters[0]); i++)
+		if (fprintf(
+			file,
+			"geneie_%s %" PRIu64 "\n",
+			counters[i].name,
+			counters[i].value
+		) < 0)
+			return false;
+
+	return fflush(file) == 0;
+}
@@ -0,0 +1,70 @@
+#ifndef GENEIE_STATS_INTERNAL_H
+#define GENEIE_STATS_INTERNAL_H
+
+#include "geneie/stats.h"
+
+/*
+ * Counting for the library's own hot paths. Without
+ * GENEIE_STATS, GENEIE_STATS_ADD() expands to nothing and its
+ * arguments aren't evaluated, so counting costs nothing.
+ */
+
+enum geneie_stats_counter {
+	GENEIE_STATS_BYTES_PROCESSED,
+	GENEIE_STATS_CODONS_TRANSLATED,
+	GENEIE_STATS_AMBIGUOUS_CODONS,
+	GENEIE_STATS_STOP_CODONS,
+	GENEIE_STATS_SPLICE_REGIONS,
+	GENEIE_STATS_MEMMOVE_BYTES,
+	GENEIE_STATS_ALLOCATIONS,
+	GENEIE_STATS_ALLOCATION_BYTES,
+	GENEIE_STATS_COUNTERS,
+};
+
+#ifdef GENEIE_STATS
+#include <stdatomic.h>
+
+struct geneie_stats_block {
+	// Only ever written by the thread owning the block;
+	// atomic so that snapshots can read them
+	atomic_uint_least64_t counters[GENEIE_STATS_COUNTERS];
+	struct geneie_stats_block *next;
+};
+
+// initial-exec skips the __tls_get_addr() call a shared
+// library would otherwise make on every count
+extern _Thread_local struct geneie_stats_block *geneie_stats_local
+	__attribute__((tls_model("initial-exec")));
+
+struct geneie_stats_block *geneie_stats_register(void);
+
+static inline void geneie_stats_add(
+	enum geneie_stats_counter counter,
+	uint64_t amount
+)
+{
+	struct geneie_stats_block *block = geneie_stats_local;
+	if (!block && !(block = geneie_stats_register()))
+		return;
+
+	// No other thread writes this counter, so a plain
+	// load and store is enough, and much cheaper than
+	// a read-modify-write
+	atomic_uint_least64_t *const value = &block->counters[counter];
+	atomic_store_explicit(
+		value,
+		atomic_load_explicit(value, memory_order_relaxed) + amount,
+		memory_order_relaxed
+	);
+}
+
+#define GENEIE_STATS_ADD(counter, amount) \
+	geneie_stats_add(GENEIE_STATS_##counter, (uint64_t)(amount))
+#else
+#define GENEIE_STATS_ADD(counter, amount) ((void)0)
+#endif
+
+#define GENEIE_STATS_ALLOCATION(bytes) \
+	(GENEIE_STATS_ADD(ALLOCATIONS, 1), GENEIE_STATS_ADD(ALLOCATION_BYTES, bytes))
+
+#endif // GENEIE_STATS_INTERNAL_H
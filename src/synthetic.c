@@ -0,0 +1,500 @@
+#include "geneie/synthetic.h"
+
+#include <math.h>
+#include <limits.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "geneie/sequence_tools.h"
+
+typedef struct geneie_synthetic_rng rng_t;
+typedef struct geneie_synthetic synthetic_t;
+typedef struct geneie_sequence_ref seq_r;
+typedef struct geneie_sequence_tools_interval interval_t;
+
+#define NEVER SSIZE_MAX
+
+static const char ambiguity_codes[] = "RYKMSWBDHV";
+static const char nucleotides[] = "TCAG";
+
+static uint64_t rotate(uint64_t x, int bits)
+{
+	return (x << bits) | (x >> (64 - bits));
+}
+
+static uint64_t splitmix64(uint64_t *state)
+{
+	uint64_t z = (*state += 0x9e3779b97f4a7c15u);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9u;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111ebu;
+	return z ^ (z >> 31);
+}
+
+rng_t geneie_synthetic_rng_init(uint64_t seed, uint64_t stream)
+{
+	// Streams are seeded from unrelated points of the
+	// splitmix64 sequence, as the xoshiro authors suggest
+	uint64_t state = seed;
+	state ^= splitmix64(&(uint64_t) { stream });
+
+	rng_t result;
+	for (int i = 0; i < 4; i++)
+		result.state[i] = splitmix64(&state);
+
+	// The one state xoshiro can't leave
+	if (!(result.state[0] | result.state[1] | result.state[2] | result.state[3]))
+		result.state[0] = 1;
+	return result;
+}
+
+uint64_t geneie_synthetic_rng_next(rng_t *rng)
+{
+	uint64_t *const s = rng->state;
+	const uint64_t result = rotate(s[1] * 5, 7) * 9;
+	const uint64_t t = s[1] << 17;
+
+	s[2] ^= s[0];
+	s[3] ^= s[1];
+	s[1] ^= s[2];
+	s[0] ^= s[3];
+	s[2] ^= t;
+	s[3] = rotate(s[3], 45);
+
+	return result;
+}
+
+uint64_t geneie_synthetic_rng_below(rng_t *rng, uint64_t bound)
+{
+	// Lemire's multiply-and-reject, to avoid modulo bias
+	unsigned __int128 product = (unsigned __int128)geneie_synthetic_rng_next(rng) * bound;
+	uint64_t low = (uint64_t)product;
+	if (low < bound) {
+		const uint64_t threshold = -bound % bound;
+		while (low < threshold) {
+			product = (unsigned __int128)geneie_synthetic_rng_next(rng) * bound;
+			low = (uint64_t)product;
+		}
+	}
+	return (uint64_t)(product >> 64);
+}
+
+double geneie_synthetic_rng_uniform(rng_t *rng)
+{
+	return (double)(geneie_synthetic_rng_next(rng) >> 11) * 0x1.0p-53;
+}
+
+/*
+ * The number of bases before the next event, for events
+ * happening with a given probability per base.
+ */
+static ssize_t gap(rng_t *rng, double rate)
+{
+	if (rate <= 0)
+		return NEVER;
+	if (rate >= 1)
+		return 0;
+
+	const double u = 1 - geneie_synthetic_rng_uniform(rng);
+	const double result = floor(log(u) / log1p(-rate));
+	return result >= (double)NEVER ? NEVER : (ssize_t)result;
+}
+
+/*
+ * A length of at least one, geometrically distributed with
+ * the given mean.
+ */
+static ssize_t run_length(rng_t *rng, ssize_t mean)
+{
+	if (mean <= 1)
+		return 1;
+	return 1 + gap(rng, 1 / (double)mean);
+}
+
+static bool rate_valid(double rate)
+{
+	return rate >= 0 && rate <= 1;
+}
+
+synthetic_t geneie_synthetic_init(
+	struct geneie_synthetic_params params,
+	uint64_t seed,
+	uint64_t stream
+)
+{
+	if (!rate_valid(params.gc_content)
+		|| !rate_valid(params.ambiguity_rate)
+		|| !rate_valid(params.n_run_rate)
+		|| !rate_valid(params.soft_mask_rate)
+		|| params.n_run_length <= 0
+		|| params.soft_mask_length <= 0)
+		return (synthetic_t) { 0 };
+
+	synthetic_t result = {
+		.rng = geneie_synthetic_rng_init(seed, stream),
+		.params = params,
+	};
+	rng_t feature_rng = geneie_synthetic_rng_init(
+		geneie_synthetic_rng_next(&result.rng),
+		stream
+	);
+	result.ambiguity_rng = geneie_synthetic_rng_init(
+		geneie_synthetic_rng_next(&feature_rng),
+		stream
+	);
+	result.n_run_rng = geneie_synthetic_rng_init(
+		geneie_synthetic_rng_next(&feature_rng),
+		stream
+	);
+	result.soft_mask_rng = geneie_synthetic_rng_init(
+		geneie_synthetic_rng_next(&feature_rng),
+		stream
+	);
+
+	// Half of the GC content each for G and C, and half of
+	// the rest each for A and T
+	for (int i = 0; i < 256; i++) {
+		const double u = (i + 0.5) / 256;
+		if (u < params.gc_content / 2)
+			result.bases[i] = 'G';
+		else if (u < params.gc_content)
+			result.bases[i] = 'C';
+		else if (u < params.gc_content + (1 - params.gc_content) / 2)
+			result.bases[i] = 'A';
+		else
+			result.bases[i] = 'T';
+	}
+
+	result.next_ambiguity = gap(&result.ambiguity_rng, params.ambiguity_rate);
+	result.next_n_run = gap(&result.n_run_rng, params.n_run_rate);
+	result.next_soft_mask = gap(&result.soft_mask_rng, params.soft_mask_rate);
+	return result;
+}
+
+bool geneie_synthetic_valid(synthetic_t generator)
+{
+	return generator.bases[0] != '\0';
+}
+
+static void fill_bases(synthetic_t *generator, seq_r out)
+{
+	char *codes = out.codes, *const end = out.codes + out.length;
+
+	// Uses up the bytes left from last time first, so the
+	// output is the same however it's split
+	for (; codes < end && generator->bytes_left; codes++, generator->bytes_left--) {
+		*codes = generator->bases[generator->bits & 0xff];
+		generator->bits >>= 8;
+	}
+
+	for (; end - codes >= 8; codes += 8) {
+		const uint64_t bits = geneie_synthetic_rng_next(&generator->rng);
+		for (int i = 0; i < 8; i++)
+			codes[i] = generator->bases[(bits >> (8 * i)) & 0xff];
+	}
+
+	if (codes < end) {
+		generator->bits = geneie_synthetic_rng_next(&generator->rng);
+		generator->bytes_left = 8;
+		for (; codes < end; codes++, generator->bytes_left--) {
+			*codes = generator->bases[generator->bits & 0xff];
+			generator->bits >>= 8;
+		}
+	}
+}
+
+static void add_ambiguity(synthetic_t *generator, seq_r out)
+{
+	ssize_t position = 0;
+	while (generator->next_ambiguity < out.length - position) {
+		position += generator->next_ambiguity;
+		out.codes[position++] = ambiguity_codes[
+			geneie_synthetic_rng_below(&generator->ambiguity_rng, sizeof(ambiguity_codes) - 1)
+		];
+		generator->next_ambiguity = gap(&generator->ambiguity_rng, generator->params.ambiguity_rate);
+	}
+	generator->next_ambiguity -= out.length - position;
+}
+
+static void set_n(char *codes, ssize_t length)
+{
+	memset(codes, 'N', (size_t)length);
+}
+
+static void soft_mask(char *codes, ssize_t length)
+{
+	// Every code generated is an upper case letter
+	for (ssize_t i = 0; i < length; i++)
+		codes[i] |= 0x20;
+}
+
+/*
+ * Applies runs, such as of N, which may carry on from the
+ * last call, at geometrically-distributed distances.
+ */
+static void add_runs(
+	rng_t *rng,
+	seq_r out,
+	ssize_t *next,
+	ssize_t *left,
+	double rate,
+	ssize_t mean_length,
+	void (*apply)(char *codes, ssize_t length)
+)
+{
+	ssize_t position = 0;
+	while (position < out.length) {
+		if (*left > 0) {
+			ssize_t length = out.length - position;
+			if (length > *left)
+				length = *left;
+
+			apply(out.codes + position, length);
+			position += length;
+			*left -= length;
+			if (*left == 0)
+				*next = gap(rng, rate);
+			continue;
+		}
+
+		if (*next >= out.length - position) {
+			*next -= out.length - position;
+			break;
+		}
+
+		position += *next;
+		*left = run_length(rng, mean_length);
+	}
+}
+
+void geneie_synthetic_fill(synthetic_t *generator, seq_r out)
+{
+	if (out.length <= 0)
+		return;
+
+	const struct geneie_synthetic_params *const params = &generator->params;
+
+	fill_bases(generator, out);
+	add_ambiguity(generator, out);
+	add_runs(
+		&generator->n_run_rng,
+		out,
+		&generator->next_n_run,
+		&generator->n_run_left,
+		params->n_run_rate,
+		params->n_run_length,
+		set_n
+	);
+	add_runs(
+		&generator->soft_mask_rng,
+		out,
+		&generator->next_soft_mask,
+		&generator->soft_mask_left,
+		params->soft_mask_rate,
+		params->soft_mask_length,
+		soft_mask
+	);
+}
+
+/*
+ * Uniform between half and one and a half times the mean.
+ */
+static ssize_t spread(rng_t *rng, ssize_t mean, ssize_t minimum)
+{
+	const ssize_t low = mean / 2;
+	const ssize_t result = low + (ssize_t)geneie_synthetic_rng_below(rng, (uint64_t)mean + 1);
+	return result < minimum ? minimum : result;
+}
+
+/*
+ * Writes codon `index` of a coding sequence with `count`
+ * codons: ATG, then any codons but stops, then a stop.
+ */
+static void write_codon(rng_t *rng, ssize_t index, ssize_t count, char *codon)
+{
+	static const char *const stops[] = { "TAA", "TAG", "TGA" };
+
+	if (index == 0) {
+		memcpy(codon, "ATG", 3);
+	} else if (index == count - 1) {
+		memcpy(codon, stops[geneie_synthetic_rng_below(rng, 3)], 3);
+	} else {
+		// Skips TAA and TAG (10 and 11), then TGA (14)
+		uint64_t code = geneie_synthetic_rng_below(rng, 61);
+		if (code >= 10)
+			code += 2;
+		if (code >= 14)
+			code++;
+
+		codon[0] = nucleotides[code >> 4];
+		codon[1] = nucleotides[(code >> 2) & 3];
+		codon[2] = nucleotides[code & 3];
+	}
+}
+
+ssize_t geneie_synthetic_gene(
+	synthetic_t *generator,
+	struct geneie_synthetic_gene_params params,
+	seq_r out,
+	interval_t *introns
+)
+{
+	if (params.exons < 1 || params.exon_length < 1 || params.intron_length < 1)
+		return -1;
+
+	// The lengths are drawn twice from copies of the same
+	// generator: once to check the gene fits, then again
+	// as it's written
+	const rng_t lengths = geneie_synthetic_rng_init(geneie_synthetic_rng_next(&generator->rng), 0);
+	rng_t sizing = lengths;
+
+	ssize_t coding = 0, total = 0;
+	for (ssize_t i = 0; i < params.exons; i++) {
+		if (i > 0)
+			total += spread(&sizing, params.intron_length, 4);
+		coding += spread(&sizing, params.exon_length, 1);
+	}
+
+	// The last exon makes up whole codons, and there's
+	// always a start and a stop
+	ssize_t padding = (3 - coding % 3) % 3;
+	if (coding + padding < 6)
+		padding = 6 - coding;
+	coding += padding;
+	total += coding;
+
+	if (total > out.length)
+		return -1;
+
+	rng_t writing = lengths;
+	const ssize_t codons = coding / 3;
+	ssize_t position = 0, written = 0;
+	char codon[3];
+
+	for (ssize_t i = 0; i < params.exons; i++) {
+		if (i > 0) {
+			const ssize_t length = spread(&writing, params.intron_length, 4);
+			char *const intron = out.codes + position;
+			memcpy(intron, "GT", 2);
+			geneie_synthetic_fill(generator, (seq_r) { length - 4, intron + 2 });
+			memcpy(intron + length - 2, "AG", 2);
+
+			if (introns)
+				introns[i - 1] = (interval_t) { position, position + length };
+			position += length;
+		}
+
+		ssize_t length = spread(&writing, params.exon_length, 1);
+		if (i == params.exons - 1)
+			length += padding;
+
+		for (ssize_t j = 0; j < length; j++, written++) {
+			if (written % 3 == 0)
+				write_codon(&generator->rng, written / 3, codons, codon);
+			out.codes[position++] = codon[written % 3];
+		}
+	}
+
+	return total;
+}
+
+static bool read_params_valid(struct geneie_synthetic_read_params params)
+{
+	return params.length >= 1
+		&& params.length_deviation >= 0
+		&& params.min_length >= 1
+		&& params.max_length >= 0
+		&& rate_valid(params.error_rate)
+		&& rate_valid(params.reverse_rate);
+}
+
+static ssize_t read_length(rng_t *rng, struct geneie_synthetic_read_params params)
+{
+	if (!params.length_deviation)
+		return params.length;
+
+	// Box-Muller
+	const double
+		u = 1 - geneie_synthetic_rng_uniform(rng),
+		v = geneie_synthetic_rng_uniform(rng),
+		normal = sqrt(-2 * log(u)) * cos(2 * M_PI * v),
+		length = round((double)params.length + normal * (double)params.length_deviation);
+
+	return length < 1 ? 1 : length > (double)SSIZE_MAX ? SSIZE_MAX : (ssize_t)length;
+}
+
+static char substitute(rng_t *rng, char base)
+{
+	// Picks one of the other three, or any for non-bases
+	const char *const found = strchr(nucleotides, base & ~0x20);
+	if (!found || !base)
+		return nucleotides[geneie_synthetic_rng_below(rng, 4)];
+
+	const uint64_t offset = 1 + geneie_synthetic_rng_below(rng, 3);
+	return nucleotides[(uint64_t)(found - nucleotides + offset) % 4];
+}
+
+ssize_t geneie_synthetic_read(
+	synthetic_t *generator,
+	struct geneie_synthetic_read_params params,
+	seq_r source,
+	seq_r out
+)
+{
+	if (!read_params_valid(params) || source.length <= 0 || out.length <= 0)
+		return -1;
+
+	rng_t *const rng = &generator->rng;
+	ssize_t length = read_length(rng, params);
+	if (length < params.min_length)
+		length = params.min_length;
+	if (params.max_length && length > params.max_length)
+		length = params.max_length;
+	if (length > source.length)
+		length = source.length;
+	if (length > out.length)
+		length = out.length;
+
+	const ssize_t start = (ssize_t)geneie_synthetic_rng_below(
+		rng,
+		(uint64_t)(source.length - length + 1)
+	);
+	memcpy(out.codes, source.codes + start, (size_t)length);
+
+	const seq_r read = { length, out.codes };
+	if (geneie_synthetic_rng_uniform(rng) < params.reverse_rate)
+		geneie_sequence_tools_reverse_complement(read);
+
+	ssize_t next = gap(rng, params.error_rate);
+	for (ssize_t i = 0; next < length - i; ) {
+		i += next;
+		read.codes[i] = substitute(rng, read.codes[i]);
+		i++;
+		next = gap(rng, params.error_rate);
+	}
+
+	return length;
+}
+
+ssize_t geneie_synthetic_write_lines(seq_r sequence, ssize_t width, seq_r out)
+{
+	if (sequence.length <= 0)
+		return 0;
+	if (width <= 0)
+		width = sequence.length;
+
+	const ssize_t lines = (sequence.length + width - 1) / width;
+	if (out.length < sequence.length + lines)
+		return -1;
+
+	char *position = out.codes;
+	for (ssize_t start = 0; start < sequence.length; start += width) {
+		ssize_t length = sequence.length - start;
+		if (length > width)
+			length = width;
+
+		memcpy(position, sequence.codes + start, (size_t)length);
+		position += length;
+		*position++ = '\n';
+	}
+	return position - out.codes;
+}
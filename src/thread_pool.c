@@ -0,0 +1,564 @@
+#include "geneie/thread_pool.h"
+
+#include <stdlib.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <pthread.h>
+
+typedef struct geneie_thread_pool pool_t;
+typedef struct geneie_thread_pool_state state_t;
+typedef struct geneie_thread_pool_group group_t;
+typedef struct geneie_sequence_ref seq_r;
+
+// Must be a power of two
+#define DEQUE_CAPACITY 4096
+
+// Parts per thread when parallel_for picks the grain
+#define PARTS_PER_THREAD 8
+
+struct task {
+	geneie_thread_pool_task *function;
+	void *param;
+	group_t *group;
+	struct task *next;
+};
+
+/*
+ * A Chase-Lev work-stealing deque, as described in
+ * "Correct and Efficient Work-Stealing for Weak Memory
+ * Models" (Lê et al., 2013). The owner pushes and takes
+ * at the bottom; thieves steal from the top.
+ */
+struct deque {
+	alignas(64) atomic_long top;
+	alignas(64) atomic_long bottom;
+	_Atomic(struct task *) tasks[DEQUE_CAPACITY];
+};
+
+struct worker {
+	state_t *pool;
+	int index;
+	pthread_t thread;
+	unsigned long random;
+	struct deque deque;
+};
+
+struct geneie_thread_pool_state {
+	int count;
+	struct worker *workers;
+
+	pthread_mutex_t lock;
+	pthread_cond_t wake;
+	bool stopping;
+
+	// Bumped whenever there is something new to look at:
+	// a queued task or a finished group
+	atomic_long epoch;
+	atomic_int sleepers;
+
+	// Tasks queued from outside the pool, under the lock
+	struct task *injected_head;
+	struct task *injected_tail;
+	atomic_long injected_count;
+};
+
+static _Thread_local struct worker *current_worker;
+static _Thread_local unsigned long outside_random = 0x9e3779b97f4a7c15ul;
+
+static struct worker *worker_of(state_t *state)
+{
+	return current_worker && current_worker->pool == state ? current_worker : NULL;
+}
+
+static unsigned long next_random(unsigned long *random)
+{
+	// xorshift64
+	*random ^= *random << 13;
+	*random ^= *random >> 7;
+	*random ^= *random << 17;
+	return *random;
+}
+
+static bool deque_push(struct deque *deque, struct task *task)
+{
+	const long
+		bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed),
+		top = atomic_load_explicit(&deque->top, memory_order_acquire);
+	if (bottom - top >= DEQUE_CAPACITY)
+		return false;
+
+	atomic_store_explicit(
+		&deque->tasks[bottom & (DEQUE_CAPACITY - 1)],
+		task,
+		memory_order_relaxed
+	);
+	atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_release);
+	return true;
+}
+
+static struct task *deque_take(struct deque *deque)
+{
+	const long bottom = atomic_load_explicit(&deque->bottom, memory_order_relaxed) - 1;
+	atomic_store_explicit(&deque->bottom, bottom, memory_order_relaxed);
+	atomic_thread_fence(memory_order_seq_cst);
+	long top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+
+	if (top > bottom) {
+		atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+		return NULL;
+	}
+
+	struct task *result = atomic_load_explicit(
+		&deque->tasks[bottom & (DEQUE_CAPACITY - 1)],
+		memory_order_relaxed
+	);
+	if (top == bottom) {
+		// The last task: race any thieves for it
+		if (!atomic_compare_exchange_strong_explicit(
+			&deque->top,
+			&top,
+			top + 1,
+			memory_order_seq_cst,
+			memory_order_relaxed
+		))
+			result = NULL;
+		atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+	}
+	return result;
+}
+
+static struct task *deque_steal(struct deque *deque)
+{
+	long top = atomic_load_explicit(&deque->top, memory_order_acquire);
+	atomic_thread_fence(memory_order_seq_cst);
+	const long bottom = atomic_load_explicit(&deque->bottom, memory_order_acquire);
+	if (top >= bottom)
+		return NULL;
+
+	struct task *const result = atomic_load_explicit(
+		&deque->tasks[top & (DEQUE_CAPACITY - 1)],
+		memory_order_relaxed
+	);
+	if (!atomic_compare_exchange_strong_explicit(
+		&deque->top,
+		&top,
+		top + 1,
+		memory_order_seq_cst,
+		memory_order_relaxed
+	))
+		return NULL;
+	return result;
+}
+
+static void notify(state_t *state)
+{
+	atomic_fetch_add(&state->epoch, 1);
+	if (atomic_load(&state->sleepers) > 0) {
+		pthread_mutex_lock(&state->lock);
+		pthread_cond_broadcast(&state->wake);
+		pthread_mutex_unlock(&state->lock);
+	}
+}
+
+static void inject(state_t *state, struct task *task)
+{
+	task->next = NULL;
+	pthread_mutex_lock(&state->lock);
+	if (state->injected_tail)
+		state->injected_tail->next = task;
+	else
+		state->injected_head = task;
+	state->injected_tail = task;
+	atomic_fetch_add_explicit(&state->injected_count, 1, memory_order_relaxed);
+	pthread_mutex_unlock(&state->lock);
+}
+
+static struct task *take_injected(state_t *state)
+{
+	if (atomic_load_explicit(&state->injected_count, memory_order_relaxed) == 0)
+		return NULL;
+
+	pthread_mutex_lock(&state->lock);
+	struct task *const result = state->injected_head;
+	if (result) {
+		state->injected_head = result->next;
+		if (!state->injected_head)
+			state->injected_tail = NULL;
+		atomic_fetch_sub_explicit(&state->injected_count, 1, memory_order_relaxed);
+	}
+	pthread_mutex_unlock(&state->lock);
+	return result;
+}
+
+/*
+ * Looks for a task: the newest on our own deque, then
+ * the oldest queued from outside, then the oldest on
+ * another worker's deque, starting from a random one.
+ */
+static struct task *find_task(state_t *state, struct worker *self)
+{
+	struct task *result = NULL;
+	if (self && (result = deque_take(&self->deque)))
+		return result;
+	if ((result = take_injected(state)))
+		return result;
+
+	unsigned long *const random = self ? &self->random : &outside_random;
+	const int start = (int)(next_random(random) % (unsigned long)state->count);
+	for (int i = 0; i < state->count; i++) {
+		struct worker *const victim = &state->workers[(start + i) % state->count];
+		if (victim != self && (result = deque_steal(&victim->deque)))
+			return result;
+	}
+	return NULL;
+}
+
+static void finish_one(group_t *group)
+{
+	// The group may be gone as soon as pending reaches zero
+	state_t *const state = group->pool.state;
+	if (__atomic_sub_fetch(&group->pending, 1, __ATOMIC_ACQ_REL) == 0)
+		notify(state);
+}
+
+static void run_task(struct task *task)
+{
+	group_t *const group = task->group;
+	task->function(task->param);
+	free(task);
+	finish_one(group);
+}
+
+/*
+ * Sleeps until the epoch moves on, the pool stops, or the
+ * group (if any) finishes. Returns false if the pool is
+ * stopping.
+ */
+static bool sleep_until_notified(state_t *state, long epoch, group_t *group)
+{
+	pthread_mutex_lock(&state->lock);
+	atomic_fetch_add(&state->sleepers, 1);
+	while (
+		!state->stopping
+		&& atomic_load(&state->epoch) == epoch
+		&& !(group && __atomic_load_n(&group->pending, __ATOMIC_SEQ_CST) == 0)
+	)
+		pthread_cond_wait(&state->wake, &state->lock);
+	atomic_fetch_sub(&state->sleepers, 1);
+	const bool stopping = state->stopping;
+	pthread_mutex_unlock(&state->lock);
+	return !stopping;
+}
+
+static void *worker_main(void *param)
+{
+	struct worker *const self = param;
+	state_t *const state = self->pool;
+	current_worker = self;
+
+	for (;;) {
+		struct task *task = find_task(state, self);
+		if (!task) {
+			// Look once more after noting the epoch, so a
+			// task queued in between isn't slept through
+			const long epoch = atomic_load(&state->epoch);
+			if (!(task = find_task(state, self))) {
+				if (!sleep_until_notified(state, epoch, NULL))
+					break;
+				continue;
+			}
+		}
+		run_task(task);
+	}
+
+	return NULL;
+}
+
+pool_t geneie_thread_pool_create(int threads)
+{
+	if (threads <= 0) {
+		const long online = sysconf(_SC_NPROCESSORS_ONLN);
+		threads = online > 0 ? (int)online : 1;
+	}
+
+	state_t *const state = calloc(1, sizeof(state_t));
+	if (!state)
+		return (pool_t) { 0 };
+
+	state->workers = calloc((size_t)threads, sizeof(struct worker));
+	if (!state->workers) {
+		free(state);
+		return (pool_t) { 0 };
+	}
+
+	pthread_mutex_init(&state->lock, NULL);
+	pthread_cond_init(&state->wake, NULL);
+
+	// The count must be final before any worker starts
+	// looking for others to steal from
+	state->count = threads;
+	for (int i = 0; i < threads; i++) {
+		struct worker *const worker = &state->workers[i];
+		worker->pool = state;
+		worker->index = i;
+		worker->random = 0x9e3779b97f4a7c15ul * (unsigned long)(i + 1);
+	}
+
+	int started = 0;
+	for (; started < threads; started++) {
+		struct worker *const worker = &state->workers[started];
+		if (pthread_create(&worker->thread, NULL, worker_main, worker))
+			break;
+	}
+
+	const pool_t result = { state };
+	if (started < threads) {
+		// Workers that did start may already be stealing
+		// from the others, so stop them all
+		pthread_mutex_lock(&state->lock);
+		state->stopping = true;
+		pthread_cond_broadcast(&state->wake);
+		pthread_mutex_unlock(&state->lock);
+		for (int i = 0; i < started; i++)
+			pthread_join(state->workers[i].thread, NULL);
+		pthread_cond_destroy(&state->wake);
+		pthread_mutex_destroy(&state->lock);
+		free(state->workers);
+		free(state);
+		return (pool_t) { 0 };
+	}
+
+	return result;
+}
+
+static pool_t default_pool;
+static pthread_once_t default_once = PTHREAD_ONCE_INIT;
+
+static void create_default_pool(void)
+{
+	const long online = sysconf(_SC_NPROCESSORS_ONLN);
+	default_pool = geneie_thread_pool_create(online > 2 ? (int)online - 1 : 1);
+}
+
+pool_t geneie_thread_pool_default(void)
+{
+	pthread_once(&default_once, create_default_pool);
+	return default_pool;
+}
+
+bool geneie_thread_pool_valid(pool_t pool)
+{
+	return pool.state != NULL;
+}
+
+int geneie_thread_pool_size(pool_t pool)
+{
+	return pool.state ? pool.state->count : 0;
+}
+
+void geneie_thread_pool_destroy(pool_t pool)
+{
+	state_t *const state = pool.state;
+	if (!state)
+		return;
+
+	pthread_mutex_lock(&state->lock);
+	state->stopping = true;
+	pthread_cond_broadcast(&state->wake);
+	pthread_mutex_unlock(&state->lock);
+
+	for (int i = 0; i < state->count; i++)
+		pthread_join(state->workers[i].thread, NULL);
+
+	pthread_cond_destroy(&state->wake);
+	pthread_mutex_destroy(&state->lock);
+	free(state->workers);
+	free(state);
+}
+
+void geneie_thread_pool_group_init(group_t *group, pool_t pool)
+{
+	group->pool = pool;
+	__atomic_store_n(&group->pending, 0, __ATOMIC_RELAXED);
+}
+
+void geneie_thread_pool_group_run(
+	group_t *group,
+	geneie_thread_pool_task *function,
+	void *param
+)
+{
+	state_t *const state = group->pool.state;
+	if (!state) {
+		function(param);
+		return;
+	}
+
+	struct task *const task = malloc(sizeof(struct task));
+	if (!task) {
+		function(param);
+		return;
+	}
+
+	*task = (struct task) {
+		.function = function,
+		.param = param,
+		.group = group,
+	};
+	__atomic_add_fetch(&group->pending, 1, __ATOMIC_RELAXED);
+
+	struct worker *const self = worker_of(state);
+	if (!self || !deque_push(&self->deque, task))
+		inject(state, task);
+	notify(state);
+}
+
+void geneie_thread_pool_group_wait(group_t *group)
+{
+	state_t *const state = group->pool.state;
+	if (!state)
+		return;
+
+	struct worker *const self = worker_of(state);
+	while (__atomic_load_n(&group->pending, __ATOMIC_ACQUIRE) > 0) {
+		struct task *task = find_task(state, self);
+		if (!task) {
+			const long epoch = atomic_load(&state->epoch);
+			if (__atomic_load_n(&group->pending, __ATOMIC_SEQ_CST) == 0)
+				break;
+			if (!(task = find_task(state, self))) {
+				sleep_until_notified(state, epoch, group);
+				continue;
+			}
+		}
+		run_task(task);
+	}
+}
+
+struct range {
+	geneie_thread_pool_range_function *function;
+	void *param;
+	group_t *group;
+	ssize_t begin;
+	ssize_t end;
+	ssize_t grain;
+};
+
+static void run_range(struct range *range);
+
+static void run_stolen_range(void *param)
+{
+	run_range(param);
+	free(param);
+}
+
+/*
+ * Splits off the upper half of the range as a new task
+ * until what's left is small enough, then runs it.
+ */
+static void run_range(struct range *range)
+{
+	ssize_t end = range->end;
+	while (end - range->begin > range->grain) {
+		const ssize_t middle = range->begin + (end - range->begin) / 2;
+		struct range *const upper = malloc(sizeof(struct range));
+		if (!upper)
+			break;
+
+		*upper = *range;
+		upper->begin = middle;
+		upper->end = end;
+		geneie_thread_pool_group_run(range->group, run_stolen_range, upper);
+		end = middle;
+	}
+
+	range->function(range->begin, end, range->param);
+}
+
+void geneie_thread_pool_parallel_for(
+	pool_t pool,
+	ssize_t begin,
+	ssize_t end,
+	ssize_t grain,
+	geneie_thread_pool_range_function *function,
+	void *param
+)
+{
+	if (end <= begin)
+		return;
+
+	if (!pool.state) {
+		function(begin, end, param);
+		return;
+	}
+
+	if (grain <= 0) {
+		const ssize_t parts = (ssize_t)(pool.state->count + 1) * PARTS_PER_THREAD;
+		grain = (end - begin) / parts;
+		if (grain < 1)
+			grain = 1;
+	}
+
+	group_t group;
+	geneie_thread_pool_group_init(&group, pool);
+
+	struct range range = {
+		function,
+		param,
+		&group,
+		begin,
+		end,
+		grain,
+	};
+	run_range(&range);
+	geneie_thread_pool_group_wait(&group);
+}
+
+struct map {
+	seq_r ref;
+	ssize_t chunk_size;
+	ssize_t overlap;
+	geneie_thread_pool_chunk_function *function;
+	void *param;
+};
+
+static void map_chunks(ssize_t begin, ssize_t end, void *param)
+{
+	const struct map *const map = param;
+	for (ssize_t i = begin; i < end; i++) {
+		const ssize_t offset = i * map->chunk_size;
+		ssize_t length = map->chunk_size + map->overlap;
+		if (length > map->ref.length - offset)
+			length = map->ref.length - offset;
+
+		const seq_r chunk = {
+			length,
+			map->ref.codes + offset,
+		};
+		map->function(chunk, offset, map->param);
+	}
+}
+
+void geneie_thread_pool_map(
+	pool_t pool,
+	seq_r ref,
+	ssize_t chunk_size,
+	ssize_t overlap,
+	geneie_thread_pool_chunk_function *function,
+	void *param
+)
+{
+	if (chunk_size <= 0 || overlap < 0 || ref.length <= 0)
+		return;
+
+	struct map map = {
+		ref,
+		chunk_size,
+		overlap,
+		function,
+		param,
+	};
+	const ssize_t chunks = (ref.length + chunk_size - 1) / chunk_size;
+	geneie_thread_pool_parallel_for(pool, 0, chunks, 1, map_chunks, &map);
+}
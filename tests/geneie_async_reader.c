@@ -0,0 +1,167 @@
+/*
+ * Geneie - A Library and Tools for gene processing
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_macros.h"
+#include "geneie/async_reader.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+typedef struct geneie_async_reader reader_t;
+typedef struct geneie_sequence_ref ref;
+
+#define BUFFER_SIZE (64 * 1024)
+
+static const enum geneie_async_reader_backend backends[] = {
+	GENEIE_ASYNC_READER_AUTO,
+	GENEIE_ASYNC_READER_IO_URING,
+	GENEIE_ASYNC_READER_THREADS,
+};
+
+static char *write_input(const char *path, ssize_t length)
+{
+	char *const result = malloc((size_t)length + 1);
+	assert(result);
+	for (ssize_t i = 0; i < length; i++)
+		result[i] = (i % 61 == 60) ? '\n' : "ACGT"[(i * 7 + i / 5) % 4];
+
+	FILE *const file = fopen(path, "wb");
+	assert(file);
+	fwrite(result, 1, (size_t)length, file);
+	fclose(file);
+	return result;
+}
+
+static void check_file(ssize_t length, int depth)
+{
+	char path[] = "test_async_reader.txt";
+	char *const input = write_input(path, length);
+
+	for (int i = 0; i < 3; i++) {
+		reader_t reader = geneie_async_reader_open(path, BUFFER_SIZE, depth, backends[i]);
+		if (!geneie_async_reader_valid(reader)) {
+			// io_uring may be missing or forbidden
+			assert(backends[i] == GENEIE_ASYNC_READER_IO_URING);
+			continue;
+		}
+		if (backends[i] != GENEIE_ASYNC_READER_AUTO)
+			assert(geneie_async_reader_backend(reader) == backends[i]);
+
+		ssize_t offset = 0;
+		ref chunk;
+		while (geneie_sequence_ref_valid(chunk = geneie_async_reader_next(reader))) {
+			assert(chunk.length > 0);
+			assert(chunk.length <= BUFFER_SIZE);
+			assert(offset + chunk.length <= length);
+			assert(memcmp(chunk.codes, input + offset, (size_t)chunk.length) == 0);
+
+			// Ours to modify until the next call
+			memset(chunk.codes, 'N', (size_t)chunk.length);
+			offset += chunk.length;
+
+			// Only the last chunk is short
+			assert(chunk.length == BUFFER_SIZE || offset == length);
+		}
+		assert(!geneie_async_reader_failed(reader));
+		assert(offset == length);
+
+		// Stays at the end
+		assert(!geneie_sequence_ref_valid(geneie_async_reader_next(reader)));
+		geneie_async_reader_close(reader);
+	}
+
+	unlink(path);
+	free(input);
+}
+
+void test_read(void)
+{
+	check_file(BUFFER_SIZE * 10 + 123, 4);
+	check_file(BUFFER_SIZE * 3, 2);
+	check_file(100, 8);
+	check_file(0, 1);
+
+	// More buffers than the file needs
+	check_file(BUFFER_SIZE * 2 + 1, 16);
+}
+
+void test_close_early(void)
+{
+	char path[] = "test_async_reader_early.txt";
+	char *const input = write_input(path, BUFFER_SIZE * 20);
+
+	for (int i = 0; i < 3; i++) {
+		reader_t reader = geneie_async_reader_open(path, BUFFER_SIZE, 4, backends[i]);
+		if (!geneie_async_reader_valid(reader))
+			continue;
+
+		ref chunk = geneie_async_reader_next(reader);
+		assert(chunk.length == BUFFER_SIZE);
+		assert(memcmp(chunk.codes, input, BUFFER_SIZE) == 0);
+
+		// With reads still in flight
+		geneie_async_reader_close(reader);
+	}
+
+	unlink(path);
+	free(input);
+}
+
+void test_pipe(void)
+{
+	int fds[2];
+	assert(pipe(fds) == 0);
+	assert(write(fds[1], "ACGT", 4) == 4);
+	close(fds[1]);
+
+	// Pipes can't be read at an offset
+	for (int i = 0; i < 3; i++) {
+		reader_t reader = geneie_async_reader_from_fd(fds[0], BUFFER_SIZE, 2, backends[i]);
+		assert(!geneie_async_reader_valid(reader));
+		assert(errno == ESPIPE);
+	}
+
+	close(fds[0]);
+}
+
+void test_invalid(void)
+{
+	reader_t reader = geneie_async_reader_open(
+		"this/file/does/not/exist",
+		0,
+		0,
+		GENEIE_ASYNC_READER_AUTO
+	);
+	assert(!geneie_async_reader_valid(reader));
+	assert(errno == ENOENT);
+
+	reader = geneie_async_reader_from_fd(0, -1, 0, GENEIE_ASYNC_READER_AUTO);
+	assert(!geneie_async_reader_valid(reader));
+	assert(errno == EINVAL);
+}
+
+int main()
+{
+	test_read();
+	test_close_early();
+	test_pipe();
+	test_invalid();
+}
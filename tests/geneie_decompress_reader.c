@@ -0,0 +1,382 @@
+/*
+ * Geneie - A Library and Tools for gene processing
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_macros.h"
+#include "geneie/decompress_reader.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <zlib.h>
+
+typedef struct geneie_decompress_reader reader_t;
+typedef struct geneie_sequence_ref ref;
+
+// The empty block bgzip writes to mark the end of a file
+static const unsigned char bgzf_eof[] = {
+	0x1f, 0x8b, 0x08, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff,
+	0x06, 0x00, 0x42, 0x43, 0x02, 0x00, 0x1b, 0x00, 0x03, 0x00,
+	0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+};
+
+static char *make_input(ssize_t length)
+{
+	char *const result = malloc((size_t)length);
+	assert(result);
+	srand(1);
+	for (ssize_t i = 0; i < length; i++)
+		result[i] = (i % 61 == 60) ? '\n' : "ACGT"[rand() % 4];
+	return result;
+}
+
+static void put_le(FILE *file, unsigned long value, int bytes)
+{
+	for (int i = 0; i < bytes; i++)
+		fputc((int)((value >> (8 * i)) & 0xff), file);
+}
+
+static void write_gzip_member(FILE *file, const char *data, ssize_t length)
+{
+	z_stream stream = { 0 };
+	assert(deflateInit2(&stream, 6, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY) == Z_OK);
+
+	const uLong bound = deflateBound(&stream, (uLong)length);
+	unsigned char *const output = malloc(bound);
+	stream.next_in = (unsigned char *)data;
+	stream.avail_in = (uInt)length;
+	stream.next_out = output;
+	stream.avail_out = (uInt)bound;
+	assert(deflate(&stream, Z_FINISH) == Z_STREAM_END);
+
+	fwrite(output, 1, stream.total_out, file);
+	deflateEnd(&stream);
+	free(output);
+}
+
+static void write_bgzf_block(FILE *file, const char *data, ssize_t length)
+{
+	z_stream stream = { 0 };
+	assert(deflateInit2(&stream, 6, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) == Z_OK);
+
+	unsigned char output[70000];
+	stream.next_in = (unsigned char *)data;
+	stream.avail_in = (uInt)length;
+	stream.next_out = output;
+	stream.avail_out = sizeof(output);
+	assert(deflate(&stream, Z_FINISH) == Z_STREAM_END);
+
+	const unsigned char header[] = {
+		0x1f, 0x8b, 0x08, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff,
+		0x06, 0x00, 'B', 'C', 0x02, 0x00,
+	};
+	fwrite(header, 1, sizeof(header), file);
+	put_le(file, sizeof(header) + 2 + stream.total_out + 8 - 1, 2);
+	fwrite(output, 1, stream.total_out, file);
+	put_le(file, crc32(0, (const unsigned char *)data, (uInt)length), 4);
+	put_le(file, (unsigned long)length, 4);
+	deflateEnd(&stream);
+}
+
+static void write_bgzf(const char *path, const char *data, ssize_t length)
+{
+	FILE *file = fopen(path, "wb");
+	assert(file);
+	for (ssize_t i = 0; i < length; i += 50000) {
+		const ssize_t amount = length - i < 50000 ? length - i : 50000;
+		write_bgzf_block(file, data + i, amount);
+	}
+	fwrite(bgzf_eof, 1, sizeof(bgzf_eof), file);
+	fclose(file);
+}
+
+/*
+ * Reads everything with geneie_decompress_reader_next()
+ * and checks it against the expected contents.
+ */
+static void check_chunks(reader_t reader, const char *expected, ssize_t length)
+{
+	ssize_t offset = 0;
+	ref chunk;
+	while (geneie_sequence_ref_valid(chunk = geneie_decompress_reader_next(reader))) {
+		assert(chunk.length > 0);
+		assert(offset + chunk.length <= length);
+		assert(!memcmp(chunk.codes, expected + offset, (size_t)chunk.length));
+		offset += chunk.length;
+	}
+	assert(!geneie_decompress_reader_failed(reader));
+	assert(offset == length);
+}
+
+void test_plain(void)
+{
+	char path[] = "test_decompress_plain.txt";
+	const ssize_t length = 3 * 1024 * 1024 + 17;
+	char *const input = make_input(length);
+
+	FILE *file = fopen(path, "wb");
+	fwrite(input, 1, (size_t)length, file);
+	fclose(file);
+
+	reader_t reader = geneie_decompress_reader_open(path, geneie_thread_pool_default());
+	assert(geneie_decompress_reader_valid(reader));
+	assert(geneie_decompress_reader_format(reader) == GENEIE_DECOMPRESS_PLAIN);
+	check_chunks(reader, input, length);
+	geneie_decompress_reader_close(reader);
+
+	unlink(path);
+	free(input);
+}
+
+void test_gzip(void)
+{
+	char path[] = "test_decompress.gz";
+	const ssize_t length = 2 * 1024 * 1024 + 5;
+	char *const input = make_input(length);
+
+	// Two members, as from `cat a.gz b.gz`
+	FILE *file = fopen(path, "wb");
+	write_gzip_member(file, input, 1000);
+	write_gzip_member(file, input + 1000, length - 1000);
+	fclose(file);
+
+	reader_t reader = geneie_decompress_reader_open(path, geneie_thread_pool_default());
+	assert(geneie_decompress_reader_valid(reader));
+	assert(geneie_decompress_reader_format(reader) == GENEIE_DECOMPRESS_GZIP);
+	check_chunks(reader, input, length);
+	geneie_decompress_reader_close(reader);
+
+	unlink(path);
+	free(input);
+}
+
+void test_bgzf(void)
+{
+	char path[] = "test_decompress.bgz";
+	const ssize_t length = 5 * 1024 * 1024 + 3;
+	char *const input = make_input(length);
+	write_bgzf(path, input, length);
+
+	for (int threads = 1; threads <= 3; threads++) {
+		struct geneie_thread_pool pool = geneie_thread_pool_create(threads);
+		reader_t reader = geneie_decompress_reader_open(path, pool);
+		assert(geneie_decompress_reader_valid(reader));
+		assert(geneie_decompress_reader_format(reader) == GENEIE_DECOMPRESS_BGZF);
+		check_chunks(reader, input, length);
+		geneie_decompress_reader_close(reader);
+		geneie_thread_pool_destroy(pool);
+	}
+
+	// Two readers sharing the default pool at once
+	reader_t
+		first = geneie_decompress_reader_open(path, geneie_thread_pool_default()),
+		second = geneie_decompress_reader_open(path, geneie_thread_pool_default());
+	check_chunks(first, input, length);
+	check_chunks(second, input, length);
+	geneie_decompress_reader_close(first);
+	geneie_decompress_reader_close(second);
+
+	// Closing part-way through
+	reader_t reader = geneie_decompress_reader_open(path, geneie_thread_pool_default());
+	assert(geneie_sequence_ref_valid(geneie_decompress_reader_next(reader)));
+	geneie_decompress_reader_close(reader);
+
+	unlink(path);
+	free(input);
+}
+
+void test_read(void)
+{
+	char path[] = "test_decompress_read.bgz";
+	const ssize_t length = 300001;
+	char *const input = make_input(length);
+	write_bgzf(path, input, length);
+
+	char *const output = malloc((size_t)length);
+	reader_t reader = geneie_decompress_reader_open(path, geneie_thread_pool_default());
+
+	// Odd sizes, so reads straddle blocks
+	ssize_t offset = 0, got;
+	while ((got = geneie_decompress_reader_read(reader, output + offset, 7777 < length - offset ? 7777 : length - offset)) > 0)
+		offset += got;
+	assert(got == 0);
+	assert(offset == length);
+	assert(!memcmp(output, input, (size_t)length));
+	assert(geneie_decompress_reader_read(reader, output, 10) == 0);
+
+	geneie_decompress_reader_close(reader);
+	unlink(path);
+	free(output);
+	free(input);
+}
+
+void test_corrupt(void)
+{
+	char path[] = "test_decompress_corrupt.bgz";
+	const ssize_t length = 200000;
+	char *const input = make_input(length);
+	write_bgzf(path, input, length);
+
+	// Break the checksum of the second block
+	FILE *file = fopen(path, "r+b");
+	unsigned char header[18];
+	assert(fread(header, 1, sizeof(header), file) == sizeof(header));
+	const long first_size = (header[16] | header[17] << 8) + 1;
+	fseek(file, first_size, SEEK_SET);
+	assert(fread(header, 1, sizeof(header), file) == sizeof(header));
+	const long second_size = (header[16] | header[17] << 8) + 1;
+	fseek(file, first_size + second_size - 8, SEEK_SET);
+	fputc(0, file);
+	fputc(0, file);
+	fclose(file);
+
+	reader_t reader = geneie_decompress_reader_open(path, geneie_thread_pool_default());
+	assert(geneie_decompress_reader_valid(reader));
+	while (geneie_sequence_ref_valid(geneie_decompress_reader_next(reader)))
+		;
+	assert(geneie_decompress_reader_failed(reader));
+	geneie_decompress_reader_close(reader);
+
+	unlink(path);
+	free(input);
+}
+
+void test_truncated_gzip(void)
+{
+	char path[] = "test_decompress_truncated.gz";
+	const ssize_t length = 100000;
+	char *const input = make_input(length);
+
+	FILE *file = fopen(path, "wb");
+	write_gzip_member(file, input, length);
+	fclose(file);
+	assert(truncate(path, 1000) == 0);
+
+	reader_t reader = geneie_decompress_reader_open(path, geneie_thread_pool_default());
+	assert(geneie_decompress_reader_valid(reader));
+	while (geneie_sequence_ref_valid(geneie_decompress_reader_next(reader)))
+		;
+	assert(geneie_decompress_reader_failed(reader));
+	geneie_decompress_reader_close(reader);
+
+	unlink(path);
+	free(input);
+}
+
+void test_short_extra_field(void)
+{
+	char path[] = "test_decompress_extra.gz";
+	const ssize_t length = 100000;
+	char *const input = make_input(length);
+
+	z_stream stream = { 0 };
+	assert(deflateInit2(&stream, 6, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) == Z_OK);
+	const uLong bound = deflateBound(&stream, (uLong)length);
+	unsigned char *const output = malloc(bound);
+	stream.next_in = (unsigned char *)input;
+	stream.avail_in = (uInt)length;
+	stream.next_out = output;
+	stream.avail_out = (uInt)bound;
+	assert(deflate(&stream, Z_FINISH) == Z_STREAM_END);
+
+	// A BC subfield claiming two bytes the extra field
+	// doesn't have, so its "block size" would really be
+	// the start of the compressed data
+	const unsigned char header[] = {
+		0x1f, 0x8b, 0x08, 0x04, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff,
+		0x04, 0x00, 'B', 'C', 0x02, 0x00,
+	};
+	FILE *file = fopen(path, "wb");
+	fwrite(header, 1, sizeof(header), file);
+	fwrite(output, 1, stream.total_out, file);
+	put_le(file, crc32(0, (const unsigned char *)input, (uInt)length), 4);
+	put_le(file, (unsigned long)length, 4);
+	fclose(file);
+	deflateEnd(&stream);
+	free(output);
+
+	reader_t reader = geneie_decompress_reader_open(path, geneie_thread_pool_default());
+	assert(geneie_decompress_reader_valid(reader));
+	assert(geneie_decompress_reader_format(reader) == GENEIE_DECOMPRESS_GZIP);
+	check_chunks(reader, input, length);
+	geneie_decompress_reader_close(reader);
+
+	unlink(path);
+	free(input);
+}
+
+void test_from_fd(void)
+{
+	char path[] = "test_decompress_fd.txt";
+	const ssize_t length = 2 * 1024 * 1024 + 5;
+	char *const input = make_input(length);
+
+	FILE *file = fopen(path, "wb");
+	fwrite(input, 1, (size_t)length, file);
+	fclose(file);
+
+	// Read ahead from the start of the file
+	int fd = open(path, O_RDONLY);
+	reader_t reader = geneie_decompress_reader_from_fd(fd, geneie_thread_pool_default());
+	assert(geneie_decompress_reader_valid(reader));
+	check_chunks(reader, input, length);
+	geneie_decompress_reader_close(reader);
+
+	// Or from wherever the caller left it
+	char skipped[17];
+	assert(read(fd, skipped, 17) == 17);
+	reader = geneie_decompress_reader_from_fd(fd, geneie_thread_pool_default());
+	assert(geneie_decompress_reader_valid(reader));
+	check_chunks(reader, input + 17, length - 17);
+	geneie_decompress_reader_close(reader);
+	close(fd);
+
+	// And from a pipe, which can't be read at an offset
+	int pipe_fds[2];
+	assert(pipe(pipe_fds) == 0);
+	assert(write(pipe_fds[1], input, 4096) == 4096);
+	close(pipe_fds[1]);
+	reader = geneie_decompress_reader_from_fd(pipe_fds[0], geneie_thread_pool_default());
+	assert(geneie_decompress_reader_valid(reader));
+	check_chunks(reader, input, 4096);
+	geneie_decompress_reader_close(reader);
+	close(pipe_fds[0]);
+
+	unlink(path);
+	free(input);
+}
+
+void test_missing(void)
+{
+	reader_t reader = geneie_decompress_reader_open("this/file/does/not/exist", geneie_thread_pool_default());
+	assert(!geneie_decompress_reader_valid(reader));
+}
+
+int main()
+{
+	test_plain();
+	test_gzip();
+	test_bgzf();
+	test_read();
+	test_corrupt();
+	test_truncated_gzip();
+	test_short_extra_field();
+	test_from_fd();
+	test_missing();
+}
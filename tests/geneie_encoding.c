@@ -805,6 +805,43 @@ void test_encode_gap(void)
 	assert(!geneie_encoding_one_codon(reference, reference));
 }
 
+void test_translate_codon(void)
+{
+	// The table agrees with the linear search everywhere
+	const char codes[] = "ACGTURYKMSWBDHVNX-Z";
+	const int count = (int)sizeof(codes) - 1;
+	for (int i = 0; i < count * count * count; i++) {
+		geneie_code codon[] = {
+			codes[i / (count * count)],
+			codes[i / count % count],
+			codes[i % count],
+		};
+		geneie_code expected = GENEIE_CODE_MASKED;
+		geneie_encoding_one_codon((ref){ 3, codon }, (ref){ 1, &expected });
+		assert(geneie_encoding_translate_codon(codon) == expected);
+	}
+
+	assert(geneie_encoding_translate_codon("aug") == GENEIE_CODE_METHIONINE);
+	assert(geneie_encoding_translate_codon("tAa") == GENEIE_CODE_STOP);
+}
+
+void test_translate(void)
+{
+	geneie_code strand[] = "AUGUAAUUNGGGCA";
+	const ssize_t written = geneie_encoding_translate(ref(strand), ref(strand));
+
+	// Carries on past the stop and the ambiguous codon,
+	// and ignores the trailing part-codon
+	assert(written == 4);
+	assert(strand[0] == GENEIE_CODE_METHIONINE);
+	assert(strand[1] == GENEIE_CODE_STOP);
+	assert(strand[2] == GENEIE_CODE_MASKED);
+	assert(strand[3] == GENEIE_CODE_GLYCINE);
+
+	geneie_code small[2];
+	assert(geneie_encoding_translate(ref("AUGAUGAUG"), (ref){ 2, small }) == 2);
+}
+
 int main()
 {
 	test_a();
@@ -843,4 +880,7 @@ int main()
 	test_encode_e();
 	test_encode_g();
 	test_encode_gap();
+
+	test_translate_codon();
+	test_translate();
 }
@@ -0,0 +1,133 @@
+/*
+ * Geneie - A Library and Tools for gene processing
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_macros.h"
+#include "geneie/fasta.h"
+
+#include <string.h>
+
+#define ref_from_literal geneie_sequence_ref_from_literal
+
+typedef struct geneie_fasta_reader reader_t;
+typedef struct geneie_fasta_record record_t;
+typedef struct geneie_sequence_ref ref;
+
+static bool header_equal(record_t record, const char *expected)
+{
+	return record.header_length == (ssize_t)strlen(expected)
+		&& !memcmp(record.header, expected, strlen(expected));
+}
+
+void test_records(void)
+{
+	char buffer[] =
+		">first sequence\n"
+		"ACGT\n"
+		"AC\n"
+		">second\r\n"
+		"GG\r\n"
+		"UU\r\n"
+		">empty\n"
+		">last\n"
+		"AAA";
+
+	reader_t reader = geneie_fasta_reader_init(buffer, sizeof(buffer) - 1, true);
+	record_t record;
+
+	assert(geneie_fasta_reader_next(&reader, &record));
+	assert(header_equal(record, "first sequence"));
+	assert(geneie_sequence_ref_equal(record.sequence, ref_from_literal("ACGTAC")));
+
+	assert(geneie_fasta_reader_next(&reader, &record));
+	assert(header_equal(record, "second"));
+	assert(geneie_sequence_ref_equal(record.sequence, ref_from_literal("GGUU")));
+
+	assert(geneie_fasta_reader_next(&reader, &record));
+	assert(header_equal(record, "empty"));
+	assert(record.sequence.length == 0);
+
+	assert(geneie_fasta_reader_next(&reader, &record));
+	assert(header_equal(record, "last"));
+	assert(geneie_sequence_ref_equal(record.sequence, ref_from_literal("AAA")));
+
+	assert(!geneie_fasta_reader_next(&reader, &record));
+	assert(geneie_fasta_reader_remaining(reader).length == 0);
+}
+
+void test_leading_junk(void)
+{
+	char buffer[] = "\n; comment > here\n>one\nAC\n";
+
+	reader_t reader = geneie_fasta_reader_init(buffer, sizeof(buffer) - 1, true);
+	record_t record;
+
+	assert(geneie_fasta_reader_next(&reader, &record));
+	assert(header_equal(record, "one"));
+	assert(geneie_sequence_ref_equal(record.sequence, ref_from_literal("AC")));
+	assert(!geneie_fasta_reader_next(&reader, &record));
+}
+
+void test_chunks(void)
+{
+	const char input[] = ">a\nACGT\nAC\n>b\nGGGG\n>c\nU\n";
+	const ssize_t input_length = sizeof(input) - 1;
+
+	// Feed the input through a small buffer, a few bytes at a time
+	char buffer[16];
+	ssize_t kept = 0, offset = 0;
+	char sequences[3][8] = { { 0 } };
+	int count = 0;
+
+	for (;;) {
+		ssize_t got = (ssize_t)sizeof(buffer) - kept;
+		if (got > 5)
+			got = 5;
+		if (got > input_length - offset)
+			got = input_length - offset;
+		memcpy(buffer + kept, input + offset, (size_t)got);
+		offset += got;
+
+		reader_t reader = geneie_fasta_reader_init(buffer, kept + got, got == 0);
+		record_t record;
+		while (geneie_fasta_reader_next(&reader, &record)) {
+			assert(count < 3);
+			assert(record.header_length == 1);
+			assert(*record.header == "abc"[count]);
+			memcpy(sequences[count++], record.sequence.codes, (size_t)record.sequence.length);
+		}
+
+		if (got == 0)
+			break;
+
+		ref rest = geneie_fasta_reader_remaining(reader);
+		memmove(buffer, rest.codes, (size_t)rest.length);
+		kept = rest.length;
+	}
+
+	assert(count == 3);
+	assert(!strcmp(sequences[0], "ACGTAC"));
+	assert(!strcmp(sequences[1], "GGGG"));
+	assert(!strcmp(sequences[2], "U"));
+}
+
+int main()
+{
+	test_records();
+	test_leading_junk();
+	test_chunks();
+}
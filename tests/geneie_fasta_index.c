@@ -0,0 +1,263 @@
+/*
+ * Geneie - A Library and Tools for gene processing
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_macros.h"
+#include "geneie/fasta_index.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ref_from_literal geneie_sequence_ref_from_literal
+
+typedef struct geneie_fasta_index index_t;
+typedef struct geneie_fasta_index_entry entry_t;
+typedef struct geneie_sequence_ref ref;
+
+static const char fasta[] =
+	">chr1 first chromosome\n"
+	"ACGTA\n"
+	"CGTAC\n"
+	"GT\n"
+	">chr2\r\n"
+	"UUUGG\r\n"
+	"CC\r\n"
+	">empty\n"
+	">chr3\n"
+	"AAAAA\n"
+	"\n";
+
+void test_build(void)
+{
+	index_t index = geneie_fasta_index_build(fasta, sizeof(fasta) - 1);
+	assert(geneie_fasta_index_valid(index));
+	assert(index.count == 4);
+
+	const entry_t *chr1 = geneie_fasta_index_find(index, "chr1");
+	assert(chr1 == &index.entries[0]);
+	assert(!strcmp(chr1->name, "chr1"));
+	assert(chr1->length == 12);
+	assert(chr1->offset == 23);
+	assert(chr1->line_bases == 5);
+	assert(chr1->line_width == 6);
+
+	const entry_t *chr2 = geneie_fasta_index_find(index, "chr2");
+	assert(chr2->length == 7);
+	assert(chr2->line_bases == 5);
+	assert(chr2->line_width == 7);
+
+	const entry_t *empty = geneie_fasta_index_find(index, "empty");
+	assert(empty->length == 0);
+
+	const entry_t *chr3 = geneie_fasta_index_find(index, "chr3");
+	assert(chr3->length == 5);
+
+	assert(!geneie_fasta_index_find(index, "chr4"));
+	geneie_fasta_index_free(index);
+}
+
+void test_build_uneven(void)
+{
+	const char uneven[] = ">a\nACGT\nAC\nACGT\n";
+	index_t index = geneie_fasta_index_build(uneven, sizeof(uneven) - 1);
+	assert(!geneie_fasta_index_valid(index));
+
+	const char longer[] = ">a\nACGT\nACGTA\n";
+	index = geneie_fasta_index_build(longer, sizeof(longer) - 1);
+	assert(!geneie_fasta_index_valid(index));
+}
+
+void test_fetch(void)
+{
+	index_t index = geneie_fasta_index_build(fasta, sizeof(fasta) - 1);
+	const entry_t *chr1 = geneie_fasta_index_find(index, "chr1");
+
+	char buffer[16];
+	const ref destination = geneie_sequence_ref_from_array_unsafe(buffer);
+
+	ref fetched = geneie_fasta_index_fetch_into(chr1, fasta, sizeof(fasta) - 1, 3, 11, destination);
+	assert(geneie_sequence_ref_equal(fetched, ref_from_literal("TACGTACG")));
+
+	fetched = geneie_fasta_index_fetch_into(chr1, fasta, sizeof(fasta) - 1, 0, 12, destination);
+	assert(geneie_sequence_ref_equal(fetched, ref_from_literal("ACGTACGTACGT")));
+
+	fetched = geneie_fasta_index_fetch_into(chr1, fasta, sizeof(fasta) - 1, 4, 4, destination);
+	assert(geneie_sequence_ref_valid(fetched));
+	assert(fetched.length == 0);
+
+	// Out of bounds, and a destination too short
+	fetched = geneie_fasta_index_fetch_into(chr1, fasta, sizeof(fasta) - 1, 10, 13, destination);
+	assert(!geneie_sequence_ref_valid(fetched));
+	fetched = geneie_fasta_index_fetch_into(chr1, fasta, sizeof(fasta) - 1, 0, 12, geneie_sequence_ref_trunc(destination, 4));
+	assert(!geneie_sequence_ref_valid(fetched));
+
+	const entry_t *chr2 = geneie_fasta_index_find(index, "chr2");
+	struct geneie_sequence sequence = geneie_fasta_index_fetch(chr2, fasta, sizeof(fasta) - 1, 2, 7);
+	assert(geneie_sequence_valid(sequence));
+	assert(!strcmp(sequence.codes, "UGGCC"));
+	geneie_sequence_free(sequence);
+
+	// Truncated file
+	sequence = geneie_fasta_index_fetch(chr2, fasta, 40, 2, 7);
+	assert(!geneie_sequence_valid(sequence));
+
+	geneie_fasta_index_free(index);
+}
+
+void test_read_write(void)
+{
+	index_t index = geneie_fasta_index_build(fasta, sizeof(fasta) - 1);
+
+	char buffer[256] = { 0 };
+	FILE *file = fmemopen(buffer, sizeof(buffer), "w");
+	assert(geneie_fasta_index_write(index, file));
+	fclose(file);
+
+	assert(!strcmp(
+		buffer,
+		"chr1\t12\t23\t5\t6\n"
+		"chr2\t7\t45\t5\t7\n"
+		"empty\t0\t63\t0\t0\n"
+		"chr3\t5\t69\t5\t6\n"
+	));
+
+	file = fmemopen(buffer, strlen(buffer), "r");
+	index_t read = geneie_fasta_index_read(file);
+	fclose(file);
+
+	assert(geneie_fasta_index_valid(read));
+	assert(read.count == index.count);
+	for (ssize_t i = 0; i < index.count; i++) {
+		assert(!strcmp(read.entries[i].name, index.entries[i].name));
+		assert(read.entries[i].length == index.entries[i].length);
+		assert(read.entries[i].offset == index.entries[i].offset);
+		assert(read.entries[i].line_bases == index.entries[i].line_bases);
+		assert(read.entries[i].line_width == index.entries[i].line_width);
+	}
+
+	geneie_fasta_index_free(read);
+	geneie_fasta_index_free(index);
+
+	char malformed[] = "chr1\t12\tx\t5\t6\n";
+	file = fmemopen(malformed, strlen(malformed), "r");
+	read = geneie_fasta_index_read(file);
+	fclose(file);
+	assert(!geneie_fasta_index_valid(read));
+}
+
+/*
+ * Writes a record of the given length, wrapped at
+ * `width` codes per line.
+ */
+static char *append_record(char *out, const char *name, ssize_t length, ssize_t width, const char *newline)
+{
+	out += sprintf(out, ">%s%s", name, newline);
+	for (ssize_t i = 0; i < length; i++) {
+		*out++ = "ACGT"[rand() % 4];
+		if (i % width == width - 1 || i == length - 1)
+			out += sprintf(out, "%s", newline);
+	}
+	return out;
+}
+
+static void assert_same(index_t first, index_t second)
+{
+	assert(geneie_fasta_index_valid(first));
+	assert(geneie_fasta_index_valid(second));
+	assert(first.count == second.count);
+	for (ssize_t i = 0; i < first.count; i++) {
+		assert(!strcmp(first.entries[i].name, second.entries[i].name));
+		assert(first.entries[i].length == second.entries[i].length);
+		assert(first.entries[i].offset == second.entries[i].offset);
+		assert(first.entries[i].line_bases == second.entries[i].line_bases);
+		assert(first.entries[i].line_width == second.entries[i].line_width);
+	}
+}
+
+void test_build_parallel(void)
+{
+	char *const data = malloc(32 * 1024 * 1024);
+	char *out = data;
+	srand(1);
+
+	out += sprintf(out, "junk before the first record\n");
+	out = append_record(out, "small", 100, 60, "\n");
+	out = append_record(out, "large", 15 * 1024 * 1024 + 7, 60, "\n");
+	out = append_record(out, "windows", 9 * 1024 * 1024, 70, "\r\n");
+	out += sprintf(out, ">empty\n");
+	for (int i = 0; i < 1000; i++) {
+		char name[16];
+		sprintf(name, "read%d", i);
+		out = append_record(out, name, 150, 80, "\n");
+	}
+	out = append_record(out, "last", 5 * 1024 * 1024, 61, "\n");
+	out += sprintf(out, "\n\n");
+	const ssize_t length = out - data;
+
+	index_t serial = geneie_fasta_index_build(data, length);
+	assert(serial.count == 1005);
+	for (int threads = 1; threads <= 4; threads++) {
+		struct geneie_thread_pool pool = geneie_thread_pool_create(threads);
+		index_t parallel = geneie_fasta_index_build_parallel(data, length, pool);
+		assert_same(serial, parallel);
+		geneie_fasta_index_free(parallel);
+		geneie_thread_pool_destroy(pool);
+	}
+	geneie_fasta_index_free(serial);
+
+	// A short line deep inside the large record, beyond
+	// where the first thread's share of it ends
+	const char *large = strstr(data, ">large\n") + 7;
+	char *const line = (char *)large + 61 * 200000;
+	line[30] = '\n';
+	assert(!geneie_fasta_index_valid(geneie_fasta_index_build(data, length)));
+	assert(!geneie_fasta_index_valid(geneie_fasta_index_build_parallel(data, length, geneie_thread_pool_default())));
+
+	free(data);
+}
+
+void test_duplicate_names(void)
+{
+	// Only the name up to the first space counts
+	const char duplicated[] = ">chr1 first\nACGT\n>chr2\nAC\n>chr1 second\nGG\n";
+	index_t index = geneie_fasta_index_build(duplicated, sizeof(duplicated) - 1);
+	assert(!geneie_fasta_index_valid(index));
+
+	index = geneie_fasta_index_build_parallel(
+		duplicated,
+		sizeof(duplicated) - 1,
+		geneie_thread_pool_default()
+	);
+	assert(!geneie_fasta_index_valid(index));
+
+	char fai[] = "chr1\t4\t12\t4\t5\nchr1\t2\t30\t2\t3\n";
+	FILE *file = fmemopen(fai, strlen(fai), "r");
+	index = geneie_fasta_index_read(file);
+	fclose(file);
+	assert(!geneie_fasta_index_valid(index));
+}
+
+int main()
+{
+	test_build();
+	test_build_uneven();
+	test_fetch();
+	test_read_write();
+	test_build_parallel();
+	test_duplicate_names();
+}
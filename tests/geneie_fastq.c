@@ -0,0 +1,142 @@
+/*
+ * Geneie - A Library and Tools for gene processing
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_macros.h"
+#include "geneie/fastq.h"
+
+#include <string.h>
+
+#define ref_from_literal geneie_sequence_ref_from_literal
+
+typedef struct geneie_fastq_reader reader_t;
+typedef struct geneie_fastq_batch batch_t;
+typedef struct geneie_fastq_record record_t;
+typedef struct geneie_sequence_ref ref;
+
+static bool name_equal(record_t record, const char *expected)
+{
+	return record.name_length == (ssize_t)strlen(expected)
+		&& !memcmp(record.name, expected, strlen(expected));
+}
+
+void test_batch_alloc(void)
+{
+	assert(!geneie_fastq_batch_valid(geneie_fastq_batch_alloc(0)));
+
+	batch_t batch = geneie_fastq_batch_alloc(4);
+	assert(geneie_fastq_batch_valid(batch));
+	assert(batch.count == 0);
+	assert(batch.capacity == 4);
+	geneie_fastq_batch_free(batch);
+}
+
+void test_read_batch(void)
+{
+	char buffer[] =
+		"@read1 extra\n"
+		"ACGT\n"
+		"+\n"
+		"IIII\n"
+		"@read2\r\n"
+		"GG\r\n"
+		"+read2\r\n"
+		"#!\r\n"
+		"\n"
+		"@read3\n"
+		"U\n"
+		"+\n"
+		"I";
+
+	batch_t batch = geneie_fastq_batch_alloc(2);
+	reader_t reader = geneie_fastq_reader_init(buffer, sizeof(buffer) - 1, true);
+
+	assert(geneie_fastq_reader_read_batch(&reader, &batch) == 2);
+	assert(batch.count == 2);
+	assert(name_equal(batch.records[0], "read1 extra"));
+	assert(geneie_sequence_ref_equal(batch.records[0].sequence, ref_from_literal("ACGT")));
+	assert(!memcmp(batch.records[0].quality.codes, "IIII", 4));
+	assert(batch.records[0].quality.length == 4);
+	assert(name_equal(batch.records[1], "read2"));
+	assert(geneie_sequence_ref_equal(batch.records[1].sequence, ref_from_literal("GG")));
+	assert(!memcmp(batch.records[1].quality.codes, "#!", 2));
+
+	assert(geneie_fastq_reader_read_batch(&reader, &batch) == 1);
+	assert(name_equal(batch.records[0], "read3"));
+	assert(geneie_sequence_ref_equal(batch.records[0].sequence, ref_from_literal("U")));
+
+	assert(geneie_fastq_reader_read_batch(&reader, &batch) == 0);
+	assert(geneie_fastq_reader_remaining(reader).length == 0);
+
+	geneie_fastq_batch_free(batch);
+}
+
+void test_malformed(void)
+{
+	batch_t batch = geneie_fastq_batch_alloc(4);
+
+	char no_separator[] = "@a\nAC\nII\nII\n";
+	reader_t reader = geneie_fastq_reader_init(no_separator, sizeof(no_separator) - 1, true);
+	assert(geneie_fastq_reader_read_batch(&reader, &batch) == -1);
+
+	char short_quality[] = "@a\nAC\n+\nII\n@b\nACG\n+\nII\n";
+	reader = geneie_fastq_reader_init(short_quality, sizeof(short_quality) - 1, true);
+	assert(geneie_fastq_reader_read_batch(&reader, &batch) == -1);
+	assert(batch.count == 1);
+	assert(*reader.position == '@');
+	assert(reader.position[1] == 'b');
+
+	char truncated[] = "@a\nAC\n+\n";
+	reader = geneie_fastq_reader_init(truncated, sizeof(truncated) - 1, true);
+	assert(geneie_fastq_reader_read_batch(&reader, &batch) == -1);
+
+	geneie_fastq_batch_free(batch);
+}
+
+void test_chunks(void)
+{
+	char buffer[] = "@a\nAC\n+\nII\n@b\nACG\n+\nIII\n";
+
+	batch_t batch = geneie_fastq_batch_alloc(4);
+
+	// Cut inside the second record's quality line
+	reader_t reader = geneie_fastq_reader_init(buffer, sizeof(buffer) - 3, false);
+	assert(geneie_fastq_reader_read_batch(&reader, &batch) == 1);
+	assert(name_equal(batch.records[0], "a"));
+
+	ref rest = geneie_fastq_reader_remaining(reader);
+	assert(rest.codes == buffer + 11);
+
+	// The whole record, but no final line ending yet
+	reader = geneie_fastq_reader_init(rest.codes, rest.length + 1, false);
+	assert(geneie_fastq_reader_read_batch(&reader, &batch) == 0);
+
+	reader = geneie_fastq_reader_init(rest.codes, rest.length + 2, false);
+	assert(geneie_fastq_reader_read_batch(&reader, &batch) == 1);
+	assert(name_equal(batch.records[0], "b"));
+	assert(geneie_sequence_ref_equal(batch.records[0].sequence, ref_from_literal("ACG")));
+
+	geneie_fastq_batch_free(batch);
+}
+
+int main()
+{
+	test_batch_alloc();
+	test_read_batch();
+	test_malformed();
+	test_chunks();
+}
@@ -0,0 +1,88 @@
+/*
+ * Geneie - A Library and Tools for gene processing
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_macros.h"
+#include "geneie/mapped_file.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+typedef struct geneie_mapped_file mapped_file;
+
+static void write_file(const char *path, const char *contents)
+{
+	FILE *file = fopen(path, "w");
+	assert(file);
+	fputs(contents, file);
+	fclose(file);
+}
+
+void test_open(void)
+{
+	char path[] = "test_mapped_file.txt";
+	write_file(path, "ACGT\n");
+
+	{
+		mapped_file file = geneie_mapped_file_open(path, false);
+		assert(geneie_mapped_file_valid(file));
+		assert(file.length == 5);
+		assert(!memcmp(file.data, "ACGT\n", 5));
+		geneie_mapped_file_close(file);
+	}
+
+	{
+		// Private, so writes don't reach the file
+		mapped_file file = geneie_mapped_file_open(path, true);
+		assert(geneie_mapped_file_valid(file));
+		file.data[0] = 'U';
+		geneie_mapped_file_close(file);
+
+		file = geneie_mapped_file_open(path, false);
+		assert(file.data[0] == 'A');
+		geneie_mapped_file_close(file);
+	}
+
+	unlink(path);
+}
+
+void test_empty(void)
+{
+	char path[] = "test_mapped_file_empty.txt";
+	write_file(path, "");
+
+	mapped_file file = geneie_mapped_file_open(path, true);
+	assert(geneie_mapped_file_valid(file));
+	assert(file.length == 0);
+	geneie_mapped_file_close(file);
+
+	unlink(path);
+}
+
+void test_missing(void)
+{
+	mapped_file file = geneie_mapped_file_open("this/file/does/not/exist", false);
+	assert(!geneie_mapped_file_valid(file));
+}
+
+int main()
+{
+	test_open();
+	test_empty();
+	test_missing();
+}
@@ -0,0 +1,284 @@
+/*
+ * Geneie - A Library and Tools for gene processing
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_macros.h"
+#include "geneie/pipeline.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+
+typedef struct geneie_pipeline pipeline_t;
+typedef struct geneie_pipeline_chunk chunk_t;
+typedef struct geneie_thread_pool pool_t;
+
+#define CHUNK_SIZE 100
+#define INPUT_LENGTH 100000
+
+struct input {
+	const char *data;
+	ssize_t length, position;
+};
+
+struct output {
+	// Each chunk's cleaned contents, by index
+	char *results[INPUT_LENGTH / CHUNK_SIZE + 1];
+	ssize_t lengths[INPUT_LENGTH / CHUNK_SIZE + 1];
+	ssize_t chunks;
+};
+
+static ssize_t read_input(geneie_code *buffer, ssize_t capacity, void *param)
+{
+	struct input *const input = param;
+	ssize_t amount = input->length - input->position;
+	if (amount > capacity)
+		amount = capacity;
+
+	memcpy(buffer, input->data + input->position, (size_t)amount);
+	input->position += amount;
+	return amount;
+}
+
+static bool write_output(chunk_t *chunk, void *param)
+{
+	struct output *const output = param;
+	assert(output->results[chunk->index] == NULL);
+
+	output->results[chunk->index] = malloc((size_t)chunk->data.length);
+	memcpy(output->results[chunk->index], chunk->data.codes, (size_t)chunk->data.length);
+	output->lengths[chunk->index] = chunk->data.length;
+	output->chunks++;
+	return true;
+}
+
+static bool fail_at_ten(chunk_t *chunk, void *param)
+{
+	(void)param;
+	return chunk->index != 10;
+}
+
+static bool count_in_flight(chunk_t *chunk, void *param)
+{
+	(void)chunk;
+	atomic_long *const seen = param;
+	atomic_fetch_add(seen, 1);
+	return true;
+}
+
+static char *make_input(void)
+{
+	char *const input = malloc(INPUT_LENGTH);
+	const char pattern[] = "ACGT TTGA\nCCTA\t";
+	for (ssize_t i = 0; i < INPUT_LENGTH; i++)
+		input[i] = pattern[i % (ssize_t)(sizeof(pattern) - 1)];
+	return input;
+}
+
+static void free_output(struct output *output)
+{
+	for (ssize_t i = 0; i < output->chunks; i++)
+		free(output->results[i]);
+}
+
+void test_create(void)
+{
+	assert(!geneie_pipeline_valid(geneie_pipeline_create(0, 10, geneie_thread_pool_default())));
+	assert(!geneie_pipeline_valid(geneie_pipeline_create(10, 0, geneie_thread_pool_default())));
+
+	pipeline_t pipeline = geneie_pipeline_create(4, 10, geneie_thread_pool_default());
+	assert(geneie_pipeline_valid(pipeline));
+	assert(!geneie_pipeline_add_stage(pipeline, fail_at_ten, NULL, 0));
+	geneie_pipeline_destroy(pipeline);
+}
+
+void test_run(void)
+{
+	char *const data = make_input();
+	pipeline_t pipeline = geneie_pipeline_create(8, CHUNK_SIZE, geneie_thread_pool_default());
+	assert(geneie_pipeline_add_stage(pipeline, geneie_pipeline_stage_clean_whitespace, NULL, 1));
+	assert(geneie_pipeline_add_stage(pipeline, geneie_pipeline_stage_dna_to_premrna, NULL, 3));
+
+	// Runs more than once
+	for (int run = 0; run < 2; run++) {
+		struct input input = { data, INPUT_LENGTH, 0 };
+		struct output *const output = calloc(1, sizeof(struct output));
+		assert(geneie_pipeline_run(pipeline, read_input, &input, write_output, output));
+		assert(output->chunks == INPUT_LENGTH / CHUNK_SIZE);
+
+		ssize_t position = 0;
+		for (ssize_t i = 0; i < output->chunks; i++) {
+			assert(output->results[i]);
+			for (ssize_t j = 0; j < output->lengths[i]; j++) {
+				while (strchr(" \n\t", data[position]))
+					position++;
+				const char expected = data[position] == 'T' ? 'U' : data[position];
+				assert(output->results[i][j] == expected);
+				position++;
+			}
+		}
+		assert(position == INPUT_LENGTH - 1);
+
+		free_output(output);
+		free(output);
+	}
+
+	geneie_pipeline_destroy(pipeline);
+	free(data);
+}
+
+void test_no_stages(void)
+{
+	char *const data = make_input();
+	pipeline_t pipeline = geneie_pipeline_create(1, CHUNK_SIZE, geneie_thread_pool_default());
+
+	struct input input = { data, INPUT_LENGTH, 0 };
+	struct output *const output = calloc(1, sizeof(struct output));
+	assert(geneie_pipeline_run(pipeline, read_input, &input, write_output, output));
+	assert(output->chunks == INPUT_LENGTH / CHUNK_SIZE);
+	assert(memcmp(output->results[5], data + 5 * CHUNK_SIZE, CHUNK_SIZE) == 0);
+
+	free_output(output);
+	free(output);
+	geneie_pipeline_destroy(pipeline);
+	free(data);
+}
+
+void test_failure(void)
+{
+	char *const data = make_input();
+	pipeline_t pipeline = geneie_pipeline_create(4, CHUNK_SIZE, geneie_thread_pool_default());
+	atomic_long seen = 0;
+	assert(geneie_pipeline_add_stage(pipeline, count_in_flight, &seen, 2));
+	assert(geneie_pipeline_add_stage(pipeline, fail_at_ten, NULL, 2));
+
+	struct input input = { data, INPUT_LENGTH, 0 };
+	struct output *const output = calloc(1, sizeof(struct output));
+	assert(!geneie_pipeline_run(pipeline, read_input, &input, write_output, output));
+
+	// Stopped early, without reading far past the failure
+	assert(output->results[10] == NULL);
+	assert(atomic_load(&seen) < INPUT_LENGTH / CHUNK_SIZE);
+
+	for (ssize_t i = 0; i < INPUT_LENGTH / CHUNK_SIZE; i++)
+		free(output->results[i]);
+	free(output);
+	geneie_pipeline_destroy(pipeline);
+	free(data);
+}
+
+static bool check_order(chunk_t *chunk, void *param)
+{
+	struct output *const output = param;
+	assert(chunk->index == output->chunks);
+	return write_output(chunk, param);
+}
+
+static bool slow_first(chunk_t *chunk, void *param)
+{
+	(void)param;
+	// Let later chunks overtake the first few
+	if (chunk->index % 8 == 0) {
+		for (int i = 0; i < 100; i++)
+			sched_yield();
+	}
+	return true;
+}
+
+void test_run_ordered(void)
+{
+	char *const data = make_input();
+	pipeline_t pipeline = geneie_pipeline_create(8, CHUNK_SIZE, geneie_thread_pool_default());
+	assert(geneie_pipeline_add_stage(pipeline, slow_first, NULL, 3));
+	assert(geneie_pipeline_add_stage(pipeline, geneie_pipeline_stage_dna_to_premrna, NULL, 2));
+
+	struct input input = { data, INPUT_LENGTH, 0 };
+	struct output *const output = calloc(1, sizeof(struct output));
+	assert(geneie_pipeline_run_ordered(pipeline, read_input, &input, check_order, output));
+	assert(output->chunks == INPUT_LENGTH / CHUNK_SIZE);
+
+	for (ssize_t i = 0; i < INPUT_LENGTH; i++) {
+		const char expected = data[i] == 'T' ? 'U' : data[i];
+		assert(output->results[i / CHUNK_SIZE][i % CHUNK_SIZE] == expected);
+	}
+
+	free_output(output);
+	free(output);
+	geneie_pipeline_destroy(pipeline);
+	free(data);
+}
+
+struct serial {
+	atomic_int running;
+	atomic_long seen;
+};
+
+static bool check_serial(chunk_t *chunk, void *param)
+{
+	(void)chunk;
+	// A stage with one thread never overlaps itself
+	struct serial *const serial = param;
+	assert(atomic_fetch_add(&serial->running, 1) == 0);
+	sched_yield();
+	atomic_fetch_add(&serial->seen, 1);
+	atomic_fetch_sub(&serial->running, 1);
+	return true;
+}
+
+void test_pools(void)
+{
+	char *const data = make_input();
+
+	// One worker for every stage, or none at all, so the
+	// stages must take turns rather than wait for each other
+	const pool_t pools[] = {
+		geneie_thread_pool_create(1),
+		(pool_t) { 0 },
+		geneie_thread_pool_create(4),
+	};
+	for (int i = 0; i < 3; i++) {
+		pipeline_t pipeline = geneie_pipeline_create(4, CHUNK_SIZE, pools[i]);
+		struct serial serial = { 0 };
+		assert(geneie_pipeline_add_stage(pipeline, geneie_pipeline_stage_clean_whitespace, NULL, 2));
+		assert(geneie_pipeline_add_stage(pipeline, check_serial, &serial, 1));
+		assert(geneie_pipeline_add_stage(pipeline, geneie_pipeline_stage_dna_to_premrna, NULL, 3));
+
+		struct input input = { data, INPUT_LENGTH, 0 };
+		struct output *const output = calloc(1, sizeof(struct output));
+		assert(geneie_pipeline_run_ordered(pipeline, read_input, &input, check_order, output));
+		assert(output->chunks == INPUT_LENGTH / CHUNK_SIZE);
+		assert(atomic_load(&serial.seen) == INPUT_LENGTH / CHUNK_SIZE);
+
+		free_output(output);
+		free(output);
+		geneie_pipeline_destroy(pipeline);
+		geneie_thread_pool_destroy(pools[i]);
+	}
+
+	free(data);
+}
+
+int main()
+{
+	test_create();
+	test_run();
+	test_no_stages();
+	test_failure();
+	test_run_ordered();
+	test_pools();
+}
@@ -0,0 +1,208 @@
+/*
+ * Geneie - A Library and Tools for gene processing
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_macros.h"
+#include "geneie/reorder.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sched.h>
+#include <pthread.h>
+
+typedef struct geneie_reorder reorder_t;
+typedef struct geneie_reorder_buffer buffer_t;
+typedef struct geneie_sequence_ref ref;
+
+#define RESULTS 5000
+#define THREADS 4
+#define WINDOW 4
+
+struct writer {
+	ssize_t expected;
+	ssize_t fail_at;
+};
+
+struct workers {
+	reorder_t reorder;
+	atomic_long next;
+	_Atomic(buffer_t *) buffers[WINDOW * 2];
+	atomic_int buffer_count;
+};
+
+static bool check_order(ref result, ssize_t sequence, void *param)
+{
+	struct writer *const writer = param;
+	assert(sequence == writer->expected);
+	writer->expected++;
+
+	if (sequence == writer->fail_at)
+		return false;
+
+	assert(result.length == sequence % 50 + 1);
+	for (ssize_t i = 0; i < result.length; i++)
+		assert(result.codes[i] == 'A' + sequence % 26);
+	return true;
+}
+
+static void remember_buffer(struct workers *workers, buffer_t *buffer)
+{
+	const int count = atomic_load(&workers->buffer_count);
+	for (int i = 0; i < count; i++) {
+		if (atomic_load(&workers->buffers[i]) == buffer)
+			return;
+	}
+	const int index = atomic_fetch_add(&workers->buffer_count, 1);
+	assert(index < WINDOW * 2);
+	atomic_store(&workers->buffers[index], buffer);
+}
+
+static void *work(void *param)
+{
+	struct workers *const workers = param;
+	unsigned long random = (unsigned long)pthread_self();
+
+	for (;;) {
+		const long sequence = atomic_fetch_add(&workers->next, 1);
+		if (sequence >= RESULTS)
+			break;
+
+		buffer_t *const buffer = geneie_reorder_acquire(workers->reorder, sequence);
+		if (!buffer)
+			break;
+		assert(buffer->sequence == sequence);
+		assert(buffer->length == 0);
+		remember_buffer(workers, buffer);
+
+		const ssize_t length = sequence % 50 + 1;
+		assert(geneie_reorder_buffer_reserve(buffer, length));
+		memset(buffer->codes, 'A' + sequence % 26, (size_t)length);
+		buffer->length = length;
+
+		// Finish out of order
+		random = random * 6364136223846793005UL + 1442695040888963407UL;
+		for (unsigned long i = (random >> 33) % 4; i > 0; i--)
+			sched_yield();
+
+		if (!geneie_reorder_submit(workers->reorder, buffer))
+			break;
+	}
+	return NULL;
+}
+
+static void run_workers(struct workers *workers)
+{
+	pthread_t threads[THREADS];
+	for (int i = 0; i < THREADS; i++)
+		assert(pthread_create(&threads[i], NULL, work, workers) == 0);
+	for (int i = 0; i < THREADS; i++)
+		pthread_join(threads[i], NULL);
+}
+
+void test_create(void)
+{
+	struct writer writer = { 0, -1 };
+	assert(!geneie_reorder_valid(geneie_reorder_create(0, 10, check_order, &writer)));
+	assert(!geneie_reorder_valid(geneie_reorder_create(4, -1, check_order, &writer)));
+
+	reorder_t reorder = geneie_reorder_create(4, 0, check_order, &writer);
+	assert(geneie_reorder_valid(reorder));
+	assert(geneie_reorder_written(reorder) == 0);
+	geneie_reorder_destroy(reorder);
+}
+
+void test_single_thread(void)
+{
+	struct writer writer = { 0, -1 };
+	reorder_t reorder = geneie_reorder_create(3, 8, check_order, &writer);
+
+	buffer_t *buffers[3];
+	for (ssize_t i = 0; i < 3; i++) {
+		buffers[i] = geneie_reorder_acquire(reorder, i);
+		assert(buffers[i]);
+		assert(buffers[i]->capacity >= 8);
+		buffers[i]->length = i + 1;
+		memset(buffers[i]->codes, 'A' + i, (size_t)(i + 1));
+	}
+
+	// Nothing until 0 arrives, then everything
+	assert(geneie_reorder_submit(reorder, buffers[2]));
+	assert(geneie_reorder_submit(reorder, buffers[1]));
+	assert(geneie_reorder_written(reorder) == 0);
+	assert(geneie_reorder_submit(reorder, buffers[0]));
+	assert(geneie_reorder_written(reorder) == 3);
+	assert(writer.expected == 3);
+
+	// The first buffer comes back for the next window
+	buffer_t *const recycled = geneie_reorder_acquire(reorder, 3);
+	assert(recycled == buffers[0]);
+	assert(recycled->sequence == 3);
+
+	// Already written
+	assert(geneie_reorder_acquire(reorder, 1) == NULL);
+
+	geneie_reorder_destroy(reorder);
+}
+
+void test_threads(void)
+{
+	struct writer writer = { 0, -1 };
+	struct workers workers = {
+		.reorder = geneie_reorder_create(WINDOW, 0, check_order, &writer),
+	};
+
+	run_workers(&workers);
+	assert(geneie_reorder_written(workers.reorder) == RESULTS);
+	assert(writer.expected == RESULTS);
+
+	// Only the window's buffers were ever handed out
+	assert(atomic_load(&workers.buffer_count) == WINDOW);
+
+	geneie_reorder_destroy(workers.reorder);
+}
+
+void test_failure(void)
+{
+	struct writer writer = { 0, 100 };
+	struct workers workers = {
+		.reorder = geneie_reorder_create(WINDOW, 0, check_order, &writer),
+	};
+
+	// Workers waiting for the window stop rather than hang
+	run_workers(&workers);
+	assert(geneie_reorder_written(workers.reorder) == -1);
+	assert(writer.expected == 101);
+	assert(geneie_reorder_acquire(workers.reorder, 101) == NULL);
+
+	geneie_reorder_destroy(workers.reorder);
+
+	writer = (struct writer) { 0, -1 };
+	reorder_t reorder = geneie_reorder_create(WINDOW, 0, check_order, &writer);
+	geneie_reorder_abort(reorder);
+	assert(geneie_reorder_acquire(reorder, 0) == NULL);
+	assert(geneie_reorder_written(reorder) == -1);
+	geneie_reorder_destroy(reorder);
+}
+
+int main()
+{
+	test_create();
+	test_single_thread();
+	test_threads();
+	test_failure();
+}
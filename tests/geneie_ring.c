@@ -0,0 +1,193 @@
+/*
+ * Geneie - A Library and Tools for gene processing
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_macros.h"
+#include "geneie/ring.h"
+
+#include <stdint.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <sched.h>
+#include <pthread.h>
+
+typedef struct geneie_ring_spsc spsc_t;
+typedef struct geneie_ring_mpmc mpmc_t;
+
+#define ITEMS 200000
+#define THREADS 3
+
+void test_spsc_single_thread(void)
+{
+	assert(!geneie_ring_spsc_valid(geneie_ring_spsc_alloc(0)));
+
+	spsc_t ring = geneie_ring_spsc_alloc(3);
+	assert(geneie_ring_spsc_valid(ring));
+
+	void *item;
+	assert(!geneie_ring_spsc_pop(ring, &item));
+
+	// Rounded up to 4
+	for (uintptr_t i = 1; i <= 4; i++)
+		assert(geneie_ring_spsc_push(ring, (void *)i));
+	assert(!geneie_ring_spsc_push(ring, (void *)5));
+
+	for (uintptr_t i = 1; i <= 4; i++) {
+		assert(geneie_ring_spsc_pop(ring, &item));
+		assert((uintptr_t)item == i);
+	}
+	assert(!geneie_ring_spsc_pop(ring, &item));
+
+	// Wrapping around
+	for (uintptr_t i = 0; i < 10; i++) {
+		assert(geneie_ring_spsc_push(ring, (void *)i));
+		assert(geneie_ring_spsc_pop(ring, &item));
+		assert((uintptr_t)item == i);
+	}
+
+	geneie_ring_spsc_free(ring);
+}
+
+void test_mpmc_single_thread(void)
+{
+	assert(!geneie_ring_mpmc_valid(geneie_ring_mpmc_alloc(-1)));
+
+	mpmc_t ring = geneie_ring_mpmc_alloc(1);
+	assert(geneie_ring_mpmc_valid(ring));
+
+	void *item;
+	assert(!geneie_ring_mpmc_pop(ring, &item));
+
+	// At least 2
+	assert(geneie_ring_mpmc_push(ring, (void *)1));
+	assert(geneie_ring_mpmc_push(ring, (void *)2));
+	assert(!geneie_ring_mpmc_push(ring, (void *)3));
+
+	for (uintptr_t i = 1; i <= 2; i++) {
+		assert(geneie_ring_mpmc_pop(ring, &item));
+		assert((uintptr_t)item == i);
+	}
+	assert(!geneie_ring_mpmc_pop(ring, &item));
+
+	for (uintptr_t i = 0; i < 10; i++) {
+		assert(geneie_ring_mpmc_push(ring, (void *)i));
+		assert(geneie_ring_mpmc_pop(ring, &item));
+		assert((uintptr_t)item == i);
+	}
+
+	geneie_ring_mpmc_free(ring);
+}
+
+static void *spsc_producer(void *param)
+{
+	spsc_t *const ring = param;
+	for (uintptr_t i = 1; i <= ITEMS; i++) {
+		while (!geneie_ring_spsc_push(*ring, (void *)i))
+			sched_yield();
+	}
+	return NULL;
+}
+
+void test_spsc_threads(void)
+{
+	spsc_t ring = geneie_ring_spsc_alloc(64);
+	pthread_t producer;
+	assert(pthread_create(&producer, NULL, spsc_producer, &ring) == 0);
+
+	// Everything arrives, in order
+	for (uintptr_t expected = 1; expected <= ITEMS; expected++) {
+		void *item;
+		while (!geneie_ring_spsc_pop(ring, &item))
+			sched_yield();
+		assert((uintptr_t)item == expected);
+	}
+
+	pthread_join(producer, NULL);
+	geneie_ring_spsc_free(ring);
+}
+
+struct mpmc_test {
+	mpmc_t ring;
+	int producer;
+	atomic_long popped;
+	atomic_char *seen;
+};
+
+static void *mpmc_producer(void *param)
+{
+	struct mpmc_test *const test = param;
+	const int producer = __atomic_fetch_add(&test->producer, 1, __ATOMIC_RELAXED);
+
+	for (uintptr_t i = 1; i <= ITEMS; i++) {
+		const uintptr_t value = (uintptr_t)producer * ITEMS + i;
+		while (!geneie_ring_mpmc_push(test->ring, (void *)value))
+			sched_yield();
+	}
+	return NULL;
+}
+
+static void *mpmc_consumer(void *param)
+{
+	struct mpmc_test *const test = param;
+
+	while (atomic_load(&test->popped) < (long)ITEMS * THREADS) {
+		void *item;
+		if (!geneie_ring_mpmc_pop(test->ring, &item)) {
+			sched_yield();
+			continue;
+		}
+		atomic_fetch_add(&test->seen[(uintptr_t)item - 1], 1);
+		atomic_fetch_add(&test->popped, 1);
+	}
+	return NULL;
+}
+
+void test_mpmc_threads(void)
+{
+	struct mpmc_test test = {
+		.ring = geneie_ring_mpmc_alloc(64),
+		.seen = calloc(ITEMS * THREADS, sizeof(atomic_char)),
+	};
+	pthread_t producers[THREADS], consumers[THREADS];
+
+	for (int i = 0; i < THREADS; i++) {
+		assert(pthread_create(&producers[i], NULL, mpmc_producer, &test) == 0);
+		assert(pthread_create(&consumers[i], NULL, mpmc_consumer, &test) == 0);
+	}
+	for (int i = 0; i < THREADS; i++) {
+		pthread_join(producers[i], NULL);
+		pthread_join(consumers[i], NULL);
+	}
+
+	// Every item exactly once
+	for (long i = 0; i < (long)ITEMS * THREADS; i++)
+		assert(test.seen[i] == 1);
+
+	void *item;
+	assert(!geneie_ring_mpmc_pop(test.ring, &item));
+
+	free(test.seen);
+	geneie_ring_mpmc_free(test.ring);
+}
+
+int main()
+{
+	test_spsc_single_thread();
+	test_mpmc_single_thread();
+	test_spsc_threads();
+	test_mpmc_threads();
+}
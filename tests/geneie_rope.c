@@ -0,0 +1,157 @@
+/*
+ * Geneie - A Library and Tools for gene processing
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_macros.h"
+#include "geneie/sequence_tools.h"
+#include "test_macros.h"
+#include "geneie/rope.h"
+#include "geneie/sequence_tools.h"
+
+#include <string.h>
+#include <stdlib.h>
+
+#define ref_from_literal geneie_sequence_ref_from_literal
+
+typedef struct geneie_rope rope_t;
+typedef struct geneie_sequence_ref ref;
+
+static bool rope_equal(rope_t rope, const char *expected)
+{
+	struct geneie_sequence sequence = geneie_rope_to_sequence(rope);
+	assert(geneie_sequence_valid(sequence));
+
+	const bool result = sequence.length == (ssize_t)strlen(expected)
+		&& !memcmp(sequence.codes, expected, strlen(expected));
+
+	geneie_sequence_free(sequence);
+	return result;
+}
+
+void test_from_ref(void)
+{
+	rope_t rope = geneie_rope_from_ref(ref_from_literal("ACGT"));
+
+	assert(geneie_rope_valid(rope));
+	assert(rope.length == 4);
+	assert(rope_equal(rope, "ACGT"));
+
+	geneie_rope_free(rope);
+
+	rope = geneie_rope_from_ref((ref) { 0 });
+	assert(!geneie_rope_valid(rope));
+}
+
+void test_append_large(void)
+{
+	// Crosses several blocks
+	const ssize_t length = GENEIE_ROPE_BLOCK_SIZE * 2 + 17;
+	char *buffer = malloc((size_t)length);
+	assert(buffer);
+	for (ssize_t i = 0; i < length; i++)
+		buffer[i] = "ACGT"[i % 4];
+
+	rope_t rope = geneie_rope_alloc();
+	assert(geneie_rope_append(&rope, ref_from_literal("GG")));
+	assert(geneie_rope_append(&rope, (ref) { length, buffer }));
+	assert(rope.length == length + 2);
+	assert(rope.count == 3);
+
+	struct geneie_sequence sequence = geneie_rope_to_sequence(rope);
+	assert(!memcmp(sequence.codes, "GG", 2));
+	assert(!memcmp(sequence.codes + 2, buffer, (size_t)length));
+
+	geneie_sequence_free(sequence);
+	geneie_rope_free(rope);
+	free(buffer);
+}
+
+void test_slice_concat(void)
+{
+	rope_t rope = geneie_rope_from_ref(ref_from_literal("AACCGGTT"));
+
+	rope_t slice = geneie_rope_slice(rope, 2, 4);
+	assert(geneie_rope_valid(slice));
+	assert(rope_equal(slice, "CCGG"));
+
+	assert(geneie_rope_concat(&slice, rope));
+	assert(rope_equal(slice, "CCGGAACCGGTT"));
+
+	// Freeing the original shouldn't affect the slice
+	geneie_rope_free(rope);
+	assert(rope_equal(slice, "CCGGAACCGGTT"));
+
+	assert(!geneie_rope_valid(geneie_rope_slice(slice, 10, 3)));
+
+	geneie_rope_free(slice);
+}
+
+void test_erase_insert(void)
+{
+	rope_t rope = geneie_rope_from_ref(ref_from_literal("AAAGUCCCAGUUU"));
+
+	assert(geneie_rope_erase(&rope, 3, 7));
+	assert(rope_equal(rope, "AAAUUU"));
+
+	rope_t middle = geneie_rope_from_ref(ref_from_literal("GG"));
+	assert(geneie_rope_insert(&rope, 3, middle));
+	assert(rope_equal(rope, "AAAGGUUU"));
+
+	assert(geneie_rope_insert(&rope, 0, middle));
+	assert(geneie_rope_insert(&rope, rope.length, middle));
+	assert(rope_equal(rope, "GGAAAGGUUUGG"));
+
+	assert(geneie_rope_erase(&rope, 0, rope.length));
+	assert(rope.length == 0);
+	assert(!geneie_rope_erase(&rope, 0, 1));
+
+	geneie_rope_free(middle);
+	geneie_rope_free(rope);
+}
+
+void test_iter(void)
+{
+	rope_t rope = geneie_rope_from_ref(ref_from_literal("ACGT"));
+	rope_t other = geneie_rope_from_ref(ref_from_literal("TTAA"));
+	assert(geneie_rope_concat(&rope, other));
+
+	struct geneie_rope_iter iter = geneie_rope_iter_init(rope);
+	ref span;
+	ssize_t spans = 0;
+	while (geneie_sequence_ref_valid(span = geneie_rope_iter_next(&iter))) {
+		geneie_sequence_tools_dna_to_premrna(span);
+		spans++;
+	}
+
+	assert(spans == 2);
+	assert(rope_equal(rope, "ACGUUUAA"));
+
+	// The spans are shared
+	assert(rope_equal(other, "UUAA"));
+
+	geneie_rope_free(other);
+	geneie_rope_free(rope);
+}
+
+int main()
+{
+	test_from_ref();
+	test_append_large();
+	test_slice_concat();
+	test_erase_insert();
+	test_iter();
+}
@@ -69,9 +69,56 @@ void test_copy_success()
 	geneie_sequence_free(copy);
 }
 
+void test_alloc_huge()
+{
+	{
+		// Too small for a huge page, should be a normal allocation
+		struct geneie_sequence result = geneie_sequence_alloc_huge(16);
+
+		assert(geneie_sequence_valid(result));
+		assert(result.mapping_length == 0);
+		assert(geneie_sequence_huge_backed(result) == 0);
+
+		geneie_sequence_free(result);
+	}
+
+	{
+		const ssize_t length = 5 * 1024 * 1024;
+		struct geneie_sequence result = geneie_sequence_alloc_huge(length);
+
+		assert(geneie_sequence_valid(result));
+		assert(result.length == length);
+		assert(result.codes[length] == '\0');
+
+		memset(result.codes, 'A', (size_t)length);
+
+		if (result.mapping_length) {
+			// 2 MiB aligned, and covers the null terminator
+			assert(((size_t)result.codes & (2 * 1024 * 1024 - 1)) == 0);
+			assert(result.mapping_length > (size_t)length);
+
+			struct geneie_sequence_huge_stats stats = geneie_sequence_huge_stats();
+			assert(stats.mapped_bytes >= result.mapping_length);
+
+			// Backing is up to the kernel, but we can at least
+			// make sure it doesn't report more than we mapped
+			assert(geneie_sequence_huge_backed(result) <= (ssize_t)result.mapping_length);
+		}
+
+		geneie_sequence_free(result);
+	}
+
+	{
+		struct geneie_sequence result = geneie_sequence_alloc_huge(-1);
+
+		assert(!geneie_sequence_valid(result));
+	}
+}
+
 int main()
 {
 	test_alloc_success();
 	test_from_string_success();
 	test_from_string_fail();
+	test_alloc_huge();
 }
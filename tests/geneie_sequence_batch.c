@@ -0,0 +1,176 @@
+/*
+ * Geneie - A Library and Tools for gene processing
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_macros.h"
+#include "geneie/sequence_batch.h"
+#include "geneie/sequence_tools.h"
+#include "geneie/encoding.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct geneie_sequence_batch batch_t;
+typedef struct geneie_sequence_ref ref;
+
+#define ref_from_string geneie_sequence_ref_from_string
+
+static const char *const reads[] = {
+	"ACGTACGTAA",
+	"",
+	"TTGACCATGN",
+	"AUGUAAGG",
+	"ACGT-XZ",
+	"gattaca",
+};
+
+#define READ_COUNT ((ssize_t)(sizeof(reads) / sizeof(reads[0])))
+
+static batch_t make_batch(void)
+{
+	// Small, to make sure appending grows it
+	batch_t batch = geneie_sequence_batch_alloc(1, 4);
+	assert(geneie_sequence_batch_valid(batch));
+
+	for (ssize_t i = 0; i < READ_COUNT; i++) {
+		// Not ref_from_string(), which refuses invalid codes
+		const ref read = { (ssize_t)strlen(reads[i]), (geneie_code *)reads[i] };
+		assert(geneie_sequence_batch_append(&batch, read));
+	}
+	return batch;
+}
+
+static bool equals(ref sequence, const char *string)
+{
+	return sequence.length == (ssize_t)strlen(string)
+		&& memcmp(sequence.codes, string, (size_t)sequence.length) == 0;
+}
+
+void test_alloc(void)
+{
+	assert(!geneie_sequence_batch_valid(geneie_sequence_batch_alloc(-1, 0)));
+	assert(!geneie_sequence_batch_valid(geneie_sequence_batch_alloc(0, -1)));
+
+	batch_t batch = geneie_sequence_batch_alloc(0, 0);
+	assert(geneie_sequence_batch_valid(batch));
+	assert(batch.count == 0);
+	assert(geneie_sequence_batch_length(batch) == 0);
+	assert(!geneie_sequence_batch_valid((batch_t) { 0 }));
+	assert(!geneie_sequence_ref_valid(geneie_sequence_batch_get(batch, 0)));
+	geneie_sequence_batch_free(batch);
+}
+
+void test_append(void)
+{
+	batch_t batch = make_batch();
+	assert(batch.count == READ_COUNT);
+
+	ssize_t total = 0;
+	for (ssize_t i = 0; i < READ_COUNT; i++) {
+		const ref sequence = geneie_sequence_batch_get(batch, i);
+		assert(geneie_sequence_ref_valid(sequence));
+		assert(equals(sequence, reads[i]));
+		assert(batch.offsets[i] == total);
+		total += sequence.length;
+	}
+	assert(geneie_sequence_batch_length(batch) == total);
+	assert(!geneie_sequence_ref_valid(geneie_sequence_batch_get(batch, READ_COUNT)));
+	assert(!geneie_sequence_ref_valid(geneie_sequence_batch_get(batch, -1)));
+	assert(!geneie_sequence_batch_append(&batch, (ref) { 0 }));
+	assert(batch.count == READ_COUNT);
+
+	// Reused without allocating
+	geneie_code *const codes = batch.codes;
+	geneie_sequence_batch_clear(&batch);
+	assert(batch.count == 0);
+	assert(geneie_sequence_batch_length(batch) == 0);
+
+	char sequence[] = "ACGT";
+	assert(geneie_sequence_batch_append(&batch, ref_from_string(sequence)));
+	assert(batch.codes == codes);
+	assert(equals(geneie_sequence_batch_get(batch, 0), "ACGT"));
+
+	geneie_sequence_batch_free(batch);
+}
+
+void test_validate(void)
+{
+	batch_t batch = make_batch();
+	bool results[READ_COUNT];
+
+	// Only "ACGT-XZ" has an invalid code
+	assert(geneie_sequence_batch_validate(batch, results) == READ_COUNT - 1);
+	for (ssize_t i = 0; i < READ_COUNT; i++)
+		assert(results[i] == (i != 4));
+	assert(geneie_sequence_batch_validate(batch, NULL) == READ_COUNT - 1);
+
+	geneie_sequence_batch_free(batch);
+}
+
+void test_transform(void)
+{
+	batch_t batch = make_batch();
+
+	geneie_sequence_batch_dna_to_premrna(batch);
+	assert(equals(geneie_sequence_batch_get(batch, 0), "ACGUACGUAA"));
+	assert(equals(geneie_sequence_batch_get(batch, 2), "UUGACCAUGN"));
+
+	geneie_sequence_batch_reverse_complement(batch);
+	assert(equals(geneie_sequence_batch_get(batch, 0), "TTACGTACGT"));
+	assert(equals(geneie_sequence_batch_get(batch, 1), ""));
+	assert(equals(geneie_sequence_batch_get(batch, 5), "tgtaatc"));
+
+	geneie_sequence_batch_free(batch);
+}
+
+void test_translate(void)
+{
+	batch_t batch = make_batch();
+	batch_t amino = geneie_sequence_batch_alloc(0, 0);
+
+	assert(geneie_sequence_batch_translate(batch, &amino));
+	assert(amino.count == READ_COUNT);
+
+	for (ssize_t i = 0; i < READ_COUNT; i++) {
+		const ref strand = geneie_sequence_batch_get(batch, i);
+		const ref result = geneie_sequence_batch_get(amino, i);
+		assert(result.length == strand.length / 3);
+
+		for (ssize_t j = 0; j < result.length; j++)
+			assert(result.codes[j] == geneie_encoding_translate_codon(&strand.codes[j * 3]));
+	}
+
+	const ref third = geneie_sequence_batch_get(amino, 3);
+	assert(third.codes[0] == GENEIE_CODE_METHIONINE);
+	assert(third.codes[1] == GENEIE_CODE_STOP);
+
+	// Replaces what was there
+	assert(geneie_sequence_batch_translate(batch, &amino));
+	assert(amino.count == READ_COUNT);
+
+	geneie_sequence_batch_free(amino);
+	geneie_sequence_batch_free(batch);
+}
+
+int main()
+{
+	test_alloc();
+	test_append();
+	test_validate();
+	test_transform();
+	test_translate();
+}
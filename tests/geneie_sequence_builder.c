@@ -0,0 +1,92 @@
+/*
+ * Geneie - A Library and Tools for gene processing
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_macros.h"
+#include "geneie/sequence_builder.h"
+
+#include <string.h>
+
+#define ref_from_literal geneie_sequence_ref_from_literal
+
+typedef struct geneie_sequence_builder builder_t;
+typedef struct geneie_sequence_ref ref;
+
+void test_append(void)
+{
+	builder_t builder = geneie_sequence_builder_alloc(0);
+	assert(geneie_sequence_builder_valid(builder));
+
+	assert(geneie_sequence_builder_append(&builder, ref_from_literal("ACGT")));
+	assert(geneie_sequence_builder_append(&builder, ref_from_literal("")));
+	assert(geneie_sequence_builder_append(&builder, ref_from_literal("UU")));
+	assert(!geneie_sequence_builder_append(&builder, (ref) { 0 }));
+
+	assert(geneie_sequence_ref_equal(
+		geneie_sequence_builder_ref(builder),
+		ref_from_literal("ACGTUU")
+	));
+
+	struct geneie_sequence result = geneie_sequence_builder_finish(builder);
+	assert(geneie_sequence_valid(result));
+	assert(result.length == 6);
+	assert(!strcmp(result.codes, "ACGTUU"));
+
+	geneie_sequence_free(result);
+}
+
+void test_growth(void)
+{
+	builder_t builder = geneie_sequence_builder_alloc(1);
+
+	for (int i = 0; i < 10000; i++)
+		assert(geneie_sequence_builder_append(&builder, ref_from_literal("ACG")));
+
+	assert(builder.length == 30000);
+	assert(builder.capacity >= builder.length);
+	// Geometric, so never more than double what's needed
+	assert(builder.capacity < builder.length * 2);
+
+	struct geneie_sequence result = geneie_sequence_builder_finish(builder);
+	assert(result.length == 30000);
+	assert(!memcmp(&result.codes[29997], "ACG", 4));
+
+	geneie_sequence_free(result);
+}
+
+void test_append_clean(void)
+{
+	builder_t builder = geneie_sequence_builder_alloc(4);
+
+	char lines[][8] = { "ACGT\n", "  GG\r\n", "\n", "UA" };
+	for (size_t i = 0; i < sizeof(lines) / sizeof(lines[0]); i++) {
+		ref line = { (ssize_t)strlen(lines[i]), lines[i] };
+		assert(geneie_sequence_builder_append_clean(&builder, line));
+	}
+
+	struct geneie_sequence result = geneie_sequence_builder_finish(builder);
+	assert(!strcmp(result.codes, "ACGTGGUA"));
+
+	geneie_sequence_free(result);
+}
+
+int main()
+{
+	test_append();
+	test_growth();
+	test_append_clean();
+}
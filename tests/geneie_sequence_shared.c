@@ -0,0 +1,174 @@
+/*
+ * Geneie - A Library and Tools for gene processing
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_macros.h"
+#include "geneie/sequence_shared.h"
+#include "geneie/sequence_tools.h"
+
+#define ref_from_literal geneie_sequence_ref_from_literal
+
+typedef struct geneie_sequence_shared shared_t;
+typedef struct geneie_sequence_ref ref;
+
+void test_from_ref(void)
+{
+	shared_t shared = geneie_sequence_shared_from_ref(ref_from_literal("ACGT"));
+
+	assert(geneie_sequence_shared_valid(shared));
+	assert(geneie_sequence_shared_unique(shared));
+	assert(geneie_sequence_ref_equal(
+		geneie_sequence_shared_read(shared),
+		ref_from_literal("ACGT")
+	));
+
+	geneie_sequence_shared_release(shared);
+
+	shared = geneie_sequence_shared_from_ref((ref) { 0 });
+	assert(!geneie_sequence_shared_valid(shared));
+}
+
+void test_share_read(void)
+{
+	shared_t first = geneie_sequence_shared_from_ref(ref_from_literal("ACGT"));
+	shared_t second = geneie_sequence_shared_share(first);
+
+	assert(!geneie_sequence_shared_unique(first));
+
+	// Readers see the very same memory
+	assert(geneie_sequence_shared_read(first).codes
+		== geneie_sequence_shared_read(second).codes);
+
+	geneie_sequence_shared_release(first);
+	assert(geneie_sequence_shared_unique(second));
+	geneie_sequence_shared_release(second);
+}
+
+void test_write(void)
+{
+	{
+		// Unique, so no copy
+		shared_t shared = geneie_sequence_shared_from_ref(ref_from_literal("ACGT"));
+		const geneie_code *original = geneie_sequence_shared_read(shared).codes;
+
+		ref writable = geneie_sequence_shared_write(&shared);
+		assert(geneie_sequence_ref_valid(writable));
+		assert(writable.codes == original);
+
+		geneie_sequence_shared_release(shared);
+	}
+
+	{
+		shared_t reader = geneie_sequence_shared_from_ref(ref_from_literal("ACGT"));
+		shared_t writer = geneie_sequence_shared_share(reader);
+
+		ref writable = geneie_sequence_shared_write(&writer);
+		assert(geneie_sequence_ref_valid(writable));
+		assert(writable.codes != geneie_sequence_shared_read(reader).codes);
+
+		geneie_sequence_tools_dna_to_premrna(writable);
+
+		assert(geneie_sequence_ref_equal(
+			geneie_sequence_shared_read(writer),
+			ref_from_literal("ACGU")
+		));
+		assert(geneie_sequence_ref_equal(
+			geneie_sequence_shared_read(reader),
+			ref_from_literal("ACGT")
+		));
+
+		assert(geneie_sequence_shared_unique(reader));
+		assert(geneie_sequence_shared_unique(writer));
+
+		geneie_sequence_shared_release(reader);
+		geneie_sequence_shared_release(writer);
+	}
+}
+
+static ref splice_first_two(ref strand, void *param)
+{
+	// Once only
+	bool *const done = param;
+	if (*done)
+		return (ref) { 0 };
+
+	*done = true;
+	return geneie_sequence_ref_trunc(strand, 2);
+}
+
+void test_commit(void)
+{
+	{
+		shared_t reader = geneie_sequence_shared_from_ref(ref_from_literal("AC GT\n"));
+		shared_t writer = geneie_sequence_shared_share(reader);
+
+		// Not while another handle shares it
+		assert(!geneie_sequence_shared_commit(
+			writer,
+			geneie_sequence_ref_trunc(geneie_sequence_shared_read(writer), 2)
+		));
+
+		ref writable = geneie_sequence_shared_write(&writer);
+		assert(geneie_sequence_shared_commit(
+			writer,
+			geneie_sequence_tools_clean_whitespace(writable)
+		));
+		assert(geneie_sequence_ref_equal(
+			geneie_sequence_shared_read(writer),
+			ref_from_literal("ACGT")
+		));
+		assert(geneie_sequence_ref_equal(
+			geneie_sequence_shared_read(reader),
+			ref_from_literal("AC GT\n")
+		));
+
+		bool done = false;
+		writable = geneie_sequence_shared_write(&writer);
+		assert(geneie_sequence_shared_commit(
+			writer,
+			geneie_sequence_tools_splice(writable, splice_first_two, &done)
+		));
+		assert(geneie_sequence_ref_equal(
+			geneie_sequence_shared_read(writer),
+			ref_from_literal("GT")
+		));
+
+		// Only shorter references to the same codes
+		assert(!geneie_sequence_shared_commit(writer, ref_from_literal("G")));
+		writable = geneie_sequence_shared_write(&writer);
+		writable.length++;
+		assert(!geneie_sequence_shared_commit(writer, writable));
+		assert(geneie_sequence_shared_read(writer).length == 2);
+
+		geneie_sequence_shared_release(reader);
+		geneie_sequence_shared_release(writer);
+	}
+
+	{
+		const shared_t invalid = { 0 };
+		assert(!geneie_sequence_shared_commit(invalid, ref_from_literal("A")));
+		assert(!geneie_sequence_shared_valid(geneie_sequence_shared_share(invalid)));
+	}
+}
+
+int main()
+{
+	test_from_ref();
+	test_share_read();
+	test_write();
+	test_commit();
+}
@@ -19,6 +19,7 @@
 #include "test_macros.h"
 #include "geneie/sequence_tools.h"
 
+#include <stdlib.h>
 #include <string.h>
 
 #define from_string geneie_sequence_from_string
@@ -132,6 +133,49 @@ void test_clean_whitespace(void)
 	}
 }
 
+void test_clean_whitespace_large(void)
+{
+	// Exercise the vectorised kernels with every kind of
+	// whitespace, at varying densities and alignments
+	const char whitespace[] = " \t\n\v\f\r";
+	char buffer[1000], expected[1000];
+	unsigned seed = 1;
+
+	for (int density = 1; density < 64; density *= 2) {
+		for (ssize_t length = 0; length < (ssize_t)sizeof(buffer); length += 37) {
+			ssize_t expected_length = 0;
+			for (ssize_t i = 0; i < length; i++) {
+				seed = seed * 1103515245 + 12345;
+				const unsigned random = seed >> 16;
+				if (random % 64 < (unsigned)density) {
+					buffer[i] = whitespace[random % 6];
+				} else {
+					buffer[i] = "ACGU"[random % 4];
+					expected[expected_length++] = buffer[i];
+				}
+			}
+
+			struct geneie_sequence_ref result = geneie_sequence_tools_clean_whitespace(
+				(struct geneie_sequence_ref) { length, buffer }
+			);
+
+			assert(result.codes == buffer);
+			assert(result.length == expected_length);
+			assert(!memcmp(result.codes, expected, (size_t)expected_length));
+		}
+	}
+
+	{
+		// All whitespace
+		char spaces[100];
+		memset(spaces, '\n', sizeof(spaces));
+		struct geneie_sequence_ref result = geneie_sequence_tools_clean_whitespace(
+			geneie_sequence_ref_from_array_unsafe(spaces)
+		);
+		assert(result.length == 0);
+	}
+}
+
 struct geneie_sequence_ref splice_G(struct geneie_sequence_ref strand, void *param)
 {
 	(void)param;
@@ -178,6 +222,135 @@ void test_splice(void)
 	}
 }
 
+ssize_t splice_G_batch(
+	struct geneie_sequence_ref strand,
+	struct geneie_sequence_ref *regions,
+	ssize_t capacity,
+	void *param
+)
+{
+	// Hand out at most two at a time, to exercise
+	// multiple calls
+	ssize_t *calls = param;
+	(*calls)++;
+	if (capacity > 2)
+		capacity = 2;
+
+	ssize_t count = 0;
+	for (; strand.length && count < capacity; strand = geneie_sequence_ref_index(strand, 1))
+		if (*strand.codes == GENEIE_CODE_GUANINE)
+			regions[count++] = geneie_sequence_ref_trunc(strand, 1);
+
+	return count;
+}
+
+void test_splice_batch(void)
+{
+	{
+		char dna[] = "GGGUGGGA";
+		ssize_t calls = 0;
+
+		struct geneie_sequence_ref sequence = ref_from_string(dna);
+
+		struct geneie_sequence_ref new_sequence
+			= geneie_sequence_tools_splice_batch(sequence, &splice_G_batch, &calls);
+
+		assert(geneie_sequence_ref_equal(ref_from_literal("UA"), new_sequence));
+		assert(calls == 4);
+	}
+
+	{
+		char dna[] = "ACUUA";
+		ssize_t calls = 0;
+
+		struct geneie_sequence_ref sequence = ref_from_string(dna);
+
+		struct geneie_sequence_ref new_sequence
+			= geneie_sequence_tools_splice_batch(sequence, &splice_G_batch, &calls);
+
+		assert(geneie_sequence_ref_equal(ref_from_literal("ACUUA"), new_sequence));
+		assert(calls == 1);
+	}
+}
+
+void test_splice_intervals(void)
+{
+	typedef struct geneie_sequence_tools_interval interval;
+
+	{
+		char dna[] = "AAAGUCCCAGUUUGUAGCC";
+		const interval exons[] = { { 0, 3 }, { 10, 13 }, { 17, 19 } };
+
+		ref result = geneie_sequence_tools_splice_intervals(
+			ref_from_string(dna),
+			exons,
+			3,
+			GENEIE_SEQUENCE_TOOLS_KEEP_INTERVALS
+		);
+
+		assert(geneie_sequence_ref_equal(ref_from_literal("AAAUUUCC"), result));
+	}
+
+	{
+		char dna[] = "AAAGUCCCAGUUUGUAGCC";
+		const interval introns[] = { { 3, 10 }, { 13, 17 } };
+
+		ref result = geneie_sequence_tools_splice_intervals(
+			ref_from_string(dna),
+			introns,
+			2,
+			GENEIE_SEQUENCE_TOOLS_REMOVE_INTERVALS
+		);
+
+		assert(geneie_sequence_ref_equal(ref_from_literal("AAAUUUCC"), result));
+	}
+
+	{
+		// Unsorted, so nothing should happen
+		char dna[] = "AAAGUCCCAGUUU";
+		const interval introns[] = { { 10, 12 }, { 3, 5 } };
+
+		ref result = geneie_sequence_tools_splice_intervals(
+			ref_from_string(dna),
+			introns,
+			2,
+			GENEIE_SEQUENCE_TOOLS_REMOVE_INTERVALS
+		);
+
+		assert(!geneie_sequence_ref_valid(result));
+		assert(!strcmp(dna, "AAAGUCCCAGUUU"));
+	}
+
+	{
+		char dna[] = "AAAGUCCCAGUUU";
+		char out[8] = { 0 };
+		const interval introns[] = { { 3, 10 } };
+
+		ref result = geneie_sequence_tools_splice_intervals_into(
+			ref_from_string(dna),
+			introns,
+			1,
+			GENEIE_SEQUENCE_TOOLS_REMOVE_INTERVALS,
+			geneie_sequence_ref_from_array_unsafe(out)
+		);
+
+		assert(geneie_sequence_ref_equal(ref_from_literal("AAAUUU"), result));
+		assert(result.codes == out);
+		// Original untouched
+		assert(!strcmp(dna, "AAAGUCCCAGUUU"));
+
+		// Destination too short
+		result = geneie_sequence_tools_splice_intervals_into(
+			ref_from_string(dna),
+			introns,
+			1,
+			GENEIE_SEQUENCE_TOOLS_REMOVE_INTERVALS,
+			(ref) { 4, out }
+		);
+		assert(!geneie_sequence_ref_valid(result));
+	}
+}
+
 void test_encode(void)
 {
 	{
@@ -220,11 +393,111 @@ void test_encode(void)
 	}
 }
 
+/*
+ * Fills a buffer with codons that never stop.
+ */
+static void fill_codons(char *buffer, ssize_t length)
+{
+	static const char *const codons[] = { "AUG", "GCU", "UUC", "CAG", "GGA", "ACC" };
+	srand(1);
+	for (ssize_t i = 0; i < length; i += 3)
+		memcpy(&buffer[i], codons[rand() % 6], (size_t)(length - i < 3 ? length - i : 3));
+}
+
+static void check_encode_parallel(char *input, ssize_t length, struct geneie_thread_pool pool)
+{
+	char *const serial = malloc((size_t)length);
+	memcpy(serial, input, (size_t)length);
+
+	ref_pair expected = geneie_sequence_tools_encode((ref) { length, serial });
+	ref_pair result = geneie_sequence_tools_encode_parallel((ref) { length, input }, pool);
+
+	assert(result.refs[0].codes == input);
+	assert(result.refs[0].length == expected.refs[0].length);
+	assert(result.refs[1].codes - input == expected.refs[1].codes - serial);
+	assert(result.refs[1].length == expected.refs[1].length);
+
+	// Everything, including the untouched remainder
+	assert(!memcmp(input, serial, (size_t)length));
+	free(serial);
+}
+
+void test_parallel(void)
+{
+	struct geneie_thread_pool pool = geneie_thread_pool_create(3);
+	assert(geneie_thread_pool_valid(pool));
+
+	// Chunks are 3 * 16KiB codes
+	const ssize_t chunk = 3 * 16 * 1024;
+	const ssize_t length = 4 * chunk + 2;
+	char *const buffer = malloc((size_t)length);
+
+	// No stop codon, with a partial codon on the end
+	fill_codons(buffer, length);
+	check_encode_parallel(buffer, length, pool);
+
+	// Stops in the middle of a chunk, and right at the
+	// end of one, with another stop in a later chunk
+	const ssize_t stops[] = { 2 * chunk + 3 * 100, chunk - 3 };
+	for (int i = 0; i < 2; i++) {
+		fill_codons(buffer, length);
+		memcpy(&buffer[stops[i]], "UAA", 3);
+		memcpy(&buffer[stops[i] + chunk], "UGA", 3);
+		check_encode_parallel(buffer, length, pool);
+	}
+
+	// Fails on a gap
+	fill_codons(buffer, length);
+	buffer[chunk + 1] = '-';
+	check_encode_parallel(buffer, length, pool);
+
+	// Small enough for a single chunk
+	fill_codons(buffer, 300);
+	check_encode_parallel(buffer, 300, pool);
+
+	for (ssize_t i = 0; i < length; i++)
+		buffer[i] = "ACGTN"[i % 5];
+	geneie_sequence_tools_dna_to_premrna_parallel((ref) { length, buffer }, pool);
+	for (ssize_t i = 0; i < length; i++)
+		assert(buffer[i] == "ACGUN"[i % 5]);
+
+	free(buffer);
+	geneie_thread_pool_destroy(pool);
+}
+
+void test_reverse_complement(void)
+{
+	{
+		char dna[] = "ACGTURYKMSWBDHVNX-";
+		geneie_sequence_tools_reverse_complement(ref_from_string(dna));
+		assert(!strcmp(dna, "-XNBDHVWSKMRYAACGT"));
+	}
+
+	{
+		// Odd length, and case is kept
+		char dna[] = "aacGt";
+		geneie_sequence_tools_reverse_complement(ref_from_string(dna));
+		assert(!strcmp(dna, "aCgtt"));
+	}
+
+	{
+		char dna[] = "";
+		geneie_sequence_tools_reverse_complement(ref_from_string(dna));
+		assert(!strcmp(dna, ""));
+	}
+}
+
 int main()
 {
 	test_ref_from_sequence();
 	test_sequence_from_ref();
 	test_dna_to_premrna();
+	test_reverse_complement();
+	test_clean_whitespace();
+	test_clean_whitespace_large();
 	test_splice();
+	test_splice_batch();
+	test_splice_intervals();
 	test_encode();
+	test_parallel();
 }
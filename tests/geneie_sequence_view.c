@@ -0,0 +1,139 @@
+/*
+ * Geneie - A Library and Tools for gene processing
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_macros.h"
+#include "geneie/sequence_view.h"
+
+#include <string.h>
+
+#define ref_from_literal geneie_sequence_ref_from_literal
+#define ref_from_string geneie_sequence_ref_from_string
+
+typedef struct geneie_sequence_view view_t;
+typedef struct geneie_sequence_ref ref;
+typedef struct geneie_sequence_tools_interval interval;
+
+static ref splice_G(ref strand, void *param)
+{
+	(void)param;
+	for (; strand.length; strand = geneie_sequence_ref_index(strand, 1))
+		if (*strand.codes == GENEIE_CODE_GUANINE)
+			return geneie_sequence_ref_trunc(strand, 1);
+
+	return (ref) { 0 };
+}
+
+void test_splice(void)
+{
+	char dna[] = "AGGCUGA";
+	view_t view = geneie_sequence_view_splice(ref_from_string(dna), splice_G, NULL);
+
+	assert(geneie_sequence_view_valid(view));
+	assert(view.length == 4);
+	assert(view.count == 3);
+
+	// Non-destructive
+	assert(!strcmp(dna, "AGGCUGA"));
+
+	struct geneie_sequence sequence = geneie_sequence_view_to_sequence(view);
+	assert(!strcmp(sequence.codes, "ACUA"));
+
+	geneie_sequence_free(sequence);
+	geneie_sequence_view_free(view);
+}
+
+void test_isoforms(void)
+{
+	char pre_mrna[] = "AUGAAAGUAAGGCCCGUCAGUUUUAG";
+	const ref strand = ref_from_string(pre_mrna);
+
+	const interval long_isoform[] = { { 0, 6 }, { 12, 15 }, { 20, 26 } };
+	const interval short_isoform[] = { { 0, 6 }, { 20, 26 } };
+
+	view_t first = geneie_sequence_view_splice_intervals(
+		strand,
+		long_isoform,
+		3,
+		GENEIE_SEQUENCE_TOOLS_KEEP_INTERVALS
+	);
+	view_t second = geneie_sequence_view_splice_intervals(
+		strand,
+		short_isoform,
+		2,
+		GENEIE_SEQUENCE_TOOLS_KEEP_INTERVALS
+	);
+
+	assert(geneie_sequence_view_valid(first));
+	assert(geneie_sequence_view_valid(second));
+
+	char aminos[16] = { 0 };
+	ref amino_out = geneie_sequence_ref_from_array_unsafe(aminos);
+
+	// AUG AAA CCC UUU UAG
+	ref encoded = geneie_sequence_view_encode(first, amino_out);
+	assert(geneie_sequence_ref_equal(encoded, ref_from_literal("MKPF\0")));
+
+	// AUG AAA UUU UAG
+	encoded = geneie_sequence_view_encode(second, amino_out);
+	assert(geneie_sequence_ref_equal(encoded, ref_from_literal("MKF\0")));
+
+	char copy[12] = { 0 };
+	ref copied = geneie_sequence_view_copy_into(
+		second,
+		geneie_sequence_ref_from_array_unsafe(copy)
+	);
+	assert(geneie_sequence_ref_equal(copied, ref_from_literal("AUGAAAUUUUAG")));
+
+	assert(!geneie_sequence_ref_valid(geneie_sequence_view_copy_into(
+		first,
+		geneie_sequence_ref_from_array_unsafe(copy)
+	)));
+
+	geneie_sequence_view_free(first);
+	geneie_sequence_view_free(second);
+}
+
+void test_encode_across_segments(void)
+{
+	// Codons split over segments, with whitespace
+	char pre_mrna[] = "AUXXGGAXX\nUXXUAG";
+	const interval introns[] = { { 2, 4 }, { 7, 9 }, { 11, 13 } };
+
+	view_t view = geneie_sequence_view_splice_intervals(
+		ref_from_string(pre_mrna),
+		introns,
+		3,
+		GENEIE_SEQUENCE_TOOLS_REMOVE_INTERVALS
+	);
+
+	char aminos[4] = { 0 };
+	ref encoded = geneie_sequence_view_encode(
+		view,
+		geneie_sequence_ref_from_array_unsafe(aminos)
+	);
+	assert(geneie_sequence_ref_equal(encoded, ref_from_literal("MD\0")));
+
+	geneie_sequence_view_free(view);
+}
+
+int main()
+{
+	test_splice();
+	test_isoforms();
+	test_encode_across_segments();
+}
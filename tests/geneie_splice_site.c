@@ -0,0 +1,187 @@
+/*
+ * Geneie - A Library and Tools for gene processing
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_macros.h"
+#include "geneie/splice_site.h"
+#include "geneie/sequence_tools.h"
+
+#include <string.h>
+#include <ctype.h>
+
+#define ref_from_literal geneie_sequence_ref_from_literal
+#define ref_from_string geneie_sequence_ref_from_string
+
+typedef struct geneie_sequence_ref ref;
+typedef struct geneie_splice_site_params params_t;
+
+void test_find_donor(void)
+{
+	assert(geneie_splice_site_find_donor(ref_from_literal("AAGUA"), GENEIE_SPLICE_SITE_GT_AG) == 2);
+	assert(geneie_splice_site_find_donor(ref_from_literal("AAgta"), GENEIE_SPLICE_SITE_GT_AG) == 2);
+	assert(geneie_splice_site_find_donor(ref_from_literal("AAGCA"), GENEIE_SPLICE_SITE_GT_AG) == -1);
+	assert(geneie_splice_site_find_donor(ref_from_literal("AAGCA"), GENEIE_SPLICE_SITE_GC_AG) == 2);
+	assert(geneie_splice_site_find_donor(ref_from_literal("CCAUA"), GENEIE_SPLICE_SITE_AT_AC) == 2);
+	assert(geneie_splice_site_find_donor(ref_from_literal("CCCG"), GENEIE_SPLICE_SITE_ALL) == -1);
+	assert(geneie_splice_site_find_donor(ref_from_literal(""), GENEIE_SPLICE_SITE_ALL) == -1);
+
+	// Long enough to go through the vectorised path, with
+	// the site straddling a block boundary
+	char long_strand[] = "CCCCCCCCCCCCCCCGUCCCCCCCCCCCCCCCCCCCCCCCCC";
+	assert(geneie_splice_site_find_donor(ref_from_string(long_strand), GENEIE_SPLICE_SITE_GT_AG) == 15);
+
+	char at_end[] = "CCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCCGT";
+	assert(geneie_splice_site_find_donor(ref_from_string(at_end), GENEIE_SPLICE_SITE_GT_AG) == 40);
+}
+
+static ssize_t naive_acceptor(ref strand)
+{
+	for (ssize_t i = 0; i + 1 < strand.length; i++)
+		if (toupper(strand.codes[i]) == 'A' && toupper(strand.codes[i + 1]) == 'G')
+			return i;
+	return -1;
+}
+
+void test_find_acceptor(void)
+{
+	assert(geneie_splice_site_find_acceptor(ref_from_literal("GUCAG"), GENEIE_SPLICE_SITE_GT_AG) == 3);
+	assert(geneie_splice_site_find_acceptor(ref_from_literal("GUCAC"), GENEIE_SPLICE_SITE_GT_AG) == -1);
+	assert(geneie_splice_site_find_acceptor(ref_from_literal("GUCAC"), GENEIE_SPLICE_SITE_AT_AC) == 3);
+
+	// Compare against a simple scan at every offset
+	char strand[] = "CUCAUCGACCAUCGGCUUACCCAGUACGAUCGAACCUUCCAAAGCUAGCCG";
+	const ref whole = ref_from_string(strand);
+	for (ssize_t i = 0; i < whole.length; i++) {
+		const ref current = geneie_sequence_ref_index(whole, i);
+		assert(geneie_splice_site_find_acceptor(current, GENEIE_SPLICE_SITE_GT_AG)
+			== naive_acceptor(current));
+	}
+}
+
+void test_splicer(void)
+{
+	{
+		params_t params = {
+			.motifs = GENEIE_SPLICE_SITE_GT_AG,
+			.min_length = 4,
+		};
+
+		char pre_mrna[] = "AUGGUAAGCCCAGGCCUAA";
+		ref result = geneie_sequence_tools_splice(
+			ref_from_string(pre_mrna),
+			geneie_splice_site_splicer,
+			&params
+		);
+
+		// GUAAG is the shortest intron starting at the first GU
+		assert(geneie_sequence_ref_equal(result, ref_from_literal("AUGCCCAGGCCUAA")));
+	}
+
+	{
+		params_t params = {
+			.motifs = GENEIE_SPLICE_SITE_GT_AG,
+			.min_length = 8,
+		};
+
+		char pre_mrna[] = "AUGGUAAGCCCAGGCCUAA";
+		ref result = geneie_sequence_tools_splice(
+			ref_from_string(pre_mrna),
+			geneie_splice_site_splicer,
+			&params
+		);
+
+		assert(geneie_sequence_ref_equal(result, ref_from_literal("AUGGCCUAA")));
+	}
+
+	{
+		// Too long, so no intron at all
+		params_t params = {
+			.motifs = GENEIE_SPLICE_SITE_GT_AG,
+			.min_length = 8,
+			.max_length = 8,
+		};
+
+		char pre_mrna[] = "AUGGUAAGCCCAGGCCUAA";
+		ref result = geneie_sequence_tools_splice(
+			ref_from_string(pre_mrna),
+			geneie_splice_site_splicer,
+			&params
+		);
+
+		assert(geneie_sequence_ref_equal(result, ref_from_literal("AUGGUAAGCCCAGGCCUAA")));
+	}
+
+	{
+		// AU-AC closes with AC, not AG
+		params_t params = {
+			.motifs = GENEIE_SPLICE_SITE_AT_AC,
+			.min_length = 4,
+		};
+
+		char pre_mrna[] = "GGAUCAGCACGG";
+		ref result = geneie_sequence_tools_splice(
+			ref_from_string(pre_mrna),
+			geneie_splice_site_splicer,
+			&params
+		);
+
+		assert(geneie_sequence_ref_equal(result, ref_from_literal("GGGG")));
+	}
+
+	{
+		// No AG follows the GU donors, which are then
+		// skipped, but the AU-AC intron is still found,
+		// whether or not the window is limited
+		const ssize_t max_lengths[] = { 0, 100 };
+		for (size_t i = 0; i < sizeof(max_lengths) / sizeof(max_lengths[0]); i++) {
+			params_t params = {
+				.motifs = GENEIE_SPLICE_SITE_GT_AG | GENEIE_SPLICE_SITE_AT_AC,
+				.min_length = 4,
+				.max_length = max_lengths[i],
+			};
+
+			char pre_mrna[] = "GUCCGUCCAUCCCACUU";
+			ref result = geneie_sequence_tools_splice(
+				ref_from_string(pre_mrna),
+				geneie_splice_site_splicer,
+				&params
+			);
+
+			assert(geneie_sequence_ref_equal(result, ref_from_literal("GUCCGUCCUU")));
+		}
+	}
+
+	{
+		// Every motif runs out of acceptors, GC along with
+		// GU since they share AG
+		params_t params = {
+			.motifs = GENEIE_SPLICE_SITE_ALL,
+			.min_length = 4,
+		};
+
+		char pre_mrna[] = "GUCCGCCAUCCUU";
+		ref strand = ref_from_string(pre_mrna);
+		assert(!geneie_sequence_ref_valid(geneie_splice_site_splicer(strand, &params)));
+	}
+}
+
+int main()
+{
+	test_find_donor();
+	test_find_acceptor();
+	test_splicer();
+}
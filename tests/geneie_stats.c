@@ -0,0 +1,239 @@
+/*
+ * Geneie - A Library and Tools for DNA data
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "test_macros.h"
+#include "geneie/stats.h"
+#include "geneie/encoding.h"
+#include "geneie/sequence.h"
+#include "geneie/sequence_tools.h"
+#include "geneie/thread_pool.h"
+
+#include <string.h>
+#include <pthread.h>
+
+typedef struct geneie_sequence_ref ref;
+typedef struct geneie_sequence_tools_interval interval_t;
+
+#define THREADS 4
+#define THREAD_CODONS 1000
+#define ENCODE_LENGTH (300 * 1000 + 1)
+
+// Without GENEIE_STATS, every counter stays at 0
+static uint64_t counted(uint64_t amount)
+{
+	return geneie_stats_enabled() ? amount : 0;
+}
+
+void test_translate()
+{
+	char strand[] = "AUGNNNUAA";
+	char aminos[3];
+
+	geneie_stats_reset();
+	assert(geneie_encoding_translate(
+		(ref) { 9, strand },
+		(ref) { 3, aminos }
+	) == 3);
+
+	const struct geneie_stats stats = geneie_stats_snapshot();
+	assert(stats.bytes_processed == counted(9));
+	assert(stats.codons_translated == counted(2));
+	assert(stats.ambiguous_codons == counted(1));
+	assert(stats.stop_codons == counted(1));
+}
+
+void test_one_codon()
+{
+	char amino;
+
+	geneie_stats_reset();
+	assert(geneie_encoding_one_codon((ref) { 3, "UAG" }, (ref) { 1, &amino }));
+	assert(!geneie_encoding_one_codon((ref) { 3, "NNN" }, (ref) { 1, &amino }));
+
+	// Too short to be a codon at all, so not ambiguous
+	assert(!geneie_encoding_one_codon((ref) { 2, "AU" }, (ref) { 1, &amino }));
+
+	const struct geneie_stats stats = geneie_stats_snapshot();
+	assert(stats.codons_translated == counted(1));
+	assert(stats.ambiguous_codons == counted(1));
+	assert(stats.stop_codons == counted(1));
+}
+
+void test_splice()
+{
+	char strand[] = "AACCGGTTAA";
+	const interval_t intervals[] = {
+		{ 2, 4 },
+		{ 6, 8 },
+	};
+
+	geneie_stats_reset();
+	const ref result = geneie_sequence_tools_splice_intervals(
+		(ref) { 10, strand },
+		intervals,
+		2,
+		GENEIE_SEQUENCE_TOOLS_REMOVE_INTERVALS
+	);
+	assert(result.length == 6);
+	assert(memcmp(result.codes, "AAGGAA", 6) == 0);
+
+	// The first two codes are already in place
+	const struct geneie_stats stats = geneie_stats_snapshot();
+	assert(stats.splice_regions == counted(2));
+	assert(stats.memmove_bytes == counted(4));
+}
+
+void test_allocations()
+{
+	geneie_stats_reset();
+	struct geneie_sequence sequence = geneie_sequence_alloc(10);
+	assert(geneie_sequence_valid(sequence));
+	geneie_sequence_free(sequence);
+
+	const struct geneie_stats stats = geneie_stats_snapshot();
+	assert(stats.allocations == counted(1));
+	assert(stats.allocation_bytes == counted(11));
+}
+
+void test_reset()
+{
+	char amino;
+	assert(geneie_encoding_one_codon((ref) { 3, "AUG" }, (ref) { 1, &amino }));
+	geneie_stats_reset();
+
+	const struct geneie_stats stats = geneie_stats_snapshot();
+	assert(stats.codons_translated == 0);
+	assert(stats.bytes_processed == 0);
+	assert(stats.allocations == 0);
+}
+
+static struct geneie_stats encode_stats(const char *input, bool parallel)
+{
+	char *const strand = malloc(ENCODE_LENGTH);
+	assert(strand);
+	memcpy(strand, input, ENCODE_LENGTH);
+
+	geneie_stats_reset();
+	if (parallel)
+		geneie_sequence_tools_encode_parallel(
+			(ref) { ENCODE_LENGTH, strand },
+			geneie_thread_pool_default()
+		);
+	else
+		geneie_sequence_tools_encode((ref) { ENCODE_LENGTH, strand });
+	const struct geneie_stats result = geneie_stats_snapshot();
+
+	free(strand);
+	return result;
+}
+
+static void check_encode_parallel(const char *input)
+{
+	const struct geneie_stats
+		serial = encode_stats(input, false),
+		parallel = encode_stats(input, true);
+
+	assert(parallel.bytes_processed == serial.bytes_processed);
+	assert(parallel.codons_translated == serial.codons_translated);
+	assert(parallel.stop_codons == serial.stop_codons);
+	assert(parallel.ambiguous_codons == serial.ambiguous_codons);
+}
+
+void test_encode_parallel()
+{
+	char *const input = malloc(ENCODE_LENGTH);
+	assert(input);
+	for (ssize_t i = 0; i < ENCODE_LENGTH; i++)
+		input[i] = "GCU"[i % 3];
+
+	// Runs off the end, with a partial codon left over
+	check_encode_parallel(input);
+
+	// Stops part-way, with codons after it in later chunks
+	// which mustn't be counted
+	memcpy(&input[150000], "UAA", 3);
+	memcpy(&input[250000], "UGA", 3);
+	check_encode_parallel(input);
+	assert(encode_stats(input, true).codons_translated == counted(50001));
+
+	// Fails on a gap
+	input[90001] = '-';
+	check_encode_parallel(input);
+
+	free(input);
+}
+
+static void *translate_codons(void *param)
+{
+	(void)param;
+	char amino;
+	for (int i = 0; i < THREAD_CODONS; i++)
+		assert(geneie_encoding_one_codon((ref) { 3, "GCU" }, (ref) { 1, &amino }));
+	return NULL;
+}
+
+void test_threads()
+{
+	pthread_t threads[THREADS];
+
+	geneie_stats_reset();
+	for (int i = 0; i < THREADS; i++)
+		assert(pthread_create(&threads[i], NULL, translate_codons, NULL) == 0);
+	for (int i = 0; i < THREADS; i++)
+		assert(pthread_join(threads[i], NULL) == 0);
+
+	// The threads have exited, but what they counted stays
+	translate_codons(NULL);
+	const struct geneie_stats stats = geneie_stats_snapshot();
+	assert(stats.codons_translated == counted((THREADS + 1) * THREAD_CODONS));
+}
+
+void test_write()
+{
+	const struct geneie_stats stats = {
+		.codons_translated = 12,
+		.allocation_bytes = 3,
+	};
+	char buffer[512] = { 0 };
+
+	FILE *const file = tmpfile();
+	assert(file);
+	assert(geneie_stats_write(stats, file));
+
+	rewind(file);
+	const size_t read = fread(buffer, 1, sizeof(buffer) - 1, file);
+	fclose(file);
+
+	assert(read > 0);
+	assert(strstr(buffer, "geneie_codons_translated 12\n"));
+	assert(strstr(buffer, "geneie_allocation_bytes 3\n"));
+	assert(strstr(buffer, "geneie_stop_codons 0\n"));
+}
+
+int main()
+{
+	test_translate();
+	test_one_codon();
+	test_splice();
+	test_allocations();
+	test_encode_parallel();
+	test_reset();
+	test_threads();
+	test_write();
+}
@@ -0,0 +1,321 @@
+/*
+ * Geneie - A Library and Tools for DNA data
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "test_macros.h"
+#include "geneie/synthetic.h"
+#include "geneie/sequence_tools.h"
+#include "geneie/encoding.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+typedef struct geneie_sequence_ref ref;
+typedef struct geneie_synthetic synthetic_t;
+typedef struct geneie_sequence_tools_interval interval_t;
+
+#define SIZE (1024 * 1024)
+
+static ref alloc_ref(ssize_t length)
+{
+	const ref result = { length, malloc((size_t)length) };
+	assert(result.codes);
+	return result;
+}
+
+static ssize_t count_of(ref sequence, const char *codes)
+{
+	ssize_t result = 0;
+	for (ssize_t i = 0; i < sequence.length; i++)
+		if (strchr(codes, sequence.codes[i]))
+			result++;
+	return result;
+}
+
+void test_rng()
+{
+	struct geneie_synthetic_rng
+		a = geneie_synthetic_rng_init(1, 0),
+		b = geneie_synthetic_rng_init(1, 0),
+		other_seed = geneie_synthetic_rng_init(2, 0),
+		other_stream = geneie_synthetic_rng_init(1, 1);
+
+	const uint64_t first = geneie_synthetic_rng_next(&a);
+	assert(first == geneie_synthetic_rng_next(&b));
+	assert(first != geneie_synthetic_rng_next(&other_seed));
+	assert(first != geneie_synthetic_rng_next(&other_stream));
+
+	for (int i = 0; i < 10000; i++) {
+		assert(geneie_synthetic_rng_below(&a, 7) < 7);
+		const double uniform = geneie_synthetic_rng_uniform(&a);
+		assert(uniform >= 0 && uniform < 1);
+	}
+	assert(geneie_synthetic_rng_below(&a, 1) == 0);
+}
+
+void test_init()
+{
+	struct geneie_synthetic_params params = GENEIE_SYNTHETIC_PARAMS_DEFAULT;
+	assert(geneie_synthetic_valid(geneie_synthetic_init(params, 1, 0)));
+
+	params.gc_content = 1.5;
+	assert(!geneie_synthetic_valid(geneie_synthetic_init(params, 1, 0)));
+
+	params = GENEIE_SYNTHETIC_PARAMS_DEFAULT;
+	params.ambiguity_rate = -0.1;
+	assert(!geneie_synthetic_valid(geneie_synthetic_init(params, 1, 0)));
+
+	params = GENEIE_SYNTHETIC_PARAMS_DEFAULT;
+	params.n_run_length = 0;
+	assert(!geneie_synthetic_valid(geneie_synthetic_init(params, 1, 0)));
+}
+
+void test_fill_plain()
+{
+	struct geneie_synthetic_params params = GENEIE_SYNTHETIC_PARAMS_DEFAULT;
+	params.gc_content = 0.6;
+	synthetic_t
+		a = geneie_synthetic_init(params, 42, 0),
+		b = geneie_synthetic_init(params, 42, 0);
+
+	const ref first = alloc_ref(SIZE), second = alloc_ref(SIZE);
+	geneie_synthetic_fill(&a, first);
+
+	// The same however it's split between calls
+	geneie_synthetic_fill(&b, (ref) { 5, second.codes });
+	geneie_synthetic_fill(&b, (ref) { SIZE - 5, second.codes + 5 });
+	assert(memcmp(first.codes, second.codes, SIZE) == 0);
+
+	assert(count_of(first, "ACGT") == SIZE);
+	const double gc = (double)count_of(first, "GC") / SIZE;
+	assert(gc > 0.59 && gc < 0.61);
+
+	// Roughly even between G and C, and between A and T
+	const double g = (double)count_of(first, "G") / SIZE;
+	assert(g > 0.29 && g < 0.31);
+	const double a_content = (double)count_of(first, "A") / SIZE;
+	assert(a_content > 0.19 && a_content < 0.21);
+
+	geneie_synthetic_fill(&a, first);
+	assert(memcmp(first.codes, second.codes, SIZE) != 0);
+
+	free(first.codes);
+	free(second.codes);
+}
+
+void test_fill_features()
+{
+	struct geneie_synthetic_params params = GENEIE_SYNTHETIC_PARAMS_DEFAULT;
+	params.ambiguity_rate = 0.01;
+	params.n_run_rate = 0.0001;
+	params.n_run_length = 100;
+	params.soft_mask_rate = 0.001;
+	params.soft_mask_length = 200;
+	synthetic_t generator = geneie_synthetic_init(params, 7, 3);
+
+	const ref sequence = alloc_ref(SIZE);
+	geneie_synthetic_fill(&generator, sequence);
+
+	const ssize_t ambiguous = count_of(sequence, "RYKMSWBDHVrykmswbdhv");
+	assert(ambiguous > SIZE / 100 * 8 / 10 && ambiguous < SIZE / 100 * 12 / 10);
+
+	// About 100 runs of about 100, some of them masked
+	const ssize_t n = count_of(sequence, "Nn");
+	assert(n > SIZE / 10000 * 100 / 2 && n < SIZE / 10000 * 100 * 2);
+
+	ssize_t runs = 0;
+	for (ssize_t i = 0; i < SIZE; i++)
+		if (toupper(sequence.codes[i]) == 'N' && (i == 0 || toupper(sequence.codes[i - 1]) != 'N'))
+			runs++;
+	assert(runs > 50 && runs < 200);
+
+	// 0.001 * 200 = about 20% masked, less overlaps
+	ssize_t lower = 0;
+	for (ssize_t i = 0; i < SIZE; i++)
+		if (islower(sequence.codes[i]))
+			lower++;
+	assert(lower > SIZE / 10 && lower < SIZE * 3 / 10);
+
+	// The same however it's split between calls, features
+	// included
+	synthetic_t split = geneie_synthetic_init(params, 7, 3);
+	const ref second = alloc_ref(SIZE);
+	for (ssize_t offset = 0, length = 1; offset < SIZE; offset += length, length = length * 7 % 1999 + 1) {
+		if (length > SIZE - offset)
+			length = SIZE - offset;
+		geneie_synthetic_fill(&split, (ref) { length, second.codes + offset });
+	}
+	assert(memcmp(sequence.codes, second.codes, SIZE) == 0);
+
+	free(second.codes);
+	free(sequence.codes);
+}
+
+void test_gene()
+{
+	synthetic_t generator = geneie_synthetic_init(GENEIE_SYNTHETIC_PARAMS_DEFAULT, 5, 0);
+	const struct geneie_synthetic_gene_params params = {
+		.exons = 5,
+		.exon_length = 150,
+		.intron_length = 500,
+	};
+
+	for (int gene = 0; gene < 20; gene++) {
+		const ref out = alloc_ref(10000);
+		interval_t introns[4];
+		const ssize_t length = geneie_synthetic_gene(&generator, params, out, introns);
+		assert(length > 0);
+
+		for (int i = 0; i < 4; i++) {
+			const interval_t intron = introns[i];
+			assert(intron.end - intron.start >= 4);
+			assert(memcmp(out.codes + intron.start, "GT", 2) == 0);
+			assert(memcmp(out.codes + intron.end - 2, "AG", 2) == 0);
+			if (i > 0)
+				assert(intron.start > introns[i - 1].end);
+		}
+
+		const ref coding = geneie_sequence_tools_splice_intervals(
+			(ref) { length, out.codes },
+			introns,
+			4,
+			GENEIE_SEQUENCE_TOOLS_REMOVE_INTERVALS
+		);
+		assert(geneie_sequence_ref_valid(coding));
+		assert(coding.length % 3 == 0);
+		assert(memcmp(coding.codes, "ATG", 3) == 0);
+
+		const ssize_t codons = geneie_encoding_translate(coding, coding);
+		assert(codons == coding.length / 3);
+		assert(coding.codes[0] == GENEIE_CODE_METHIONINE);
+		for (ssize_t i = 0; i < codons - 1; i++)
+			assert(coding.codes[i] != GENEIE_CODE_STOP);
+		assert(coding.codes[codons - 1] == GENEIE_CODE_STOP);
+
+		free(out.codes);
+	}
+
+	// Too small
+	const ref small = alloc_ref(10);
+	assert(geneie_synthetic_gene(&generator, params, small, NULL) == -1);
+
+	// A single exon is just a coding sequence
+	const struct geneie_synthetic_gene_params single = { 1, 2, 1 };
+	const ssize_t length = geneie_synthetic_gene(&generator, single, small, NULL);
+	assert(length == 6);
+	assert(memcmp(small.codes, "ATG", 3) == 0);
+	free(small.codes);
+}
+
+void test_read()
+{
+	synthetic_t generator = geneie_synthetic_init(GENEIE_SYNTHETIC_PARAMS_DEFAULT, 9, 0);
+	const ref source = alloc_ref(10000);
+	geneie_synthetic_fill(&generator, source);
+	const ref out = alloc_ref(1000);
+
+	struct geneie_synthetic_read_params params = {
+		.length = 150,
+		.length_deviation = 30,
+		.min_length = 100,
+		.max_length = 200,
+	};
+
+	double total = 0;
+	for (int i = 0; i < 1000; i++) {
+		const ssize_t length = geneie_synthetic_read(&generator, params, source, out);
+		assert(length >= 100 && length <= 200);
+		total += (double)length;
+
+		// No errors or reversing, so it's part of the source
+		bool found = false;
+		for (ssize_t start = 0; !found && start + length <= source.length; start++)
+			found = memcmp(source.codes + start, out.codes, (size_t)length) == 0;
+		assert(found);
+	}
+	assert(total / 1000 > 140 && total / 1000 < 160);
+
+	// Always reversed, so it's part of the reverse complement
+	params.reverse_rate = 1;
+	params.length_deviation = 0;
+	const ref reversed = alloc_ref(source.length);
+	memcpy(reversed.codes, source.codes, (size_t)source.length);
+	geneie_sequence_tools_reverse_complement(reversed);
+
+	const ssize_t length = geneie_synthetic_read(&generator, params, source, out);
+	assert(length == 150);
+	bool found = false;
+	for (ssize_t start = 0; !found && start + length <= reversed.length; start++)
+		found = memcmp(reversed.codes + start, out.codes, (size_t)length) == 0;
+	assert(found);
+
+	// Errors substitute a different base
+	params.reverse_rate = 0;
+	params.error_rate = 1;
+	params.length = 1000;
+	params.max_length = 0;
+	const ref plain = alloc_ref(1000);
+	memset(plain.codes, 'A', 1000);
+	assert(geneie_synthetic_read(&generator, params, plain, out) == 1000);
+	assert(count_of((ref) { 1000, out.codes }, "CGT") == 1000);
+
+	// Never longer than the output
+	params.error_rate = 0;
+	assert(geneie_synthetic_read(&generator, params, source, (ref) { 10, out.codes }) == 10);
+
+	params.min_length = 0;
+	assert(geneie_synthetic_read(&generator, params, source, out) == -1);
+
+	free(plain.codes);
+	free(reversed.codes);
+	free(source.codes);
+	free(out.codes);
+}
+
+void test_write_lines()
+{
+	char sequence[] = "ACGTACGTAC", buffer[32];
+	const ref out = { sizeof(buffer), buffer };
+
+	ssize_t written = geneie_synthetic_write_lines((ref) { 10, sequence }, 4, out);
+	assert(written == 13);
+	assert(memcmp(buffer, "ACGT\nACGT\nAC\n", 13) == 0);
+
+	written = geneie_synthetic_write_lines((ref) { 8, sequence }, 4, out);
+	assert(written == 10);
+	assert(memcmp(buffer, "ACGT\nACGT\n", 10) == 0);
+
+	written = geneie_synthetic_write_lines((ref) { 10, sequence }, 0, out);
+	assert(written == 11);
+	assert(memcmp(buffer, "ACGTACGTAC\n", 11) == 0);
+
+	assert(geneie_synthetic_write_lines((ref) { 0, sequence }, 4, out) == 0);
+	assert(geneie_synthetic_write_lines((ref) { 10, sequence }, 4, (ref) { 12, buffer }) == -1);
+}
+
+int main()
+{
+	test_rng();
+	test_init();
+	test_fill_plain();
+	test_fill_features();
+	test_gene();
+	test_read();
+	test_write_lines();
+}
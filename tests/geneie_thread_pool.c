@@ -0,0 +1,235 @@
+/*
+ * Geneie - A Library and Tools for gene processing
+ * Copyright (C) 2024   Marcus Harrison
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "test_macros.h"
+#include "geneie/thread_pool.h"
+
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct geneie_thread_pool pool_t;
+typedef struct geneie_thread_pool_group group_t;
+typedef struct geneie_sequence_ref ref;
+
+static void count_range(ssize_t begin, ssize_t end, void *param)
+{
+	atomic_long *const counts = param;
+	for (ssize_t i = begin; i < end; i++)
+		atomic_fetch_add(&counts[i], 1);
+}
+
+void test_create(void)
+{
+	pool_t pool = geneie_thread_pool_create(2);
+	assert(geneie_thread_pool_valid(pool));
+	assert(geneie_thread_pool_size(pool) == 2);
+	geneie_thread_pool_destroy(pool);
+
+	pool = geneie_thread_pool_default();
+	assert(geneie_thread_pool_valid(pool));
+	assert(geneie_thread_pool_size(pool) >= 1);
+	assert(geneie_thread_pool_default().state == pool.state);
+}
+
+void test_parallel_for(void)
+{
+	pool_t pool = geneie_thread_pool_create(3);
+	const ssize_t length = 100000;
+	atomic_long *const counts = calloc((size_t)length, sizeof(atomic_long));
+
+	// Every index exactly once, whatever the grain
+	const ssize_t grains[] = { 0, 1, 7, 1000, length * 2 };
+	for (int i = 0; i < 5; i++) {
+		geneie_thread_pool_parallel_for(pool, 0, length, grains[i], count_range, counts);
+		for (ssize_t j = 0; j < length; j++)
+			assert(atomic_load(&counts[j]) == i + 1);
+	}
+
+	// Empty ranges do nothing
+	geneie_thread_pool_parallel_for(pool, 5, 5, 0, count_range, counts);
+	geneie_thread_pool_parallel_for(pool, 5, 2, 0, count_range, counts);
+	assert(atomic_load(&counts[5]) == 5);
+
+	free(counts);
+	geneie_thread_pool_destroy(pool);
+}
+
+struct tree {
+	pool_t pool;
+	int depth;
+	atomic_long *leaves;
+};
+
+/*
+ * Each task starts two more and waits for them, so the
+ * waits only finish if waiting threads run tasks too.
+ */
+static void grow(void *param)
+{
+	struct tree *const tree = param;
+	if (tree->depth == 0) {
+		atomic_fetch_add(tree->leaves, 1);
+		return;
+	}
+
+	struct tree children[2] = {
+		{ tree->pool, tree->depth - 1, tree->leaves },
+		{ tree->pool, tree->depth - 1, tree->leaves },
+	};
+
+	group_t group;
+	geneie_thread_pool_group_init(&group, tree->pool);
+	geneie_thread_pool_group_run(&group, grow, &children[0]);
+	geneie_thread_pool_group_run(&group, grow, &children[1]);
+	geneie_thread_pool_group_wait(&group);
+}
+
+void test_nested_groups(void)
+{
+	for (int threads = 1; threads <= 4; threads++) {
+		pool_t pool = geneie_thread_pool_create(threads);
+		atomic_long leaves = 0;
+		struct tree root = { pool, 12, &leaves };
+
+		group_t group;
+		geneie_thread_pool_group_init(&group, pool);
+		geneie_thread_pool_group_run(&group, grow, &root);
+		geneie_thread_pool_group_wait(&group);
+		assert(atomic_load(&leaves) == 1 << 12);
+
+		geneie_thread_pool_destroy(pool);
+	}
+}
+
+static void increment(void *param)
+{
+	atomic_fetch_add((atomic_long *)param, 1);
+}
+
+static void spawn_many(void *param)
+{
+	// More than fit on one worker's queue
+	atomic_long *const total = param;
+	group_t group;
+	geneie_thread_pool_group_init(&group, geneie_thread_pool_default());
+	for (int i = 0; i < 10000; i++)
+		geneie_thread_pool_group_run(&group, increment, total);
+	geneie_thread_pool_group_wait(&group);
+}
+
+void test_many_tasks(void)
+{
+	atomic_long total = 0;
+	group_t group;
+	geneie_thread_pool_group_init(&group, geneie_thread_pool_default());
+	geneie_thread_pool_group_run(&group, spawn_many, &total);
+	geneie_thread_pool_group_run(&group, spawn_many, &total);
+	geneie_thread_pool_group_wait(&group);
+	assert(atomic_load(&total) == 20000);
+
+	// Waiting for an empty group returns straight away
+	geneie_thread_pool_group_wait(&group);
+}
+
+struct chunks {
+	const char *base;
+	atomic_long seen;
+};
+
+static void check_chunk(ref chunk, ssize_t offset, void *param)
+{
+	struct chunks *const chunks = param;
+	assert(chunk.codes == chunks->base + offset);
+	assert(offset % 10 == 0);
+
+	// 10 codes of our own, and 3 more unless we're near the end
+	const ssize_t expected = 1003 - offset < 13 ? 1003 - offset : 13;
+	assert(chunk.length == expected);
+	atomic_fetch_add(&chunks->seen, 1);
+}
+
+void test_map(void)
+{
+	char buffer[1003];
+	memset(buffer, 'A', sizeof(buffer));
+
+	struct chunks chunks = { buffer, 0 };
+	geneie_thread_pool_map(
+		geneie_thread_pool_default(),
+		geneie_sequence_ref_from_array_unsafe(buffer),
+		10,
+		3,
+		check_chunk,
+		&chunks
+	);
+	assert(atomic_load(&chunks.seen) == 101);
+}
+
+static void count_calls(ssize_t begin, ssize_t end, void *param)
+{
+	// The whole range, in a single call
+	assert(begin == 3 && end == 103);
+	atomic_fetch_add((atomic_long *)param, 1);
+}
+
+void test_invalid_pool(void)
+{
+	// Such as a default pool whose threads couldn't start:
+	// everything runs on the calling thread
+	const pool_t pool = (pool_t) { 0 };
+	assert(!geneie_thread_pool_valid(pool));
+	assert(geneie_thread_pool_size(pool) == 0);
+
+	atomic_long total = 0;
+	group_t group;
+	geneie_thread_pool_group_init(&group, pool);
+	geneie_thread_pool_group_run(&group, increment, &total);
+	assert(atomic_load(&total) == 1);
+	geneie_thread_pool_group_run(&group, spawn_many, &total);
+	assert(atomic_load(&total) == 10001);
+	geneie_thread_pool_group_wait(&group);
+
+	atomic_long calls = 0;
+	geneie_thread_pool_parallel_for(pool, 3, 103, 0, count_calls, &calls);
+	geneie_thread_pool_parallel_for(pool, 3, 103, 1, count_calls, &calls);
+	assert(atomic_load(&calls) == 2);
+
+	char buffer[1003];
+	memset(buffer, 'A', sizeof(buffer));
+	struct chunks chunks = { buffer, 0 };
+	geneie_thread_pool_map(
+		pool,
+		geneie_sequence_ref_from_array_unsafe(buffer),
+		10,
+		3,
+		check_chunk,
+		&chunks
+	);
+	assert(atomic_load(&chunks.seen) == 101);
+}
+
+int main()
+{
+	test_create();
+	test_parallel_for();
+	test_nested_groups();
+	test_many_tasks();
+	test_map();
+	test_invalid_pool();
+}
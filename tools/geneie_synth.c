@@ -0,0 +1,746 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include <geneie.h>
+
+/*
+ * Generates reproducible test inputs: genomes as FASTA,
+ * genes as FASTA with their introns in the header, or
+ * reads as FASTQ.
+ *
+ * The output is cut into chunks, each generated from its
+ * own stream of the seed, so the chunks can be generated
+ * on any number of threads and the output is the same.
+ * A geneie_reorder writes them in order.
+ */
+
+typedef struct geneie_sequence_ref ref;
+typedef struct geneie_sequence_tools_interval interval_t;
+
+#define PROGRAM "geneie-synth"
+
+#define CHUNK_BASES (4 * 1024 * 1024)
+#define GENES_PER_CHUNK 64
+#define READS_PER_CHUNK 4096
+#define CHUNKS_PER_THREAD 2
+#define OUTPUT_BUFFER_SIZE (1024 * 1024)
+
+// The source genome of the reads comes from a stream no
+// chunk uses
+#define SOURCE_STREAM UINT64_MAX
+
+enum mode {
+	MODE_GENOME,
+	MODE_GENES,
+	MODE_READS,
+};
+
+struct options {
+	enum mode mode;
+	ssize_t size;
+	ssize_t count;
+	uint64_t seed;
+	ssize_t width;
+	int threads;
+	bool quiet;
+	const char *output;
+	struct geneie_synthetic_params params;
+	struct geneie_synthetic_gene_params gene;
+	struct geneie_synthetic_read_params read;
+};
+
+/*
+ * A piece of one genome record.
+ */
+struct piece {
+	ssize_t record;
+	ssize_t start;
+	ssize_t length;
+	bool last;
+};
+
+struct context {
+	struct options options;
+	struct geneie_reorder reorder;
+
+	struct piece *pieces;
+	ssize_t chunk_count;
+	atomic_long next_chunk;
+
+	ref source;
+	atomic_long bases;
+};
+
+/*
+ * Scratch space for one worker.
+ */
+struct scratch {
+	ref sequence;
+	interval_t *introns;
+};
+
+static double seconds_since(struct timespec start)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (double)(now.tv_sec - start.tv_sec)
+		+ (double)(now.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+static bool write_output(ref result, ssize_t sequence, void *param)
+{
+	(void)sequence;
+	FILE *const output = param;
+	return fwrite(result.codes, 1, (size_t)result.length, output)
+		== (size_t)result.length;
+}
+
+static bool append(struct geneie_reorder_buffer *buffer, const char *text, ssize_t length)
+{
+	if (!geneie_reorder_buffer_reserve(buffer, buffer->length + length))
+		return false;
+	memcpy(buffer->codes + buffer->length, text, (size_t)length);
+	buffer->length += length;
+	return true;
+}
+
+/*
+ * Appends a sequence as lines. A genome record without
+ * wrapping is one line, so only its last piece ends it.
+ */
+static bool append_lines(
+	struct context *context,
+	struct geneie_reorder_buffer *buffer,
+	ref sequence,
+	bool last
+)
+{
+	const ssize_t width = context->options.width;
+	if (!geneie_reorder_buffer_reserve(buffer, buffer->length + sequence.length + sequence.length / (width ? width : 1) + 2))
+		return false;
+
+	const ref out = {
+		buffer->capacity - buffer->length,
+		buffer->codes + buffer->length,
+	};
+	if (width) {
+		buffer->length += geneie_synthetic_write_lines(sequence, width, out);
+	} else {
+		memcpy(out.codes, sequence.codes, (size_t)sequence.length);
+		buffer->length += sequence.length;
+		if (last)
+			buffer->codes[buffer->length++] = '\n';
+	}
+	return true;
+}
+
+static bool generate_genome(
+	struct context *context,
+	ssize_t chunk,
+	struct geneie_reorder_buffer *buffer,
+	struct scratch *scratch
+)
+{
+	const struct piece piece = context->pieces[chunk];
+	struct geneie_synthetic generator = geneie_synthetic_init(
+		context->options.params,
+		context->options.seed,
+		(uint64_t)chunk
+	);
+	const ref sequence = { piece.length, scratch->sequence.codes };
+	geneie_synthetic_fill(&generator, sequence);
+
+	if (piece.start == 0) {
+		char header[64];
+		const int length = snprintf(header, sizeof(header), ">sequence%zd\n", piece.record + 1);
+		if (!append(buffer, header, length))
+			return false;
+	}
+
+	atomic_fetch_add_explicit(&context->bases, piece.length, memory_order_relaxed);
+	return append_lines(context, buffer, sequence, piece.last);
+}
+
+static bool generate_genes(
+	struct context *context,
+	ssize_t chunk,
+	struct geneie_reorder_buffer *buffer,
+	struct scratch *scratch
+)
+{
+	const struct options *const options = &context->options;
+	struct geneie_synthetic generator = geneie_synthetic_init(
+		options->params,
+		options->seed,
+		(uint64_t)chunk
+	);
+
+	ssize_t first = chunk * GENES_PER_CHUNK, last = first + GENES_PER_CHUNK;
+	if (last > options->count)
+		last = options->count;
+
+	long bases = 0;
+	for (ssize_t gene = first; gene < last; gene++) {
+		const ssize_t length = geneie_synthetic_gene(
+			&generator,
+			options->gene,
+			scratch->sequence,
+			scratch->introns
+		);
+		if (length < 0)
+			return false;
+
+		// The introns as 1-based, inclusive ranges
+		char header[64];
+		int header_length = snprintf(header, sizeof(header), ">gene%zd introns=", gene + 1);
+		if (!append(buffer, header, header_length))
+			return false;
+		for (ssize_t i = 0; i < options->gene.exons - 1; i++) {
+			header_length = snprintf(
+				header,
+				sizeof(header),
+				"%s%zd-%zd",
+				i ? "," : "",
+				scratch->introns[i].start + 1,
+				scratch->introns[i].end
+			);
+			if (!append(buffer, header, header_length))
+				return false;
+		}
+		if (!append(buffer, "\n", 1))
+			return false;
+
+		if (!append_lines(context, buffer, (ref) { length, scratch->sequence.codes }, true))
+			return false;
+		bases += length;
+	}
+
+	atomic_fetch_add_explicit(&context->bases, bases, memory_order_relaxed);
+	return true;
+}
+
+static bool generate_reads(
+	struct context *context,
+	ssize_t chunk,
+	struct geneie_reorder_buffer *buffer,
+	struct scratch *scratch
+)
+{
+	const struct options *const options = &context->options;
+	struct geneie_synthetic generator = geneie_synthetic_init(
+		options->params,
+		options->seed,
+		(uint64_t)chunk
+	);
+
+	ssize_t first = chunk * READS_PER_CHUNK, last = first + READS_PER_CHUNK;
+	if (last > options->count)
+		last = options->count;
+
+	long bases = 0;
+	for (ssize_t read = first; read < last; read++) {
+		const ssize_t length = geneie_synthetic_read(
+			&generator,
+			options->read,
+			context->source,
+			scratch->sequence
+		);
+		if (length < 0)
+			return false;
+
+		char header[64];
+		const int header_length = snprintf(header, sizeof(header), "@read%zd\n", read + 1);
+		if (!append(buffer, header, header_length)
+			|| !geneie_reorder_buffer_reserve(buffer, buffer->length + length * 2 + 4))
+			return false;
+
+		char *out = buffer->codes + buffer->length;
+		memcpy(out, scratch->sequence.codes, (size_t)length);
+		out += length;
+		memcpy(out, "\n+\n", 3);
+		out += 3;
+		memset(out, 'I', (size_t)length);
+		out += length;
+		*out++ = '\n';
+		buffer->length = out - buffer->codes;
+		bases += length;
+	}
+
+	atomic_fetch_add_explicit(&context->bases, bases, memory_order_relaxed);
+	return true;
+}
+
+static bool generate(
+	struct context *context,
+	ssize_t chunk,
+	struct geneie_reorder_buffer *buffer,
+	struct scratch *scratch
+)
+{
+	buffer->length = 0;
+	switch (context->options.mode) {
+	case MODE_GENOME:
+		return generate_genome(context, chunk, buffer, scratch);
+	case MODE_GENES:
+		return generate_genes(context, chunk, buffer, scratch);
+	case MODE_READS:
+		return generate_reads(context, chunk, buffer, scratch);
+	}
+	return false;
+}
+
+static ssize_t scratch_size(const struct options *options, ref source)
+{
+	switch (options->mode) {
+	case MODE_GENOME:
+		return CHUNK_BASES;
+	case MODE_GENES: {
+		// The longest gene geneie_synthetic_gene() can make
+		const struct geneie_synthetic_gene_params gene = options->gene;
+		return gene.exons * (gene.exon_length + gene.exon_length / 2 + 1)
+			+ (gene.exons - 1) * (gene.intron_length + gene.intron_length / 2 + 4)
+			+ 6;
+	}
+	case MODE_READS:
+		return source.length;
+	}
+	return 0;
+}
+
+static void *worker_main(void *param)
+{
+	struct context *const context = param;
+	const struct options *const options = &context->options;
+	const ssize_t size = scratch_size(options, context->source);
+	struct scratch scratch = {
+		{ size, malloc((size_t)size) },
+		malloc((size_t)options->gene.exons * sizeof(interval_t)),
+	};
+	if (!scratch.sequence.codes || !scratch.introns)
+		geneie_reorder_abort(context->reorder);
+
+	ssize_t chunk;
+	while ((chunk = atomic_fetch_add(&context->next_chunk, 1)) < context->chunk_count) {
+		struct geneie_reorder_buffer *const buffer
+			= geneie_reorder_acquire(context->reorder, chunk);
+		if (!buffer)
+			break;
+
+		if (generate(context, chunk, buffer, &scratch))
+			geneie_reorder_submit(context->reorder, buffer);
+		else
+			geneie_reorder_abort(context->reorder);
+	}
+
+	free(scratch.sequence.codes);
+	free(scratch.introns);
+	return NULL;
+}
+
+/*
+ * Splits the genome into records, and the records into
+ * pieces of whole lines.
+ */
+static bool plan_genome(struct context *context)
+{
+	const struct options *const options = &context->options;
+	const ssize_t piece_size = options->width
+		? CHUNK_BASES / options->width * options->width
+		: CHUNK_BASES;
+	const ssize_t record_size = options->size / options->count;
+
+	ssize_t capacity = options->count + options->size / piece_size + 1;
+	context->pieces = malloc((size_t)capacity * sizeof(struct piece));
+	if (!context->pieces)
+		return false;
+
+	ssize_t count = 0;
+	for (ssize_t record = 0; record < options->count; record++) {
+		ssize_t length = record_size;
+		if (record == options->count - 1)
+			length = options->size - record_size * record;
+
+		ssize_t start = 0;
+		do {
+			ssize_t piece = length - start;
+			if (piece > piece_size)
+				piece = piece_size;
+			context->pieces[count++] = (struct piece) {
+				record,
+				start,
+				piece,
+				start + piece == length,
+			};
+			start += piece;
+		} while (start < length);
+	}
+
+	context->chunk_count = count;
+	return true;
+}
+
+static bool plan(struct context *context)
+{
+	const struct options *const options = &context->options;
+	switch (options->mode) {
+	case MODE_GENOME:
+		return plan_genome(context);
+	case MODE_GENES:
+		context->chunk_count = (options->count + GENES_PER_CHUNK - 1) / GENES_PER_CHUNK;
+		return true;
+	case MODE_READS: {
+		context->chunk_count = (options->count + READS_PER_CHUNK - 1) / READS_PER_CHUNK;
+		context->source = (ref) { options->size, malloc((size_t)options->size) };
+		if (!context->source.codes)
+			return false;
+
+		struct geneie_synthetic generator = geneie_synthetic_init(
+			options->params,
+			options->seed,
+			SOURCE_STREAM
+		);
+		geneie_synthetic_fill(&generator, context->source);
+		return true;
+	}
+	}
+	return false;
+}
+
+static void usage(FILE *file)
+{
+	fprintf(file,
+		"Usage: " PROGRAM " [options]\n"
+		"\n"
+		"Generates reproducible synthetic sequences. The same options\n"
+		"and seed always give the same output, whatever the number of\n"
+		"threads.\n"
+		"\n"
+		"Options:\n"
+		"  -m, --mode=MODE         genome, genes or reads (default genome)\n"
+		"  -n, --size=N            genome size in bases, with an optional\n"
+		"                          K, M or G suffix (default 1M); for reads,\n"
+		"                          the size of the genome they're taken from\n"
+		"  -c, --count=N           sequences in the genome (default 1),\n"
+		"                          genes (default 100) or reads (default 10000)\n"
+		"  -s, --seed=N            random seed (default 1)\n"
+		"  -w, --width=N           FASTA line width, 0 for none (default 60)\n"
+		"  -j, --threads=N         threads (default: one per processor)\n"
+		"  -o, --output=FILE       write to FILE instead of standard output\n"
+		"  -q, --quiet             don't print statistics\n"
+		"  -h, --help              show this help\n"
+		"\n"
+		"Sequence options:\n"
+		"      --gc=F              GC content (default 0.41)\n"
+		"      --ambiguity=F       ambiguity codes per base (default 0)\n"
+		"      --n-runs=F          runs of N per base (default 0)\n"
+		"      --n-run-length=N    mean length of runs of N (default 1000)\n"
+		"      --soft-mask=F       lower case regions per base (default 0)\n"
+		"      --soft-mask-length=N\n"
+		"                          mean length of lower case regions\n"
+		"                          (default 300)\n"
+		"\n"
+		"Gene options:\n"
+		"      --exons=N           exons per gene (default 8)\n"
+		"      --exon-length=N     mean exon length (default 150)\n"
+		"      --intron-length=N   mean intron length (default 2000)\n"
+		"\n"
+		"Read options:\n"
+		"      --read-length=N     mean read length (default 150)\n"
+		"      --read-deviation=N  standard deviation of the read length\n"
+		"                          (default 0)\n"
+		"      --min-read-length=N shortest read (default 1)\n"
+		"      --max-read-length=N longest read, 0 for none (default 0)\n"
+		"      --error-rate=F      substitutions per base (default 0)\n"
+		"      --reverse-rate=F    fraction of reverse strand reads\n"
+		"                          (default 0.5)\n");
+}
+
+static bool parse_size(const char *text, ssize_t minimum, ssize_t *out)
+{
+	char *end;
+	errno = 0;
+	long long value = strtoll(text, &end, 10);
+	if (errno || end == text)
+		return false;
+
+	switch (*end) {
+	case 'G': case 'g':
+		value *= 1024;
+		// fallthrough
+	case 'M': case 'm':
+		value *= 1024;
+		// fallthrough
+	case 'K': case 'k':
+		value *= 1024;
+		end++;
+		break;
+	}
+
+	if (*end || value < minimum)
+		return false;
+	*out = (ssize_t)value;
+	return true;
+}
+
+static bool parse_rate(const char *text, double *out)
+{
+	char *end;
+	errno = 0;
+	const double value = strtod(text, &end);
+	if (errno || end == text || *end || !(value >= 0 && value <= 1))
+		return false;
+	*out = value;
+	return true;
+}
+
+static int parse_options(int argc, char **argv, struct options *options)
+{
+	enum {
+		OPTION_GC = 256,
+		OPTION_AMBIGUITY,
+		OPTION_N_RUNS,
+		OPTION_N_RUN_LENGTH,
+		OPTION_SOFT_MASK,
+		OPTION_SOFT_MASK_LENGTH,
+		OPTION_EXONS,
+		OPTION_EXON_LENGTH,
+		OPTION_INTRON_LENGTH,
+		OPTION_READ_LENGTH,
+		OPTION_READ_DEVIATION,
+		OPTION_MIN_READ_LENGTH,
+		OPTION_MAX_READ_LENGTH,
+		OPTION_ERROR_RATE,
+		OPTION_REVERSE_RATE,
+	};
+	static const struct option long_options[] = {
+		{ "mode", required_argument, NULL, 'm' },
+		{ "size", required_argument, NULL, 'n' },
+		{ "count", required_argument, NULL, 'c' },
+		{ "seed", required_argument, NULL, 's' },
+		{ "width", required_argument, NULL, 'w' },
+		{ "threads", required_argument, NULL, 'j' },
+		{ "output", required_argument, NULL, 'o' },
+		{ "quiet", no_argument, NULL, 'q' },
+		{ "help", no_argument, NULL, 'h' },
+		{ "gc", required_argument, NULL, OPTION_GC },
+		{ "ambiguity", required_argument, NULL, OPTION_AMBIGUITY },
+		{ "n-runs", required_argument, NULL, OPTION_N_RUNS },
+		{ "n-run-length", required_argument, NULL, OPTION_N_RUN_LENGTH },
+		{ "soft-mask", required_argument, NULL, OPTION_SOFT_MASK },
+		{ "soft-mask-length", required_argument, NULL, OPTION_SOFT_MASK_LENGTH },
+		{ "exons", required_argument, NULL, OPTION_EXONS },
+		{ "exon-length", required_argument, NULL, OPTION_EXON_LENGTH },
+		{ "intron-length", required_argument, NULL, OPTION_INTRON_LENGTH },
+		{ "read-length", required_argument, NULL, OPTION_READ_LENGTH },
+		{ "read-deviation", required_argument, NULL, OPTION_READ_DEVIATION },
+		{ "min-read-length", required_argument, NULL, OPTION_MIN_READ_LENGTH },
+		{ "max-read-length", required_argument, NULL, OPTION_MAX_READ_LENGTH },
+		{ "error-rate", required_argument, NULL, OPTION_ERROR_RATE },
+		{ "reverse-rate", required_argument, NULL, OPTION_REVERSE_RATE },
+		{ 0 },
+	};
+
+	*options = (struct options) {
+		.mode = MODE_GENOME,
+		.size = 1024 * 1024,
+		.seed = 1,
+		.width = 60,
+		.params = GENEIE_SYNTHETIC_PARAMS_DEFAULT,
+		.gene = { 8, 150, 2000 },
+		.read = {
+			.length = 150,
+			.min_length = 1,
+			.reverse_rate = 0.5,
+		},
+	};
+
+	ssize_t threads = 0;
+	int option;
+	bool valid = true;
+	while (valid && (option = getopt_long(argc, argv, "m:n:c:s:w:j:o:qh", long_options, NULL)) != -1) {
+		switch (option) {
+		case 'm':
+			if (!strcmp(optarg, "genome"))
+				options->mode = MODE_GENOME;
+			else if (!strcmp(optarg, "genes"))
+				options->mode = MODE_GENES;
+			else if (!strcmp(optarg, "reads"))
+				options->mode = MODE_READS;
+			else
+				valid = false;
+			break;
+		case 'n':
+			valid = parse_size(optarg, 1, &options->size);
+			break;
+		case 'c':
+			valid = parse_size(optarg, 1, &options->count);
+			break;
+		case 's': {
+			char *end;
+			errno = 0;
+			options->seed = strtoull(optarg, &end, 0);
+			valid = !errno && end != optarg && !*end;
+			break;
+		}
+		case 'w':
+			valid = parse_size(optarg, 0, &options->width);
+			break;
+		case 'j':
+			valid = parse_size(optarg, 1, &threads) && threads <= 1024;
+			options->threads = (int)threads;
+			break;
+		case 'o':
+			options->output = optarg;
+			break;
+		case 'q':
+			options->quiet = true;
+			break;
+		case 'h':
+			usage(stdout);
+			exit(0);
+		case OPTION_GC:
+			valid = parse_rate(optarg, &options->params.gc_content);
+			break;
+		case OPTION_AMBIGUITY:
+			valid = parse_rate(optarg, &options->params.ambiguity_rate);
+			break;
+		case OPTION_N_RUNS:
+			valid = parse_rate(optarg, &options->params.n_run_rate);
+			break;
+		case OPTION_N_RUN_LENGTH:
+			valid = parse_size(optarg, 1, &options->params.n_run_length);
+			break;
+		case OPTION_SOFT_MASK:
+			valid = parse_rate(optarg, &options->params.soft_mask_rate);
+			break;
+		case OPTION_SOFT_MASK_LENGTH:
+			valid = parse_size(optarg, 1, &options->params.soft_mask_length);
+			break;
+		case OPTION_EXONS:
+			valid = parse_size(optarg, 1, &options->gene.exons);
+			break;
+		case OPTION_EXON_LENGTH:
+			valid = parse_size(optarg, 1, &options->gene.exon_length);
+			break;
+		case OPTION_INTRON_LENGTH:
+			valid = parse_size(optarg, 1, &options->gene.intron_length);
+			break;
+		case OPTION_READ_LENGTH:
+			valid = parse_size(optarg, 1, &options->read.length);
+			break;
+		case OPTION_READ_DEVIATION:
+			valid = parse_size(optarg, 0, &options->read.length_deviation);
+			break;
+		case OPTION_MIN_READ_LENGTH:
+			valid = parse_size(optarg, 1, &options->read.min_length);
+			break;
+		case OPTION_MAX_READ_LENGTH:
+			valid = parse_size(optarg, 0, &options->read.max_length);
+			break;
+		case OPTION_ERROR_RATE:
+			valid = parse_rate(optarg, &options->read.error_rate);
+			break;
+		case OPTION_REVERSE_RATE:
+			valid = parse_rate(optarg, &options->read.reverse_rate);
+			break;
+		default:
+			usage(stderr);
+			return 2;
+		}
+	}
+
+	if (!valid) {
+		fprintf(stderr, PROGRAM ": invalid argument: %s\n", optarg);
+		return 2;
+	}
+	if (optind < argc) {
+		usage(stderr);
+		return 2;
+	}
+
+	if (!options->count) {
+		options->count = options->mode == MODE_GENES ? 100
+			: options->mode == MODE_READS ? 10000
+			: 1;
+	}
+	if (options->mode == MODE_GENOME && options->count > options->size) {
+		fprintf(stderr, PROGRAM ": more sequences than bases\n");
+		return 2;
+	}
+
+	if (!options->threads) {
+		const long online = sysconf(_SC_NPROCESSORS_ONLN);
+		options->threads = online > 0 ? (int)online : 1;
+	}
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	struct context context = { 0 };
+	const int usage_error = parse_options(argc, argv, &context.options);
+	if (usage_error)
+		return usage_error;
+	const struct options *const options = &context.options;
+
+	FILE *const output = options->output ? fopen(options->output, "w") : stdout;
+	if (!output) {
+		fprintf(stderr, PROGRAM ": %s: %s\n", options->output, strerror(errno));
+		return 1;
+	}
+	setvbuf(output, NULL, _IOFBF, OUTPUT_BUFFER_SIZE);
+
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	const int window = options->threads * CHUNKS_PER_THREAD;
+	pthread_t *const threads = calloc((size_t)options->threads, sizeof(pthread_t));
+	context.reorder = geneie_reorder_create(window, 0, write_output, output);
+	if (!threads || !geneie_reorder_valid(context.reorder) || !plan(&context)) {
+		fprintf(stderr, PROGRAM ": out of memory\n");
+		return 1;
+	}
+
+	int started = 0;
+	for (; started < options->threads; started++) {
+		if (pthread_create(&threads[started], NULL, worker_main, &context))
+			break;
+	}
+	for (int i = 0; i < started; i++)
+		pthread_join(threads[i], NULL);
+
+	bool ok = true;
+	if (geneie_reorder_written(context.reorder) != context.chunk_count
+		|| fflush(output)
+		|| ferror(output)) {
+		fprintf(stderr, PROGRAM ": failed: %s\n", errno ? strerror(errno) : "invalid parameters");
+		ok = false;
+	}
+	if (options->output && fclose(output))
+		ok = false;
+
+	const double elapsed = seconds_since(start);
+	if (!options->quiet) {
+		const long bases = atomic_load(&context.bases);
+		fprintf(stderr,
+			PROGRAM ": %ld bases in %.3f s (%.1f Mbases/s, %d threads)\n",
+			bases,
+			elapsed,
+			elapsed > 0 ? (double)bases / elapsed / 1e6 : 0.0,
+			started
+		);
+	}
+
+	geneie_reorder_destroy(context.reorder);
+	free(context.pieces);
+	free(context.source.codes);
+	free(threads);
+	return ok ? 0 : 1;
+}
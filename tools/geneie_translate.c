@@ -0,0 +1,686 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <getopt.h>
+
+#include <geneie.h>
+
+/*
+ * Translates every record of a FASTA or FASTQ file into
+ * protein FASTA.
+ *
+ * This is a geneie_pipeline run in order: the source parses
+ * records, filling each chunk with references to them
+ * rather than copies, one stage translates chunks on every
+ * thread, and the sink writes them out in input order.
+ *
+ * Each chunk has a slot, picked by its index, holding the
+ * input its records reference when streaming and the
+ * output it's translated into. Ordered runs never have
+ * more chunks in flight than the pipeline owns, so no two
+ * of them share a slot, and memory stays bounded however
+ * big the input is.
+ */
+
+typedef struct geneie_sequence_ref ref;
+typedef struct geneie_pipeline_chunk chunk_t;
+
+#define PROGRAM "geneie-translate"
+
+#define JOB_CODES (1024 * 1024)
+#define JOB_RECORDS 8192
+#define JOBS_PER_THREAD 2
+#define OUTPUT_BUFFER_SIZE (1024 * 1024)
+#define FASTQ_BATCH_SIZE 1024
+
+// Each chunk copies what the last one left, so keep it small
+#define STREAM_BUFFER_SIZE (2 * JOB_CODES)
+
+enum strands {
+	STRAND_FORWARD = 1,
+	STRAND_REVERSE = 2,
+	STRAND_BOTH = STRAND_FORWARD | STRAND_REVERSE,
+};
+
+struct options {
+	int first_frame, last_frame;
+	enum strands strands;
+	int threads;
+	int width;
+	bool stream;
+	bool quiet;
+	const char *input;
+	const char *output;
+};
+
+struct record {
+	ref name;
+	ref strand;
+};
+
+struct buffer {
+	ssize_t length, capacity;
+	char *codes;
+};
+
+struct slot {
+	struct buffer input;
+	struct buffer output;
+	struct buffer aminos;
+	long translated;
+};
+
+struct context {
+	struct options options;
+	int translations;
+
+	struct slot *slots;
+	ssize_t slot_count;
+	FILE *output;
+	bool write_failed;
+
+	// Only used by the source
+	struct geneie_mapped_file file;
+	struct geneie_decompress_reader reader;
+	struct geneie_fastq_batch batch;
+	ref rest;
+	bool final;
+	ssize_t filled;
+
+	ssize_t records, bases;
+	long aminos;
+};
+
+static double seconds_since(struct timespec start)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (double)(now.tv_sec - start.tv_sec)
+		+ (double)(now.tv_nsec - start.tv_nsec) / 1e9;
+}
+
+static bool reserve(struct buffer *buffer, ssize_t capacity)
+{
+	if (capacity <= buffer->capacity)
+		return true;
+
+	if (capacity < buffer->capacity * 2)
+		capacity = buffer->capacity * 2;
+	char *const codes = realloc(buffer->codes, (size_t)capacity);
+	if (!codes)
+		return false;
+	buffer->codes = codes;
+	buffer->capacity = capacity;
+	return true;
+}
+
+static struct slot *slot_of(struct context *context, ssize_t index)
+{
+	return &context->slots[index % context->slot_count];
+}
+
+/*
+ * Appends a header for one translation: the whole header
+ * if each record only gets one, or else the first word
+ * with the strand and frame added, then the rest.
+ */
+static char *put_header(
+	struct context *context,
+	char *out,
+	ref name,
+	bool reverse,
+	int frame
+)
+{
+	*out++ = '>';
+	if (context->translations == 1) {
+		memcpy(out, name.codes, (size_t)name.length);
+		out += name.length;
+	} else {
+		ssize_t word = 0;
+		while (word < name.length && name.codes[word] != ' ' && name.codes[word] != '\t')
+			word++;
+
+		memcpy(out, name.codes, (size_t)word);
+		out += word;
+		out += sprintf(out, "_%c%d", reverse ? 'R' : 'F', frame);
+		memcpy(out, name.codes + word, (size_t)(name.length - word));
+		out += name.length - word;
+	}
+	*out++ = '\n';
+	return out;
+}
+
+/*
+ * Appends the amino acids, wrapped to the line width, with
+ * stops written as '*' as protein FASTA expects.
+ */
+static char *put_aminos(struct context *context, char *out, ref aminos)
+{
+	const ssize_t width = context->options.width
+		? context->options.width
+		: aminos.length;
+
+	for (ssize_t start = 0; start < aminos.length; start += width) {
+		ssize_t line = aminos.length - start;
+		if (line > width)
+			line = width;
+
+		for (ssize_t i = 0; i < line; i++) {
+			const geneie_code amino = aminos.codes[start + i];
+			out[i] = amino == GENEIE_CODE_STOP ? '*' : amino;
+		}
+		out += line;
+		*out++ = '\n';
+	}
+	if (aminos.length == 0)
+		*out++ = '\n';
+	return out;
+}
+
+static bool translate_frame(
+	struct context *context,
+	struct slot *slot,
+	struct record record,
+	bool reverse,
+	int frame
+)
+{
+	const ssize_t width = context->options.width ? context->options.width : 1;
+
+	ref codons = { 0, record.strand.codes };
+	if (record.strand.length >= frame - 1)
+		codons = geneie_sequence_ref_index(record.strand, frame - 1);
+
+	const ssize_t count = codons.length / 3;
+	if (!reserve(&slot->aminos, count))
+		return false;
+	const ref aminos = {
+		geneie_encoding_translate(codons, (ref) { count, slot->aminos.codes }),
+		slot->aminos.codes,
+	};
+
+	// Header, a suffix and line breaks
+	struct buffer *const output = &slot->output;
+	const ssize_t needed = output->length
+		+ record.name.length + 32
+		+ count + count / width + 2;
+	if (!reserve(output, needed))
+		return false;
+
+	char *out = output->codes + output->length;
+	out = put_header(context, out, record.name, reverse, frame);
+	out = put_aminos(context, out, aminos);
+	output->length = out - output->codes;
+	slot->translated += count;
+	return true;
+}
+
+/*
+ * The pipeline's stage. Forward frames come first, since
+ * the reverse ones complement the record in place.
+ */
+static bool translate_chunk(chunk_t *chunk, void *param)
+{
+	struct context *const context = param;
+	const struct options *const options = &context->options;
+	struct slot *const slot = slot_of(context, chunk->index);
+	const struct record *const records = (const struct record *)chunk->data.codes;
+	const ssize_t count = chunk->data.length / (ssize_t)sizeof(struct record);
+
+	slot->output.length = 0;
+	slot->translated = 0;
+	for (ssize_t i = 0; i < count; i++) {
+		for (int reverse = 0; reverse < 2; reverse++) {
+			if (!(options->strands & (reverse ? STRAND_REVERSE : STRAND_FORWARD)))
+				continue;
+			if (reverse)
+				geneie_sequence_tools_reverse_complement(records[i].strand);
+
+			for (int frame = options->first_frame; frame <= options->last_frame; frame++) {
+				if (!translate_frame(context, slot, records[i], reverse, frame)) {
+					fprintf(stderr, PROGRAM ": out of memory\n");
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+static bool write_chunk(chunk_t *chunk, void *param)
+{
+	struct context *const context = param;
+	const struct slot *const slot = slot_of(context, chunk->index);
+
+	context->aminos += slot->translated;
+	if (fwrite(slot->output.codes, 1, (size_t)slot->output.length, context->output)
+		!= (size_t)slot->output.length) {
+		context->write_failed = true;
+		return false;
+	}
+	return true;
+}
+
+/*
+ * Parses complete records from the rest of the input, up
+ * to a chunk's worth, and returns how many, or -1 if the
+ * input is malformed.
+ */
+static ssize_t parse_fasta(struct context *context, struct record *records, ssize_t room)
+{
+	struct geneie_fasta_reader reader
+		= geneie_fasta_reader_init(context->rest.codes, context->rest.length, context->final);
+	struct geneie_fasta_record record;
+
+	ssize_t count = 0, bases = 0;
+	while (count < room && bases < JOB_CODES && geneie_fasta_reader_next(&reader, &record)) {
+		records[count++] = (struct record) {
+			.name = { record.header_length, record.header },
+			.strand = record.sequence,
+		};
+		bases += record.sequence.length;
+	}
+
+	context->rest = geneie_fasta_reader_remaining(reader);
+	return count;
+}
+
+static ssize_t parse_fastq(struct context *context, struct record *records, ssize_t room)
+{
+	struct geneie_fastq_reader reader
+		= geneie_fastq_reader_init(context->rest.codes, context->rest.length, context->final);
+	struct geneie_fastq_batch *const batch = &context->batch;
+
+	ssize_t count = 0, bases = 0, got = batch->capacity;
+	while (got == batch->capacity && count + batch->capacity <= room && bases < JOB_CODES) {
+		got = geneie_fastq_reader_read_batch(&reader, batch);
+		if (got < 0) {
+			fprintf(stderr, PROGRAM ": malformed FASTQ record\n");
+			return -1;
+		}
+
+		for (ssize_t i = 0; i < got; i++) {
+			const struct geneie_fastq_record *const record = &batch->records[i];
+			records[count++] = (struct record) {
+				.name = { record->name_length, record->name },
+				.strand = record->sequence,
+			};
+			bases += record->sequence.length;
+		}
+	}
+
+	context->rest = geneie_fastq_reader_remaining(reader);
+	return count;
+}
+
+static ssize_t parse(struct context *context, struct record *records, ssize_t room)
+{
+	const ref rest = context->rest;
+	ssize_t start = 0;
+	while (start < rest.length && (rest.codes[start] == '\n' || rest.codes[start] == '\r'))
+		start++;
+
+	const bool fastq = start < rest.length && rest.codes[start] == '@';
+	return fastq
+		? parse_fastq(context, records, room)
+		: parse_fasta(context, records, room);
+}
+
+/*
+ * Reads more input after the rest, which must be at the
+ * front of the buffer, growing it if the rest fills it.
+ */
+static bool read_more(struct context *context, struct buffer *input)
+{
+	if (context->rest.length == input->capacity && !reserve(input, input->capacity * 2)) {
+		fprintf(stderr, PROGRAM ": out of memory\n");
+		return false;
+	}
+
+	const ssize_t space = input->capacity - context->rest.length;
+	const ssize_t got = geneie_decompress_reader_read(
+		context->reader,
+		input->codes + context->rest.length,
+		space
+	);
+	if (got < 0) {
+		const char *const path = context->options.input;
+		fprintf(stderr, PROGRAM ": %s: read error\n", path ? path : "stdin");
+		return false;
+	}
+
+	context->final = got < space;
+	context->rest = (ref) { context->rest.length + got, input->codes };
+	return true;
+}
+
+/*
+ * Moves the rest of the input, still in the last chunk's
+ * slot, into this one's, so that each chunk only references
+ * its own slot.
+ */
+static bool take_rest(struct context *context, struct buffer *input)
+{
+	const ssize_t wanted = context->rest.length > STREAM_BUFFER_SIZE
+		? context->rest.length
+		: STREAM_BUFFER_SIZE;
+	if (!reserve(input, wanted)) {
+		fprintf(stderr, PROGRAM ": out of memory\n");
+		return false;
+	}
+
+	if (context->rest.length)
+		memcpy(input->codes, context->rest.codes, (size_t)context->rest.length);
+	context->rest.codes = input->codes;
+	return context->final || read_more(context, input);
+}
+
+/*
+ * The pipeline's source. Chunks are numbered in the order
+ * they're filled, so counting them gives this one's slot.
+ */
+static ssize_t read_records(geneie_code *buffer, ssize_t capacity, void *param)
+{
+	struct context *const context = param;
+	struct slot *const slot = slot_of(context, context->filled);
+	struct record *const records = (struct record *)buffer;
+	const ssize_t room = capacity / (ssize_t)sizeof(struct record);
+	const bool streaming = geneie_decompress_reader_valid(context->reader);
+
+	if (streaming && !take_rest(context, &slot->input))
+		return -1;
+
+	for (;;) {
+		const ssize_t count = parse(context, records, room);
+		if (count < 0)
+			return -1;
+
+		if (count > 0) {
+			for (ssize_t i = 0; i < count; i++)
+				context->bases += records[i].strand.length;
+			context->records += count;
+			context->filled++;
+			return count * (ssize_t)sizeof(struct record);
+		}
+
+		// Anything left at the end is an incomplete record
+		if (context->final)
+			return context->rest.length ? -1 : 0;
+
+		if (!streaming || !read_more(context, &slot->input))
+			return -1;
+	}
+}
+
+/*
+ * Maps plain files, which lets the FASTA reader work on
+ * them in-place, and streams anything compressed or not
+ * seekable.
+ */
+static bool open_input(struct context *context)
+{
+	const char *const path = context->options.input;
+	bool stream = !path || context->options.stream;
+
+	if (!stream) {
+		const int fd = open(path, O_RDONLY | O_CLOEXEC);
+		if (fd < 0) {
+			fprintf(stderr, PROGRAM ": %s: %s\n", path, strerror(errno));
+			return false;
+		}
+
+		unsigned char magic[2] = { 0 };
+		const bool compressed = read(fd, magic, 2) == 2
+			&& magic[0] == 0x1f && magic[1] == 0x8b;
+		const bool seekable = lseek(fd, 0, SEEK_END) > 0;
+		close(fd);
+		stream = compressed || !seekable;
+	}
+
+	if (stream) {
+		context->reader = path
+			? geneie_decompress_reader_open(path, geneie_thread_pool_default())
+			: geneie_decompress_reader_from_fd(STDIN_FILENO, geneie_thread_pool_default());
+		if (!geneie_decompress_reader_valid(context->reader)) {
+			fprintf(stderr, PROGRAM ": %s: %s\n", path ? path : "stdin", strerror(errno));
+			return false;
+		}
+		return true;
+	}
+
+	context->file = geneie_mapped_file_open(path, true);
+	if (!geneie_mapped_file_valid(context->file)) {
+		fprintf(stderr, PROGRAM ": %s: %s\n", path, strerror(errno));
+		return false;
+	}
+	context->rest = (ref) { context->file.length, context->file.data };
+	context->final = true;
+	return true;
+}
+
+static void close_input(struct context *context)
+{
+	if (geneie_decompress_reader_valid(context->reader))
+		geneie_decompress_reader_close(context->reader);
+	if (geneie_mapped_file_valid(context->file))
+		geneie_mapped_file_close(context->file);
+}
+
+static void usage(FILE *file)
+{
+	fprintf(file,
+		"Usage: " PROGRAM " [options] [input]\n"
+		"\n"
+		"Translates FASTA or FASTQ records, optionally gzip or BGZF\n"
+		"compressed, into protein FASTA. Reads standard input if no\n"
+		"input is given, or it is -.\n"
+		"\n"
+		"Options:\n"
+		"  -f, --frame=N      frame 1, 2 or 3, or \"all\" (default 1)\n"
+		"  -s, --strand=S     forward, reverse or both (default forward)\n"
+		"  -t, --table=N      genetic code; only 1, the standard code,\n"
+		"                     is supported\n"
+		"  -j, --threads=N    most threads to translate on at once\n"
+		"                     (default: one per processor)\n"
+		"  -w, --width=N      protein line width, 0 for no wrapping\n"
+		"                     (default 60)\n"
+		"  -o, --output=FILE  write to FILE instead of standard output\n"
+		"      --stream       read plain files instead of mapping them\n"
+		"  -q, --quiet        don't print statistics\n"
+		"  -h, --help         show this help\n"
+		"\n"
+		"Codons that can't be resolved to one amino acid are written\n"
+		"as X, and stop codons as *.\n");
+}
+
+static bool parse_number(const char *text, int minimum, int *out)
+{
+	char *end;
+	errno = 0;
+	const long value = strtol(text, &end, 10);
+	if (errno || end == text || *end || value < minimum || value > 1 << 20)
+		return false;
+	*out = (int)value;
+	return true;
+}
+
+static int parse_options(int argc, char **argv, struct options *options)
+{
+	enum { OPTION_STREAM = 256 };
+	static const struct option long_options[] = {
+		{ "frame", required_argument, NULL, 'f' },
+		{ "strand", required_argument, NULL, 's' },
+		{ "table", required_argument, NULL, 't' },
+		{ "threads", required_argument, NULL, 'j' },
+		{ "width", required_argument, NULL, 'w' },
+		{ "output", required_argument, NULL, 'o' },
+		{ "stream", no_argument, NULL, OPTION_STREAM },
+		{ "quiet", no_argument, NULL, 'q' },
+		{ "help", no_argument, NULL, 'h' },
+		{ 0 },
+	};
+
+	*options = (struct options) {
+		.first_frame = 1,
+		.last_frame = 1,
+		.strands = STRAND_FORWARD,
+		.width = 60,
+	};
+
+	int option, table;
+	while ((option = getopt_long(argc, argv, "f:s:t:j:w:o:qh", long_options, NULL)) != -1) {
+		switch (option) {
+		case 'f':
+			if (!strcmp(optarg, "all")) {
+				options->first_frame = 1;
+				options->last_frame = 3;
+			} else if (parse_number(optarg, 1, &options->first_frame)
+				&& options->first_frame <= 3) {
+				options->last_frame = options->first_frame;
+			} else {
+				fprintf(stderr, PROGRAM ": invalid frame: %s\n", optarg);
+				return 2;
+			}
+			break;
+		case 's':
+			if (!strcmp(optarg, "forward")) {
+				options->strands = STRAND_FORWARD;
+			} else if (!strcmp(optarg, "reverse")) {
+				options->strands = STRAND_REVERSE;
+			} else if (!strcmp(optarg, "both")) {
+				options->strands = STRAND_BOTH;
+			} else {
+				fprintf(stderr, PROGRAM ": invalid strand: %s\n", optarg);
+				return 2;
+			}
+			break;
+		case 't':
+			if (!parse_number(optarg, 1, &table) || table != 1) {
+				fprintf(stderr, PROGRAM ": unsupported genetic code: %s\n", optarg);
+				return 2;
+			}
+			break;
+		case 'j':
+			if (!parse_number(optarg, 1, &options->threads)) {
+				fprintf(stderr, PROGRAM ": invalid thread count: %s\n", optarg);
+				return 2;
+			}
+			break;
+		case 'w':
+			if (!parse_number(optarg, 0, &options->width)) {
+				fprintf(stderr, PROGRAM ": invalid width: %s\n", optarg);
+				return 2;
+			}
+			break;
+		case 'o':
+			options->output = optarg;
+			break;
+		case OPTION_STREAM:
+			options->stream = true;
+			break;
+		case 'q':
+			options->quiet = true;
+			break;
+		case 'h':
+			usage(stdout);
+			exit(0);
+		default:
+			usage(stderr);
+			return 2;
+		}
+	}
+
+	if (optind < argc - 1) {
+		usage(stderr);
+		return 2;
+	}
+	if (optind == argc - 1 && strcmp(argv[optind], "-"))
+		options->input = argv[optind];
+
+	if (!options->threads) {
+		const long online = sysconf(_SC_NPROCESSORS_ONLN);
+		options->threads = online > 0 ? (int)online : 1;
+	}
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	struct context context = { 0 };
+	const int usage_error = parse_options(argc, argv, &context.options);
+	if (usage_error)
+		return usage_error;
+
+	const struct options *const options = &context.options;
+	context.translations = (options->last_frame - options->first_frame + 1)
+		* (options->strands == STRAND_BOTH ? 2 : 1);
+
+	context.output = options->output ? fopen(options->output, "w") : stdout;
+	if (!context.output) {
+		fprintf(stderr, PROGRAM ": %s: %s\n", options->output, strerror(errno));
+		return 1;
+	}
+	setvbuf(context.output, NULL, _IOFBF, OUTPUT_BUFFER_SIZE);
+
+	struct timespec start;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+
+	context.slot_count = options->threads * JOBS_PER_THREAD + 1;
+	context.slots = calloc((size_t)context.slot_count, sizeof(struct slot));
+	context.batch = geneie_fastq_batch_alloc(FASTQ_BATCH_SIZE);
+	const struct geneie_pipeline pipeline = geneie_pipeline_create(
+		context.slot_count,
+		JOB_RECORDS * (ssize_t)sizeof(struct record),
+		geneie_thread_pool_default()
+	);
+	if (!context.slots
+		|| !geneie_fastq_batch_valid(context.batch)
+		|| !geneie_pipeline_valid(pipeline)
+		|| !geneie_pipeline_add_stage(pipeline, translate_chunk, &context, options->threads)) {
+		fprintf(stderr, PROGRAM ": out of memory\n");
+		return 1;
+	}
+
+	bool ok = open_input(&context)
+		&& geneie_pipeline_run_ordered(pipeline, read_records, &context, write_chunk, &context);
+	close_input(&context);
+
+	if (context.write_failed
+		|| fflush(context.output)
+		|| ferror(context.output)) {
+		fprintf(stderr, PROGRAM ": write error: %s\n", strerror(errno));
+		ok = false;
+	}
+	if (options->output && fclose(context.output))
+		ok = false;
+
+	const double elapsed = seconds_since(start);
+	if (!options->quiet) {
+		fprintf(stderr,
+			PROGRAM ": %zd records, %zd bases, %ld amino acids"
+			" in %.3f s (%.1f Mbases/s, %.0f records/s, %d threads)\n",
+			context.records,
+			context.bases,
+			context.aminos,
+			elapsed,
+			elapsed > 0 ? (double)context.bases / elapsed / 1e6 : 0.0,
+			elapsed > 0 ? (double)context.records / elapsed : 0.0,
+			options->threads
+		);
+	}
+
+	for (ssize_t i = 0; i < context.slot_count; i++) {
+		free(context.slots[i].input.codes);
+		free(context.slots[i].output.codes);
+		free(context.slots[i].aminos.codes);
+	}
+	geneie_pipeline_destroy(pipeline);
+	geneie_fastq_batch_free(context.batch);
+	free(context.slots);
+	return ok ? 0 : 1;
+}